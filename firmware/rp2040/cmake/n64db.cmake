@@ -0,0 +1,107 @@
+# ── Cartridge database: docs/n64.txt → sorted table in flash ───────
+# Included:   n64_generate_cart_db(<target> <n64.txt>) adds a build step
+#             that writes n64db_data.c and compiles it into <target>.
+# Script (-P): cmake -DIN=n64.txt -DOUT=n64db_data.c -P n64db.cmake
+#
+# n64.txt records are "<name>.z64", "CRC32,CRC1,sizeMB,savetype", blank.
+# The table is sorted by (CRC1, CRC32) for n64db_find(); names go to a
+# separate string pool so the entries stay 12 bytes.
+
+if(NOT CMAKE_SCRIPT_MODE_FILE)
+    set(N64DB_SCRIPT ${CMAKE_CURRENT_LIST_FILE})
+
+    function(n64_generate_cart_db target input)
+        set(out ${CMAKE_CURRENT_BINARY_DIR}/n64db_data.c)
+        add_custom_command(
+            OUTPUT  ${out}
+            COMMAND ${CMAKE_COMMAND} -DIN=${input} -DOUT=${out} -P ${N64DB_SCRIPT}
+            DEPENDS ${input} ${N64DB_SCRIPT}
+            COMMENT "Compiling cartridge database ${input}"
+            VERBATIM)
+        target_sources(${target} PRIVATE ${out})
+    endfunction()
+    return()
+endif()
+
+# ── Script mode ────────────────────────────────────────────────────
+file(READ ${IN} text)
+
+# Names may hold ';' and brackets, which CMake lists treat specially
+string(REPLACE ";" "@SC@" text "${text}")
+string(REPLACE "[" "@LB@" text "${text}")
+string(REPLACE "]" "@RB@" text "${text}")
+string(REPLACE "\r" "" text "${text}")
+string(REPLACE "\n" ";" lines "${text}")
+
+set(records "")
+set(name "")
+set(lineno 0)
+foreach(line IN LISTS lines)
+    math(EXPR lineno "${lineno} + 1")
+    if(line STREQUAL "")
+        continue()
+    endif()
+    if(name STREQUAL "")
+        set(name "${line}")
+        continue()
+    endif()
+
+    string(REGEX MATCH "^([0-9A-Fa-f]+),([0-9A-Fa-f]+),([0-9]+),([0-9]+)$" m "${line}")
+    if(NOT m)
+        message(FATAL_ERROR "${IN}:${lineno}: expected CRC32,CRC1,size,save")
+    endif()
+    string(TOUPPER "${CMAKE_MATCH_1}" crc32)
+    string(TOUPPER "${CMAKE_MATCH_2}" crc1)
+    math(EXPR size "${CMAKE_MATCH_3}")      # drops the leading zero of "08"
+    set(save ${CMAKE_MATCH_4})
+    string(REGEX REPLACE "\\.[zZ]64$" "" name "${name}")
+
+    # CRC1 first so a plain string sort orders the table numerically
+    list(APPEND records "${crc1}|${crc32}|${size}|${save}|${name}")
+    set(name "")
+endforeach()
+list(SORT records)
+list(LENGTH records count)
+
+set(entries "")
+set(pool "")
+set(pool_len 0)
+foreach(r IN LISTS records)
+    string(REPLACE "|" ";" f "${r}")
+    list(GET f 0 crc1)
+    list(GET f 1 crc32)
+    list(GET f 2 size)
+    list(GET f 3 save)
+    list(GET f 4 name)
+    string(REPLACE "@SC@" ";" name "${name}")
+    string(REPLACE "@LB@" "[" name "${name}")
+    string(REPLACE "@RB@" "]" name "${name}")
+
+    string(APPEND entries "    { 0x${crc1}u, 0x${crc32}u, ${pool_len}u, ${size}u, ${save}u },\n")
+
+    string(LENGTH "${name}" n)
+    math(EXPR pool_len "${pool_len} + ${n} + 1")
+    string(REPLACE "\\" "\\\\" name "${name}")
+    string(REPLACE "\"" "\\\"" name "${name}")
+    string(APPEND pool "    \"${name}\\0\"\n")
+endforeach()
+
+if(pool_len GREATER 65535)
+    message(FATAL_ERROR "${IN}: name pool is ${pool_len} bytes, n64db_entry_t.name is 16-bit")
+endif()
+
+file(WRITE ${OUT}
+"/* n64db_data.c – generated from n64.txt by cmake/n64db.cmake, do not edit */
+#include <stdint.h>
+#include <stddef.h>
+
+#include <app/n64db.h>
+
+const n64db_entry_t n64db_table[] = {
+${entries}};
+
+const size_t n64db_count = ${count};
+
+const char n64db_names[${pool_len}] =
+${pool};
+")
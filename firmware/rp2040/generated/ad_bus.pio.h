@@ -0,0 +1,52 @@
+// -------------------------------------------------- //
+// This file is autogenerated by pioasm; do not edit! //
+// -------------------------------------------------- //
+
+#pragma once
+
+#if !PICO_NO_HARDWARE
+#include "hardware/pio.h"
+#endif
+
+// ----------- //
+// ad_bus_read //
+// ----------- //
+
+#define ad_bus_read_wrap_target 0
+#define ad_bus_read_wrap 7
+#define ad_bus_read_pio_version 0
+
+#define ad_bus_read_offset_word_loop 2u
+#define ad_bus_read_offset_access_wait 4u
+
+static const uint16_t ad_bus_read_program_instructions[] = {
+            //     .wrap_target
+    0x80a0, //  0: pull   block
+    0x6030, //  1: out    x, 16
+    0xe000, //  2: set    pins, 0
+    0xa047, //  3: mov    y, osr
+    0x0084, //  4: jmp    y--, 4
+    0x4010, //  5: in     pins, 16
+    0xe601, //  6: set    pins, 1                [6]
+    0x0042, //  7: jmp    x--, 2
+            //     .wrap
+};
+
+#if !PICO_NO_HARDWARE
+static const struct pio_program ad_bus_read_program = {
+    .instructions = ad_bus_read_program_instructions,
+    .length = 8,
+    .origin = -1,
+    .pio_version = ad_bus_read_pio_version,
+#if PICO_PIO_VERSION > 0
+    .used_gpio_ranges = 0x0
+#endif
+};
+
+static inline pio_sm_config ad_bus_read_program_get_default_config(uint offset) {
+    pio_sm_config c = pio_get_default_sm_config();
+    sm_config_set_wrap(&c, offset + ad_bus_read_wrap_target, offset + ad_bus_read_wrap);
+    return c;
+}
+#endif
+
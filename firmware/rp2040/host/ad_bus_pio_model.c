@@ -0,0 +1,218 @@
+/* ad_bus_pio_model.c – host-side timing model of the ad_bus_read PIO program
+ *  ---------------------------------------------------------------
+ *  • Runs the generated ad_bus_read instructions in pio_sim against a
+ *    cartridge that only drives valid data T_acs after /RD falls
+ *  • Reports words/s, estimated 64 MiB dump time and the sample margin
+ *  • --sweep walks the access delay to find the fastest passing setting
+ *
+ *  Build (from firmware/rp2040):
+ *    cc -O2 -std=c11 -DPICO_NO_HARDWARE=1 -Iinclude -Igenerated -Ihost \
+ *       -o ad_bus_pio_model host/ad_bus_pio_model.c host/pio_sim.c
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "ad_bus.pio.h"
+#include "pio_sim.h"
+#include <bus/ad_bus.h>
+#include <bus/ad_bus_pio.h>
+
+#define SYNC_CYCLES   2u          // GPIO input synchroniser depth
+#define HISTORY       4u          // ring of pad levels, > SYNC_CYCLES
+
+typedef struct {
+    // parameters
+    double   ns_per_cycle;
+    double   tacc_ns;             // cartridge /RD → data valid
+    // pad state
+    uint32_t out_levels;          // levels driven by the SM (RD only)
+    uint32_t pending_mask, pending_vals;
+    uint32_t pad_hist[HISTORY];
+    uint64_t now;                 // current system cycle
+    // cartridge state
+    uint32_t addr;
+    bool     rd_low;
+    uint64_t rd_fall;
+    uint64_t rd_rise;
+    double   min_rd_high_ns;
+    // sample bookkeeping
+    double   min_margin_ns;
+} model_t;
+
+static uint16_t rom_word(uint32_t addr) {
+    uint32_t v = addr * 2654435761u;
+    return (uint16_t)(v >> 16);
+}
+
+static uint32_t model_read_pins(void *ctx) {
+    model_t *m = ctx;
+    uint64_t seen = m->now >= SYNC_CYCLES ? m->now - SYNC_CYCLES : 0;
+    return m->pad_hist[seen % HISTORY];
+}
+
+static void model_write_pins(void *ctx, uint32_t mask, uint32_t values) {
+    model_t *m = ctx;
+    // Output changes reach the pad on the next cycle
+    m->pending_mask |= mask;
+    m->pending_vals  = (m->pending_vals & ~mask) | (values & mask);
+}
+
+// Advance the pads to cycle m->now and compute what the cart drives
+static void model_update_pads(model_t *m) {
+    if (m->pending_mask) {
+        m->out_levels = (m->out_levels & ~m->pending_mask) | m->pending_vals;
+        m->pending_mask = 0;
+    }
+
+    bool rd_low = !((m->out_levels >> RD_PIN) & 1u);
+    if (rd_low && !m->rd_low) {
+        m->rd_fall = m->now;
+        if (m->rd_rise) {
+            double high_ns = (double)(m->now - m->rd_rise) * m->ns_per_cycle;
+            if (high_ns < m->min_rd_high_ns) m->min_rd_high_ns = high_ns;
+        }
+    } else if (!rd_low && m->rd_low) {
+        m->rd_rise = m->now;
+        m->addr   += 2;                       // /RD rising edge auto-increments
+    }
+    m->rd_low = rd_low;
+
+    uint32_t ad;
+    if (rd_low) {
+        double since = (double)(m->now - m->rd_fall) * m->ns_per_cycle;
+        ad = (since >= m->tacc_ns) ? rom_word(m->addr) : (uint16_t)~rom_word(m->addr);
+    } else {
+        ad = 0xFFFF;                          // pulled up
+    }
+    m->pad_hist[m->now % HISTORY] = (ad << AD_BUS_PIN_START) | m->out_levels;
+}
+
+typedef struct {
+    uint64_t cycles;
+    size_t   errors;
+    double   min_margin_ns;
+    double   min_rd_high_ns;
+} run_result_t;
+
+static run_result_t run_burst(double sys_mhz, uint32_t clkdiv, double tacc_ns,
+                              uint32_t access, size_t words) {
+    model_t m;
+    memset(&m, 0, sizeof(m));
+    m.ns_per_cycle   = 1000.0 / sys_mhz;
+    m.tacc_ns        = tacc_ns;
+    m.out_levels     = 1u << RD_PIN;
+    m.min_rd_high_ns = 1e9;
+
+    uint16_t imem[PIO_SIM_IMEM_SIZE] = {0};
+    pio_sim_load(imem, ad_bus_read_program_instructions,
+                 (uint8_t)(sizeof(ad_bus_read_program_instructions) / sizeof(uint16_t)), 0);
+
+    pio_sim_sm_t sm;
+    memset(&sm, 0, sizeof(sm));
+    sm.pins = (pio_sim_pins_t){ model_read_pins, model_write_pins, NULL, &m };
+    pio_sim_sm_reset(&sm, imem);
+    sm.wrap_bottom     = ad_bus_read_wrap_target;
+    sm.wrap_top        = ad_bus_read_wrap;
+    sm.in_base         = AD_BUS_PIN_START;
+    sm.set_base        = RD_PIN;
+    sm.set_count       = 1;
+    sm.in_shift_right  = false;
+    sm.autopush        = true;
+    sm.push_threshold  = 16;
+    sm.out_shift_right = true;
+    sm.clkdiv          = clkdiv;
+    sm.enabled         = true;
+
+    pio_sim_tx_put(&sm, AD_BUS_PIO_DESC(words, access));
+
+    run_result_t r = { 0, 0, 1e9, 0 };
+    size_t   got = 0;
+    uint64_t limit = (uint64_t)words * (access + 64u) * clkdiv + 1000u;
+    while (got < words && m.now < limit) {
+        model_update_pads(&m);
+        pio_sim_clock(&sm);
+        // DMA: one RX entry per cycle
+        if (!pio_sim_rx_empty(&sm)) {
+            uint16_t w = (uint16_t)pio_sim_rx_get(&sm);
+            if (w != rom_word((uint32_t)got * 2u)) r.errors++;
+            // The sample was taken SYNC_CYCLES ago from a pad whose /RD
+            // fell at rd_fall; margin is how long data had been valid.
+            double sampled_ns = (double)(m.now - SYNC_CYCLES - m.rd_fall) * m.ns_per_cycle;
+            double margin = sampled_ns - tacc_ns;
+            if (margin < r.min_margin_ns) r.min_margin_ns = margin;
+            got++;
+        }
+        m.now++;
+    }
+    if (got < words) r.errors += words - got;
+    r.cycles         = m.now;
+    r.min_rd_high_ns = m.min_rd_high_ns;
+    return r;
+}
+
+static void usage(const char *argv0) {
+    fprintf(stderr,
+            "usage: %s [--sys-mhz F] [--clkdiv N] [--tacc-ns F] [--access N]\n"
+            "          [--words N] [--sweep]\n", argv0);
+}
+
+int main(int argc, char **argv) {
+    double   sys_mhz = 125.0;
+    uint32_t clkdiv  = 1;
+    double   tacc_ns = 400.0;
+    uint32_t access  = AD_BUS_PIO_ACCESS_CYCLES;
+    size_t   words   = 512;                    // one N64_FAST_CHUNK_BYTES burst
+    bool     sweep   = false;
+
+    for (int i = 1; i < argc; ++i) {
+        const char *a = argv[i];
+        const char *v = (i + 1 < argc) ? argv[i + 1] : NULL;
+        if      (!strcmp(a, "--sys-mhz") && v) { sys_mhz = atof(v); ++i; }
+        else if (!strcmp(a, "--clkdiv")  && v) { clkdiv  = (uint32_t)atoi(v); ++i; }
+        else if (!strcmp(a, "--tacc-ns") && v) { tacc_ns = atof(v); ++i; }
+        else if (!strcmp(a, "--access")  && v) { access  = (uint32_t)atoi(v); ++i; }
+        else if (!strcmp(a, "--words")   && v) { words   = (size_t)atol(v); ++i; }
+        else if (!strcmp(a, "--sweep"))        { sweep   = true; }
+        else { usage(argv[0]); return 2; }
+    }
+    if (clkdiv == 0 || words == 0 || words > AD_BUS_PIO_MAX_WORDS) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    printf("ad_bus_read model: %.1f MHz / %u, T_acs %.0f ns, %zu words/burst\n",
+           sys_mhz, (unsigned)clkdiv, tacc_ns, words);
+
+    if (!sweep) {
+        run_result_t r = run_burst(sys_mhz, clkdiv, tacc_ns, access, words);
+        double ns      = (double)r.cycles * 1000.0 / sys_mhz;
+        double wps     = (double)words / (ns * 1e-9);
+        double mibps   = wps * 2.0 / (1024.0 * 1024.0);
+        printf("access %u cycles: %.1f ns/word, %.2f Mwords/s, %.2f MiB/s, "
+               "64 MiB in %.1f s\n",
+               (unsigned)access, ns / (double)words, wps / 1e6, mibps, 64.0 / mibps);
+        printf("sample margin %.1f ns, min /RD high %.1f ns, %zu bad words\n",
+               r.min_margin_ns, r.min_rd_high_ns, r.errors);
+        return r.errors ? 1 : 0;
+    }
+
+    // Sweep the access delay downwards and report the fastest clean setting
+    int fastest = -1;
+    printf("access  ns/word  MiB/s   margin  errors\n");
+    for (int a = 80; a >= 0; --a) {
+        run_result_t r = run_burst(sys_mhz, clkdiv, tacc_ns, (uint32_t)a, words);
+        double ns = (double)r.cycles * 1000.0 / sys_mhz / (double)words;
+        printf("%6d  %7.1f  %5.2f  %7.1f  %zu\n",
+               a, ns, 2.0e9 / ns / (1024.0 * 1024.0), r.min_margin_ns, r.errors);
+        if (r.errors == 0) fastest = a;
+    }
+    if (fastest < 0) {
+        printf("no passing access delay\n");
+        return 1;
+    }
+    printf("fastest passing access delay: %d cycles\n", fastest);
+    return 0;
+}
@@ -0,0 +1,322 @@
+/*  bench_main.c – hot-path benchmarks on the simulated RP2040
+ *  ---------------------------------------------------------------
+ *  • Runs the firmware read paths against a synthetic cart and turns
+ *    the simulator's cost counters (SIO accesses, NOP cycles, pin
+ *    reconfigurations, SDK register calls) into time at 125 MHz
+ *  • Each benchmark times a sample and scales it to a full dump of
+ *    its region; results are compared with bench_baseline.txt and any
+ *    that got slower fail the run
+ *  • Everything is simulated and deterministic: the same tree gives
+ *    the same numbers on any machine, so the tolerance can be tight
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "pico/stdlib.h"
+#include "tusb.h"
+
+#include <app/crc32.h>
+#include <app/digest.h>
+#include <bus/ad_bus.h>
+#include <bus/bus_perf.h>
+#include <bus/joybus.h>
+#include <devices/cartridge.h>
+
+#include "sim.h"
+
+#define ROM_IMAGE_BYTES    (256u * 1024u)
+#define ROM_FULL_BYTES     (64u * 1024u * 1024u)
+#define SRAM_FULL_BYTES    (32u * 1024u)
+#define EEPROM_FULL_BYTES  2048u
+#define DEFAULT_TOLERANCE  1.0           // percent
+
+// The simulator charges bus and SDK work only; the digests are pure
+// Cortex-M0+ arithmetic, so their cost is counted from the code instead.
+// Two-operand ALU ops and ROR are 1 cycle, loads 2, a taken branch 2.
+#define DIGEST_CYCLES_CRC_BYTE    11u    // ldrb, eors, uxtb, lsls, ldr, lsrs, eors, loop
+#define DIGEST_CYCLES_MD5_BLOCK   1300u  // 64 steps of ~19 (3 logic, 2 loads, 4 adds,
+                                         //   movs + ror, spills) and the word loads
+#define DIGEST_CYCLES_SHA1_BLOCK  2600u  // 80 rounds of ~20 and 64 schedule words
+                                         //   of ~15, plus 16 byte-swapped loads
+
+typedef struct {
+    const char *name;
+    const char *desc;
+    uint32_t    full_bytes;              // one whole dump of the region
+    bool      (*run)(uint32_t *bytes);   // bytes moved by the sample
+} bench_t;
+
+typedef struct {
+    uint32_t    bytes;
+    uint64_t    cycles;
+    sim_stats_t st;
+    double      mibs;
+} result_t;
+
+static uint8_t rom_buf[ROM_IMAGE_BYTES];
+static uint8_t eep_pattern[EEPROM_FULL_BYTES];
+static uint8_t eep_buf[EEPROM_FULL_BYTES];
+
+/* ------------------------------------------------------------ */
+/*  Synthetic cart                                               */
+/* ------------------------------------------------------------ */
+static uint32_t xorshift(uint32_t *s) {
+    *s ^= *s << 13;
+    *s ^= *s >> 17;
+    *s ^= *s << 5;
+    return *s;
+}
+
+static bool load_cart(void) {
+    static uint8_t image[ROM_IMAGE_BYTES];
+    uint32_t seed = 0x4E363442u;
+    for (size_t i = 0; i < sizeof(image); i += 4) {
+        uint32_t v = xorshift(&seed);
+        memcpy(&image[i], &v, 4);
+    }
+    static const uint8_t pi_bsd[4] = { 0x80, 0x37, 0x12, 0x40 };
+    memcpy(image, pi_bsd, sizeof(pi_bsd));
+    for (size_t i = 0; i < sizeof(eep_pattern); ++i) eep_pattern[i] = (uint8_t)(xorshift(&seed) >> 24);
+
+    eeprom_model_set_size(EEPROM_FULL_BYTES);
+    return cart_model_set_rom(image, sizeof(image));
+}
+
+static bool check(const char *what, const uint8_t *got, const uint8_t *want, size_t len) {
+    if (!memcmp(got, want, len)) return true;
+    fprintf(stderr, "%s: read back the wrong data\n", what);
+    return false;
+}
+
+/* ------------------------------------------------------------ */
+/*  Benchmarks                                                   */
+/* ------------------------------------------------------------ */
+static bool bench_rom_word(uint32_t *bytes) {
+    *bytes = 64u * 1024u;
+    return n64_read_bytes(N64_ROM_BASE, rom_buf, *bytes) &&
+           check("rom_word", rom_buf, cart_model_rom(), *bytes);
+}
+
+static bool bench_rom_burst(uint32_t *bytes) {
+    *bytes = ROM_IMAGE_BYTES;
+    return n64_read_bytes_fast(N64_ROM_BASE, rom_buf, *bytes) &&
+           check("rom_burst", rom_buf, cart_model_rom(), *bytes);
+}
+
+// The hex goes to /dev/null; USB CDC time is not part of the model
+static bool bench_sram_stdio(uint32_t *bytes) {
+    *bytes = SRAM_FULL_BYTES;
+    fflush(stdout);
+    int saved = dup(STDOUT_FILENO);
+    int null  = open("/dev/null", O_WRONLY);
+    if (saved < 0 || null < 0) return false;
+    dup2(null, STDOUT_FILENO);
+    close(null);
+
+    dump_sram_to_stdio();
+
+    fflush(stdout);
+    dup2(saved, STDOUT_FILENO);
+    close(saved);
+    return true;
+}
+
+static bool bench_eeprom_write(uint32_t *bytes) {
+    *bytes = gEepromSize;
+    return WriteEepromBlocks(0, gEepromSize / 8u, eep_pattern) &&
+           check("eeprom_write", eeprom_model_data(), eep_pattern, gEepromSize);
+}
+
+static bool bench_eeprom_read(uint32_t *bytes) {
+    *bytes = gEepromSize;
+    return ReadEepromBlocks(0, gEepromSize / 8u, eep_buf) &&
+           check("eeprom_read", eep_buf, eeprom_model_data(), gEepromSize);
+}
+
+// All three hashes over ROM data as xfer_run() feeds them on core 0, with
+// the cost model above. Core 0 must outrun USB for the dump rate to hold.
+static bool bench_digest(uint32_t *bytes) {
+    *bytes = ROM_IMAGE_BYTES;
+    digest_t        d;
+    digest_result_t r;
+    digest_init(&d);
+    for (uint32_t off = 0; off < *bytes; off += 4096u)
+        digest_update(&d, cart_model_rom() + off, 4096u);
+    digest_final(&d, &r);
+
+    uint32_t blocks = *bytes / 64u;
+    sim_advance((uint64_t)*bytes * DIGEST_CYCLES_CRC_BYTE +
+                (uint64_t)blocks * (DIGEST_CYCLES_MD5_BLOCK + DIGEST_CYCLES_SHA1_BLOCK));
+    if (r.crc32 == crc32_update(0, cart_model_rom(), *bytes)) return true;
+    fprintf(stderr, "digest: CRC-32 does not match crc32_update\n");
+    return false;
+}
+
+static const bench_t benches[] = {
+    { "rom_word",     "n64_read_bytes, ROM",           ROM_FULL_BYTES,    bench_rom_word },
+    { "rom_burst",    "n64_read_bytes_fast, ROM",      ROM_FULL_BYTES,    bench_rom_burst },
+    { "sram_stdio",   "dump_sram_to_stdio",            SRAM_FULL_BYTES,   bench_sram_stdio },
+    { "eeprom_write", "WriteEepromBlocks, 16 Kbit",    EEPROM_FULL_BYTES, bench_eeprom_write },
+    { "eeprom_read",  "ReadEepromBlocks, 16 Kbit",     EEPROM_FULL_BYTES, bench_eeprom_read },
+    { "digest",       "digest_update, CRC+MD5+SHA-1",  ROM_FULL_BYTES,    bench_digest },
+};
+#define NUM_BENCHES (sizeof(benches) / sizeof(benches[0]))
+
+static bool run_bench(const bench_t *b, result_t *r) {
+    sim_reset_stats();
+    uint64_t t0 = sim_now();
+    bool ok = b->run(&r->bytes);
+    r->cycles = sim_now() - t0;
+    r->st     = sim_stats;
+    double s  = (double)r->cycles / SIM_SYS_HZ;
+    r->mibs   = s > 0 ? r->bytes / s / (1024.0 * 1024.0) : 0.0;
+    return ok && r->bytes;
+}
+
+static void print_header(void) {
+    printf("%-13s %8s %11s %9s %11s %9s %9s %7s %7s %6s\n",
+           "benchmark", "sample", "est. time", "MiB/s", "full dump",
+           "SIO/KiB", "NOP/KiB", "reconf", "sdk", "wait%");
+}
+
+static void print_result(const bench_t *b, const result_t *r) {
+    double kib  = r->bytes / 1024.0;
+    double s    = (double)r->cycles / SIM_SYS_HZ;
+    double full = s * b->full_bytes / r->bytes;
+    printf("%-13s %4.0f KiB %8.3f ms %9.4g %9.2f s %9.0f %9.0f %7llu %7llu %5.1f%%\n",
+           b->name, kib, s * 1000.0, r->mibs, full,
+           r->st.sio_accesses / kib, r->st.nop_cycles / kib,
+           (unsigned long long)r->st.pin_reconfigs, (unsigned long long)r->st.sdk_calls,
+           r->cycles ? 100.0 * r->st.wait_cycles / r->cycles : 0.0);
+}
+
+/* ------------------------------------------------------------ */
+/*  Baseline                                                     */
+/* ------------------------------------------------------------ */
+// Baseline MiB/s per benchmark, negative where the file has none
+static bool load_baseline(const char *path, double *base) {
+    for (unsigned i = 0; i < NUM_BENCHES; ++i) base[i] = -1.0;
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        perror(path);
+        return false;
+    }
+    char line[160];
+    while (fgets(line, sizeof(line), f)) {
+        char   name[40];
+        double mibs;
+        if (line[0] == '#' || sscanf(line, "%39s %lf", name, &mibs) != 2) continue;
+        for (unsigned i = 0; i < NUM_BENCHES; ++i) {
+            if (!strcmp(name, benches[i].name)) base[i] = mibs;
+        }
+    }
+    fclose(f);
+    return true;
+}
+
+static bool write_baseline(const char *path, const result_t *res) {
+    FILE *f = fopen(path, "w");
+    if (!f) {
+        perror(path);
+        return false;
+    }
+    fprintf(f, "# n64_bench baseline: estimated MiB/s on a 125 MHz RP2040 (simulated)\n"
+               "# A result below one of these fails the run. Regenerate with\n"
+               "#   n64_bench --update\n"
+               "# after a change that is meant to move the numbers.\n");
+    for (unsigned i = 0; i < NUM_BENCHES; ++i) {
+        fprintf(f, "%-13s %.6g\n", benches[i].name, res[i].mibs);
+    }
+    fclose(f);
+    fprintf(stderr, "baseline written to %s\n", path);
+    return true;
+}
+
+// False if any benchmark is slower than its baseline by more than 'tol' %
+static bool compare(const double *base, const result_t *res, double tol) {
+    bool ok = true;
+    for (unsigned i = 0; i < NUM_BENCHES; ++i) {
+        if (base[i] < 0) {
+            fprintf(stderr, "%s: no baseline entry\n", benches[i].name);
+            continue;
+        }
+        double delta = base[i] > 0 ? 100.0 * (res[i].mibs - base[i]) / base[i] : 0.0;
+        if (delta < -tol) {
+            fprintf(stderr, "\n*** REGRESSION: %s is %.1f%% SLOWER than the baseline "
+                    "(%.4g MiB/s, baseline %.4g MiB/s) ***\n",
+                    benches[i].name, -delta, res[i].mibs, base[i]);
+            ok = false;
+        } else if (delta > tol) {
+            fprintf(stderr, "%s: %.1f%% faster than the baseline; run with --update to keep it\n",
+                    benches[i].name, delta);
+        }
+    }
+    return ok;
+}
+
+/*------------------------------------------------------------------*/
+/* Main                                                             */
+/*------------------------------------------------------------------*/
+static void usage(const char *argv0) {
+    fprintf(stderr,
+        "usage: %s [options]\n"
+        "  --baseline FILE   compare with this file (default %s)\n"
+        "  --update          write the results to the baseline file instead\n"
+        "  --tolerance PCT   allowed slowdown before failing (default %.1f)\n",
+        argv0, N64_BENCH_BASELINE, DEFAULT_TOLERANCE);
+}
+
+int main(int argc, char **argv)
+{
+    const char *baseline = N64_BENCH_BASELINE;
+    bool        update   = false;
+    double      tol      = DEFAULT_TOLERANCE;
+    for (int i = 1; i < argc; ++i) {
+        const char *v = (i + 1 < argc) ? argv[i + 1] : NULL;
+        if      (!strcmp(argv[i], "--update"))          update = true;
+        else if (!strcmp(argv[i], "--baseline") && v)  { baseline = v; ++i; }
+        else if (!strcmp(argv[i], "--tolerance") && v) { tol = atof(v); ++i; }
+        else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    if (!load_cart()) return 2;
+
+    tusb_init();
+    stdio_init_all();
+    bus_perf_init();
+    n64_adBus_init();
+    n64_eep_init();                      // core 1 stays idle: nothing here uses the pipeline
+    if (gEepromSize != EEPROM_FULL_BYTES) {
+        fprintf(stderr, "eeprom: not detected\n");
+        return 2;
+    }
+
+    printf("n64_bench: firmware hot paths on a simulated %u MHz RP2040\n",
+           SIM_SYS_HZ / 1000000u);
+    print_header();
+    result_t res[NUM_BENCHES];
+    bool ok = true;
+    for (unsigned i = 0; i < NUM_BENCHES; ++i) {
+        if (!run_bench(&benches[i], &res[i])) {
+            fprintf(stderr, "%s (%s): FAILED\n", benches[i].name, benches[i].desc);
+            ok = false;
+            continue;
+        }
+        print_result(&benches[i], &res[i]);
+    }
+    fflush(stdout);
+    if (!ok) return 1;
+
+    if (update) return write_baseline(baseline, res) ? 0 : 1;
+
+    double base[NUM_BENCHES];
+    if (!load_baseline(baseline, base)) return 2;
+    return compare(base, res, tol) ? 0 : 1;
+}
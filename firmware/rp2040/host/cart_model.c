@@ -0,0 +1,254 @@
+/* cart_model.c – N64 cartridge on the multiplexed AD bus (host builds)
+ *  ---------------------------------------------------------------
+ *  • ALE_H↓ latches AD15..0 as address[31:16], ALE_L↓ as address[15:0]
+ *  • /RD low drives the addressed word, valid T_acs after the falling
+ *    edge; /RD↑ and /WR↑ advance the address by one word
+ *  • ROM (0x1000'0000) mirrors past its size like partially decoded
+ *    mask ROMs: a power-of-two ROM repeats, a 12 MiB board (8 + 4 MiB
+ *    chips) repeats every 16 MiB with the 4 MiB chip aliased in its
+ *    upper half; SRAM (0x0800'0000) is 32 KiB and writable, unless a
+ *    FlashRAM is loaded in its place (flashram_model.c); a repro cart's
+ *    flash takes over the ROM window the same way (reproflash_model.c)
+ *  • Optionally the ROM's address counter only increments inside a page,
+ *    like carts that need a re-latch every few hundred bytes
+ *  • Optionally a ROM read returns one flipped bit now and then, like a
+ *    dirty contact; the sequence is fixed so runs repeat exactly
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include <bus/ad_bus.h>
+
+#include "sim.h"
+
+#define CART_SRAM_SIZE   (32u * 1024u)
+#define ROM_WINDOW_END   0x1FC00000u
+#define SYNC_CYCLES      2u              // GPIO input synchroniser depth
+
+static uint8_t  *rom;
+static size_t    rom_size;
+static uint8_t   sram[CART_SRAM_SIZE];
+static uint64_t  tacc_cycles = 38;       // ~300 ns, a typical mask ROM
+static uint32_t  page_bytes;             // ROM auto-increment wraps here (0 = never)
+static uint32_t  error_every;            // mean ROM words per flipped bit (0 = never)
+static uint32_t  error_rng = 0x2545F491u;
+
+static uint16_t  addr_hi;
+static uint32_t  addr;
+static bool      rd_low;
+static uint64_t  rd_fall;
+static uint16_t  rd_flip;                // bit error for the current /RD
+
+/* ------------------------------------------------------------ */
+/*  Images                                                       */
+/* ------------------------------------------------------------ */
+static uint8_t *read_file(const char *path, size_t *size) {
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        perror(path);
+        return NULL;
+    }
+    fseek(f, 0, SEEK_END);
+    long n = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    uint8_t *buf = (n > 0) ? malloc((size_t)n) : NULL;
+    if (!buf || fread(buf, 1, (size_t)n, f) != (size_t)n) {
+        fprintf(stderr, "%s: read failed\n", path);
+        free(buf);
+        fclose(f);
+        return NULL;
+    }
+    fclose(f);
+    *size = (size_t)n;
+    return buf;
+}
+
+// Accept .z64 (big-endian), .v64 (byte-swapped) and .n64 (little-endian)
+bool cart_model_load_rom(const char *path) {
+    size_t n;
+    uint8_t *buf = read_file(path, &n);
+    if (!buf) return false;
+    if (n < 64 || (n & 3)) {
+        fprintf(stderr, "%s: not an N64 ROM image\n", path);
+        free(buf);
+        return false;
+    }
+
+    uint32_t magic = ((uint32_t)buf[0] << 24) | ((uint32_t)buf[1] << 16) |
+                     ((uint32_t)buf[2] << 8) | buf[3];
+    if (magic == 0x37804012u) {                 // .v64
+        for (size_t i = 0; i < n; i += 2) {
+            uint8_t t = buf[i]; buf[i] = buf[i + 1]; buf[i + 1] = t;
+        }
+    } else if (magic == 0x40123780u) {          // .n64
+        for (size_t i = 0; i < n; i += 4) {
+            uint8_t t0 = buf[i], t1 = buf[i + 1];
+            buf[i] = buf[i + 3]; buf[i + 1] = buf[i + 2];
+            buf[i + 2] = t1;     buf[i + 3] = t0;
+        }
+    }
+
+    free(rom);
+    rom      = buf;
+    rom_size = n;
+    return true;
+}
+
+bool cart_model_set_rom(const uint8_t *image, size_t len) {
+    if (len < 64 || (len & 3)) return false;
+    uint8_t *buf = malloc(len);
+    if (!buf) return false;
+    memcpy(buf, image, len);
+
+    free(rom);
+    rom      = buf;
+    rom_size = len;
+    return true;
+}
+
+void cart_model_eject(void) {
+    free(rom);
+    rom      = NULL;
+    rom_size = 0;
+}
+
+bool cart_model_load_sram(const char *path) {
+    size_t n;
+    uint8_t *buf = read_file(path, &n);
+    if (!buf) return false;
+    memset(sram, 0xFF, sizeof(sram));
+    memcpy(sram, buf, n < sizeof(sram) ? n : sizeof(sram));
+    free(buf);
+    return true;
+}
+
+bool cart_model_save_sram(const char *path) {
+    FILE *f = fopen(path, "wb");
+    if (!f) {
+        perror(path);
+        return false;
+    }
+    bool ok = fwrite(sram, 1, sizeof(sram), f) == sizeof(sram);
+    fclose(f);
+    return ok;
+}
+
+void cart_model_set_page_bytes(uint32_t bytes) {
+    page_bytes = bytes;
+}
+
+void cart_model_set_read_errors(uint32_t every) {
+    error_every = every;
+}
+
+void cart_model_set_tacc_ns(double ns) {
+    tacc_cycles = (uint64_t)(ns * SIM_SYS_HZ / 1e9 + 0.999);
+}
+
+size_t         cart_model_rom_size(void) { return rom_size; }
+const uint8_t *cart_model_rom(void)      { return rom; }
+const uint8_t *cart_model_sram(void)     { return sram; }
+
+/* ------------------------------------------------------------ */
+/*  Bus protocol                                                 */
+/* ------------------------------------------------------------ */
+static inline bool fell(uint32_t before, uint32_t after, unsigned pin) {
+    return ((before >> pin) & 1u) && !((after >> pin) & 1u);
+}
+
+static inline bool rose(uint32_t before, uint32_t after, unsigned pin) {
+    return !((before >> pin) & 1u) && ((after >> pin) & 1u);
+}
+
+static inline uint16_t ad_of(uint32_t levels) {
+    return (uint16_t)((levels & AD_BUS_MASK) >> AD_BUS_PIN_START);
+}
+
+// Split 'size' into power-of-two chips, largest first; each decodes only
+// its own address lines
+static size_t rom_decode(size_t off, size_t size) {
+    size_t chip = 1, span;
+    while (chip * 2u <= size) chip *= 2u;
+    if (chip == size) return off % size;
+    for (span = chip; span < size; span *= 2u) {}
+    off %= span;
+    return off < chip ? off : chip + rom_decode(off - chip, size - chip);
+}
+
+// Resolve an address to a word in one of the cart's regions
+static uint8_t *word_at(uint32_t a) {
+    if (a >= N64_ROM_BASE && a < ROM_WINDOW_END && rom_size) {
+        return rom + rom_decode(a - N64_ROM_BASE, rom_size);
+    }
+    if (a >= N64_SRAM_BASE && a < N64_SRAM_BASE + CART_SRAM_SIZE) {
+        return sram + (a - N64_SRAM_BASE);
+    }
+    return NULL;                                // open bus, pulled up
+}
+
+// Decided once per /RD so every sample of the access sees the same value
+static uint16_t next_flip(void) {
+    if (!error_every || addr < N64_ROM_BASE || addr >= ROM_WINDOW_END) return 0;
+    error_rng ^= error_rng << 13;
+    error_rng ^= error_rng >> 17;
+    error_rng ^= error_rng << 5;
+    return (error_rng % error_every) == 0 ? (uint16_t)(1u << (error_rng >> 28)) : 0;
+}
+
+void cart_model_edges(uint32_t before, uint32_t after, uint64_t t) {
+    if (fell(before, after, ALE_H_PIN)) {
+        addr_hi = ad_of(after);
+    }
+    if (fell(before, after, ALE_L_PIN)) {
+        addr = ((uint32_t)addr_hi << 16) | ad_of(after);
+        if (flashram_model_claims(addr)) flashram_model_latch(addr);
+    }
+    if (fell(before, after, RD_PIN)) {
+        rd_low  = true;
+        rd_fall = t;
+        rd_flip = next_flip();
+    }
+    if (rose(before, after, RD_PIN)) {
+        rd_low = false;
+        if (flashram_model_claims(addr)) flashram_model_rd_done();
+        if (page_bytes && addr >= N64_ROM_BASE) {
+            addr = (addr & ~(page_bytes - 1u)) | ((addr + 2u) & (page_bytes - 1u));
+        } else {
+            addr += 2;
+        }
+    }
+    if (rose(before, after, WR_PIN)) {
+        uint8_t *w = word_at(addr);
+        if (flashram_model_claims(addr)) {
+            flashram_model_write(addr, ad_of(before));
+        } else if (reproflash_model_claims(addr)) {
+            reproflash_model_write(addr, ad_of(before));
+        } else if (w && (addr >> 28) == 0) {   // ROM is read-only
+            uint16_t v = ad_of(before);
+            w[0] = (uint8_t)(v >> 8);
+            w[1] = (uint8_t)v;
+        }
+        addr += 2;
+    }
+}
+
+bool cart_model_drive(uint64_t t, uint16_t *ad) {
+    if (!rd_low) return false;
+    uint16_t v;
+    if (flashram_model_claims(addr)) {
+        v = flashram_model_peek();
+    } else if (reproflash_model_claims(addr)) {
+        v = reproflash_model_peek(addr);
+    } else {
+        const uint8_t *w = word_at(addr & ~1u);
+        if (!w) return false;
+        v = (uint16_t)((w[0] << 8) | w[1]) ^ rd_flip;
+    }
+    // Sampled before T_acs has elapsed → the bus is still settling
+    bool valid = t >= SYNC_CYCLES && (t - SYNC_CYCLES) >= rd_fall + tacc_cycles;
+    *ad = valid ? v : (uint16_t)~v;
+    return true;
+}
@@ -0,0 +1,157 @@
+/* controller_model.c – N64 controller + controller pak on CTRL_DAT (host builds)
+ *  ---------------------------------------------------------------
+ *  • Answers 0x00/0xFF (info), 0x01 (poll), 0x02/0x03 (pak read/write)
+ *  • The stick sweeps a triangle wave and one button at a time is held,
+ *    so a stream of polls shows movement that can be checked
+ *  • Pak addresses and data are checked with the bit-serial CRCs the
+ *    console uses, independently of the firmware's tables: a bad address
+ *    CRC or a missing pak answers with an inverted data CRC
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "sim.h"
+#include "joybus_dev.h"
+
+#define PAK_BYTES        0x8000u
+#define PAK_BLOCK        32u
+#define US(x)            ((uint64_t)(x) * SIM_CYCLES_PER_US)
+#define STICK_PERIOD     US(1000000)  // one full stick sweep
+#define STICK_RANGE      80           // ± counts at the ends of the sweep
+#define BUTTON_HOLD      US(50000)    // each button is held this long
+
+static bool     plugged;
+static bool     pak_present;
+static uint8_t  pak[PAK_BYTES];
+
+/* ------------------------------------------------------------ */
+/*  Images                                                       */
+/* ------------------------------------------------------------ */
+void controller_model_plug(bool with_pak) {
+    plugged     = true;
+    pak_present = with_pak;
+}
+
+bool controller_model_load_pak(const char *path) {
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        perror(path);
+        return false;
+    }
+    memset(pak, 0, sizeof(pak));
+    size_t n = fread(pak, 1, sizeof(pak), f);
+    fclose(f);
+    (void)n;
+    controller_model_plug(true);
+    return true;
+}
+
+const uint8_t *controller_model_pak(void) { return pak; }
+
+/* ------------------------------------------------------------ */
+/*  CRCs, bit by bit as the console computes them                */
+/* ------------------------------------------------------------ */
+static uint16_t addr_crc(uint16_t addr) {
+    static const uint8_t xor_table[16] = {
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x15, 0x1F, 0x0B,
+        0x16, 0x19, 0x07, 0x0E, 0x1C, 0x0D, 0x1A, 0x01,
+    };
+    uint16_t crc = 0;
+    for (unsigned i = 5; i <= 15; ++i) {
+        if ((addr >> i) & 1u) crc ^= xor_table[i];
+    }
+    return crc & 0x1Fu;
+}
+
+static uint8_t data_crc(const uint8_t *d) {
+    uint8_t crc = 0;
+    for (unsigned i = 0; i <= PAK_BLOCK; ++i) {
+        for (int j = 7; j >= 0; --j) {
+            uint8_t x = (crc & 0x80u) ? 0x85u : 0x00u;
+            crc = (uint8_t)(crc << 1);
+            if (i < PAK_BLOCK && ((d[i] >> j) & 1u)) crc |= 1u;
+            crc ^= x;
+        }
+    }
+    return crc;
+}
+
+/* ------------------------------------------------------------ */
+/*  Command handling                                             */
+/* ------------------------------------------------------------ */
+static unsigned command_length(uint8_t cmd) {
+    switch (cmd) {
+    case 0x02: return 3;
+    case 0x03: return 3u + PAK_BLOCK;
+    default:   return 1;                      // info, poll and unknowns
+    }
+}
+
+static int8_t stick(uint64_t t, uint64_t phase) {
+    uint64_t p = (t + phase) % STICK_PERIOD;
+    int64_t  v = (int64_t)(p * 4u * STICK_RANGE / STICK_PERIOD);  // 0 .. 4R
+    if (v > 2 * STICK_RANGE) v = 4 * STICK_RANGE - v;             // 0 .. 2R .. 0
+    return (int8_t)(v - STICK_RANGE);
+}
+
+static void execute(jb_dev_t *d, uint64_t stop_rise) {
+    switch (d->rx[0]) {
+    case 0x00:
+    case 0xFF: {
+        uint8_t info[3] = { 0x05, 0x00, pak_present ? 0x01 : 0x02 };
+        jb_dev_reply(d, info, 3, stop_rise);
+        break;
+    }
+    case 0x01: {
+        // 14 real buttons: bits 15..8 and 5..0; bits 7..6 stay clear
+        static const uint8_t order[14] = { 15, 14, 13, 12, 11, 10, 9, 8, 5, 4, 3, 2, 1, 0 };
+        uint16_t buttons = (uint16_t)(1u << order[(stop_rise / BUTTON_HOLD) % 14u]);
+        uint8_t  r[4] = { (uint8_t)(buttons >> 8), (uint8_t)buttons,
+                          (uint8_t)stick(stop_rise, 0), (uint8_t)stick(stop_rise, STICK_PERIOD / 4u) };
+        jb_dev_reply(d, r, 4, stop_rise);
+        break;
+    }
+    case 0x02: {
+        uint16_t a    = (uint16_t)(d->rx[1] << 8 | d->rx[2]);
+        uint16_t base = a & (uint16_t)~0x1Fu;
+        bool     ok   = pak_present && (a & 0x1Fu) == addr_crc(base);
+        uint8_t  r[PAK_BLOCK + 1];
+        memset(r, 0, sizeof(r));
+        if (ok && base < PAK_BYTES) memcpy(r, &pak[base], PAK_BLOCK);
+        r[PAK_BLOCK] = (uint8_t)(data_crc(r) ^ (ok ? 0x00u : 0xFFu));
+        jb_dev_reply(d, r, sizeof(r), stop_rise);
+        break;
+    }
+    case 0x03: {
+        uint16_t a    = (uint16_t)(d->rx[1] << 8 | d->rx[2]);
+        uint16_t base = a & (uint16_t)~0x1Fu;
+        bool     ok   = pak_present && (a & 0x1Fu) == addr_crc(base);
+        if (ok && base < PAK_BYTES) memcpy(&pak[base], &d->rx[3], PAK_BLOCK);
+        uint8_t crc = (uint8_t)(data_crc(&d->rx[3]) ^ (ok ? 0x00u : 0xFFu));
+        jb_dev_reply(d, &crc, 1, stop_rise);
+        break;
+    }
+    default:
+        break;                                // unknown command: stay silent
+    }
+}
+
+static jb_dev_t dev = { .command_length = command_length, .execute = execute };
+
+/* ------------------------------------------------------------ */
+/*  Line                                                         */
+/* ------------------------------------------------------------ */
+void controller_model_line(bool level, uint64_t t) {
+    if (plugged) jb_dev_line(&dev, level, t);
+}
+
+bool controller_model_pulling_low(uint64_t t) {
+    return jb_dev_pulling_low(&dev, t);
+}
+
+uint64_t controller_model_next_event(uint64_t now) {
+    return jb_dev_next_event(&dev, now);
+}
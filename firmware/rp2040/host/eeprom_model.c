@@ -0,0 +1,119 @@
+/* eeprom_model.c – 4 Kbit / 16 Kbit joybus EEPROM on EEP_DAT (host builds)
+ *  ---------------------------------------------------------------
+ *  • Line decoding and the reply waveform are in joybus_dev.c
+ *  • Answers 0x00/0xFF (info), 0x04 (read 8 bytes), 0x05 (write 8 bytes)
+ *  • A write keeps the part busy for a while: the info status byte has
+ *    bit 7 set and reads/writes go unanswered until it is done
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "sim.h"
+#include "joybus_dev.h"
+
+#define EEP_MAX_SIZE     2048u
+#define US(x)            ((uint64_t)(x) * SIM_CYCLES_PER_US)
+#define WRITE_TIME       US(2000)     // internal write cycle of one block
+
+static uint8_t  data[EEP_MAX_SIZE];
+static size_t   eep_size;
+
+static uint64_t busy_until;           // end of the last write cycle
+
+/* ------------------------------------------------------------ */
+/*  Images                                                       */
+/* ------------------------------------------------------------ */
+void eeprom_model_set_size(size_t size) {
+    eep_size = (size > EEP_MAX_SIZE) ? EEP_MAX_SIZE : size;
+    memset(data, 0xFF, sizeof(data));
+}
+
+bool eeprom_model_load(const char *path, size_t size) {
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        perror(path);
+        return false;
+    }
+    if (size == 0) {
+        fseek(f, 0, SEEK_END);
+        size = (ftell(f) > 512) ? EEP_MAX_SIZE : 512u;
+        fseek(f, 0, SEEK_SET);
+    }
+    eeprom_model_set_size(size);
+    size_t n = fread(data, 1, eep_size, f);
+    fclose(f);
+    (void)n;
+    return true;
+}
+
+bool eeprom_model_save(const char *path) {
+    FILE *f = fopen(path, "wb");
+    if (!f) {
+        perror(path);
+        return false;
+    }
+    bool ok = fwrite(data, 1, eep_size, f) == eep_size;
+    fclose(f);
+    return ok;
+}
+
+size_t         eeprom_model_size(void) { return eep_size; }
+const uint8_t *eeprom_model_data(void) { return data; }
+
+/* ------------------------------------------------------------ */
+/*  Command handling                                             */
+/* ------------------------------------------------------------ */
+static unsigned command_length(uint8_t cmd) {
+    switch (cmd) {
+    case 0x04: return 2;
+    case 0x05: return 10;
+    default:   return 1;                      // 0x00 / 0xFF info and unknowns
+    }
+}
+
+static void execute(jb_dev_t *d, uint64_t stop_rise) {
+    unsigned blocks = (unsigned)(eep_size / 8u);
+    bool     busy   = stop_rise < busy_until;
+    switch (d->rx[0]) {
+    case 0x00:
+    case 0xFF: {
+        uint8_t info[3] = { 0x00, eep_size > 512 ? 0xC0 : 0x80, busy ? 0x80 : 0x00 };
+        jb_dev_reply(d, info, 3, stop_rise);
+        break;
+    }
+    case 0x04:
+        if (busy) break;
+        jb_dev_reply(d, &data[(d->rx[1] % blocks) * 8u], 8, stop_rise);
+        break;
+    case 0x05: {
+        if (busy) break;
+        memcpy(&data[(d->rx[1] % blocks) * 8u], &d->rx[2], 8);
+        busy_until = stop_rise + WRITE_TIME;
+        uint8_t status = 0x00;
+        jb_dev_reply(d, &status, 1, stop_rise);
+        break;
+    }
+    default:
+        break;                                // unknown command: stay silent
+    }
+}
+
+static jb_dev_t dev = { .command_length = command_length, .execute = execute };
+
+/* ------------------------------------------------------------ */
+/*  Line                                                         */
+/* ------------------------------------------------------------ */
+void eeprom_model_line(bool level, uint64_t t) {
+    if (eep_size) jb_dev_line(&dev, level, t);
+}
+
+bool eeprom_model_pulling_low(uint64_t t) {
+    return jb_dev_pulling_low(&dev, t);
+}
+
+uint64_t eeprom_model_next_event(uint64_t now) {
+    return jb_dev_next_event(&dev, now);
+}
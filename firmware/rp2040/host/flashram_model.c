@@ -0,0 +1,172 @@
+/* flashram_model.c – 1 Mbit FlashRAM in the cart's save window (host builds)
+ *  ---------------------------------------------------------------
+ *  • Replaces SRAM at 0x0800'0000 when loaded; commands are written as
+ *    two halfwords to 0x0801'0000
+ *  • F0 read mode, E1 status mode (the 8-byte silicon ID), B4 load the
+ *    128-byte page buffer, A5 program page, 4B/78 sector erase, 3C chip
+ *    erase, D2 execute
+ *  • Erase and program take simulated time; until they finish the status
+ *    word reads 0x1111'8000 instead of the ID. Programming can only clear
+ *    bits, like the real array.
+ *  • MX29L1100 parts address their data at half the byte offset
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include <bus/ad_bus.h>
+
+#include "sim.h"
+
+#define FRAM_BYTES         (128u * 1024u)
+#define FRAM_PAGE_BYTES    128u
+#define FRAM_SECTOR_BYTES  (16u * 1024u)
+#define FRAM_CMD_REG       0x08010000u
+#define FRAM_WINDOW_END    0x08020000u
+#define US(x)              ((uint64_t)(x) * SIM_CYCLES_PER_US)
+#define PROGRAM_TIME       US(150)          // one page
+#define ERASE_TIME         US(40000)        // one sector or the whole chip
+
+enum { MODE_READ, MODE_STATUS, MODE_WRITE, MODE_ERASE_SECTOR, MODE_ERASE_CHIP };
+
+static const struct {
+    const char *name;
+    uint8_t     id[8];
+    unsigned    shift;
+} types[] = {
+    { "1101", { 0x11, 0x11, 0x80, 0x01, 0x00, 0xC2, 0x00, 0x1D }, 1 },
+    { "1100", { 0x11, 0x11, 0x80, 0x01, 0x00, 0xC2, 0x00, 0x1E }, 2 },
+    { "mn63", { 0x11, 0x11, 0x80, 0x01, 0x00, 0x32, 0x00, 0xF1 }, 1 },
+};
+
+static uint8_t  data[FRAM_BYTES];
+static uint8_t  page_buf[FRAM_PAGE_BYTES];
+static bool     present;
+static unsigned type;
+static int      mode;
+static uint32_t cmd_hi;
+static uint32_t erase_offset;            // page number from 4B
+static uint32_t ptr;                     // byte offset of the next word
+static uint64_t busy_until;
+
+/* ------------------------------------------------------------ */
+/*  Images                                                       */
+/* ------------------------------------------------------------ */
+bool flashram_model_load(const char *path, const char *type_name) {
+    type = 0;
+    if (type_name) {
+        while (type < sizeof(types) / sizeof(types[0]) && strcmp(types[type].name, type_name)) type++;
+        if (type == sizeof(types) / sizeof(types[0])) {
+            fprintf(stderr, "unknown FlashRAM type '%s' (1101, 1100, mn63)\n", type_name);
+            return false;
+        }
+    }
+    memset(data, 0xFF, sizeof(data));
+    if (path) {
+        FILE *f = fopen(path, "rb");
+        if (!f) {
+            perror(path);
+            return false;
+        }
+        size_t n = fread(data, 1, sizeof(data), f);
+        fclose(f);
+        (void)n;
+    }
+    present = true;
+    mode    = MODE_READ;
+    return true;
+}
+
+bool flashram_model_present(void)        { return present; }
+const uint8_t *flashram_model_data(void) { return data; }
+
+bool flashram_model_claims(uint32_t addr) {
+    return present && addr >= N64_SRAM_BASE && addr < FRAM_WINDOW_END;
+}
+
+/* ------------------------------------------------------------ */
+/*  Bus                                                          */
+/* ------------------------------------------------------------ */
+static bool busy(void) { return sim_now() < busy_until; }
+
+void flashram_model_latch(uint32_t addr) {
+    if (mode == MODE_READ) {
+        ptr = ((addr - N64_SRAM_BASE) * types[type].shift) % FRAM_BYTES;
+    } else {
+        ptr = 0;
+    }
+}
+
+uint16_t flashram_model_peek(void) {
+    if (mode == MODE_STATUS) {
+        const uint8_t *id = types[type].id;
+        unsigned i = ptr % 8u;
+        if (busy() && i == 2) return 0x8000;
+        return (uint16_t)(id[i] << 8 | id[i + 1]);
+    }
+    if (mode == MODE_READ && !busy()) {
+        return (uint16_t)(data[ptr] << 8 | data[ptr + 1]);
+    }
+    return 0xFFFF;
+}
+
+void flashram_model_rd_done(void) {
+    ptr = (ptr + 2u) % FRAM_BYTES;
+}
+
+static void execute(void) {
+    if (busy()) return;
+    switch (mode) {
+    case MODE_WRITE: {
+        uint8_t *dst = &data[(erase_offset % (FRAM_BYTES / FRAM_PAGE_BYTES)) * FRAM_PAGE_BYTES];
+        for (unsigned i = 0; i < FRAM_PAGE_BYTES; ++i) dst[i] &= page_buf[i];
+        busy_until = sim_now() + PROGRAM_TIME;
+        break;
+    }
+    case MODE_ERASE_SECTOR: {
+        uint32_t sector = (erase_offset * FRAM_PAGE_BYTES / FRAM_SECTOR_BYTES) % (FRAM_BYTES / FRAM_SECTOR_BYTES);
+        memset(&data[sector * FRAM_SECTOR_BYTES], 0xFF, FRAM_SECTOR_BYTES);
+        busy_until = sim_now() + ERASE_TIME;
+        break;
+    }
+    case MODE_ERASE_CHIP:
+        memset(data, 0xFF, sizeof(data));
+        busy_until = sim_now() + ERASE_TIME;
+        break;
+    default:
+        break;
+    }
+}
+
+static void command(uint32_t cmd) {
+    switch (cmd >> 24) {
+    case 0xF0: mode = MODE_READ;                               break;
+    case 0xE1: mode = MODE_STATUS;                             break;
+    case 0xB4: mode = MODE_WRITE; memset(page_buf, 0xFF, sizeof(page_buf)); break;
+    case 0xA5: erase_offset = cmd & 0xFFFFu;                   break;
+    case 0x4B: erase_offset = cmd & 0xFFFFu;                   break;
+    case 0x78: mode = MODE_ERASE_SECTOR;                       break;
+    case 0x3C: mode = MODE_ERASE_CHIP;                         break;
+    case 0xD2: execute();                                      break;
+    default:                                                   break;
+    }
+}
+
+void flashram_model_write(uint32_t addr, uint16_t v) {
+    if (addr >= FRAM_CMD_REG) {
+        if ((addr & 2u) == 0) {
+            cmd_hi = v;
+        } else {
+            command(cmd_hi << 16 | v);
+        }
+        return;
+    }
+    if (mode == MODE_WRITE) {
+        unsigned i = ptr % FRAM_PAGE_BYTES;
+        page_buf[i]     = (uint8_t)(v >> 8);
+        page_buf[i + 1] = (uint8_t)v;
+    }
+    ptr = (ptr + 2u) % FRAM_BYTES;
+}
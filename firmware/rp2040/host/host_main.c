@@ -0,0 +1,745 @@
+/*  host_main.c – Linux entry point for the simulated dumper
+ *  ---------------------------------------------------------------
+ *  • Without dump options it runs the same super-loop as main.c, with
+ *    the CLI on stdin/stdout (pipe keys in, or use a terminal)
+ *  • --dump-* options run the firmware read paths against the
+ *    simulated cartridge, write the result and report simulated time
+ *  • --verify compares every dump with the loaded image; exit 1 on a
+ *    mismatch so CI can gate on correctness and throughput
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "pico/stdlib.h"
+#include "tusb.h"
+
+#include <app/autodump.h>
+#include <app/cartfs.h>
+#include <app/cartid.h>
+#include <app/cli.h>
+#include <app/crc32.h>
+#include <app/ctrlstream.h>
+#include <app/digest.h>
+#include <app/flasher.h>
+#include <app/pipeline.h>
+#include <app/sddump.h>
+#include <bus/ad_bus.h>
+#include <bus/ad_bus_timing.h>
+#include <bus/bus_perf.h>
+#include <bus/joybus.h>
+#include <devices/cartridge.h>
+#include <devices/controller.h>
+#include <devices/flashram.h>
+#include <storage/sdcard.h>
+
+#include "sim.h"
+
+#define SRAM_DUMP_BYTES  (32u * 1024u)
+
+typedef struct {
+    const char *rom, *sram, *eeprom, *flashram, *flashram_type;
+    size_t      eeprom_size;
+    double      tacc_ns;
+    unsigned    page_bytes;
+    unsigned    read_errors;
+    const char *dump_rom, *dump_rom_slow, *dump_sram, *dump_eeprom;
+    const char *dump_flashram, *restore_flashram, *restore_eeprom;
+    const char *save_sram;
+    const char *mpk, *dump_mpk, *restore_mpk;
+    const char *repro, *program_repro;
+    bool        repro_diff;
+    const char *flash;
+    const char *sd_image;
+    unsigned    sd_create_mb;
+    bool        sd_dump;
+    bool        auto_dump;
+    unsigned    swap_ms;
+    const char *msc_read;
+    bool        controller;
+    unsigned    ctrl_stream_ms, ctrl_rate;
+    double      min_mibs;
+    bool        verify;
+    bool        calibrate;
+    bool        bench_bus;
+} options_t;
+
+static void usage(const char *argv0) {
+    fprintf(stderr,
+        "usage: %s [options]\n"
+        "  --rom FILE            cartridge ROM image (.z64/.v64/.n64)\n"
+        "  --sram FILE           SRAM contents (32 KiB)\n"
+        "  --eeprom FILE         EEPROM contents\n"
+        "  --eeprom-size 4k|16k  EEPROM type (default: from file, else none)\n"
+        "  --flashram FILE       FlashRAM contents (128 KiB), replaces SRAM\n"
+        "  --flashram-type T     1101 (default), 1100 or mn63\n"
+        "  --tacc-ns NS          ROM access time (default 300)\n"
+        "  --rom-page BYTES      ROM auto-increment wraps at this boundary\n"
+        "  --read-errors N       flip a bit in about one of every N ROM reads\n"
+        "  --dump-rom OUT        read the ROM with the PIO/DMA burst path\n"
+        "  --dump-rom-slow OUT   read the ROM one word at a time\n"
+        "  --dump-sram OUT       read the SRAM\n"
+        "  --dump-eeprom OUT     read the EEPROM over joybus\n"
+        "  --restore-eeprom IN   write the EEPROM from a file\n"
+        "  --dump-flashram OUT   read the FlashRAM\n"
+        "  --restore-flashram IN erase and program the FlashRAM from a file\n"
+        "  --save-sram OUT       write the cart's SRAM after the run\n"
+        "  --controller          plug a controller (no pak) into the controller port\n"
+        "  --mpk FILE            plug a controller with this pak image (32 KiB)\n"
+        "  --dump-mpk OUT        read the controller pak over joybus\n"
+        "  --restore-mpk IN      write the controller pak from a file\n"
+        "  --repro TYPE          repro cart flash in the ROM window, preloaded from --rom\n"
+        "                        (s29gl256, s29gl256x2, s29gl128, m29w128, mx29lv640[x2])\n"
+        "  --program-repro IN    program the repro flash from a file\n"
+        "  --repro-diff          only the sectors that differ from the cart\n"
+        "  --flash FILE          the Pico's program flash (cart cache), kept across runs\n"
+        "  --sd-image FILE       disk image in the SD card slot\n"
+        "  --sd-create MB        format a fresh FAT32 image of this size first\n"
+        "  --sd-dump             dump ROM and save to files on the SD card\n"
+        "  --cart-queue FILE     after the --rom cart is pulled, put this one in\n"
+        "                        (repeat for more; the operator goes by the LED)\n"
+        "  --swap-ms MS          operator's time to pull / insert a cart (default 4000)\n"
+        "  --auto-dump           dump every cart in turn (SD card if any, else the host)\n"
+        "  --msc-read OUT        read the whole USB cart drive into a disk image\n"
+        "  --ctrl-stream MS      stream controller samples to stdout for MS ms\n"
+        "  --ctrl-rate HZ        polls per second for --ctrl-stream (default 1000)\n"
+        "  --verify              compare dumps with the loaded images\n"
+        "  --calibrate           tune the bus timing and burst length to the cart\n"
+        "  --bench-bus           time address latches and word reads\n"
+        "  --min-mibs N          fail if the burst ROM dump is slower\n"
+        "Without --dump-* options the CLI runs on stdin/stdout.\n",
+        argv0);
+}
+
+static bool parse(int argc, char **argv, options_t *o) {
+    memset(o, 0, sizeof(*o));
+    for (int i = 1; i < argc; ++i) {
+        const char *a = argv[i];
+        const char *v = (i + 1 < argc) ? argv[i + 1] : NULL;
+        bool flag = true;
+
+        if      (!strcmp(a, "--verify"))        { o->verify = true; flag = false; }
+        else if (!strcmp(a, "--calibrate"))     { o->calibrate = true; flag = false; }
+        else if (!strcmp(a, "--bench-bus"))     { o->bench_bus = true; flag = false; }
+        else if (!strcmp(a, "--controller"))    { o->controller = true; flag = false; }
+        else if (!strcmp(a, "--repro-diff"))    { o->repro_diff = true; flag = false; }
+        else if (!strcmp(a, "--sd-dump"))       { o->sd_dump = true; flag = false; }
+        else if (!strcmp(a, "--auto-dump"))     { o->auto_dump = true; flag = false; }
+        else if (!v)                            { return false; }
+        else if (!strcmp(a, "--rom"))           o->rom           = v;
+        else if (!strcmp(a, "--sram"))          o->sram          = v;
+        else if (!strcmp(a, "--eeprom"))        o->eeprom        = v;
+        else if (!strcmp(a, "--tacc-ns"))       o->tacc_ns       = atof(v);
+        else if (!strcmp(a, "--rom-page"))      o->page_bytes    = (unsigned)atoi(v);
+        else if (!strcmp(a, "--read-errors"))   o->read_errors   = (unsigned)atoi(v);
+        else if (!strcmp(a, "--dump-rom"))      o->dump_rom      = v;
+        else if (!strcmp(a, "--dump-rom-slow")) o->dump_rom_slow = v;
+        else if (!strcmp(a, "--dump-sram"))     o->dump_sram     = v;
+        else if (!strcmp(a, "--dump-eeprom"))   o->dump_eeprom   = v;
+        else if (!strcmp(a, "--restore-eeprom")) o->restore_eeprom = v;
+        else if (!strcmp(a, "--flashram"))      o->flashram      = v;
+        else if (!strcmp(a, "--flashram-type")) o->flashram_type = v;
+        else if (!strcmp(a, "--dump-flashram")) o->dump_flashram = v;
+        else if (!strcmp(a, "--restore-flashram")) o->restore_flashram = v;
+        else if (!strcmp(a, "--save-sram"))     o->save_sram     = v;
+        else if (!strcmp(a, "--mpk"))           o->mpk           = v;
+        else if (!strcmp(a, "--dump-mpk"))      o->dump_mpk      = v;
+        else if (!strcmp(a, "--restore-mpk"))   o->restore_mpk   = v;
+        else if (!strcmp(a, "--repro"))         o->repro         = v;
+        else if (!strcmp(a, "--program-repro")) o->program_repro = v;
+        else if (!strcmp(a, "--flash"))         o->flash         = v;
+        else if (!strcmp(a, "--sd-image"))      o->sd_image      = v;
+        else if (!strcmp(a, "--swap-ms"))       o->swap_ms       = (unsigned)atoi(v);
+        else if (!strcmp(a, "--cart-queue")) {
+            if (!slot_model_queue(v)) return false;
+        }
+        else if (!strcmp(a, "--msc-read"))      o->msc_read      = v;
+        else if (!strcmp(a, "--sd-create"))     o->sd_create_mb  = (unsigned)atoi(v);
+        else if (!strcmp(a, "--ctrl-stream"))   o->ctrl_stream_ms = (unsigned)atoi(v);
+        else if (!strcmp(a, "--ctrl-rate"))     o->ctrl_rate     = (unsigned)atoi(v);
+        else if (!strcmp(a, "--min-mibs"))      o->min_mibs      = atof(v);
+        else if (!strcmp(a, "--eeprom-size")) {
+            if      (!strcmp(v, "4k"))  o->eeprom_size = 512;
+            else if (!strcmp(v, "16k")) o->eeprom_size = 2048;
+            else return false;
+        }
+        else return false;
+
+        if (flag) ++i;
+    }
+    return true;
+}
+
+/* ------------------------------------------------------------ */
+/*  Dump helpers                                                 */
+/* ------------------------------------------------------------ */
+static bool write_file(const char *path, const uint8_t *buf, size_t len) {
+    FILE *f = fopen(path, "wb");
+    if (!f) {
+        perror(path);
+        return false;
+    }
+    bool ok = fwrite(buf, 1, len, f) == len;
+    fclose(f);
+    return ok;
+}
+
+static bool check(const char *what, const uint8_t *got, const uint8_t *want, size_t len) {
+    for (size_t i = 0; i < len; ++i) {
+        if (got[i] != want[i]) {
+            fprintf(stderr, "%s: MISMATCH at 0x%06zX (read %02X, expected %02X)\n",
+                    what, i, got[i], want[i]);
+            return false;
+        }
+    }
+    fprintf(stderr, "%s: verified %zu bytes\n", what, len);
+    return true;
+}
+
+static void report(const char *what, size_t len, uint64_t cycles) {
+    double s = (double)cycles / SIM_SYS_HZ;
+    fprintf(stderr, "%s: %zu bytes in %.3f s simulated (%.3f MiB/s)\n",
+            what, len, s, s > 0 ? len / s / (1024.0 * 1024.0) : 0.0);
+}
+
+typedef bool (*rom_reader_t)(uint32_t base_addr, uint8_t *buf, size_t len);
+
+static bool dump_rom(const char *what, const char *out, rom_reader_t read,
+                     bool verify, double *mibs) {
+    size_t   len = cart_model_rom_size();
+    uint8_t *buf = malloc(len);
+    if (!buf) return false;
+
+    uint64_t t0 = sim_now();
+    bool ok = read(N64_ROM_BASE, buf, len);
+    uint64_t dt = sim_now() - t0;
+    report(what, len, dt);
+    if (mibs) *mibs = len / ((double)dt / SIM_SYS_HZ) / (1024.0 * 1024.0);
+
+    ok = ok && write_file(out, buf, len);
+    if (ok && verify) ok = check(what, buf, cart_model_rom(), len);
+    free(buf);
+    return ok;
+}
+
+static bool dump_sram(const char *out, bool verify) {
+    static uint8_t buf[SRAM_DUMP_BYTES];
+    uint64_t t0 = sim_now();
+    for (uint32_t off = 0; off < SRAM_DUMP_BYTES; off += 2) {
+        uint16_t w = sram_read_word(N64_SRAM_BASE + off);
+        buf[off]     = (uint8_t)(w >> 8);
+        buf[off + 1] = (uint8_t)w;
+    }
+    report("sram", sizeof(buf), sim_now() - t0);
+
+    bool ok = write_file(out, buf, sizeof(buf));
+    if (ok && verify) ok = check("sram", buf, cart_model_sram(), sizeof(buf));
+    return ok;
+}
+
+static void report_eeprom(const char *what) {
+    eep_stats_t st;
+    GetEepromStats(&st);
+    if (st.blocks) {
+        fprintf(stderr, "%s: %u blocks, %.1f us/block, %u retries, %u busy polls\n", what,
+                (unsigned)st.blocks, (double)st.us / st.blocks, (unsigned)st.retries, (unsigned)st.polls);
+    }
+}
+
+static bool dump_eeprom(const char *out, bool verify) {
+    if (gEepromSize == 0) {
+        fprintf(stderr, "eeprom: no EEPROM detected\n");
+        return false;
+    }
+    static uint8_t buf[2048];
+    uint64_t t0 = sim_now();
+    bool ok = ReadEepromBlocks(0, gEepromSize / 8u, buf);
+    report("eeprom", gEepromSize, sim_now() - t0);
+    report_eeprom("eeprom");
+
+    ok = ok && write_file(out, buf, gEepromSize);
+    if (ok && verify) {
+        ok = gEepromSize == eeprom_model_size() &&
+             check("eeprom", buf, eeprom_model_data(), gEepromSize);
+    }
+    return ok;
+}
+
+static bool restore_eeprom(const char *in, bool verify) {
+    static uint8_t buf[2048];
+    if (gEepromSize == 0) {
+        fprintf(stderr, "eeprom: no EEPROM detected\n");
+        return false;
+    }
+    FILE *f = fopen(in, "rb");
+    if (!f) {
+        perror(in);
+        return false;
+    }
+    size_t n = fread(buf, 1, gEepromSize, f);
+    fclose(f);
+    if (n != gEepromSize) {
+        fprintf(stderr, "%s: the EEPROM holds %u bytes\n", in, (unsigned)gEepromSize);
+        return false;
+    }
+
+    uint64_t t0 = sim_now();
+    bool ok = WriteEepromBlocks(0, gEepromSize / 8u, buf);
+    report("eeprom write", gEepromSize, sim_now() - t0);
+    report_eeprom("eeprom write");
+    if (!ok) fprintf(stderr, "eeprom: write failed\n");
+    if (ok && verify) ok = check("eeprom write", eeprom_model_data(), buf, gEepromSize);
+    return ok;
+}
+
+static bool dump_flashram(const char *out, bool verify) {
+    static uint8_t buf[FLASHRAM_BYTES] __attribute__((aligned(4)));
+    flashram_info_t fi;
+    if (!flashram_identify(&fi)) {
+        fprintf(stderr, "flashram: no FlashRAM detected\n");
+        return false;
+    }
+    uint64_t t0 = sim_now();
+    bool ok = flashram_read(0, buf, sizeof(buf));
+    report("flashram", sizeof(buf), sim_now() - t0);
+
+    ok = ok && write_file(out, buf, sizeof(buf));
+    if (ok && verify) ok = check("flashram", buf, flashram_model_data(), sizeof(buf));
+    return ok;
+}
+
+static bool restore_flashram(const char *in, bool verify) {
+    static uint8_t buf[FLASHRAM_BYTES];
+    FILE *f = fopen(in, "rb");
+    if (!f) {
+        perror(in);
+        return false;
+    }
+    size_t n = fread(buf, 1, sizeof(buf), f);
+    fclose(f);
+    if (n != sizeof(buf)) {
+        fprintf(stderr, "%s: FlashRAM images are %u bytes\n", in, FLASHRAM_BYTES);
+        return false;
+    }
+
+    flashram_info_t fi;
+    if (!flashram_identify(&fi)) {
+        fprintf(stderr, "flashram: no FlashRAM detected\n");
+        return false;
+    }
+    uint64_t t0 = sim_now();
+    bool ok = flashram_write(0, buf, sizeof(buf));
+    report("flashram write", sizeof(buf), sim_now() - t0);
+    if (!ok) fprintf(stderr, "flashram: write failed\n");
+    if (ok && verify) ok = check("flashram write", flashram_model_data(), buf, sizeof(buf));
+    return ok;
+}
+
+static bool dump_mpk(const char *out, bool verify) {
+    static uint8_t buf[CTRL_PAK_BYTES];
+    controller_info_t ci;
+    if (!controller_info(&ci) || !(ci.status & CTRL_STATUS_PAK)) {
+        fprintf(stderr, "mpk: no controller pak detected\n");
+        return false;
+    }
+    joybus_port_t *p = controller_port();
+    uint32_t timeouts = p->timeouts;
+    uint64_t t0 = sim_now();
+    bool ok = controller_pak_read_range(0, sizeof(buf), buf);
+    report("mpk", sizeof(buf), sim_now() - t0);
+    fprintf(stderr, "mpk: %.1f us/block, %u timeouts\n",
+            (double)(sim_now() - t0) / SIM_CYCLES_PER_US / (sizeof(buf) / CTRL_PAK_BLOCK),
+            (unsigned)(p->timeouts - timeouts));
+
+    ok = ok && write_file(out, buf, sizeof(buf));
+    if (ok && verify) ok = check("mpk", buf, controller_model_pak(), sizeof(buf));
+    return ok;
+}
+
+static bool restore_mpk(const char *in, bool verify) {
+    static uint8_t buf[CTRL_PAK_BYTES];
+    FILE *f = fopen(in, "rb");
+    if (!f) {
+        perror(in);
+        return false;
+    }
+    size_t n = fread(buf, 1, sizeof(buf), f);
+    fclose(f);
+    if (n != sizeof(buf)) {
+        fprintf(stderr, "%s: controller pak images are %u bytes\n", in, CTRL_PAK_BYTES);
+        return false;
+    }
+
+    uint64_t t0 = sim_now();
+    bool ok = true;
+    for (uint32_t a = 0; ok && a < sizeof(buf); a += CTRL_PAK_BLOCK) {
+        ok = controller_pak_write((uint16_t)a, &buf[a]);
+    }
+    report("mpk write", sizeof(buf), sim_now() - t0);
+    if (!ok) fprintf(stderr, "mpk: write failed\n");
+    if (ok && verify) ok = check("mpk write", controller_model_pak(), buf, sizeof(buf));
+    return ok;
+}
+
+// CRC of the image over one sector, 0xFF past its end
+static uint32_t image_sector_crc(const uint8_t *img, size_t n, const xfer_sector_t *s) {
+    uint8_t pad[256];
+    memset(pad, 0xFF, sizeof(pad));
+    uint32_t have = s->offset < n ? (uint32_t)(n - s->offset) : 0;
+    if (have > s->size) have = s->size;
+    uint32_t crc = crc32_update(0, &img[s->offset], have);
+    for (uint32_t left = s->size - have; left;) {
+        uint32_t k = left < sizeof(pad) ? left : (uint32_t)sizeof(pad);
+        crc = crc32_update(crc, pad, k);
+        left -= k;
+    }
+    return crc;
+}
+
+static bool program_repro(const char *in, bool diff, bool verify) {
+    FILE *f = fopen(in, "rb");
+    if (!f) {
+        perror(in);
+        return false;
+    }
+    fseek(f, 0, SEEK_END);
+    long n = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    uint8_t *img = (n > 0) ? malloc((size_t)n) : NULL;
+    bool ok = img && fread(img, 1, (size_t)n, f) == (size_t)n;
+    fclose(f);
+    if (!ok) {
+        fprintf(stderr, "%s: read failed\n", in);
+        free(img);
+        return false;
+    }
+
+    // Same calls as the PDATA loop in flasher_run(), minus USB
+    repro_info_t ri;
+    const char  *err;
+    uint64_t t0 = sim_now();
+    if (!flasher_begin((uint32_t)n, diff ? XFER_PROGRAM_DIFF : 0, &ri, &err)) {
+        fprintf(stderr, "repro: %s\n", err);
+        free(img);
+        return false;
+    }
+    fprintf(stderr, "repro: %s x%u, %u MiB\n", ri.chip[0]->name, ri.chips, (unsigned)(ri.bytes >> 20));
+
+    // Without the differential scan the whole image is one changed span
+    uint32_t count, changed = 0;
+    const xfer_sector_t *sec = flasher_sectors(&count);
+    xfer_sector_t whole = { 0, (uint32_t)n, 0, 0, { 0 } };
+    if (!diff) {
+        sec   = &whole;
+        count = 1;
+    } else {
+        fprintf(stderr, "repro: %u sectors scanned in %.3f s simulated\n",
+                (unsigned)count, (double)(sim_now() - t0) / SIM_SYS_HZ);
+    }
+    for (uint32_t i = 0; ok && i < count; ++i) {
+        if (diff && sec[i].crc32 == image_sector_crc(img, (size_t)n, &sec[i])) continue;
+        changed++;
+        uint32_t end = sec[i].offset + sec[i].size < (uint32_t)n ? sec[i].offset + sec[i].size : (uint32_t)n;
+        for (uint32_t off = sec[i].offset; ok && off < end; off += PIPE_SLOT_BYTES) {
+            uint16_t len = (uint16_t)(end - off < PIPE_SLOT_BYTES ? end - off : PIPE_SLOT_BYTES);
+            memcpy(flasher_slot(), &img[off], len);
+            ok = flasher_commit(off, len);
+        }
+    }
+    xfer_program_done_t d;
+    ok = flasher_end(&d) && ok;
+    report("repro write", (size_t)n, sim_now() - t0);
+    if (!ok) {
+        fprintf(stderr, "repro: write failed at 0x%08X\n", (unsigned)flasher_fail_offset());
+        free(img);
+        return false;
+    }
+    fprintf(stderr, "repro: crc %08X, read back %08X; %u stalls on the flash, %u on the input\n",
+            (unsigned)d.crc32, (unsigned)d.flash_crc32,
+            (unsigned)d.producer_stalls, (unsigned)d.consumer_stalls);
+    if (diff) {
+        fprintf(stderr, "repro: %u of %u sectors written, %u erased, %u were blank\n",
+                (unsigned)changed, (unsigned)count, (unsigned)d.erased, (unsigned)d.blank);
+    }
+    if (d.crc32 != d.flash_crc32) {
+        fprintf(stderr, "repro: read-back CRC differs\n");
+        ok = false;
+    }
+    if (ok && verify) ok = check("repro write", reproflash_model_data(), img, (size_t)n);
+    free(img);
+    return ok;
+}
+
+// Value below which about 'frac' of a histogram's counts fall
+/* ------------------------------------------------------------ */
+/*  SD card                                                      */
+/* ------------------------------------------------------------ */
+// Read a file back from the card image by its first block
+static bool check_sd_file(const char *name, uint32_t lba, const uint8_t *want, size_t len) {
+    uint32_t blocks = (uint32_t)((len + SD_BLOCK_BYTES - 1u) / SD_BLOCK_BYTES);
+    uint8_t *buf = malloc((size_t)blocks * SD_BLOCK_BYTES);
+    if (!buf) return false;
+    bool ok = sd_read_blocks(lba, buf, blocks);
+    if (!ok) fprintf(stderr, "sd: cannot read back %s\n", name);
+    ok = ok && check(name, buf, want, len);
+    free(buf);
+    return ok;
+}
+
+static bool sd_dump(bool verify) {
+    sddump_result_t r;
+    const char *err = NULL;
+    uint64_t t0 = sim_now();
+    bool ok = sddump_run(&r, &err);
+    if (!ok) {
+        fprintf(stderr, "sd: %s\n", err);
+        return false;
+    }
+    report("sd rom", r.rom_bytes, (uint64_t)r.rom_us * SIM_CYCLES_PER_US);
+    fprintf(stderr, "sd: \"%s\" crc %08X%s; %u stalls on the card, %u on the cart\n",
+            r.rom_name, (unsigned)r.rom_crc32,
+            !r.db_crc32 ? " (not in the database)" :
+            (r.db_crc32 == r.rom_crc32 ? " (matches the database)" : " (DIFFERS from the database)"),
+            (unsigned)r.producer_stalls, (unsigned)r.consumer_stalls);
+    char md5[2 * DIGEST_MD5_LEN + 1], sha1[2 * DIGEST_SHA1_LEN + 1];
+    digest_hex(r.rom_md5,  DIGEST_MD5_LEN,  md5);
+    digest_hex(r.rom_sha1, DIGEST_SHA1_LEN, sha1);
+    fprintf(stderr, "sd: md5 %s sha1 %s\n", md5, sha1);
+    if (r.save_name[0]) fprintf(stderr, "sd: \"%s\" %u bytes\n", r.save_name, (unsigned)r.save_bytes);
+    fprintf(stderr, "sd: done in %.3f s simulated\n", (double)(sim_now() - t0) / SIM_SYS_HZ);
+
+    if (!verify) return true;
+    // A ROM shorter than a power of two is dumped with the mirror tail
+    size_t rom_len = r.rom_bytes < cart_model_rom_size() ? r.rom_bytes : cart_model_rom_size();
+    ok = check_sd_file(r.rom_name, r.rom_lba, cart_model_rom(), rom_len);
+    if (!r.save_name[0]) return ok;
+    const uint8_t *save = flashram_model_present() ? flashram_model_data() :
+                          eeprom_model_size()      ? eeprom_model_data()   : cart_model_sram();
+    return check_sd_file(r.save_name, r.save_lba, save, r.save_bytes) && ok;
+}
+
+// One dump per cart in the slot model, timed like the operator swaps them
+static bool auto_dump(void) {
+    sd_info_t si;
+    autodump_stats_t st;
+    autodump_run(sd_init(&si) ? AUTODUMP_TO_SD : AUTODUMP_TO_HOST, slot_model_carts(), &st);
+    fprintf(stderr, "auto: %u carts, %u failed in %.3f s simulated (%.0f carts/hour)\n",
+            (unsigned)st.carts, (unsigned)st.failed, st.total_ms / 1000.0,
+            st.total_ms ? st.carts * 3600000.0 / st.total_ms : 0.0);
+    return st.carts && !st.failed;
+}
+
+/* ------------------------------------------------------------ */
+/*  USB drive                                                    */
+/* ------------------------------------------------------------ */
+#define MSC_READ_BYTES  (64u * 1024u)             // a typical host READ10
+
+// The blocks a host sees, front to back, in the requests it would send
+static bool msc_read(const char *path, bool verify) {
+    if (!cartfs_mount()) {
+        fprintf(stderr, "msc: no cart\n");
+        return false;
+    }
+    uint32_t blocks = cartfs_blocks();
+    uint64_t bytes  = (uint64_t)blocks * CARTFS_BLOCK_BYTES;
+    uint8_t *img    = malloc((size_t)bytes);
+    if (!img) return false;
+
+    uint64_t t0 = sim_now();
+    bool ok = true;
+    for (uint64_t at = 0; ok && at < bytes; at += MSC_READ_BYTES) {
+        uint32_t n = bytes - at < MSC_READ_BYTES ? (uint32_t)(bytes - at) : MSC_READ_BYTES;
+        ok = cartfs_read((uint32_t)(at / CARTFS_BLOCK_BYTES), 0, &img[at], n);
+    }
+    uint64_t cycles = sim_now() - t0;
+    if (!ok) fprintf(stderr, "msc: read failed\n");
+    report("msc drive", (size_t)bytes, cycles);
+
+    unsigned n;
+    const cartfs_file_t *f = cartfs_files(&n);
+    for (unsigned i = 0; i < n; ++i)
+        fprintf(stderr, "msc: \"%s\" %u bytes at block %u\n", f[i].name,
+                (unsigned)f[i].bytes, (unsigned)f[i].first_lba);
+
+    FILE *fp = fopen(path, "wb");
+    if (!fp || fwrite(img, 1, (size_t)bytes, fp) != bytes) {
+        perror(path);
+        ok = false;
+    }
+    if (fp) fclose(fp);
+
+    if (ok && verify) {
+        for (unsigned i = 0; i < n; ++i) {
+            const uint8_t *got = &img[(size_t)f[i].first_lba * CARTFS_BLOCK_BYTES];
+            size_t len = f[i].bytes;
+            if (f[i].region == PIPE_REGION_ROM) {
+                if (len > cart_model_rom_size()) len = cart_model_rom_size();
+                ok &= check(f[i].name, got, cart_model_rom(), len);
+            } else if (f[i].region == PIPE_REGION_FLASHRAM) {
+                ok &= check(f[i].name, got, flashram_model_data(), len);
+            } else if (f[i].region == PIPE_REGION_EEPROM) {
+                ok &= check(f[i].name, got, eeprom_model_data(), len);
+            } else if (f[i].region == PIPE_REGION_SRAM) {
+                ok &= check(f[i].name, got, cart_model_sram(), len);
+            }
+        }
+    }
+    cartfs_unmount();
+    free(img);
+    return ok;
+}
+
+static unsigned hist_quantile(const uint32_t *h, uint32_t total, double frac) {
+    uint32_t acc = 0;
+    for (unsigned i = 0; i < XFER_CTRL_HIST_BUCKETS; ++i) {
+        acc += h[i];
+        if (acc >= total * frac) return 2u << i;
+    }
+    return 2u << (XFER_CTRL_HIST_BUCKETS - 1u);
+}
+
+static bool ctrl_stream(unsigned ms, unsigned hz, bool verify) {
+    xfer_ctrl_stream_t rq = { .rate_hz = (uint16_t)hz, .duration_ms = ms };
+    xfer_ctrl_done_t   d;
+    uint64_t t0 = sim_now();
+    if (!ctrlstream_run(&rq, &d)) {
+        fprintf(stderr, "ctrl: no controller answers\n");
+        return false;
+    }
+    double s = (double)(sim_now() - t0) / SIM_SYS_HZ;
+    uint32_t lat[XFER_CTRL_HIST_BUCKETS], jit[XFER_CTRL_HIST_BUCKETS], jn = 0;
+    memcpy(lat, d.latency, sizeof(lat));          // the wire struct is packed
+    memcpy(jit, d.jitter, sizeof(jit));
+    for (unsigned i = 0; i < XFER_CTRL_HIST_BUCKETS; ++i) jn += jit[i];
+
+    fprintf(stderr, "ctrl: %u samples in %.3f s simulated (%.0f Hz), %u polls, "
+            "%u timeouts, %u overruns, %u dropped\n",
+            (unsigned)d.samples, s, s > 0 ? d.samples / s : 0.0, (unsigned)d.polls,
+            (unsigned)d.timeouts, (unsigned)d.overruns, (unsigned)d.dropped);
+    fprintf(stderr, "ctrl: latency p50 < %u us, p99 < %u us, max %u us; jitter p99 < %u us, max %u us\n",
+            hist_quantile(lat, d.samples, 0.5), hist_quantile(lat, d.samples, 0.99),
+            (unsigned)d.latency_max_us, hist_quantile(jit, jn, 0.99), (unsigned)d.jitter_max_us);
+
+    if (!verify) return d.samples > 0;
+    bool ok = d.samples > 0 && d.samples == d.polls && !d.timeouts && !d.overruns && !d.dropped;
+    if (!ok) fprintf(stderr, "ctrl: FAILED, polls were lost\n");
+    return ok;
+}
+
+/*------------------------------------------------------------------*/
+/* Main                                                             */
+/*------------------------------------------------------------------*/
+int main(int argc, char **argv)
+{
+    options_t o;
+    if (!parse(argc, argv, &o)) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    if (o.rom  && !cart_model_load_rom(o.rom))   return 2;
+    if (o.sram && !cart_model_load_sram(o.sram)) return 2;
+    if (o.eeprom) {
+        if (!eeprom_model_load(o.eeprom, o.eeprom_size)) return 2;
+    } else if (o.eeprom_size) {
+        eeprom_model_set_size(o.eeprom_size);
+    }
+    if ((o.flashram || o.flashram_type) && !flashram_model_load(o.flashram, o.flashram_type)) return 2;
+    if (o.repro && !reproflash_model_load(o.repro, cart_model_rom(), cart_model_rom_size())) return 2;
+    if (o.flash && !sim_flash_open(o.flash)) return 2;
+    if (o.sd_image && !sd_image_open(o.sd_image, o.sd_create_mb)) return 2;
+    if (o.mpk) {
+        if (!controller_model_load_pak(o.mpk)) return 2;
+    } else if (o.controller) {
+        controller_model_plug(false);
+    }
+    if (o.swap_ms) slot_model_set_swap_ms(o.swap_ms);
+    if (o.tacc_ns > 0) cart_model_set_tacc_ns(o.tacc_ns);
+    if (o.page_bytes & (o.page_bytes - 1u)) {
+        fprintf(stderr, "--rom-page must be a power of two\n");
+        return 2;
+    }
+    cart_model_set_page_bytes(o.page_bytes);
+    cart_model_set_read_errors(o.read_errors);
+
+    tusb_init();
+    stdio_init_all();
+
+    bus_perf_init();
+
+    // Initialize AD Bus and Joybus
+    n64_adBus_init();
+    n64_eep_init();
+    controller_init();
+    cartid_init();
+    pipe_init();
+
+    bool batch = o.dump_rom || o.dump_rom_slow || o.dump_sram || o.dump_eeprom ||
+                 o.dump_flashram || o.restore_flashram || o.restore_eeprom ||
+                 o.dump_mpk || o.restore_mpk || o.ctrl_stream_ms || o.program_repro ||
+                 o.sd_dump || o.msc_read || o.calibrate || o.bench_bus || o.auto_dump;
+    if (!batch) {
+        while (!sim_stdin_closed())
+        {
+            tud_task();
+            cli_task();
+        }
+    }
+
+    bool ok = true;
+    if (o.calibrate) {
+        ad_bus_cal_result_t r;
+        uint64_t t0 = sim_now();
+        if (adBus_calibrate(&r)) {
+            fprintf(stderr, "calibrate: access %u (stable %u), latch %u (stable %u) cycles, "
+                    "%u reads in %.3f ms simulated\n",
+                    r.applied.access_cycles, r.fastest.access_cycles,
+                    r.applied.latch_cycles, r.fastest.latch_cycles, (unsigned)r.reads,
+                    (double)(sim_now() - t0) * 1000.0 / SIM_SYS_HZ);
+        } else {
+            fprintf(stderr, "calibrate: reference reads unstable, keeping defaults\n");
+        }
+        fprintf(stderr, "calibrate: bursts of %u bytes\n", (unsigned)n64_probe_burst_bytes());
+    }
+    if (o.bench_bus) {
+        ad_bus_bench_t b;
+        adBus_benchmark(&b);
+        fprintf(stderr, "bus: latch %u ns (ALE_L only %u ns), word %u ns, burst word %u ns\n",
+                (unsigned)b.latch_full_ns, (unsigned)b.latch_lo_ns,
+                (unsigned)b.read_word_ns, (unsigned)b.burst_word_ns);
+    }
+    if ((o.dump_rom || o.dump_rom_slow) && !cart_model_rom_size()) {
+        fprintf(stderr, "rom: --dump-rom needs --rom\n");
+        ok = false;
+    } else {
+        double mibs = 0;
+        if (o.dump_rom) {
+            ok &= dump_rom("rom", o.dump_rom, n64_read_bytes_fast, o.verify, &mibs);
+            if (o.min_mibs > 0 && mibs < o.min_mibs) {
+                fprintf(stderr, "rom: %.3f MiB/s is below the %.3f MiB/s floor\n",
+                        mibs, o.min_mibs);
+                ok = false;
+            }
+        }
+        if (o.dump_rom_slow) {
+            ok &= dump_rom("rom (word)", o.dump_rom_slow, n64_read_bytes, o.verify, NULL);
+        }
+    }
+    if (o.dump_sram)   ok &= dump_sram(o.dump_sram, o.verify);
+    if (o.restore_eeprom) ok &= restore_eeprom(o.restore_eeprom, o.verify);
+    if (o.dump_eeprom)    ok &= dump_eeprom(o.dump_eeprom, o.verify);
+    if (o.restore_flashram) ok &= restore_flashram(o.restore_flashram, o.verify);
+    if (o.dump_flashram)    ok &= dump_flashram(o.dump_flashram, o.verify);
+    if (o.restore_mpk) ok &= restore_mpk(o.restore_mpk, o.verify);
+    if (o.dump_mpk)    ok &= dump_mpk(o.dump_mpk, o.verify);
+    if (o.program_repro) ok &= program_repro(o.program_repro, o.repro_diff, o.verify);
+    if (o.sd_dump) ok &= sd_dump(o.verify);
+    if (o.auto_dump) ok &= auto_dump();
+    if (o.msc_read) ok &= msc_read(o.msc_read, o.verify);
+    if (o.ctrl_stream_ms) ok &= ctrl_stream(o.ctrl_stream_ms, o.ctrl_rate, o.verify);
+
+    if (o.save_sram && !cart_model_save_sram(o.save_sram)) ok = false;
+    sd_image_close();
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,70 @@
+/* hardware/dma.h – host stand-in for the Pico SDK (N64_HOST builds only)
+ *  Channels paced by a PIO DREQ move data between the simulated FIFOs and
+ *  memory as the state machines produce/consume it; unpaced channels
+ *  complete immediately.
+ */
+#ifndef HOST_HARDWARE_DMA_H_
+#define HOST_HARDWARE_DMA_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "pico/platform.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define NUM_DMA_CHANNELS 12
+#define DREQ_FORCE       0x3f
+
+enum dma_channel_transfer_size {
+    DMA_SIZE_8  = 0,
+    DMA_SIZE_16 = 1,
+    DMA_SIZE_32 = 2,
+};
+
+typedef struct {
+    enum dma_channel_transfer_size size;
+    bool read_increment;
+    bool write_increment;
+    bool bswap;
+    uint dreq;
+    int  chain_to;
+} dma_channel_config;
+
+int  dma_claim_unused_channel(bool required);
+void dma_channel_claim(uint channel);
+void dma_channel_unclaim(uint channel);
+
+dma_channel_config dma_channel_get_default_config(uint channel);
+void channel_config_set_transfer_data_size(dma_channel_config *c, enum dma_channel_transfer_size size);
+void channel_config_set_read_increment(dma_channel_config *c, bool incr);
+void channel_config_set_write_increment(dma_channel_config *c, bool incr);
+void channel_config_set_bswap(dma_channel_config *c, bool bswap);
+void channel_config_set_dreq(dma_channel_config *c, uint dreq);
+void channel_config_set_chain_to(dma_channel_config *c, uint chain_to);
+
+void dma_channel_configure(uint channel, const dma_channel_config *config,
+                           volatile void *write_addr, const volatile void *read_addr,
+                           uint transfer_count, bool trigger);
+void dma_channel_set_read_addr(uint channel, const volatile void *read_addr, bool trigger);
+void dma_channel_set_write_addr(uint channel, volatile void *write_addr, bool trigger);
+void dma_channel_set_trans_count(uint channel, uint32_t trans_count, bool trigger);
+void dma_channel_start(uint channel);
+void dma_channel_abort(uint channel);
+bool dma_channel_is_busy(uint channel);
+void dma_channel_wait_for_finish_blocking(uint channel);
+
+// Completion interrupts (DMA_IRQ_0 / DMA_IRQ_1 in hardware/irq.h)
+void dma_channel_set_irq0_enabled(uint channel, bool enabled);
+void dma_channel_set_irq1_enabled(uint channel, bool enabled);
+bool dma_channel_get_irq0_status(uint channel);
+bool dma_channel_get_irq1_status(uint channel);
+void dma_channel_acknowledge_irq0(uint channel);
+void dma_channel_acknowledge_irq1(uint channel);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* HOST_HARDWARE_DMA_H_ */
@@ -0,0 +1,34 @@
+/* hardware/flash.h – host stand-in for the Pico SDK (N64_HOST builds only)
+ *  ---------------------------------------------------------------
+ *  • The program flash is a byte array, optionally backed by a file
+ *    (host/sdk_flash.c); XIP_BASE points at it so firmware reads it
+ *    the way it reads the real XIP window
+ *  • Erase and program enforce the NOR rules: sector/page alignment,
+ *    and programming can only clear bits
+ */
+#ifndef HOST_HARDWARE_FLASH_H_
+#define HOST_HARDWARE_FLASH_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define FLASH_PAGE_SIZE        (1u << 8)
+#define FLASH_SECTOR_SIZE      (1u << 12)
+#ifndef PICO_FLASH_SIZE_BYTES
+#define PICO_FLASH_SIZE_BYTES  (2u * 1024u * 1024u)
+#endif
+
+extern uint8_t sim_flash[PICO_FLASH_SIZE_BYTES];
+#define XIP_BASE               ((uintptr_t)sim_flash)
+
+void flash_range_erase(uint32_t flash_offs, size_t count);
+void flash_range_program(uint32_t flash_offs, const uint8_t *data, size_t count);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* HOST_HARDWARE_FLASH_H_ */
@@ -0,0 +1,46 @@
+/* hardware/gpio.h – host stand-in for the Pico SDK (N64_HOST builds only)
+ *  Pins are modelled by host/sim_core.c and connected to the simulated
+ *  cartridge and EEPROM.
+ */
+#ifndef HOST_HARDWARE_GPIO_H_
+#define HOST_HARDWARE_GPIO_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "pico/platform.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define NUM_BANK0_GPIOS 30
+
+#define GPIO_OUT 1
+#define GPIO_IN  0
+
+enum gpio_function {
+    GPIO_FUNC_SPI  = 1,
+    GPIO_FUNC_UART = 2,
+    GPIO_FUNC_I2C  = 3,
+    GPIO_FUNC_PWM  = 4,
+    GPIO_FUNC_SIO  = 5,
+    GPIO_FUNC_PIO0 = 6,
+    GPIO_FUNC_PIO1 = 7,
+    GPIO_FUNC_NULL = 0x1f,
+};
+
+void gpio_init(uint gpio);
+void gpio_set_function(uint gpio, enum gpio_function fn);
+void gpio_set_dir(uint gpio, bool out);
+void gpio_put(uint gpio, bool value);
+bool gpio_get(uint gpio);
+void gpio_set_pulls(uint gpio, bool up, bool down);
+void gpio_pull_up(uint gpio);
+void gpio_pull_down(uint gpio);
+void gpio_disable_pulls(uint gpio);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* HOST_HARDWARE_GPIO_H_ */
@@ -0,0 +1,28 @@
+/* hardware/irq.h – host stand-in for the Pico SDK (N64_HOST builds only)
+ *  Handlers run between simulated clock ticks, never inside a critical
+ *  section and never nested; see host/sdk_irq.c.
+ */
+#ifndef HOST_HARDWARE_IRQ_H_
+#define HOST_HARDWARE_IRQ_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "pico/platform.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define DMA_IRQ_0 11
+#define DMA_IRQ_1 12
+
+typedef void (*irq_handler_t)(void);
+
+void irq_set_exclusive_handler(uint num, irq_handler_t handler);
+void irq_set_enabled(uint num, bool enabled);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* HOST_HARDWARE_IRQ_H_ */
@@ -0,0 +1,105 @@
+/* hardware/pio.h – host stand-in for the Pico SDK (N64_HOST builds only)
+ *  Programs run instruction by instruction in host/pio_sim.c, clocked by
+ *  the simulated system clock.
+ */
+#ifndef HOST_HARDWARE_PIO_H_
+#define HOST_HARDWARE_PIO_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "pico/platform.h"
+#include "hardware/gpio.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define NUM_PIOS              2
+#define NUM_PIO_STATE_MACHINES 4
+
+// Register block: only the FIFO windows are real, so DMA can be pointed at them
+typedef struct {
+    volatile uint32_t txf[NUM_PIO_STATE_MACHINES];
+    volatile uint32_t rxf[NUM_PIO_STATE_MACHINES];
+} pio_hw_t;
+
+typedef pio_hw_t *PIO;
+
+extern pio_hw_t host_pio_hw[NUM_PIOS];
+#define pio0 (&host_pio_hw[0])
+#define pio1 (&host_pio_hw[1])
+
+struct pio_program {
+    const uint16_t *instructions;
+    uint8_t length;
+    int8_t  origin;
+    uint8_t pio_version;
+};
+
+typedef struct {
+    uint32_t clkdiv;
+    uint8_t  wrap_target, wrap;
+    uint8_t  in_base;
+    uint8_t  out_base, out_count;
+    uint8_t  set_base, set_count;
+    uint8_t  jmp_pin;
+    bool     in_shift_right, autopush;
+    uint8_t  push_threshold;
+    bool     out_shift_right, autopull;
+    uint8_t  pull_threshold;
+} pio_sm_config;
+
+enum pio_fifo_join {
+    PIO_FIFO_JOIN_NONE = 0,
+    PIO_FIFO_JOIN_TX   = 1,
+    PIO_FIFO_JOIN_RX   = 2,
+};
+
+pio_sm_config pio_get_default_sm_config(void);
+void sm_config_set_wrap(pio_sm_config *c, uint wrap_target, uint wrap);
+void sm_config_set_in_pins(pio_sm_config *c, uint in_base);
+void sm_config_set_out_pins(pio_sm_config *c, uint out_base, uint out_count);
+void sm_config_set_set_pins(pio_sm_config *c, uint set_base, uint set_count);
+void sm_config_set_jmp_pin(pio_sm_config *c, uint pin);
+void sm_config_set_clkdiv(pio_sm_config *c, float div);
+void sm_config_set_in_shift(pio_sm_config *c, bool shift_right, bool autopush, uint push_threshold);
+void sm_config_set_out_shift(pio_sm_config *c, bool shift_right, bool autopull, uint pull_threshold);
+void sm_config_set_fifo_join(pio_sm_config *c, enum pio_fifo_join join);
+
+uint pio_get_index(PIO pio);
+uint pio_add_program(PIO pio, const struct pio_program *program);
+bool pio_can_add_program(PIO pio, const struct pio_program *program);
+void pio_gpio_init(PIO pio, uint pin);
+
+void pio_sm_claim(PIO pio, uint sm);
+int  pio_claim_unused_sm(PIO pio, bool required);
+void pio_sm_unclaim(PIO pio, uint sm);
+
+void pio_sm_init(PIO pio, uint sm, uint initial_pc, const pio_sm_config *config);
+void pio_sm_set_enabled(PIO pio, uint sm, bool enabled);
+void pio_sm_restart(PIO pio, uint sm);
+void pio_sm_clear_fifos(PIO pio, uint sm);
+void pio_sm_exec_jmp(PIO pio, uint sm, uint pc);
+void pio_sm_exec(PIO pio, uint sm, uint instr);     // unconditional JMP only
+
+static inline uint pio_encode_jmp(uint addr) { return addr & 0x1Fu; }
+void pio_sm_set_pins_with_mask(PIO pio, uint sm, uint32_t pin_values, uint32_t pin_mask);
+void pio_sm_set_pindirs_with_mask(PIO pio, uint sm, uint32_t pin_dirs, uint32_t pin_mask);
+void pio_sm_set_consecutive_pindirs(PIO pio, uint sm, uint pin_base, uint pin_count, bool is_out);
+
+bool     pio_sm_is_tx_fifo_full(PIO pio, uint sm);
+bool     pio_sm_is_tx_fifo_empty(PIO pio, uint sm);
+bool     pio_sm_is_rx_fifo_empty(PIO pio, uint sm);
+uint     pio_sm_get_rx_fifo_level(PIO pio, uint sm);
+void     pio_sm_put(PIO pio, uint sm, uint32_t data);
+void     pio_sm_put_blocking(PIO pio, uint sm, uint32_t data);
+uint32_t pio_sm_get(PIO pio, uint sm);
+uint32_t pio_sm_get_blocking(PIO pio, uint sm);
+
+uint pio_get_dreq(PIO pio, uint sm, bool is_tx);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* HOST_HARDWARE_PIO_H_ */
@@ -0,0 +1,13 @@
+/* hardware/sync.h – host stand-in for the Pico SDK (N64_HOST builds only) */
+#ifndef HOST_HARDWARE_SYNC_H_
+#define HOST_HARDWARE_SYNC_H_
+
+#include <stdint.h>
+
+static inline void __dmb(void) { __sync_synchronize(); }
+
+// One host thread runs both cores; nothing can interrupt it
+static inline uint32_t save_and_disable_interrupts(void) { return 0; }
+static inline void restore_interrupts(uint32_t status) { (void)status; }
+
+#endif /* HOST_HARDWARE_SYNC_H_ */
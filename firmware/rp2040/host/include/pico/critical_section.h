@@ -0,0 +1,23 @@
+/* pico/critical_section.h – host stand-in for the Pico SDK (N64_HOST builds only)
+ *  Both cores share the host thread, so a critical section only has to
+ *  hold off the simulated interrupt handlers.
+ */
+#ifndef HOST_PICO_CRITICAL_SECTION_H_
+#define HOST_PICO_CRITICAL_SECTION_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    int depth;
+} critical_section_t;
+
+void critical_section_init(critical_section_t *crit_sec);
+void critical_section_enter_blocking(critical_section_t *crit_sec);
+void critical_section_exit(critical_section_t *crit_sec);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* HOST_PICO_CRITICAL_SECTION_H_ */
@@ -0,0 +1,24 @@
+/* pico/multicore.h – host stand-in for the Pico SDK (N64_HOST builds only)
+ *  Core 1 runs as a coroutine on the host thread; see host/sdk_multicore.c.
+ */
+#ifndef HOST_PICO_MULTICORE_H_
+#define HOST_PICO_MULTICORE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void     multicore_launch_core1(void (*entry)(void));
+bool     multicore_fifo_rvalid(void);
+bool     multicore_fifo_wready(void);
+void     multicore_fifo_push_blocking(uint32_t data);
+uint32_t multicore_fifo_pop_blocking(void);
+uint32_t get_core_num(void);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* HOST_PICO_MULTICORE_H_ */
@@ -0,0 +1,16 @@
+/* pico/platform.h – host stand-in for the Pico SDK (N64_HOST builds only) */
+#ifndef HOST_PICO_PLATFORM_H_
+#define HOST_PICO_PLATFORM_H_
+
+#include <stdint.h>
+
+typedef unsigned int uint;
+
+#define __time_critical_func(func_name) func_name
+#define __not_in_flash_func(func_name)  func_name
+#define __not_in_flash(group)
+
+// Spin-wait hint; on the host it also lets the other core run
+void tight_loop_contents(void);
+
+#endif /* HOST_PICO_PLATFORM_H_ */
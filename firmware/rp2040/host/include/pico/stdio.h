@@ -0,0 +1,19 @@
+/* pico/stdio.h – host stand-in for the Pico SDK (N64_HOST builds only) */
+#ifndef HOST_PICO_STDIO_H_
+#define HOST_PICO_STDIO_H_
+
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct stdio_driver stdio_driver_t;
+
+bool stdio_init_all(void);
+void stdio_set_translate_crlf(stdio_driver_t *driver, bool translate);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* HOST_PICO_STDIO_H_ */
@@ -0,0 +1,18 @@
+/* pico/stdio_usb.h – host stand-in for the Pico SDK (N64_HOST builds only)
+ *  stdout is written as-is on the host, so CRLF translation is a no-op.
+ */
+#ifndef HOST_PICO_STDIO_USB_H_
+#define HOST_PICO_STDIO_USB_H_
+
+#include "pico/stdio.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern stdio_driver_t stdio_usb;
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* HOST_PICO_STDIO_USB_H_ */
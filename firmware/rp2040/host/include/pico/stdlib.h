@@ -0,0 +1,36 @@
+/* pico/stdlib.h – host stand-in for the Pico SDK (N64_HOST builds only)
+ *  ---------------------------------------------------------------
+ *  • Time is the simulated 125 MHz clock in host/sim_core.c
+ *  • stdio is the process' stdin/stdout
+ */
+#ifndef HOST_PICO_STDLIB_H_
+#define HOST_PICO_STDLIB_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "pico/platform.h"
+#include "pico/stdio.h"
+#include "pico/time.h"
+#include "hardware/gpio.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PICO_ERROR_TIMEOUT  (-1)
+#define PICO_DEFAULT_LED_PIN 25      // boards/pico.h
+
+int      getchar_timeout_us(uint32_t timeout_us);
+
+void     sleep_us(uint64_t us);
+void     sleep_ms(uint32_t ms);
+void     busy_wait_us_32(uint32_t us);
+uint32_t time_us_32(void);
+uint64_t time_us_64(void);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* HOST_PICO_STDLIB_H_ */
@@ -0,0 +1,27 @@
+/* pico/time.h – host stand-in for the Pico SDK (N64_HOST builds only)
+ *  Alarms fire on the simulated clock, in "interrupt" context like the
+ *  default alarm pool on the board; see host/sdk_irq.c.
+ */
+#ifndef HOST_PICO_TIME_H_
+#define HOST_PICO_TIME_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef int32_t alarm_id_t;
+
+// Return 0 to stop, <0 to fire again -ret µs after the scheduled time,
+// >0 to fire again ret µs from now
+typedef int64_t (*alarm_callback_t)(alarm_id_t id, void *user_data);
+
+alarm_id_t add_alarm_in_us(uint64_t us, alarm_callback_t callback, void *user_data, bool fire_if_past);
+bool       cancel_alarm(alarm_id_t alarm_id);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* HOST_PICO_TIME_H_ */
@@ -0,0 +1,21 @@
+/* tusb.h – host stand-in for TinyUSB (N64_HOST builds only)
+ *  The CDC port is the process' stdin/stdout and is always "connected".
+ */
+#ifndef HOST_TUSB_H_
+#define HOST_TUSB_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+bool tusb_init(void);
+void tud_task(void);
+bool tud_cdc_connected(void);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* HOST_TUSB_H_ */
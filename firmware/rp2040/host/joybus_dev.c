@@ -0,0 +1,79 @@
+/* joybus_dev.c – line-level joybus device core (host builds) */
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "sim.h"
+#include "joybus_dev.h"
+
+#define US(x)            ((uint64_t)(x) * SIM_CYCLES_PER_US)
+#define BIT_CELL         US(4)
+#define BIT_THRESHOLD    US(2)        // low time separating a 1 from a 0
+#define FRAME_GAP        US(50)       // idle time that starts a new command
+#define REPLY_DELAY      US(8)        // stop bit → first reply bit
+
+void jb_dev_reply(jb_dev_t *d, const uint8_t *bytes, unsigned len, uint64_t stop_rise) {
+    memcpy(d->tx, bytes, len);
+    d->tx_bits   = len * 8u;
+    d->tx_start  = stop_rise + REPLY_DELAY;
+    d->tx_active = true;
+}
+
+void jb_dev_line(jb_dev_t *d, bool level, uint64_t t) {
+    if (d->tx_active) return;
+
+    if (!level) {
+        if (t - d->rise_t > FRAME_GAP) {      // long idle → new command
+            d->rx_bits   = 0;
+            d->rx_expect = 0;
+        }
+        d->fall_t = t;
+        return;
+    }
+
+    d->rise_t = t;
+    bool bit = (t - d->fall_t) < BIT_THRESHOLD;
+    if (d->rx_expect && d->rx_bits == d->rx_expect * 8u) {
+        // This was the console stop bit
+        d->execute(d, t);
+        d->rx_bits   = 0;
+        d->rx_expect = 0;
+        return;
+    }
+    if (d->rx_bits < sizeof(d->rx) * 8u) {
+        uint8_t *b = &d->rx[d->rx_bits / 8u];
+        *b = (uint8_t)((*b << 1) | bit);
+        d->rx_bits++;
+    }
+    if (d->rx_bits == 8u) d->rx_expect = d->command_length(d->rx[0]);
+}
+
+static uint64_t cell_low_time(const jb_dev_t *d, unsigned i) {
+    if (i == d->tx_bits) return US(2);         // stop bit
+    bool one = (d->tx[i / 8u] >> (7u - (i % 8u))) & 1u;
+    return one ? US(1) : US(3);
+}
+
+bool jb_dev_pulling_low(const jb_dev_t *d, uint64_t t) {
+    if (!d->tx_active || t < d->tx_start) return false;
+    uint64_t off  = t - d->tx_start;
+    unsigned cell = (unsigned)(off / BIT_CELL);
+    if (cell > d->tx_bits) return false;
+    return (off % BIT_CELL) < cell_low_time(d, cell);
+}
+
+uint64_t jb_dev_next_event(jb_dev_t *d, uint64_t now) {
+    if (!d->tx_active) return SIM_NEVER;
+    if (now < d->tx_start) return d->tx_start;
+
+    uint64_t off  = now - d->tx_start;
+    unsigned cell = (unsigned)(off / BIT_CELL);
+    if (cell > d->tx_bits) {
+        d->tx_active = false;                 // reply fully on the wire
+        d->rise_t    = now;
+        return SIM_NEVER;
+    }
+    uint64_t cell_start = d->tx_start + (uint64_t)cell * BIT_CELL;
+    uint64_t rise       = cell_start + cell_low_time(d, cell);
+    return (now < rise) ? rise : cell_start + BIT_CELL;
+}
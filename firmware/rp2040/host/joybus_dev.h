@@ -0,0 +1,40 @@
+/* joybus_dev.h – line-level joybus device core shared by the host models
+ *  ---------------------------------------------------------------
+ *  • Decodes console bits from the line: low < 2 µs is a 1, longer a 0
+ *  • Replies with 4 µs bit cells and a 2 µs stop bit, pulling the line
+ *    low open-drain style; sim_advance() steps to every reply edge
+ */
+#ifndef HOST_JOYBUS_DEV_H_
+#define HOST_JOYBUS_DEV_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define JB_DEV_MAX_BYTES 40u
+
+typedef struct jb_dev jb_dev_t;
+
+struct jb_dev {
+    // Device behaviour
+    unsigned (*command_length)(uint8_t cmd);             // bytes incl. the command
+    void     (*execute)(jb_dev_t *d, uint64_t stop_rise); // d->rx holds the command
+
+    // Receiver
+    uint64_t fall_t, rise_t;
+    uint8_t  rx[JB_DEV_MAX_BYTES];
+    unsigned rx_bits;
+    unsigned rx_expect;                  // command length in bytes, 0 = unknown yet
+
+    // Reply
+    uint8_t  tx[JB_DEV_MAX_BYTES];
+    unsigned tx_bits;                    // data bits; a stop bit follows
+    uint64_t tx_start;
+    bool     tx_active;
+};
+
+void     jb_dev_reply(jb_dev_t *d, const uint8_t *bytes, unsigned len, uint64_t stop_rise);
+void     jb_dev_line(jb_dev_t *d, bool level, uint64_t t);   // host-side drive level
+bool     jb_dev_pulling_low(const jb_dev_t *d, uint64_t t);
+uint64_t jb_dev_next_event(jb_dev_t *d, uint64_t now);
+
+#endif /* HOST_JOYBUS_DEV_H_ */
@@ -0,0 +1,385 @@
+/* pio_sim.c – cycle-level model of an RP2040 PIO state machine (host only) */
+#include <string.h>
+
+#include "pio_sim.h"
+
+#define OP_JMP   0u
+#define OP_WAIT  1u
+#define OP_IN    2u
+#define OP_OUT   3u
+#define OP_PUSH  4u   /* PUSH / PULL share a major opcode */
+#define OP_MOV   5u
+#define OP_IRQ   6u
+#define OP_SET   7u
+
+static inline uint32_t rotl32(uint32_t v, unsigned n) {
+    n &= 31u;
+    return n ? (v << n) | (v >> (32u - n)) : v;
+}
+
+static inline uint32_t low_mask(unsigned bits) {
+    return bits >= 32u ? 0xFFFFFFFFu : ((1u << bits) - 1u);
+}
+
+static inline uint32_t bit_reverse(uint32_t v) {
+    uint32_t r = 0;
+    for (int i = 0; i < 32; ++i) {
+        r = (r << 1) | (v & 1u);
+        v >>= 1;
+    }
+    return r;
+}
+
+/* ------------------------------------------------------------ */
+/*  Program loading / reset                                     */
+/* ------------------------------------------------------------ */
+// Copy a pioasm program into instruction memory, relocating JMP targets
+// exactly like pio_add_program_at_offset() does.
+void pio_sim_load(uint16_t *imem, const uint16_t *prog, uint8_t len, uint8_t offset) {
+    for (uint8_t i = 0; i < len && (uint8_t)(offset + i) < PIO_SIM_IMEM_SIZE; ++i) {
+        uint16_t ins = prog[i];
+        if ((ins >> 13) == OP_JMP) {
+            ins = (uint16_t)((ins & ~0x1Fu) | ((ins + offset) & 0x1Fu));
+        }
+        imem[offset + i] = ins;
+    }
+}
+
+void pio_sim_sm_reset(pio_sim_sm_t *sm, const uint16_t *imem) {
+    pio_sim_pins_t pins = sm->pins;
+    memset(sm, 0, sizeof(*sm));
+    sm->pins           = pins;
+    sm->imem           = imem;
+    sm->wrap_top       = PIO_SIM_IMEM_SIZE - 1;
+    sm->in_shift_right = true;
+    sm->out_shift_right = true;
+    sm->push_threshold = 32;
+    sm->pull_threshold = 32;
+    sm->osr_count      = 32;   // OSR starts empty
+    sm->clkdiv         = 1;
+}
+
+void pio_sim_jump(pio_sim_sm_t *sm, uint8_t pc) {
+    sm->pc      = pc & 0x1Fu;
+    sm->delay   = 0;
+    sm->blocked = PIO_SIM_RUNNING;
+}
+
+/* ------------------------------------------------------------ */
+/*  FIFOs                                                        */
+/* ------------------------------------------------------------ */
+bool pio_sim_tx_full(const pio_sim_sm_t *sm)  { return sm->tx_level == PIO_SIM_FIFO_DEPTH; }
+bool pio_sim_rx_empty(const pio_sim_sm_t *sm) { return sm->rx_level == 0; }
+
+void pio_sim_tx_put(pio_sim_sm_t *sm, uint32_t v) {
+    if (pio_sim_tx_full(sm)) return;                 // hardware drops it too
+    sm->tx[(sm->tx_head + sm->tx_level++) % PIO_SIM_FIFO_DEPTH] = v;
+    if (sm->blocked == PIO_SIM_BLOCKED_FIFO) sm->blocked = PIO_SIM_RUNNING;
+}
+
+uint32_t pio_sim_rx_get(pio_sim_sm_t *sm) {
+    if (pio_sim_rx_empty(sm)) return 0;
+    uint32_t v = sm->rx[sm->rx_head];
+    sm->rx_head = (uint8_t)((sm->rx_head + 1) % PIO_SIM_FIFO_DEPTH);
+    sm->rx_level--;
+    if (sm->blocked == PIO_SIM_BLOCKED_FIFO) sm->blocked = PIO_SIM_RUNNING;
+    return v;
+}
+
+static bool tx_pop(pio_sim_sm_t *sm, uint32_t *v) {
+    if (sm->tx_level == 0) return false;
+    *v = sm->tx[sm->tx_head];
+    sm->tx_head = (uint8_t)((sm->tx_head + 1) % PIO_SIM_FIFO_DEPTH);
+    sm->tx_level--;
+    return true;
+}
+
+static void rx_push(pio_sim_sm_t *sm, uint32_t v) {
+    sm->rx[(sm->rx_head + sm->rx_level++) % PIO_SIM_FIFO_DEPTH] = v;
+}
+
+/* ------------------------------------------------------------ */
+/*  Pin helpers                                                  */
+/* ------------------------------------------------------------ */
+static uint32_t read_pins(pio_sim_sm_t *sm) {
+    return sm->pins.read_pins ? sm->pins.read_pins(sm->pins.ctx) : 0;
+}
+
+static void write_pins(pio_sim_sm_t *sm, uint8_t base, uint8_t count, uint32_t data) {
+    if (!sm->pins.write_pins || count == 0) return;
+    uint32_t mask = rotl32(low_mask(count), base);
+    sm->pins.write_pins(sm->pins.ctx, mask, rotl32(data, base) & mask);
+}
+
+static void write_pindirs(pio_sim_sm_t *sm, uint8_t base, uint8_t count, uint32_t data) {
+    if (!sm->pins.write_pindirs || count == 0) return;
+    uint32_t mask = rotl32(low_mask(count), base);
+    sm->pins.write_pindirs(sm->pins.ctx, mask, rotl32(data, base) & mask);
+}
+
+/* ------------------------------------------------------------ */
+/*  Instruction execution                                        */
+/*  Returns PIO_SIM_RUNNING, or the reason the instruction stalls */
+/* ------------------------------------------------------------ */
+static uint8_t exec(pio_sim_sm_t *sm, uint16_t ins, bool *jumped) {
+    unsigned op  = ins >> 13;
+    unsigned arg = (ins >> 5) & 7u;
+    unsigned idx = ins & 0x1Fu;
+
+    switch (op) {
+    case OP_JMP: {
+        bool take;
+        switch (arg) {
+        case 0: take = true;                        break;
+        case 1: take = (sm->x == 0);                break;
+        case 2: take = (sm->x != 0); sm->x--;       break;
+        case 3: take = (sm->y == 0);                break;
+        case 4: take = (sm->y != 0); sm->y--;       break;
+        case 5: take = (sm->x != sm->y);            break;
+        case 6: take = (read_pins(sm) >> sm->jmp_pin) & 1u; break;
+        default: take = sm->osr_count < sm->pull_threshold; break;
+        }
+        if (take) {
+            sm->pc  = (uint8_t)idx;
+            *jumped = true;
+        }
+        return PIO_SIM_RUNNING;
+    }
+
+    case OP_WAIT: {
+        unsigned pol = (ins >> 7) & 1u;
+        unsigned src = (ins >> 5) & 3u;
+        uint32_t level;
+        if (src == 0)      level = (read_pins(sm) >> idx) & 1u;
+        else if (src == 1) level = (read_pins(sm) >> ((sm->in_base + idx) & 31u)) & 1u;
+        else               level = pol;          // IRQ waits are not modelled
+        return (level == pol) ? PIO_SIM_RUNNING : PIO_SIM_BLOCKED_WAIT;
+    }
+
+    case OP_IN: {
+        unsigned bits = idx ? idx : 32u;
+        if (sm->autopush && sm->isr_count + bits >= sm->push_threshold &&
+            sm->rx_level == PIO_SIM_FIFO_DEPTH) {
+            return PIO_SIM_BLOCKED_FIFO;
+        }
+        uint32_t data;
+        switch (arg) {
+        case 0:  data = rotl32(read_pins(sm), 32u - sm->in_base); break;
+        case 1:  data = sm->x;   break;
+        case 2:  data = sm->y;   break;
+        case 6:  data = sm->isr; break;
+        case 7:  data = sm->osr; break;
+        default: data = 0;       break;
+        }
+        data &= low_mask(bits);
+        if (bits == 32u)              sm->isr = data;
+        else if (sm->in_shift_right)  sm->isr = (sm->isr >> bits) | (data << (32u - bits));
+        else                          sm->isr = (sm->isr << bits) | data;
+        sm->isr_count = (uint8_t)((sm->isr_count + bits > 32u) ? 32u : sm->isr_count + bits);
+        if (sm->autopush && sm->isr_count >= sm->push_threshold) {
+            rx_push(sm, sm->isr);
+            sm->isr = 0;
+            sm->isr_count = 0;
+        }
+        return PIO_SIM_RUNNING;
+    }
+
+    case OP_OUT: {
+        unsigned bits = idx ? idx : 32u;
+        if (sm->autopull && sm->osr_count >= sm->pull_threshold) {
+            if (!tx_pop(sm, &sm->osr)) return PIO_SIM_BLOCKED_FIFO;
+            sm->osr_count = 0;
+        }
+        uint32_t data;
+        if (sm->out_shift_right) {
+            data    = sm->osr & low_mask(bits);
+            sm->osr = (bits == 32u) ? 0 : (sm->osr >> bits);
+        } else {
+            data    = (bits == 32u) ? sm->osr : (sm->osr >> (32u - bits));
+            sm->osr = (bits == 32u) ? 0 : (sm->osr << bits);
+        }
+        sm->osr_count = (uint8_t)((sm->osr_count + bits > 32u) ? 32u : sm->osr_count + bits);
+        switch (arg) {
+        case 0: write_pins(sm, sm->out_base, sm->out_count, data);    break;
+        case 1: sm->x = data;                                         break;
+        case 2: sm->y = data;                                         break;
+        case 4: write_pindirs(sm, sm->out_base, sm->out_count, data); break;
+        case 5: sm->pc = (uint8_t)(data & 0x1Fu); *jumped = true;     break;
+        case 6: sm->isr = data; sm->isr_count = (uint8_t)bits;        break;
+        default: break;
+        }
+        return PIO_SIM_RUNNING;
+    }
+
+    case OP_PUSH: {
+        bool is_pull = (ins >> 7) & 1u;
+        bool if_flag = (ins >> 6) & 1u;
+        bool block   = (ins >> 5) & 1u;
+        if (!is_pull) {
+            if (if_flag && sm->isr_count < sm->push_threshold) return PIO_SIM_RUNNING;
+            if (sm->rx_level == PIO_SIM_FIFO_DEPTH) {
+                return block ? PIO_SIM_BLOCKED_FIFO : PIO_SIM_RUNNING;
+            }
+            rx_push(sm, sm->isr);
+            sm->isr = 0;
+            sm->isr_count = 0;
+        } else {
+            if (if_flag && sm->osr_count < sm->pull_threshold) return PIO_SIM_RUNNING;
+            uint32_t v;
+            if (!tx_pop(sm, &v)) {
+                if (block) return PIO_SIM_BLOCKED_FIFO;
+                v = sm->x;                       // non-blocking PULL copies X
+            }
+            sm->osr = v;
+            sm->osr_count = 0;
+        }
+        return PIO_SIM_RUNNING;
+    }
+
+    case OP_MOV: {
+        unsigned mop = (ins >> 3) & 3u;
+        unsigned src = ins & 7u;
+        uint32_t data;
+        switch (src) {
+        case 0:  data = rotl32(read_pins(sm), 32u - sm->in_base); break;
+        case 1:  data = sm->x;   break;
+        case 2:  data = sm->y;   break;
+        case 6:  data = sm->isr; break;
+        case 7:  data = sm->osr; break;
+        default: data = 0;       break;
+        }
+        if (mop == 1)      data = ~data;
+        else if (mop == 2) data = bit_reverse(data);
+        switch (arg) {
+        case 0: write_pins(sm, sm->out_base, sm->out_count, data); break;
+        case 1: sm->x = data;                                      break;
+        case 2: sm->y = data;                                      break;
+        case 5: sm->pc = (uint8_t)(data & 0x1Fu); *jumped = true;  break;
+        case 6: sm->isr = data; sm->isr_count = 0;                 break;
+        case 7: sm->osr = data; sm->osr_count = 0;                 break;
+        default: break;
+        }
+        return PIO_SIM_RUNNING;
+    }
+
+    case OP_IRQ:
+        return PIO_SIM_RUNNING;                  // IRQ flags are not modelled
+
+    default: /* OP_SET */
+        switch (arg) {
+        case 0: write_pins(sm, sm->set_base, sm->set_count, idx);    break;
+        case 1: sm->x = idx;                                         break;
+        case 2: sm->y = idx;                                         break;
+        case 4: write_pindirs(sm, sm->set_base, sm->set_count, idx); break;
+        default: break;
+        }
+        return PIO_SIM_RUNNING;
+    }
+}
+
+/* ------------------------------------------------------------ */
+/*  One system clock tick                                        */
+/* ------------------------------------------------------------ */
+void pio_sim_clock(pio_sim_sm_t *sm) {
+    if (!sm->enabled || !sm->imem) return;
+    if (++sm->div_count < sm->clkdiv) return;
+    sm->div_count = 0;
+    sm->recheck   = false;
+
+    if (sm->delay) {
+        sm->delay--;
+        return;
+    }
+
+    uint16_t ins    = sm->imem[sm->pc];
+    bool     jumped = false;
+    sm->blocked = exec(sm, ins, &jumped);
+    if (sm->blocked != PIO_SIM_RUNNING) {
+        sm->stalled++;
+        return;
+    }
+    sm->executed++;
+    sm->delay = (ins >> 8) & 0x1Fu;
+
+    if (!jumped) {
+        sm->pc = (sm->pc == sm->wrap_top) ? sm->wrap_bottom
+                                          : (uint8_t)((sm->pc + 1u) & 0x1Fu);
+    }
+}
+
+/* ------------------------------------------------------------ */
+/*  Event skipping                                               */
+/* ------------------------------------------------------------ */
+// True when everything reachable from the current pc is SET or an
+// unconditional JMP: the SM never touches a FIFO or samples a pin, so its
+// only effect is the level of its own SET pins (e.g. a clock generator).
+bool pio_sim_free_running(const pio_sim_sm_t *sm) {
+    if (!sm->imem) return false;
+    uint32_t seen = 0;
+    uint8_t  pc   = sm->pc;
+    while (!(seen & (1u << pc))) {
+        seen |= 1u << pc;
+        uint16_t ins = sm->imem[pc];
+        unsigned op  = ins >> 13;
+        if (op == OP_JMP && ((ins >> 5) & 7u) == 0) {
+            pc = (uint8_t)(ins & 0x1Fu);
+        } else if (op == OP_SET) {
+            pc = (pc == sm->wrap_top) ? sm->wrap_bottom : (uint8_t)((pc + 1u) & 0x1Fu);
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Number of loop iterations ahead that are a "jmp x--/y-- to itself" with
+// no delay: each one only decrements the counter, so they can be skipped
+// like delay cycles. The iteration that finds the counter at 0 falls through.
+static uint32_t *self_loop_counter(pio_sim_sm_t *sm) {
+    uint16_t ins = sm->imem[sm->pc];
+    if ((ins >> 13) != 0 || (ins & 0x1F00u) || (ins & 0x1Fu) != sm->pc) return NULL;
+    switch ((ins >> 5) & 7u) {
+    case 2:  return &sm->x;
+    case 4:  return &sm->y;
+    default: return NULL;
+    }
+}
+
+// Number of upcoming ticks on which the SM only burns delay/divider cycles.
+// Blocked SMs report UINT32_MAX until pio_sim_recheck() says a pin or FIFO
+// changed; then they are due again at their next divider boundary.
+uint32_t pio_sim_quiet_cycles(const pio_sim_sm_t *sm) {
+    if (!sm->enabled || !sm->imem) return UINT32_MAX;
+    if (sm->blocked != PIO_SIM_RUNNING) {
+        return sm->recheck ? sm->clkdiv - sm->div_count - 1u : UINT32_MAX;
+    }
+    uint64_t idle = sm->delay;
+    uint32_t *loop = self_loop_counter((pio_sim_sm_t *)sm);
+    if (loop) idle += *loop;
+    uint64_t q = (sm->clkdiv - sm->div_count) + idle * sm->clkdiv - 1u;
+    return (q >= UINT32_MAX) ? UINT32_MAX - 1u : (uint32_t)q;
+}
+
+void pio_sim_skip(pio_sim_sm_t *sm, uint32_t ticks) {
+    if (!sm->enabled || !sm->imem) return;
+    uint64_t total = (uint64_t)sm->div_count + ticks;
+    if (sm->blocked != PIO_SIM_RUNNING) {
+        sm->div_count = (uint32_t)(total % sm->clkdiv);   // divider keeps running
+        return;
+    }
+    uint32_t execs = (uint32_t)(total / sm->clkdiv);
+    sm->div_count  = (uint32_t)(total % sm->clkdiv);
+
+    uint32_t from_delay = execs < sm->delay ? execs : sm->delay;
+    sm->delay -= from_delay;
+    execs     -= from_delay;
+    if (execs) {
+        uint32_t *loop = self_loop_counter(sm);
+        *loop         -= execs;
+        sm->executed  += execs;
+    }
+}
+
+void pio_sim_recheck(pio_sim_sm_t *sm) {
+    if (sm->blocked != PIO_SIM_RUNNING) sm->recheck = true;
+}
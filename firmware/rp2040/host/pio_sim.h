@@ -0,0 +1,80 @@
+/* pio_sim.h – cycle-level model of an RP2040 PIO state machine (host only)
+ *  ---------------------------------------------------------------
+ *  • Executes the real instruction words emitted by pioasm
+ *  • One pio_sim_clock() call = one system clock tick (clkdiv honoured)
+ *  • Side-set and EXEC destinations are not modelled
+ */
+#ifndef HOST_PIO_SIM_H_
+#define HOST_PIO_SIM_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define PIO_SIM_IMEM_SIZE   32
+#define PIO_SIM_FIFO_DEPTH  4
+
+// Why the last instruction stalled. A blocked SM cannot make progress until
+// a FIFO is serviced or a pin changes, so the scheduler may skip it.
+#define PIO_SIM_RUNNING       0
+#define PIO_SIM_BLOCKED_FIFO  1
+#define PIO_SIM_BLOCKED_WAIT  2
+
+typedef struct {
+    uint32_t (*read_pins)(void *ctx);                              // synchronised input levels
+    void     (*write_pins)(void *ctx, uint32_t mask, uint32_t values);
+    void     (*write_pindirs)(void *ctx, uint32_t mask, uint32_t dirs);
+    void      *ctx;
+} pio_sim_pins_t;
+
+typedef struct {
+    const uint16_t *imem;        // shared instruction memory of the block
+
+    // Execution state
+    uint8_t  pc;
+    uint32_t x, y, isr, osr;
+    uint8_t  isr_count;          // bits shifted into ISR
+    uint8_t  osr_count;          // bits shifted out of OSR
+    uint32_t delay;              // remaining delay cycles
+    uint32_t div_count;
+    bool     enabled;
+    uint8_t  blocked;            // PIO_SIM_BLOCKED_* reason of the last stall
+    bool     recheck;            // blocked, but its inputs changed since
+
+    // FIFOs
+    uint32_t tx[PIO_SIM_FIFO_DEPTH];
+    uint32_t rx[PIO_SIM_FIFO_DEPTH];
+    uint8_t  tx_head, tx_level;
+    uint8_t  rx_head, rx_level;
+
+    // Configuration (mirrors pio_sm_config)
+    uint8_t  wrap_bottom, wrap_top;
+    uint8_t  in_base, out_base, out_count, set_base, set_count, jmp_pin;
+    bool     in_shift_right, out_shift_right;
+    bool     autopush, autopull;
+    uint8_t  push_threshold, pull_threshold;   // 32 when 0 is programmed
+    uint32_t clkdiv;                           // integer divider, >= 1
+
+    // Statistics
+    uint64_t executed;
+    uint64_t stalled;
+
+    pio_sim_pins_t pins;
+} pio_sim_sm_t;
+
+void pio_sim_load(uint16_t *imem, const uint16_t *prog, uint8_t len, uint8_t offset);
+void pio_sim_sm_reset(pio_sim_sm_t *sm, const uint16_t *imem);
+void pio_sim_jump(pio_sim_sm_t *sm, uint8_t pc);
+void pio_sim_clock(pio_sim_sm_t *sm);
+
+// Event skipping: ticks that cannot change any state, and jumping over them
+uint32_t pio_sim_quiet_cycles(const pio_sim_sm_t *sm);
+void     pio_sim_skip(pio_sim_sm_t *sm, uint32_t ticks);
+bool     pio_sim_free_running(const pio_sim_sm_t *sm);
+void     pio_sim_recheck(pio_sim_sm_t *sm);       // pins/FIFOs changed
+
+bool     pio_sim_tx_full(const pio_sim_sm_t *sm);
+bool     pio_sim_rx_empty(const pio_sim_sm_t *sm);
+void     pio_sim_tx_put(pio_sim_sm_t *sm, uint32_t v);
+uint32_t pio_sim_rx_get(pio_sim_sm_t *sm);
+
+#endif /* HOST_PIO_SIM_H_ */
@@ -0,0 +1,231 @@
+/* reproflash_model.c – NOR flash of a repro cart in the ROM window (host builds)
+ *  ---------------------------------------------------------------
+ *  • Replaces the mask ROM at 0x1000'0000 when loaded; a second chip
+ *    sits one chip size further in, each with its own command state
+ *  • AMD x16 commands: AA/55 unlock at 0x555/0x2AA (word addresses),
+ *    then 90 autoselect, A0 word program, 25 .. 29 write buffer, 80 +
+ *    unlock + 30 sector / 10 chip erase; F0 back to read mode
+ *  • While an operation runs every read of that chip returns status:
+ *    DQ7 is the complement of the last word programmed, 0 during an
+ *    erase. Programming can only clear bits, like the real array.
+ *  • Intel parts and the doubled command set of two x8 chips are not
+ *    modelled
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include <bus/ad_bus.h>
+
+#include "sim.h"
+
+#define MB                 (1024u * 1024u)
+#define MAX_CHIPS          2u
+#define MAX_BUFFER_WORDS   64u
+#define US(x)              ((uint64_t)(x) * SIM_CYCLES_PER_US)
+#define WORD_TIME          US(11)           // typical datasheet figures
+#define BUFFER_TIME        US(240)
+#define SECTOR_ERASE_TIME  US(500000)
+
+enum { MODE_READ, MODE_AUTOSELECT, MODE_WORD, MODE_BUF_COUNT, MODE_BUF_DATA, MODE_BUF_CONFIRM };
+enum { BOOT_NONE, BOOT_BOTTOM, BOOT_TOP };
+
+static const struct {
+    const char *name;
+    uint16_t    vendor, flash_id, cart_id;
+    uint32_t    chip_mb;
+    unsigned    chips;
+    unsigned    buffer_words;                // 0 = word program only
+    uint32_t    sector_bytes;
+    int         boot;
+    unsigned    boot_count;
+    uint32_t    boot_bytes;
+} types[] = {
+    { "s29gl256",    0x0001, 0x227E, 0x2201, 32, 1, 16, 0x20000u, BOOT_NONE, 0, 0 },
+    { "s29gl256x2",  0x0001, 0x227E, 0x2201, 32, 2, 16, 0x20000u, BOOT_NONE, 0, 0 },
+    { "s29gl128",    0x0001, 0x227E, 0x2101, 16, 1, 16, 0x20000u, BOOT_NONE, 0, 0 },
+    { "m29w128",     0x0020, 0x227E, 0x2100, 16, 1, 32, 0x20000u, BOOT_NONE, 0, 0 },
+    { "mx29lv640",   0x00C2, 0x22C9, 0,       8, 1,  0, 0x10000u, BOOT_TOP,  8, 0x2000u },
+    { "mx29lv640x2", 0x00C2, 0x22C9, 0,       8, 2,  0, 0x10000u, BOOT_TOP,  8, 0x2000u },
+};
+
+typedef struct {
+    int      mode;
+    unsigned unlock;                         // AA/55 cycles seen
+    bool     erase_armed;                    // 80 seen, waiting for 30/10
+    uint32_t buf_sa;                         // byte offset the 25 went to
+    unsigned buf_left;
+    unsigned buf_n;
+    uint32_t buf_off[MAX_BUFFER_WORDS];
+    uint16_t buf_val[MAX_BUFFER_WORDS];
+    uint64_t busy_until;
+    uint16_t status;                         // read while busy
+} chip_t;
+
+static uint8_t  *data;
+static uint32_t  size;
+static uint32_t  chip_bytes;
+static unsigned  type;
+static chip_t    chips[MAX_CHIPS];
+
+/* ------------------------------------------------------------ */
+/*  Images                                                       */
+/* ------------------------------------------------------------ */
+bool reproflash_model_load(const char *type_name, const uint8_t *image, size_t len) {
+    type = 0;
+    while (type < sizeof(types) / sizeof(types[0]) && strcmp(types[type].name, type_name)) type++;
+    if (type == sizeof(types) / sizeof(types[0])) {
+        fprintf(stderr, "unknown repro flash '%s' (s29gl256, s29gl256x2, s29gl128, m29w128, "
+                "mx29lv640, mx29lv640x2)\n", type_name);
+        return false;
+    }
+    chip_bytes = types[type].chip_mb * MB;
+    size       = chip_bytes * types[type].chips;
+    free(data);
+    data = malloc(size);
+    if (!data) return false;
+    memset(data, 0xFF, size);
+    if (image) memcpy(data, image, len < size ? len : size);
+    memset(chips, 0, sizeof(chips));
+    return true;
+}
+
+bool reproflash_model_present(void)        { return data != NULL; }
+const uint8_t *reproflash_model_data(void) { return data; }
+size_t reproflash_model_size(void)         { return size; }
+
+bool reproflash_model_claims(uint32_t addr) {
+    return data && addr >= N64_ROM_BASE && addr - N64_ROM_BASE < size;
+}
+
+/* ------------------------------------------------------------ */
+/*  Array                                                        */
+/* ------------------------------------------------------------ */
+static void sector_of(uint32_t rel, uint32_t *start, uint32_t *len) {
+    uint32_t span = types[type].boot_count * types[type].boot_bytes;
+    bool boot = (types[type].boot == BOOT_BOTTOM && rel < span) ||
+                (types[type].boot == BOOT_TOP && rel >= chip_bytes - span);
+    *len   = boot ? types[type].boot_bytes : types[type].sector_bytes;
+    *start = rel / *len * *len;
+}
+
+static void program(uint32_t off, uint16_t v) {
+    data[off]     &= (uint8_t)(v >> 8);
+    data[off + 1] &= (uint8_t)v;
+}
+
+static void start_busy(chip_t *c, uint64_t t, uint16_t status) {
+    c->busy_until = sim_now() + t;
+    c->status     = status;
+    c->mode       = MODE_READ;
+}
+
+/* ------------------------------------------------------------ */
+/*  Bus                                                          */
+/* ------------------------------------------------------------ */
+uint16_t reproflash_model_peek(uint32_t addr) {
+    uint32_t off = (addr - N64_ROM_BASE) & ~1u;
+    chip_t  *c   = &chips[off / chip_bytes];
+    uint32_t rel = off % chip_bytes;
+
+    if (sim_now() < c->busy_until) return c->status;
+    if (c->mode == MODE_AUTOSELECT) {
+        switch (rel >> 1 & 0xFFu) {
+        case 0x00: return types[type].vendor;
+        case 0x01: return types[type].flash_id;
+        case 0x0E: return types[type].cart_id >> 8;
+        case 0x0F: return types[type].cart_id & 0xFFu;
+        default:   return 0;
+        }
+    }
+    return (uint16_t)(data[off] << 8 | data[off + 1]);
+}
+
+void reproflash_model_write(uint32_t addr, uint16_t v) {
+    uint32_t off  = (addr - N64_ROM_BASE) & ~1u;
+    chip_t  *c    = &chips[off / chip_bytes];
+    uint32_t base = off - off % chip_bytes;
+    uint32_t rel  = off - base;
+    uint32_t word = rel >> 1 & 0x7FFu;
+    uint8_t  cmd  = (uint8_t)v;
+
+    if (sim_now() < c->busy_until) return;   // no suspend support
+
+    switch (c->mode) {
+    case MODE_WORD:
+        program(off, v);
+        start_busy(c, WORD_TIME, (uint16_t)(~v & 0x80u));
+        return;
+    case MODE_BUF_COUNT:
+        c->buf_left = v + 1u;
+        c->buf_n    = 0;
+        c->mode     = (v < types[type].buffer_words) ? MODE_BUF_DATA : MODE_READ;
+        return;
+    case MODE_BUF_DATA: {
+        uint32_t page = types[type].buffer_words * 2u;
+        if (off / page != c->buf_sa / page) {   // outside the buffer: abort
+            c->mode = MODE_READ;
+            return;
+        }
+        c->buf_off[c->buf_n]   = off;
+        c->buf_val[c->buf_n++] = v;
+        if (--c->buf_left == 0) c->mode = MODE_BUF_CONFIRM;
+        return;
+    }
+    case MODE_BUF_CONFIRM:
+        if (cmd == 0x29) {
+            for (unsigned i = 0; i < c->buf_n; ++i) program(c->buf_off[i], c->buf_val[i]);
+            start_busy(c, BUFFER_TIME, (uint16_t)(~c->buf_val[c->buf_n - 1u] & 0x80u));
+        } else {
+            c->mode = MODE_READ;
+        }
+        return;
+    default:
+        break;
+    }
+
+    if (cmd == 0xF0) {
+        c->mode        = MODE_READ;
+        c->unlock      = 0;
+        c->erase_armed = false;
+        return;
+    }
+    if (c->unlock == 0) {
+        c->unlock = (cmd == 0xAA && word == 0x555) ? 1u : 0u;
+        return;
+    }
+    if (c->unlock == 1) {
+        c->unlock = (cmd == 0x55 && word == 0x2AA) ? 2u : 0u;
+        return;
+    }
+
+    c->unlock = 0;
+    if (c->erase_armed) {
+        c->erase_armed = false;
+        if (cmd == 0x30) {
+            uint32_t start, len;
+            sector_of(rel, &start, &len);
+            memset(&data[base + start], 0xFF, len);
+            start_busy(c, SECTOR_ERASE_TIME, 0);
+        } else if (cmd == 0x10 && word == 0x555) {
+            memset(&data[base], 0xFF, chip_bytes);
+            start_busy(c, SECTOR_ERASE_TIME * (chip_bytes / types[type].sector_bytes) / 4u, 0);
+        }
+        return;
+    }
+    switch (cmd) {
+    case 0x90: if (word == 0x555) c->mode = MODE_AUTOSELECT; break;
+    case 0xA0: if (word == 0x555) c->mode = MODE_WORD;       break;
+    case 0x80: if (word == 0x555) c->erase_armed = true;     break;
+    case 0x25:
+        if (types[type].buffer_words) {
+            c->buf_sa = off;
+            c->mode   = MODE_BUF_COUNT;
+        }
+        break;
+    default:
+        break;
+    }
+}
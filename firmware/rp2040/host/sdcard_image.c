@@ -0,0 +1,192 @@
+/* sdcard_image.c – SD card backed by a disk image file (host builds)
+ *  ---------------------------------------------------------------
+ *  • Implements storage/sdcard.h on a FILE*; the image can be mounted
+ *    or checked on the PC afterwards (mtools, fsck.fat, a loop device)
+ *  • sd_image_open() with a size formats a fresh card the way SD cards
+ *    ship: MBR, one FAT32 partition at 1 MiB
+ *  • Each call charges the SPI time of its bytes at SD_FAST_HZ, plus a
+ *    fixed programming busy per write command; the card's own erase
+ *    and wear levelling are not modelled
+ *  • Multi-block writes must stay inside the announced block count,
+ *    like CMD25 after ACMD23
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include <storage/sdcard.h>
+
+#include "sim.h"
+
+#define PART_LBA          2048u
+#define RESERVED_BLOCKS   32u
+#define NUM_FATS          2u
+#define CMD_BYTES         8u               // command, R1 and the gaps around it
+#define BLOCK_OVERHEAD    5u               // token, CRC16, data response, busy poll
+#define WRITE_BUSY_US     250u             // after the stop token
+
+static FILE    *img;
+static uint32_t img_blocks;
+static uint32_t w_lba, w_left;
+static bool     w_open;
+
+static void charge(uint32_t bytes) {
+    sim_advance((uint64_t)bytes * 8u * SIM_SYS_HZ / SD_FAST_HZ);
+}
+
+static void put16(uint8_t *p, uint16_t v) { p[0] = (uint8_t)v; p[1] = (uint8_t)(v >> 8); }
+static void put32(uint8_t *p, uint32_t v) { put16(p, (uint16_t)v); put16(p + 2, (uint16_t)(v >> 16)); }
+
+static bool write_at(uint32_t lba, const void *src, uint32_t n) {
+    return fseek(img, (long)lba * SD_BLOCK_BYTES, SEEK_SET) == 0 &&
+           fwrite(src, SD_BLOCK_BYTES, n, img) == n;
+}
+
+/* ------------------------------------------------------------ */
+/*  Image                                                        */
+/* ------------------------------------------------------------ */
+// Fresh card: MBR with one type 0x0C partition, FAT32 with the root
+// directory in cluster 2
+static bool format(uint32_t blocks) {
+    uint8_t  b[SD_BLOCK_BYTES];
+    uint32_t part = blocks - PART_LBA;
+    uint32_t spc  = part < 532480u ? 1u : (part < 33554432u ? 8u : 64u);
+    uint32_t fat  = (part - RESERVED_BLOCKS + (256u * spc + NUM_FATS) / 2u - 1u) /
+                    ((256u * spc + NUM_FATS) / 2u);
+    uint32_t clusters = (part - RESERVED_BLOCKS - NUM_FATS * fat) / spc;
+    if (clusters < 65525u) {
+        fprintf(stderr, "sd image: %u blocks is too small for FAT32\n", blocks);
+        return false;
+    }
+
+    memset(b, 0, sizeof(b));
+    uint8_t *pe = &b[446];
+    pe[4] = 0x0C;                                   // FAT32, LBA
+    put32(&pe[8], PART_LBA);
+    put32(&pe[12], part);
+    put16(&b[510], 0xAA55u);
+    if (!write_at(0, b, 1)) return false;
+
+    memset(b, 0, sizeof(b));
+    memcpy(b, "\xEB\x58\x90" "N64DUMP ", 11);
+    put16(&b[11], SD_BLOCK_BYTES);
+    b[13] = (uint8_t)spc;
+    put16(&b[14], RESERVED_BLOCKS);
+    b[16] = NUM_FATS;
+    b[21] = 0xF8;                                   // fixed disk
+    put16(&b[24], 63);
+    put16(&b[26], 255);
+    put32(&b[28], PART_LBA);
+    put32(&b[32], part);
+    put32(&b[36], fat);
+    put32(&b[44], 2);                               // root cluster
+    put16(&b[48], 1);                               // FSInfo
+    put16(&b[50], 6);                               // backup boot sector
+    b[64] = 0x80;
+    b[66] = 0x29;
+    put32(&b[67], 0x6E363464u);
+    memcpy(&b[71], "N64 DUMPS  FAT32   ", 19);
+    put16(&b[510], 0xAA55u);
+    if (!write_at(PART_LBA, b, 1) || !write_at(PART_LBA + 6u, b, 1)) return false;
+
+    memset(b, 0, sizeof(b));
+    put32(&b[0], 0x41615252u);
+    put32(&b[484], 0x61417272u);
+    put32(&b[488], clusters - 1u);                  // all but the root
+    put32(&b[492], 3);
+    put32(&b[508], 0xAA550000u);
+    if (!write_at(PART_LBA + 1u, b, 1) || !write_at(PART_LBA + 7u, b, 1)) return false;
+
+    memset(b, 0, sizeof(b));
+    put32(&b[0], 0x0FFFFFF8u);                      // media byte
+    put32(&b[4], 0x0FFFFFFFu);
+    put32(&b[8], 0x0FFFFFFFu);                      // root directory, one cluster
+    for (uint32_t i = 0; i < NUM_FATS; ++i) {
+        if (!write_at(PART_LBA + RESERVED_BLOCKS + i * fat, b, 1)) return false;
+    }
+    return true;
+}
+
+bool sd_image_open(const char *path, uint32_t create_mb) {
+    if (img) fclose(img);
+    img = fopen(path, create_mb ? "w+b" : "r+b");
+    if (!img) {
+        perror(path);
+        return false;
+    }
+    if (create_mb) {
+        img_blocks = create_mb * (1024u * 1024u / SD_BLOCK_BYTES);
+        // Size the file first: the unwritten blocks read back as zeros
+        if (fseek(img, (long)img_blocks * SD_BLOCK_BYTES - 1, SEEK_SET) != 0 ||
+            fputc(0, img) == EOF || !format(img_blocks)) {
+            fprintf(stderr, "%s: cannot format\n", path);
+            return false;
+        }
+        fflush(img);
+    } else {
+        fseek(img, 0, SEEK_END);
+        img_blocks = (uint32_t)(ftell(img) / SD_BLOCK_BYTES);
+    }
+    return true;
+}
+
+void sd_image_close(void) {
+    if (img) fclose(img);
+    img = NULL;
+}
+
+/* ------------------------------------------------------------ */
+/*  storage/sdcard.h                                             */
+/* ------------------------------------------------------------ */
+bool sd_init(sd_info_t *out) {
+    w_open = false;
+    if (!img) return false;
+    sim_advance((uint64_t)SIM_CYCLES_PER_US * 2000u);   // identification at 400 kHz
+    if (out) {
+        out->blocks        = img_blocks;
+        out->high_capacity = true;
+    }
+    return true;
+}
+
+bool sd_read_blocks(uint32_t lba, void *dst, uint32_t n) {
+    if (!img || w_open || lba + n > img_blocks) return false;
+    charge(2u * CMD_BYTES + n * (SD_BLOCK_BYTES + BLOCK_OVERHEAD));
+    return fseek(img, (long)lba * SD_BLOCK_BYTES, SEEK_SET) == 0 &&
+           fread(dst, SD_BLOCK_BYTES, n, img) == n;
+}
+
+bool sd_write_begin(uint32_t lba, uint32_t n) {
+    if (!img || w_open || lba + n > img_blocks) return false;
+    charge(3u * CMD_BYTES);                         // CMD55, ACMD23, CMD25
+    w_lba  = lba;
+    w_left = n;
+    w_open = true;
+    return true;
+}
+
+bool sd_write_next(const void *src, uint32_t n) {
+    if (!w_open || n > w_left) return false;
+    charge(n * (SD_BLOCK_BYTES + BLOCK_OVERHEAD));
+    if (!write_at(w_lba, src, n)) return false;
+    w_lba  += n;
+    w_left -= n;
+    return true;
+}
+
+bool sd_write_end(void) {
+    bool ok = w_open && w_left == 0;
+    w_open = false;
+    charge(2u);
+    sim_advance((uint64_t)SIM_CYCLES_PER_US * WRITE_BUSY_US);
+    fflush(img);
+    return ok;
+}
+
+bool sd_write_blocks(uint32_t lba, const void *src, uint32_t n) {
+    if (!sd_write_begin(lba, n)) return false;
+    bool ok = sd_write_next(src, n);
+    return sd_write_end() && ok;
+}
@@ -0,0 +1,72 @@
+/* sdk_flash.c – program flash for host builds
+ *  ---------------------------------------------------------------
+ *  • hardware/flash.h on a 2 MiB array that starts erased (all 0xFF)
+ *  • sim_flash_open() loads a file and writes every change back to
+ *    it, so what the firmware stores survives to the next run
+ *  • Erase and program charge the W25Q16's typical busy times, with
+ *    both cores stopped, as on the board
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "hardware/flash.h"
+
+#include "sim.h"
+
+#define SECTOR_ERASE_US   45000u
+#define PAGE_PROGRAM_US   400u
+
+uint8_t sim_flash[PICO_FLASH_SIZE_BYTES];
+static FILE *backing;
+
+__attribute__((constructor))
+static void flash_power_on(void) {
+    memset(sim_flash, 0xFF, sizeof(sim_flash));
+}
+
+static void write_back(uint32_t off, size_t count) {
+    if (!backing) return;
+    if (fseek(backing, (long)off, SEEK_SET) != 0 ||
+        fwrite(&sim_flash[off], 1, count, backing) != count || fflush(backing) != 0) {
+        perror("flash image");
+    }
+}
+
+bool sim_flash_open(const char *path) {
+    backing = fopen(path, "r+b");
+    if (backing) {
+        size_t n = fread(sim_flash, 1, sizeof(sim_flash), backing);
+        (void)n;                                // a short file is erased beyond its end
+    } else {
+        backing = fopen(path, "w+b");
+        if (!backing) {
+            perror(path);
+            return false;
+        }
+    }
+    write_back(0, sizeof(sim_flash));
+    return true;
+}
+
+void flash_range_erase(uint32_t flash_offs, size_t count) {
+    if (flash_offs % FLASH_SECTOR_SIZE || count % FLASH_SECTOR_SIZE ||
+        flash_offs + count > sizeof(sim_flash)) {
+        sim_hang("flash_range_erase: unaligned or out of range");
+    }
+    memset(&sim_flash[flash_offs], 0xFF, count);
+    sim_wait((uint64_t)SECTOR_ERASE_US * SIM_CYCLES_PER_US * (count / FLASH_SECTOR_SIZE));
+    write_back(flash_offs, count);
+}
+
+void flash_range_program(uint32_t flash_offs, const uint8_t *data, size_t count) {
+    if (flash_offs % FLASH_PAGE_SIZE || count % FLASH_PAGE_SIZE ||
+        flash_offs + count > sizeof(sim_flash)) {
+        sim_hang("flash_range_program: unaligned or out of range");
+    }
+    for (size_t i = 0; i < count; ++i) sim_flash[flash_offs + i] &= data[i];
+    sim_wait((uint64_t)PAGE_PROGRAM_US * SIM_CYCLES_PER_US * (count / FLASH_PAGE_SIZE));
+    write_back(flash_offs, count);
+}
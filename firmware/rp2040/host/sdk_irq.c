@@ -0,0 +1,135 @@
+/* sdk_irq.c – hardware/irq.h, pico/time.h alarm and critical section
+ *  stand-ins for host builds
+ *  ---------------------------------------------------------------
+ *  • sim_irq_dispatch() runs after every simulated tick: asserted DMA
+ *    lines call their handler, due alarms call their callback
+ *  • Handlers never nest and are held off while a critical section is
+ *    open; whatever they do to the clock stays inside the handler
+ */
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "pico/stdlib.h"
+#include "pico/critical_section.h"
+#include "hardware/irq.h"
+
+#include "sim.h"
+
+#define MAX_ALARMS 16u
+#define NUM_IRQS   32u
+
+typedef struct {
+    alarm_id_t       id;                 // 0 = slot free
+    uint64_t         at;                 // cycle it fires on
+    alarm_callback_t cb;
+    void            *user;
+} alarm_t;
+
+static irq_handler_t handlers[NUM_IRQS];
+static uint32_t      enabled;
+static int           masked;             // open critical sections
+static bool          in_irq;
+static alarm_t       alarms[MAX_ALARMS];
+static alarm_id_t    last_id;
+
+/* ------------------------------------------------------------ */
+/*  hardware/irq.h                                               */
+/* ------------------------------------------------------------ */
+void irq_set_exclusive_handler(uint num, irq_handler_t handler) {
+    if (num < NUM_IRQS) handlers[num] = handler;
+}
+
+void irq_set_enabled(uint num, bool en) {
+    if (num >= NUM_IRQS) return;
+    enabled = en ? (enabled | (1u << num)) : (enabled & ~(1u << num));
+    sim_kick();
+}
+
+/* ------------------------------------------------------------ */
+/*  pico/time.h alarms                                           */
+/* ------------------------------------------------------------ */
+alarm_id_t add_alarm_in_us(uint64_t us, alarm_callback_t callback, void *user_data, bool fire_if_past) {
+    (void)fire_if_past;
+    for (unsigned i = 0; i < MAX_ALARMS; ++i) {
+        if (alarms[i].id) continue;
+        if (++last_id <= 0) last_id = 1;
+        alarms[i] = (alarm_t){ last_id, sim_now() + us * SIM_CYCLES_PER_US, callback, user_data };
+        sim_kick();
+        return last_id;
+    }
+    sim_hang("add_alarm_in_us (no free alarm)");
+    return -1;
+}
+
+bool cancel_alarm(alarm_id_t alarm_id) {
+    if (alarm_id <= 0) return false;
+    for (unsigned i = 0; i < MAX_ALARMS; ++i) {
+        if (alarms[i].id == alarm_id) {
+            alarms[i].id = 0;
+            return true;
+        }
+    }
+    return false;
+}
+
+uint64_t sim_irq_next_event(void) {
+    uint64_t next = SIM_NEVER;
+    for (unsigned i = 0; i < MAX_ALARMS; ++i) {
+        if (alarms[i].id && alarms[i].at < next) next = alarms[i].at;
+    }
+    return next;
+}
+
+/* ------------------------------------------------------------ */
+/*  Dispatch                                                     */
+/* ------------------------------------------------------------ */
+static void run_alarms(void) {
+    uint64_t now = sim_now();
+    for (unsigned i = 0; i < MAX_ALARMS; ++i) {
+        alarm_t a = alarms[i];
+        if (!a.id || a.at > now) continue;
+        alarms[i].id = 0;
+        int64_t again = a.cb(a.id, a.user);
+        if (again == 0) continue;
+
+        // The callback may have taken this slot for an alarm of its own
+        unsigned s = i;
+        if (alarms[s].id) {
+            for (s = 0; s < MAX_ALARMS && alarms[s].id; ++s) {}
+        }
+        if (s == MAX_ALARMS) sim_hang("alarm repeat (no free alarm)");
+        alarms[s] = a;
+        alarms[s].at = (again < 0) ? a.at + (uint64_t)(-again) * SIM_CYCLES_PER_US
+                                   : sim_now() + (uint64_t)again * SIM_CYCLES_PER_US;
+    }
+}
+
+void sim_irq_dispatch(void) {
+    if (in_irq || masked) return;
+    in_irq = true;
+    for (unsigned line = 0; line < 2; ++line) {
+        uint num = line ? DMA_IRQ_1 : DMA_IRQ_0;
+        if ((enabled & (1u << num)) && handlers[num] && sim_dma_irq_pending(line)) handlers[num]();
+    }
+    run_alarms();
+    in_irq = false;
+}
+
+/* ------------------------------------------------------------ */
+/*  pico/critical_section.h                                      */
+/* ------------------------------------------------------------ */
+void critical_section_init(critical_section_t *crit_sec) {
+    crit_sec->depth = 0;
+}
+
+void critical_section_enter_blocking(critical_section_t *crit_sec) {
+    crit_sec->depth++;
+    masked++;
+}
+
+void critical_section_exit(critical_section_t *crit_sec) {
+    crit_sec->depth--;
+    masked--;
+    sim_kick();
+}
@@ -0,0 +1,114 @@
+/* sdk_multicore.c – pico/multicore.h stand-ins for host builds
+ *  ---------------------------------------------------------------
+ *  • Core 1 is a ucontext coroutine on the host thread. The cores
+ *    switch whenever the running one spins (tight_loop_contents, a
+ *    blocking FIFO call, an empty getchar poll).
+ *  • Both cores share the one simulated clock, so the simulation shows
+ *    the order of events but not the overlap the second core buys
+ */
+#define _XOPEN_SOURCE 700
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <ucontext.h>
+
+#include "pico/platform.h"
+#include "pico/multicore.h"
+
+#include "sim.h"
+
+#define CORE1_STACK_BYTES  (256u * 1024u)
+#define FIFO_DEPTH         8u               // per direction, like the SIO FIFOs
+
+typedef struct {
+    uint32_t data[FIFO_DEPTH];
+    unsigned head, level;
+} fifo_t;
+
+static ucontext_t  core_ctx[2];
+static unsigned    current;                 // core executing right now
+static bool        core1_running;
+static void      (*core1_entry)(void);
+static fifo_t      fifo_to[2];              // fifo_to[n] is read by core n
+
+/* ------------------------------------------------------------ */
+/*  Core switching                                               */
+/* ------------------------------------------------------------ */
+static void core1_trampoline(void) {
+    core1_entry();
+    core1_running = false;                  // returned: never scheduled again
+    current = 0;
+    setcontext(&core_ctx[0]);
+}
+
+void sim_core_yield(void) {
+    if (!core1_running) return;
+    unsigned from = current;
+    current = from ^ 1u;
+    swapcontext(&core_ctx[from], &core_ctx[current]);
+}
+
+void tight_loop_contents(void) {
+    sim_wait(SIM_CYCLES_NOP_ITER);
+    sim_core_yield();
+}
+
+void multicore_launch_core1(void (*entry)(void)) {
+    static uint8_t *stack;
+    if (!stack) stack = malloc(CORE1_STACK_BYTES);
+    if (!stack) sim_hang("multicore_launch_core1");
+
+    getcontext(&core_ctx[1]);
+    core_ctx[1].uc_stack.ss_sp   = stack;
+    core_ctx[1].uc_stack.ss_size = CORE1_STACK_BYTES;
+    core_ctx[1].uc_link          = NULL;
+    makecontext(&core_ctx[1], core1_trampoline, 0);
+    core1_entry   = entry;
+    core1_running = true;
+    sim_sdk_call(16u);
+}
+
+uint32_t get_core_num(void) { return current; }
+
+/* ------------------------------------------------------------ */
+/*  Inter-core FIFOs                                             */
+/* ------------------------------------------------------------ */
+bool multicore_fifo_rvalid(void) {
+    sim_stats.sio_accesses++;
+    sim_advance(SIM_CYCLES_SIO_ACCESS);
+    return fifo_to[current].level != 0;
+}
+
+bool multicore_fifo_wready(void) {
+    sim_stats.sio_accesses++;
+    sim_advance(SIM_CYCLES_SIO_ACCESS);
+    return fifo_to[current ^ 1u].level < FIFO_DEPTH;
+}
+
+void multicore_fifo_push_blocking(uint32_t data) {
+    fifo_t  *f = &fifo_to[current ^ 1u];
+    uint64_t start = sim_now();
+    while (f->level == FIFO_DEPTH) {
+        if (sim_now() - start > SIM_HANG_CYCLES) sim_hang("multicore_fifo_push_blocking");
+        tight_loop_contents();
+    }
+    f->data[(f->head + f->level++) % FIFO_DEPTH] = data;
+    sim_stats.sio_accesses++;
+    sim_advance(SIM_CYCLES_SIO_ACCESS);
+}
+
+uint32_t multicore_fifo_pop_blocking(void) {
+    fifo_t  *f = &fifo_to[current];
+    uint64_t start = sim_now();
+    while (f->level == 0) {
+        if (sim_now() - start > SIM_HANG_CYCLES) sim_hang("multicore_fifo_pop_blocking");
+        tight_loop_contents();
+    }
+    uint32_t v = f->data[f->head];
+    f->head = (f->head + 1u) % FIFO_DEPTH;
+    f->level--;
+    sim_stats.sio_accesses++;
+    sim_advance(SIM_CYCLES_SIO_ACCESS);
+    return v;
+}
@@ -0,0 +1,569 @@
+/* sdk_pio.c – hardware/pio.h + hardware/dma.h stand-ins for host builds
+ *  ---------------------------------------------------------------
+ *  • Every state machine is a pio_sim_sm_t running the real program
+ *  • DMA channels pointed at a PIO FIFO window move one word per tick
+ *    as the SM produces/consumes it; memory-to-memory copies are instant
+ */
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "hardware/pio.h"
+#include "hardware/dma.h"
+
+#include "pio_sim.h"
+#include "sim.h"
+
+pio_hw_t host_pio_hw[NUM_PIOS];
+
+typedef struct {
+    uint16_t     imem[PIO_SIM_IMEM_SIZE];
+    uint32_t     used;                          // instruction slots taken
+    uint8_t      claimed;                       // SM claim bitmap
+    uint8_t      parked;                        // SMs not clocked, see park()
+    pio_sim_sm_t sm[NUM_PIO_STATE_MACHINES];
+} pio_block_t;
+
+static pio_block_t blocks[NUM_PIOS];
+
+/* ------------------------------------------------------------ */
+/*  Pin plumbing                                                 */
+/* ------------------------------------------------------------ */
+static uint32_t pins_read(void *ctx) {
+    (void)ctx;
+    return sim_gpio_levels();
+}
+
+static void pins_write(void *ctx, uint32_t mask, uint32_t values) {
+    sim_pio_write_pins((unsigned)(uintptr_t)ctx, mask, values);
+}
+
+static void pindirs_write(void *ctx, uint32_t mask, uint32_t dirs) {
+    sim_pio_write_pindirs((unsigned)(uintptr_t)ctx, mask, dirs);
+}
+
+static pio_sim_sm_t *sm_of(PIO pio, uint sm) {
+    return &blocks[pio_get_index(pio)].sm[sm & 3u];
+}
+
+/* ------------------------------------------------------------ */
+/*  Scheduling hooks for sim_advance()                           */
+/* ------------------------------------------------------------ */
+// A free-running SM whose SET pins no model looks at (the EEPROM clock
+// generator) cannot influence anything; leaving it unclocked keeps it from
+// turning every 60-cycle stretch of simulated time into three events.
+static void park(PIO pio, uint sm) {
+    pio_block_t  *b = &blocks[pio_get_index(pio)];
+    pio_sim_sm_t *s = &b->sm[sm & 3u];
+    uint32_t pins = ((s->set_count >= 32) ? 0xFFFFFFFFu : ((1u << s->set_count) - 1u)) << s->set_base;
+    bool idle = s->enabled && pio_sim_free_running(s) && !(pins & sim_gpio_observed());
+    b->parked = idle ? (uint8_t)(b->parked | (1u << sm)) : (uint8_t)(b->parked & ~(1u << sm));
+}
+
+uint64_t sim_pio_quiet(void) {
+    uint64_t q = SIM_NEVER;
+    for (unsigned b = 0; b < NUM_PIOS; ++b) {
+        for (unsigned i = 0; i < NUM_PIO_STATE_MACHINES; ++i) {
+            if (blocks[b].parked & (1u << i)) continue;
+            uint32_t s = pio_sim_quiet_cycles(&blocks[b].sm[i]);
+            if (s != UINT32_MAX && s < q) q = s;
+        }
+    }
+    return q;
+}
+
+void sim_pio_skip(uint64_t ticks) {
+    for (unsigned b = 0; b < NUM_PIOS; ++b) {
+        for (unsigned i = 0; i < NUM_PIO_STATE_MACHINES; ++i) {
+            if (blocks[b].parked & (1u << i)) continue;
+            pio_sim_skip(&blocks[b].sm[i], (uint32_t)ticks);
+        }
+    }
+}
+
+void sim_pio_recheck(void) {
+    for (unsigned b = 0; b < NUM_PIOS; ++b) {
+        for (unsigned i = 0; i < NUM_PIO_STATE_MACHINES; ++i) {
+            pio_sim_recheck(&blocks[b].sm[i]);
+        }
+    }
+}
+
+void sim_pio_tick(void) {
+    for (unsigned b = 0; b < NUM_PIOS; ++b) {
+        for (unsigned i = 0; i < NUM_PIO_STATE_MACHINES; ++i) {
+            if (blocks[b].parked & (1u << i)) continue;
+            pio_sim_clock(&blocks[b].sm[i]);
+        }
+    }
+}
+
+/* ------------------------------------------------------------ */
+/*  sm_config_*                                                  */
+/* ------------------------------------------------------------ */
+pio_sm_config pio_get_default_sm_config(void) {
+    pio_sm_config c;
+    memset(&c, 0, sizeof(c));
+    c.clkdiv          = 1;
+    c.wrap            = PIO_SIM_IMEM_SIZE - 1;
+    c.in_shift_right  = true;
+    c.out_shift_right = true;
+    c.push_threshold  = 32;
+    c.pull_threshold  = 32;
+    return c;
+}
+
+void sm_config_set_wrap(pio_sm_config *c, uint wrap_target, uint wrap) {
+    c->wrap_target = (uint8_t)wrap_target;
+    c->wrap        = (uint8_t)wrap;
+}
+
+void sm_config_set_in_pins(pio_sm_config *c, uint in_base) { c->in_base = (uint8_t)in_base; }
+
+void sm_config_set_out_pins(pio_sm_config *c, uint out_base, uint out_count) {
+    c->out_base  = (uint8_t)out_base;
+    c->out_count = (uint8_t)out_count;
+}
+
+void sm_config_set_set_pins(pio_sm_config *c, uint set_base, uint set_count) {
+    c->set_base  = (uint8_t)set_base;
+    c->set_count = (uint8_t)set_count;
+}
+
+void sm_config_set_jmp_pin(pio_sm_config *c, uint pin) { c->jmp_pin = (uint8_t)pin; }
+
+void sm_config_set_clkdiv(pio_sm_config *c, float div) {
+    c->clkdiv = div < 1.0f ? 1u : (uint32_t)(div + 0.5f);
+}
+
+void sm_config_set_in_shift(pio_sm_config *c, bool shift_right, bool autopush, uint push_threshold) {
+    c->in_shift_right = shift_right;
+    c->autopush       = autopush;
+    c->push_threshold = (uint8_t)(push_threshold ? push_threshold : 32u);
+}
+
+void sm_config_set_out_shift(pio_sm_config *c, bool shift_right, bool autopull, uint pull_threshold) {
+    c->out_shift_right = shift_right;
+    c->autopull        = autopull;
+    c->pull_threshold  = (uint8_t)(pull_threshold ? pull_threshold : 32u);
+}
+
+void sm_config_set_fifo_join(pio_sm_config *c, enum pio_fifo_join join) {
+    (void)c;
+    (void)join;                                 // FIFOs stay 4 deep in the model
+}
+
+/* ------------------------------------------------------------ */
+/*  Program / SM management                                      */
+/* ------------------------------------------------------------ */
+uint pio_get_index(PIO pio) { return pio == pio1 ? 1u : 0u; }
+
+static int find_offset(const pio_block_t *b, const struct pio_program *program) {
+    uint32_t mask = (program->length >= 32) ? 0xFFFFFFFFu : ((1u << program->length) - 1u);
+    if (program->origin >= 0) {
+        return (b->used & (mask << program->origin)) ? -1 : program->origin;
+    }
+    // The SDK allocates from the top of instruction memory downwards
+    for (int off = PIO_SIM_IMEM_SIZE - program->length; off >= 0; --off) {
+        if (!(b->used & (mask << off))) return off;
+    }
+    return -1;
+}
+
+bool pio_can_add_program(PIO pio, const struct pio_program *program) {
+    return find_offset(&blocks[pio_get_index(pio)], program) >= 0;
+}
+
+uint pio_add_program(PIO pio, const struct pio_program *program) {
+    pio_block_t *b = &blocks[pio_get_index(pio)];
+    int off = find_offset(b, program);
+    if (off < 0) {
+        fprintf(stderr, "[sim] no room for a %u-instruction program in pio%u\n",
+                (unsigned)program->length, pio_get_index(pio));
+        sim_hang("pio_add_program");
+    }
+    pio_sim_load(b->imem, program->instructions, program->length, (uint8_t)off);
+    b->used |= ((program->length >= 32) ? 0xFFFFFFFFu : ((1u << program->length) - 1u)) << off;
+    sim_sdk_call(program->length);
+    return (uint)off;
+}
+
+void pio_gpio_init(PIO pio, uint pin) {
+    gpio_set_function(pin, pio_get_index(pio) ? GPIO_FUNC_PIO1 : GPIO_FUNC_PIO0);
+}
+
+void pio_sm_claim(PIO pio, uint sm) {
+    pio_block_t *b = &blocks[pio_get_index(pio)];
+    if (b->claimed & (1u << sm)) {
+        fprintf(stderr, "[sim] pio%u sm%u claimed twice\n", pio_get_index(pio), sm);
+    }
+    b->claimed |= (uint8_t)(1u << sm);
+}
+
+int pio_claim_unused_sm(PIO pio, bool required) {
+    pio_block_t *b = &blocks[pio_get_index(pio)];
+    for (uint sm = 0; sm < NUM_PIO_STATE_MACHINES; ++sm) {
+        if (!(b->claimed & (1u << sm))) {
+            b->claimed |= (uint8_t)(1u << sm);
+            return (int)sm;
+        }
+    }
+    if (required) sim_hang("pio_claim_unused_sm");
+    return -1;
+}
+
+void pio_sm_unclaim(PIO pio, uint sm) {
+    blocks[pio_get_index(pio)].claimed &= (uint8_t)~(1u << sm);
+}
+
+void pio_sm_init(PIO pio, uint sm, uint initial_pc, const pio_sm_config *config) {
+    pio_block_t  *b = &blocks[pio_get_index(pio)];
+    pio_sim_sm_t *s = &b->sm[sm & 3u];
+
+    s->pins = (pio_sim_pins_t){ pins_read, pins_write, pindirs_write,
+                                (void *)(uintptr_t)pio_get_index(pio) };
+    pio_sim_sm_reset(s, b->imem);
+    s->wrap_bottom     = config->wrap_target;
+    s->wrap_top        = config->wrap;
+    s->in_base         = config->in_base;
+    s->out_base        = config->out_base;
+    s->out_count       = config->out_count;
+    s->set_base        = config->set_base;
+    s->set_count       = config->set_count;
+    s->jmp_pin         = config->jmp_pin;
+    s->in_shift_right  = config->in_shift_right;
+    s->autopush        = config->autopush;
+    s->push_threshold  = config->push_threshold;
+    s->out_shift_right = config->out_shift_right;
+    s->autopull        = config->autopull;
+    s->pull_threshold  = config->pull_threshold;
+    s->clkdiv          = config->clkdiv;
+    pio_sim_jump(s, (uint8_t)initial_pc);
+    park(pio, sm);
+    sim_sdk_call(4u);
+}
+
+void pio_sm_set_enabled(PIO pio, uint sm, bool enabled) {
+    sm_of(pio, sm)->enabled = enabled;
+    park(pio, sm);
+    sim_kick();
+    sim_sdk_call(1u);
+}
+
+void pio_sm_restart(PIO pio, uint sm) {
+    pio_sim_sm_t *s = sm_of(pio, sm);
+    s->isr = s->osr = 0;
+    s->isr_count = 0;
+    s->osr_count = 32;
+    s->delay = 0;
+    s->blocked = PIO_SIM_RUNNING;
+    sim_sdk_call(1u);
+}
+
+void pio_sm_clear_fifos(PIO pio, uint sm) {
+    pio_sim_sm_t *s = sm_of(pio, sm);
+    s->tx_level = s->rx_level = 0;
+    s->tx_head  = s->rx_head  = 0;
+    s->blocked  = PIO_SIM_RUNNING;
+    sim_sdk_call(1u);
+}
+
+void pio_sm_exec_jmp(PIO pio, uint sm, uint pc) {
+    pio_sim_jump(sm_of(pio, sm), (uint8_t)pc);
+    park(pio, sm);
+    sim_kick();
+    sim_sdk_call(1u);
+}
+
+void pio_sm_exec(PIO pio, uint sm, uint instr) {
+    if (instr & ~0x1Fu) sim_hang("pio_sm_exec: only 'jmp addr' is modelled");
+    pio_sm_exec_jmp(pio, sm, instr);
+}
+
+void pio_sm_set_pins_with_mask(PIO pio, uint sm, uint32_t pin_values, uint32_t pin_mask) {
+    (void)sm;
+    sim_pio_write_pins(pio_get_index(pio), pin_mask, pin_values);
+    sim_sdk_call(1u);
+}
+
+void pio_sm_set_pindirs_with_mask(PIO pio, uint sm, uint32_t pin_dirs, uint32_t pin_mask) {
+    (void)sm;
+    sim_pio_write_pindirs(pio_get_index(pio), pin_mask, pin_dirs);
+    sim_stats.pin_reconfigs++;
+    sim_sdk_call(1u);
+}
+
+void pio_sm_set_consecutive_pindirs(PIO pio, uint sm, uint pin_base, uint pin_count, bool is_out) {
+    uint32_t mask = ((pin_count >= 32) ? 0xFFFFFFFFu : ((1u << pin_count) - 1u)) << pin_base;
+    pio_sm_set_pindirs_with_mask(pio, sm, is_out ? mask : 0, mask);
+}
+
+/* ------------------------------------------------------------ */
+/*  FIFO access                                                  */
+/* ------------------------------------------------------------ */
+bool pio_sm_is_tx_fifo_full(PIO pio, uint sm) {
+    sim_sdk_call(1u);
+    return pio_sim_tx_full(sm_of(pio, sm));
+}
+
+bool pio_sm_is_tx_fifo_empty(PIO pio, uint sm) {
+    sim_sdk_call(1u);
+    return sm_of(pio, sm)->tx_level == 0;
+}
+
+bool pio_sm_is_rx_fifo_empty(PIO pio, uint sm) {
+    sim_sdk_call(1u);
+    return pio_sim_rx_empty(sm_of(pio, sm));
+}
+
+uint pio_sm_get_rx_fifo_level(PIO pio, uint sm) {
+    sim_sdk_call(1u);
+    return sm_of(pio, sm)->rx_level;
+}
+
+void pio_sm_put(PIO pio, uint sm, uint32_t data) {
+    pio_sim_tx_put(sm_of(pio, sm), data);
+    sim_kick();
+    sim_sdk_call(1u);
+}
+
+void pio_sm_put_blocking(PIO pio, uint sm, uint32_t data) {
+    pio_sim_sm_t *s = sm_of(pio, sm);
+    uint64_t start = sim_now();
+    while (pio_sim_tx_full(s)) {
+        if (sim_now() - start > SIM_HANG_CYCLES) sim_hang("pio_sm_put_blocking");
+        sim_advance_event();
+    }
+    pio_sm_put(pio, sm, data);
+}
+
+uint32_t pio_sm_get(PIO pio, uint sm) {
+    uint32_t v = pio_sim_rx_get(sm_of(pio, sm));
+    sim_kick();
+    sim_sdk_call(1u);
+    return v;
+}
+
+uint32_t pio_sm_get_blocking(PIO pio, uint sm) {
+    pio_sim_sm_t *s = sm_of(pio, sm);
+    uint64_t start = sim_now();
+    while (pio_sim_rx_empty(s)) {
+        if (sim_now() - start > SIM_HANG_CYCLES) sim_hang("pio_sm_get_blocking");
+        sim_advance_event();
+    }
+    return pio_sm_get(pio, sm);
+}
+
+// DREQ numbering matches the RP2040: PIO0 TX0..3, RX0..3, then PIO1
+uint pio_get_dreq(PIO pio, uint sm, bool is_tx) {
+    return pio_get_index(pio) * 8u + (is_tx ? 0u : 4u) + sm;
+}
+
+/* ------------------------------------------------------------ */
+/*  DMA                                                          */
+/* ------------------------------------------------------------ */
+typedef struct {
+    bool               claimed;
+    bool               busy;
+    dma_channel_config cfg;
+    volatile uint8_t  *wr;
+    const volatile uint8_t *rd;
+    uint32_t           remaining;
+    uint32_t           count;                   // reload value for re-triggers
+    pio_sim_sm_t      *rd_sm, *wr_sm;           // paced by this RX / TX FIFO
+} dma_chan_t;
+
+static dma_chan_t chans[NUM_DMA_CHANNELS];
+static unsigned   busy_count;
+static uint32_t   irq_raw;                      // INTR: completions not yet acknowledged
+static uint32_t   irq_en[2];                    // INTE0 / INTE1
+
+// Map a FIFO window address back to its state machine
+static pio_sim_sm_t *fifo_sm(const volatile void *addr, bool *is_tx) {
+    for (unsigned b = 0; b < NUM_PIOS; ++b) {
+        for (unsigned i = 0; i < NUM_PIO_STATE_MACHINES; ++i) {
+            if (addr == (const volatile void *)&host_pio_hw[b].txf[i]) { *is_tx = true;  return &blocks[b].sm[i]; }
+            if (addr == (const volatile void *)&host_pio_hw[b].rxf[i]) { *is_tx = false; return &blocks[b].sm[i]; }
+        }
+    }
+    return NULL;
+}
+
+static uint32_t swap_bytes(uint32_t v, enum dma_channel_transfer_size size) {
+    if (size == DMA_SIZE_16) return (uint16_t)((v << 8) | ((v >> 8) & 0xFFu));
+    if (size == DMA_SIZE_32) return __builtin_bswap32(v);
+    return v;
+}
+
+static void chan_store(dma_chan_t *c, uint32_t v) {
+    unsigned n = 1u << c->cfg.size;
+    if (c->cfg.bswap) v = swap_bytes(v, c->cfg.size);
+    memcpy((void *)c->wr, &v, n);
+    if (c->cfg.write_increment) c->wr += n;
+}
+
+static uint32_t chan_load(dma_chan_t *c) {
+    unsigned n = 1u << c->cfg.size;
+    uint32_t v = 0;
+    memcpy(&v, (const void *)c->rd, n);
+    if (c->cfg.read_increment) c->rd += n;
+    return v;
+}
+
+static void chan_complete(uint ch) {
+    chans[ch].busy = false;
+    busy_count--;
+    irq_raw |= 1u << ch;
+    int next = chans[ch].cfg.chain_to;
+    if (next >= 0 && (uint)next != ch) dma_channel_start((uint)next);
+}
+
+// Move whatever the paced channels can move this tick
+static void chan_service(uint ch) {
+    dma_chan_t *c = &chans[ch];
+    if (!c->busy) return;
+
+    pio_sim_sm_t *rd_sm = c->rd_sm;
+    pio_sim_sm_t *wr_sm = c->wr_sm;
+
+    while (c->remaining) {
+        uint32_t v;
+        if (rd_sm) {
+            if (pio_sim_rx_empty(rd_sm)) break;
+            v = pio_sim_rx_get(rd_sm);
+        } else {
+            v = chan_load(c);
+        }
+        if (wr_sm) {
+            if (pio_sim_tx_full(wr_sm)) {
+                if (!rd_sm) c->rd -= c->cfg.read_increment ? (1u << c->cfg.size) : 0;
+                break;
+            }
+            if (c->cfg.bswap) v = swap_bytes(v, c->cfg.size);
+            pio_sim_tx_put(wr_sm, v);
+        } else {
+            chan_store(c, v);
+        }
+        c->remaining--;
+        if (rd_sm || wr_sm) break;              // one paced transfer per tick
+    }
+    if (c->remaining == 0) chan_complete(ch);
+}
+
+void sim_dma_tick(void) {
+    if (!busy_count) return;
+    for (uint ch = 0; ch < NUM_DMA_CHANNELS; ++ch) chan_service(ch);
+}
+
+int dma_claim_unused_channel(bool required) {
+    for (uint ch = 0; ch < NUM_DMA_CHANNELS; ++ch) {
+        if (!chans[ch].claimed) {
+            chans[ch].claimed = true;
+            return (int)ch;
+        }
+    }
+    if (required) sim_hang("dma_claim_unused_channel");
+    return -1;
+}
+
+void dma_channel_claim(uint channel)   { chans[channel].claimed = true; }
+void dma_channel_unclaim(uint channel) { chans[channel].claimed = false; }
+
+dma_channel_config dma_channel_get_default_config(uint channel) {
+    dma_channel_config c;
+    memset(&c, 0, sizeof(c));
+    c.size            = DMA_SIZE_32;
+    c.read_increment  = true;
+    c.write_increment = false;
+    c.dreq            = DREQ_FORCE;
+    c.chain_to        = (int)channel;
+    return c;
+}
+
+void channel_config_set_transfer_data_size(dma_channel_config *c, enum dma_channel_transfer_size size) { c->size = size; }
+void channel_config_set_read_increment(dma_channel_config *c, bool incr)  { c->read_increment = incr; }
+void channel_config_set_write_increment(dma_channel_config *c, bool incr) { c->write_increment = incr; }
+void channel_config_set_bswap(dma_channel_config *c, bool bswap)          { c->bswap = bswap; }
+void channel_config_set_dreq(dma_channel_config *c, uint dreq)            { c->dreq = dreq; }
+void channel_config_set_chain_to(dma_channel_config *c, uint chain_to)    { c->chain_to = (int)chain_to; }
+
+void dma_channel_configure(uint channel, const dma_channel_config *config,
+                           volatile void *write_addr, const volatile void *read_addr,
+                           uint transfer_count, bool trigger) {
+    dma_chan_t *c = &chans[channel];
+    c->cfg       = *config;
+    c->wr        = write_addr;
+    c->rd        = read_addr;
+    c->count     = transfer_count;
+    c->remaining = transfer_count;
+    sim_sdk_call(4u);
+    if (trigger) dma_channel_start(channel);
+}
+
+void dma_channel_set_read_addr(uint channel, const volatile void *read_addr, bool trigger) {
+    chans[channel].rd = read_addr;
+    if (trigger) dma_channel_start(channel);
+}
+
+void dma_channel_set_write_addr(uint channel, volatile void *write_addr, bool trigger) {
+    chans[channel].wr = write_addr;
+    if (trigger) dma_channel_start(channel);
+}
+
+void dma_channel_set_trans_count(uint channel, uint32_t trans_count, bool trigger) {
+    chans[channel].count = trans_count;
+    if (trigger) dma_channel_start(channel);
+}
+
+void dma_channel_start(uint channel) {
+    dma_chan_t *c = &chans[channel];
+    if (c->busy) busy_count--;
+    c->remaining = c->count;
+    c->busy      = c->remaining != 0;
+    if (c->busy) busy_count++;
+
+    bool is_tx;
+    c->rd_sm = fifo_sm(c->rd, &is_tx);
+    if (c->rd_sm && is_tx) c->rd_sm = NULL;
+    c->wr_sm = fifo_sm(c->wr, &is_tx);
+    if (c->wr_sm && !is_tx) c->wr_sm = NULL;
+    sim_kick();
+    chan_service(channel);                      // unpaced copies finish here
+}
+
+void dma_channel_abort(uint channel) {
+    if (chans[channel].busy) busy_count--;
+    chans[channel].busy = false;
+    chans[channel].remaining = 0;
+}
+
+bool dma_channel_is_busy(uint channel) {
+    sim_sdk_call(1u);
+    return chans[channel].busy;
+}
+
+void dma_channel_wait_for_finish_blocking(uint channel) {
+    uint64_t start = sim_now();
+    while (chans[channel].busy) {
+        if (sim_now() - start > SIM_HANG_CYCLES) sim_hang("dma_channel_wait_for_finish_blocking");
+        sim_advance_event();
+    }
+}
+
+void dma_channel_set_irq0_enabled(uint channel, bool enabled) {
+    irq_en[0] = enabled ? (irq_en[0] | (1u << channel)) : (irq_en[0] & ~(1u << channel));
+}
+
+void dma_channel_set_irq1_enabled(uint channel, bool enabled) {
+    irq_en[1] = enabled ? (irq_en[1] | (1u << channel)) : (irq_en[1] & ~(1u << channel));
+}
+
+bool dma_channel_get_irq0_status(uint channel) { return (irq_raw & irq_en[0] & (1u << channel)) != 0; }
+bool dma_channel_get_irq1_status(uint channel) { return (irq_raw & irq_en[1] & (1u << channel)) != 0; }
+void dma_channel_acknowledge_irq0(uint channel) { irq_raw &= ~(1u << channel); }
+void dma_channel_acknowledge_irq1(uint channel) { irq_raw &= ~(1u << channel); }
+
+bool sim_dma_irq_pending(unsigned line) {
+    return (irq_raw & irq_en[line & 1u]) != 0;
+}
@@ -0,0 +1,93 @@
+/* sdk_stdlib.c – pico/stdlib.h + tusb.h stand-ins for host builds
+ *  ---------------------------------------------------------------
+ *  • sleep_* / time_* run on the simulated clock, so a dump reports the
+ *    time it would take on the board, not on the build machine
+ *  • The CDC port is stdin/stdout; EOF on stdin ends the session
+ */
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <poll.h>
+#include <unistd.h>
+
+#include "pico/stdlib.h"
+#include "pico/stdio_usb.h"
+#include "tusb.h"
+
+#include "sim.h"
+
+#define IDLE_POLLS_BEFORE_SLEEP 256   // empty non-blocking reads before backing off
+
+static bool     stdin_closed;
+static unsigned idle_polls;
+
+bool sim_stdin_closed(void) { return stdin_closed; }
+
+/* ------------------------------------------------------------ */
+/*  Time                                                         */
+/* ------------------------------------------------------------ */
+void sleep_us(uint64_t us)          { sim_wait(us * SIM_CYCLES_PER_US); }
+void sleep_ms(uint32_t ms)          { sim_wait((uint64_t)ms * 1000u * SIM_CYCLES_PER_US); }
+void busy_wait_us_32(uint32_t us)   { sim_wait((uint64_t)us * SIM_CYCLES_PER_US); }
+
+uint64_t time_us_64(void) {
+    sim_sdk_call(1u);
+    return sim_now() / SIM_CYCLES_PER_US;
+}
+
+uint32_t time_us_32(void) {
+    return (uint32_t)time_us_64();
+}
+
+/* ------------------------------------------------------------ */
+/*  stdio                                                        */
+/* ------------------------------------------------------------ */
+struct stdio_driver { int unused; };
+stdio_driver_t stdio_usb;
+
+bool stdio_init_all(void) {
+    setvbuf(stdout, NULL, _IOLBF, 0);
+    return true;
+}
+
+void stdio_set_translate_crlf(stdio_driver_t *driver, bool translate) {
+    (void)driver;
+    (void)translate;
+}
+
+int getchar_timeout_us(uint32_t timeout_us) {
+    fflush(stdout);
+    if (stdin_closed) {
+        sim_wait(timeout_us ? (uint64_t)timeout_us * SIM_CYCLES_PER_US : SIM_CYCLES_SDK_CALL);
+        return PICO_ERROR_TIMEOUT;
+    }
+
+    // Host wall-clock wait; a CLI polling an idle terminal should not spin
+    // a core, but back-to-back polls during a transfer must stay cheap.
+    // Whatever the host waits, the simulated clock waits as well.
+    struct pollfd pfd = { .fd = STDIN_FILENO, .events = POLLIN };
+    int ms = (int)(timeout_us / 1000u);
+    if (ms == 0 && idle_polls >= IDLE_POLLS_BEFORE_SLEEP) ms = 1;
+    sim_advance(ms ? (uint64_t)ms * 1000u * SIM_CYCLES_PER_US : SIM_CYCLES_SDK_CALL);
+    if (poll(&pfd, 1, ms) <= 0) {
+        idle_polls++;
+        sim_core_yield();
+        return PICO_ERROR_TIMEOUT;
+    }
+    idle_polls = 0;
+
+    unsigned char c;
+    ssize_t n = read(STDIN_FILENO, &c, 1);
+    if (n <= 0) {
+        stdin_closed = true;
+        return PICO_ERROR_TIMEOUT;
+    }
+    return c;
+}
+
+/* ------------------------------------------------------------ */
+/*  TinyUSB                                                      */
+/* ------------------------------------------------------------ */
+bool tusb_init(void)         { return true; }
+void tud_task(void)          {}
+bool tud_cdc_connected(void) { return !stdin_closed; }   // the terminal went away
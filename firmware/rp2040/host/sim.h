@@ -0,0 +1,143 @@
+/* sim.h – simulated RP2040 + N64 cartridge for host builds
+ *  ---------------------------------------------------------------
+ *  • One global 125 MHz cycle counter shared by the CPU stand-ins,
+ *    the PIO state machines, DMA and the cartridge/EEPROM models
+ *  • Firmware code never includes this; it only sees the SDK stand-ins
+ *    in host/include and the bus HAL
+ */
+#ifndef HOST_SIM_H_
+#define HOST_SIM_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#define SIM_SYS_HZ            125000000u
+#define SIM_CYCLES_PER_US     (SIM_SYS_HZ / 1000000u)
+#define SIM_NEVER             UINT64_MAX
+
+// CPU-side costs charged by the stand-ins (cycles at 125 MHz)
+#define SIM_CYCLES_SIO_ACCESS 1u    // single-cycle IOPORT store/load
+#define SIM_CYCLES_NOP_ITER   4u    // nop + add + cmp + taken branch
+#define SIM_CYCLES_SDK_CALL   8u    // call + APB register access
+#define SIM_CYCLES_GPIO_FUNC  24u   // gpio_set_function / pull setters
+
+// Give up on a blocking call after this much simulated time
+#define SIM_HANG_CYCLES       ((uint64_t)SIM_SYS_HZ * 5u)
+
+/* ---------- Clock ---------- */
+uint64_t sim_now(void);
+void     sim_advance(uint64_t cycles);
+void     sim_advance_event(void);           // run up to the next tick that can change state
+void     sim_kick(void);                    // outputs/FIFOs changed: re-evaluate next tick
+void     sim_hang(const char *what);        // blocking call never completed
+void     sim_wait(uint64_t cycles);         // sleep/spin: sim_advance(), counted as waiting
+
+/* ---------- Cost counters (sim_core.c) ---------- */
+// What the CPU stand-ins charged since sim_reset_stats(); n64_bench turns
+// these into a profile of each hot path
+typedef struct {
+    uint64_t sio_accesses;      // GPIO out/in/OE and inter-core FIFO loads and stores
+    uint64_t pin_reconfigs;     // direction changes, function and pull selects
+    uint64_t nop_cycles;        // spent in bus_hal_delay_cycles()
+    uint64_t sdk_calls;         // PIO, DMA and timer register calls
+    uint64_t wait_cycles;       // blocked on a FIFO, DMA, sleep or spin loop
+} sim_stats_t;
+
+extern sim_stats_t sim_stats;
+void     sim_reset_stats(void);
+void     sim_sdk_call(unsigned calls);      // sim_advance(SIM_CYCLES_SDK_CALL * calls), counted
+
+/* ---------- Pads ---------- */
+uint32_t sim_gpio_levels(void);             // what an input synchroniser sees now
+bool     sim_gpio_pio_owned(unsigned pin, unsigned pio_index);
+uint32_t sim_gpio_observed(void);            // pins some model reacts to
+void     sim_pio_write_pins(unsigned pio_index, uint32_t mask, uint32_t values);
+void     sim_pio_write_pindirs(unsigned pio_index, uint32_t mask, uint32_t dirs);
+
+/* ---------- PIO / DMA scheduling (sdk_pio.c) ---------- */
+uint64_t sim_pio_quiet(void);
+void     sim_pio_skip(uint64_t ticks);
+void     sim_pio_recheck(void);              // wake blocked SMs at their next divider tick
+void     sim_pio_tick(void);
+void     sim_dma_tick(void);
+bool     sim_dma_irq_pending(unsigned line);  // DMA_IRQ_0 / DMA_IRQ_1 asserted
+
+/* ---------- Interrupts and alarms (sdk_irq.c) ---------- */
+uint64_t sim_irq_next_event(void);           // next alarm, SIM_NEVER if none
+void     sim_irq_dispatch(void);             // run whatever is due, once per tick
+
+/* ---------- Cartridge on the AD bus (cart_model.c) ---------- */
+bool     cart_model_load_rom(const char *path);
+bool     cart_model_set_rom(const uint8_t *image, size_t len);   // .z64 byte order
+bool     cart_model_load_sram(const char *path);
+bool     cart_model_save_sram(const char *path);
+void     cart_model_set_tacc_ns(double ns);
+void     cart_model_set_page_bytes(uint32_t bytes);   // power of two, 0 = off
+void     cart_model_set_read_errors(uint32_t every);  // ~1 bad ROM word per 'every', 0 = off
+void     cart_model_eject(void);                     // empty slot: the bus reads pull-ups
+size_t   cart_model_rom_size(void);
+const uint8_t *cart_model_rom(void);
+const uint8_t *cart_model_sram(void);
+void     cart_model_edges(uint32_t before, uint32_t after, uint64_t t);
+bool     cart_model_drive(uint64_t t, uint16_t *ad);
+
+/* ---------- FlashRAM in the save window (flashram_model.c) ---------- */
+bool     flashram_model_load(const char *path, const char *type_name);  // NULL path = erased
+bool     flashram_model_present(void);
+const uint8_t *flashram_model_data(void);
+bool     flashram_model_claims(uint32_t addr);
+void     flashram_model_latch(uint32_t addr);
+uint16_t flashram_model_peek(void);
+void     flashram_model_rd_done(void);
+void     flashram_model_write(uint32_t addr, uint16_t v);
+
+/* ---------- Repro cart flash in the ROM window (reproflash_model.c) ---------- */
+bool     reproflash_model_load(const char *type_name, const uint8_t *image, size_t len);
+bool     reproflash_model_present(void);
+const uint8_t *reproflash_model_data(void);
+size_t   reproflash_model_size(void);
+bool     reproflash_model_claims(uint32_t addr);
+uint16_t reproflash_model_peek(uint32_t addr);
+void     reproflash_model_write(uint32_t addr, uint16_t v);
+
+/* ---------- Cart swaps (slot_model.c) ---------- */
+bool     slot_model_queue(const char *rom_path);   // goes in after the ones before it
+void     slot_model_set_swap_ms(uint32_t ms);     // operator's pull / insert time
+unsigned slot_model_carts(void);                  // --rom and the queue
+void     slot_model_led(bool on, uint64_t t);
+uint64_t slot_model_next_event(void);
+void     slot_model_run(uint64_t now);
+
+/* ---------- Program flash (sdk_flash.c) ---------- */
+bool     sim_flash_open(const char *path);    // load, and keep the file in sync
+
+/* ---------- SD card slot (sdcard_image.c) ---------- */
+bool     sd_image_open(const char *path, uint32_t create_mb);   // 0 = use as is
+void     sd_image_close(void);
+
+/* ---------- Joybus EEPROM (eeprom_model.c) ---------- */
+bool     eeprom_model_load(const char *path, size_t size);
+bool     eeprom_model_save(const char *path);
+void     eeprom_model_set_size(size_t size);
+size_t   eeprom_model_size(void);
+const uint8_t *eeprom_model_data(void);
+void     eeprom_model_line(bool level, uint64_t t);   // host-side drive level
+bool     eeprom_model_pulling_low(uint64_t t);
+uint64_t eeprom_model_next_event(uint64_t now);
+
+/* ---------- Controller + pak on CTRL_DAT (controller_model.c) ---------- */
+void     controller_model_plug(bool with_pak);
+bool     controller_model_load_pak(const char *path);  // also plugs the controller in
+const uint8_t *controller_model_pak(void);
+void     controller_model_line(bool level, uint64_t t);
+bool     controller_model_pulling_low(uint64_t t);
+uint64_t controller_model_next_event(uint64_t now);
+
+/* ---------- Cores (sdk_multicore.c) ---------- */
+void     sim_core_yield(void);              // let the other core run until it spins
+
+/* ---------- Host stdio ---------- */
+bool     sim_stdin_closed(void);
+
+#endif /* HOST_SIM_H_ */
@@ -0,0 +1,290 @@
+/* sim_core.c – simulated clock, GPIO pads and the host bus HAL backend
+ *  ---------------------------------------------------------------
+ *  • sim_advance() is the only place time moves; it clocks the PIO
+ *    state machines and DMA, jumping over ticks where nothing happens
+ *  • Pads combine SIO/PIO outputs with what the cartridge, EEPROM and
+ *    controller models drive, and report control-line edges to them
+ *    (and the LED to the operator in slot_model.c)
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "pico/stdlib.h"
+#include "hardware/gpio.h"
+
+#include <bus/ad_bus.h>
+#include <bus/bus_hal.h>
+#include <bus/bus_perf.h>
+#include <bus/joybus.h>
+#include <devices/controller.h>
+
+#include "sim.h"
+
+/* ------------------------------------------------------------ */
+/*  Clock                                                        */
+/* ------------------------------------------------------------ */
+static uint64_t now_cycles;
+static bool     kicked;
+
+sim_stats_t sim_stats;
+
+uint64_t sim_now(void) { return now_cycles; }
+
+void sim_reset_stats(void) {
+    sim_stats = (sim_stats_t){0};
+}
+
+void sim_kick(void) { kicked = true; }
+
+void sim_hang(const char *what) {
+    fprintf(stderr, "\n[sim] %s did not complete after %.1f s simulated time (t=%.6f s)\n",
+            what, (double)SIM_HANG_CYCLES / SIM_SYS_HZ, (double)now_cycles / SIM_SYS_HZ);
+    exit(3);
+}
+
+// Jump straight to the next tick on which something can change (at most
+// 'budget' cycles ahead), run that tick and return the cycles consumed.
+static uint64_t step(uint64_t budget) {
+    if (kicked) sim_pio_recheck();
+
+    uint64_t skip = kicked ? 0 : budget - 1;
+    uint64_t q = sim_pio_quiet();
+    if (q < skip) skip = q;
+    uint64_t ev  = eeprom_model_next_event(now_cycles);
+    uint64_t cev = controller_model_next_event(now_cycles);
+    if (cev < ev) ev = cev;
+    bool jb_edge = false;
+    if (ev != SIM_NEVER) {
+        uint64_t until = ev > now_cycles ? ev - now_cycles : 0;
+        if (until <= skip) {
+            skip     = until;
+            jb_edge = true;
+        }
+    }
+    uint64_t al = sim_irq_next_event();
+    uint64_t sl = slot_model_next_event();
+    if (sl < al) al = sl;
+    if (al != SIM_NEVER) {
+        uint64_t until = al > now_cycles ? al - now_cycles : 0;
+        if (until < skip) skip = until;
+    }
+    if (skip) {
+        sim_pio_skip(skip);
+        now_cycles += skip;
+    }
+    if (jb_edge) sim_pio_recheck();
+
+    kicked = false;
+    sim_pio_tick();
+    sim_dma_tick();
+    now_cycles++;
+    slot_model_run(now_cycles);
+    sim_irq_dispatch();
+    return skip + 1;
+}
+
+void sim_advance(uint64_t cycles) {
+    while (cycles) cycles -= step(cycles);
+}
+
+void sim_advance_event(void) {
+    sim_stats.wait_cycles += step(SIM_HANG_CYCLES);
+}
+
+void sim_wait(uint64_t cycles) {
+    sim_stats.wait_cycles += cycles;
+    sim_advance(cycles);
+}
+
+void sim_sdk_call(unsigned calls) {
+    sim_stats.sdk_calls += calls;
+    sim_advance((uint64_t)SIM_CYCLES_SDK_CALL * calls);
+}
+
+/* ------------------------------------------------------------ */
+/*  Pads                                                         */
+/* ------------------------------------------------------------ */
+#define CART_CTRL_MASK ((1u << RD_PIN) | (1u << WR_PIN) | (1u << ALE_H_PIN) | (1u << ALE_L_PIN))
+#define EEP_DAT_MASK   (1u << EEP_DAT)
+#define CTRL_DAT_MASK  (1u << CTRL_DAT)
+#define LED_MASK       (1u << PICO_DEFAULT_LED_PIN)
+
+static uint8_t  pad_func[NUM_BANK0_GPIOS];
+static uint32_t sio_func, pio_func[2];        // pads muxed to SIO / PIO0 / PIO1
+static uint32_t sio_out, sio_oe;
+static uint32_t pio_out[2], pio_oe[2];
+static uint32_t pull_up, pull_down;
+static uint32_t mcu_levels = CART_CTRL_MASK | EEP_DAT_MASK | CTRL_DAT_MASK;
+
+static uint32_t mcu_driven(uint32_t *values) {
+    uint32_t s  = sio_oe    & sio_func;
+    uint32_t p0 = pio_oe[0] & pio_func[0];
+    uint32_t p1 = pio_oe[1] & pio_func[1];
+    *values = (sio_out & s) | (pio_out[0] & p0) | (pio_out[1] & p1);
+    return s | p0 | p1;
+}
+
+// Levels as the MCU side alone would leave them (undriven pins at their pull)
+static uint32_t mcu_side_levels(void) {
+    uint32_t values;
+    uint32_t driven = mcu_driven(&values);
+    return values | (~driven & pull_up);
+}
+
+// Report edges on the lines the external models care about
+static void pads_changed(void) {
+    uint32_t after = mcu_side_levels();
+    uint32_t diff  = after ^ mcu_levels;
+    uint64_t t     = now_cycles + 1;          // outputs settle one cycle later
+
+    if (diff & (CART_CTRL_MASK | AD_BUS_MASK)) {
+        cart_model_edges(mcu_levels, after, t);
+    }
+    if (diff & EEP_DAT_MASK) {
+        eeprom_model_line((after & EEP_DAT_MASK) != 0, t);
+    }
+    if (diff & CTRL_DAT_MASK) {
+        controller_model_line((after & CTRL_DAT_MASK) != 0, t);
+    }
+    if (diff & LED_MASK) {
+        slot_model_led((after & LED_MASK) != 0, t);
+    }
+    mcu_levels = after;
+    sim_kick();
+}
+
+uint32_t sim_gpio_levels(void) {
+    uint32_t values;
+    uint32_t driven = mcu_driven(&values);
+    uint32_t levels = values | (~driven & pull_up);
+
+    uint16_t ad;
+    if ((driven & AD_BUS_MASK) != AD_BUS_MASK && cart_model_drive(now_cycles, &ad)) {
+        uint32_t cart = ((uint32_t)ad << AD_BUS_PIN_START) & AD_BUS_MASK & ~driven;
+        levels = (levels & ~(AD_BUS_MASK & ~driven)) | cart;
+    }
+    if (eeprom_model_pulling_low(now_cycles)) {
+        levels &= ~EEP_DAT_MASK;              // open-drain wired-AND
+    }
+    if (controller_model_pulling_low(now_cycles)) {
+        levels &= ~CTRL_DAT_MASK;
+    }
+    return levels;
+}
+
+uint32_t sim_gpio_observed(void) {
+    return CART_CTRL_MASK | AD_BUS_MASK | EEP_DAT_MASK | CTRL_DAT_MASK;
+}
+
+bool sim_gpio_pio_owned(unsigned pin, unsigned pio_index) {
+    return pad_func[pin] == (pio_index ? GPIO_FUNC_PIO1 : GPIO_FUNC_PIO0);
+}
+
+void sim_pio_write_pins(unsigned pio_index, uint32_t mask, uint32_t values) {
+    pio_out[pio_index] = (pio_out[pio_index] & ~mask) | (values & mask);
+    pads_changed();
+}
+
+void sim_pio_write_pindirs(unsigned pio_index, uint32_t mask, uint32_t dirs) {
+    pio_oe[pio_index] = (pio_oe[pio_index] & ~mask) | (dirs & mask);
+    pads_changed();
+}
+
+/* ------------------------------------------------------------ */
+/*  Bus HAL backend                                              */
+/* ------------------------------------------------------------ */
+void bus_hal_gpio_set(uint32_t mask) {
+    sio_out |= mask;
+    pads_changed();
+    sim_stats.sio_accesses++;
+    sim_advance(SIM_CYCLES_SIO_ACCESS);
+}
+
+void bus_hal_gpio_clr(uint32_t mask) {
+    sio_out &= ~mask;
+    pads_changed();
+    sim_stats.sio_accesses++;
+    sim_advance(SIM_CYCLES_SIO_ACCESS);
+}
+
+uint32_t bus_hal_gpio_in(void) {
+    uint32_t v = sim_gpio_levels();
+    sim_stats.sio_accesses++;
+    sim_advance(SIM_CYCLES_SIO_ACCESS);
+    return v;
+}
+
+void bus_hal_oe_set(uint32_t mask) {
+    sio_oe |= mask;
+    pads_changed();
+    sim_stats.sio_accesses++;
+    sim_stats.pin_reconfigs++;
+    sim_advance(SIM_CYCLES_SIO_ACCESS);
+}
+
+void bus_hal_oe_clr(uint32_t mask) {
+    sio_oe &= ~mask;
+    pads_changed();
+    sim_stats.sio_accesses++;
+    sim_stats.pin_reconfigs++;
+    sim_advance(SIM_CYCLES_SIO_ACCESS);
+}
+
+void bus_hal_delay_cycles(uint32_t cycles) {
+    sim_stats.nop_cycles += cycles;
+    sim_advance(cycles);
+}
+
+#if defined(N64_PERF) && N64_PERF
+uint32_t bus_perf_now(void) {
+    return (uint32_t)now_cycles & BUS_PERF_CYCLE_MASK;
+}
+#endif
+
+/* ------------------------------------------------------------ */
+/*  hardware/gpio.h stand-ins                                    */
+/* ------------------------------------------------------------ */
+void gpio_init(uint gpio) {
+    sio_oe  &= ~(1u << gpio);
+    sio_out &= ~(1u << gpio);
+    gpio_set_function(gpio, GPIO_FUNC_SIO);
+}
+
+void gpio_set_function(uint gpio, enum gpio_function fn) {
+    uint32_t bit = 1u << gpio;
+    pad_func[gpio] = (uint8_t)fn;
+    sio_func    = (fn == GPIO_FUNC_SIO)  ? (sio_func    | bit) : (sio_func    & ~bit);
+    pio_func[0] = (fn == GPIO_FUNC_PIO0) ? (pio_func[0] | bit) : (pio_func[0] & ~bit);
+    pio_func[1] = (fn == GPIO_FUNC_PIO1) ? (pio_func[1] | bit) : (pio_func[1] & ~bit);
+    pads_changed();
+    sim_stats.pin_reconfigs++;
+    sim_advance(SIM_CYCLES_GPIO_FUNC);
+}
+
+void gpio_set_dir(uint gpio, bool out) {
+    if (out) bus_hal_oe_set(1u << gpio);
+    else     bus_hal_oe_clr(1u << gpio);
+}
+
+void gpio_put(uint gpio, bool value) {
+    if (value) bus_hal_gpio_set(1u << gpio);
+    else       bus_hal_gpio_clr(1u << gpio);
+}
+
+bool gpio_get(uint gpio) {
+    return (bus_hal_gpio_in() >> gpio) & 1u;
+}
+
+void gpio_set_pulls(uint gpio, bool up, bool down) {
+    pull_up   = (pull_up   & ~(1u << gpio)) | ((uint32_t)up   << gpio);
+    pull_down = (pull_down & ~(1u << gpio)) | ((uint32_t)down << gpio);
+    pads_changed();
+    sim_stats.pin_reconfigs++;
+    sim_advance(SIM_CYCLES_GPIO_FUNC);
+}
+
+void gpio_pull_up(uint gpio)       { gpio_set_pulls(gpio, true, false); }
+void gpio_pull_down(uint gpio)     { gpio_set_pulls(gpio, false, true); }
+void gpio_disable_pulls(uint gpio) { gpio_set_pulls(gpio, false, false); }
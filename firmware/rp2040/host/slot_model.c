@@ -0,0 +1,64 @@
+/* slot_model.c – an operator swapping carts by the LED (host builds)
+ *  ---------------------------------------------------------------
+ *  • The cart loaded with --rom is in the slot at the start; the ones
+ *    queued after it go in one at a time
+ *  • The operator waits for the LED to go dark after it was lit (the
+ *    dump is over and the blinking has started), pulls the cart after
+ *    a reaction time and puts the next one in after the same time
+ *  • Only the ROM changes hands; the save chips stay as loaded
+ */
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "sim.h"
+
+#define SLOT_QUEUE_MAX  32u
+
+static const char *queue[SLOT_QUEUE_MAX];
+static unsigned    queued, next_in;
+static uint64_t    swap_cycles = (uint64_t)4000u * 1000u * SIM_CYCLES_PER_US;
+static uint64_t    due = SIM_NEVER;     // next pull or insertion
+static bool        lit_seen;            // LED on since this cart went in
+
+bool slot_model_queue(const char *rom_path) {
+    if (queued >= SLOT_QUEUE_MAX) return false;
+    queue[queued++] = rom_path;
+    return true;
+}
+
+void slot_model_set_swap_ms(uint32_t ms) {
+    swap_cycles = (uint64_t)ms * 1000u * SIM_CYCLES_PER_US;
+}
+
+unsigned slot_model_carts(void) {
+    return queued + 1u;
+}
+
+void slot_model_led(bool on, uint64_t t) {
+    if (on) {
+        lit_seen = cart_model_rom_size() != 0;
+    } else if (lit_seen && due == SIM_NEVER) {
+        lit_seen = false;
+        due      = t + swap_cycles;
+    }
+}
+
+uint64_t slot_model_next_event(void) {
+    return due;
+}
+
+void slot_model_run(uint64_t now) {
+    if (now < due) return;
+    due = SIM_NEVER;
+    if (cart_model_rom_size()) {
+        cart_model_eject();
+        fprintf(stderr, "[slot] %.3f s: cart pulled\n", (double)now / SIM_SYS_HZ);
+        if (next_in < queued) due = now + swap_cycles;
+        return;
+    }
+    const char *path = queue[next_in++];
+    if (!cart_model_load_rom(path)) return;
+    lit_seen = false;
+    fprintf(stderr, "[slot] %.3f s: %s inserted\n", (double)now / SIM_SYS_HZ, path);
+}
@@ -0,0 +1,56 @@
+/* autodump.h – dump every cart put in the slot, no menu in between */
+#ifndef APP_AUTODUMP_H_
+#define APP_AUTODUMP_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ======================================================================
+// Auto dump
+// Purpose: Bulk archiving, where the operator's only job is to swap
+//          carts. The slot is polled with a few word reads
+//          (n64_cart_present()). A cart that reads the same for
+//          AUTODUMP_SETTLE_POLLS polls in a row is reset, identified
+//          (app/cartid.h) and dumped, ROM and save. The dump goes to
+//          the SD card (app/sddump.h) or is announced to the host tool
+//          with a CART frame (app/xfer.h), which then pulls ROM and
+//          save over the usual transfers.
+//          The board LED tells the operator what to do:
+//            off          slot empty, insert the next cart
+//            on           busy, leave the cart in
+//            slow blink   done, pull the cart
+//            fast blink   failed, pull the cart (and try it again)
+//          The cart that is still in the slot after its dump is not
+//          dumped again; it has to come out first.
+// ======================================================================
+
+#define AUTODUMP_POLL_US        100000u     // slot check and LED step
+#define AUTODUMP_SETTLE_POLLS   3u          // same CRC1 this often → inserted
+#define AUTODUMP_GONE_POLLS     3u          // absent this often → removed
+#define AUTODUMP_ANNOUNCE_US    2000000u    // CART repeat until the host answers
+#define AUTODUMP_HOST_QUIET_US  30000000u   // host silent mid-cart → failed
+
+typedef enum {
+    AUTODUMP_TO_SD,
+    AUTODUMP_TO_HOST,
+} autodump_target_t;
+
+typedef struct {
+    uint32_t carts;             // dumped
+    uint32_t failed;            // dump started but did not complete
+    uint32_t busy_ms;           // insertion seen → pull signal, all carts
+    uint32_t total_ms;          // start → stop
+} autodump_stats_t;
+
+// Dump carts until a key arrives on the console, or after 'max_carts'
+// attempts (0 = no limit). Reports each cart on the console.
+void autodump_run(autodump_target_t target, uint32_t max_carts, autodump_stats_t *out);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* APP_AUTODUMP_H_ */
@@ -0,0 +1,55 @@
+/* blockmap.h – per-block CRC map of the last ROM dump, and its repair */
+#ifndef APP_BLOCKMAP_H_
+#define APP_BLOCKMAP_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ======================================================================
+// Block map
+// Purpose: While a ROM transfer streams, record the CRC-32 of every
+//          64 KiB block exactly as it went to the host. A later repair
+//          re-reads the cart block by block; only blocks whose CRC comes
+//          back different are read again, several times, and settled by
+//          a per-word majority vote. Re-reads scale with the number of
+//          bad blocks, not with the size of the cart.
+// ======================================================================
+
+#define BLOCKMAP_BLOCK_BYTES  (64u * 1024u)
+#define BLOCKMAP_MAX_BLOCKS   1024u          // 64 MiB
+#define BLOCKMAP_PIECE_BYTES  4096u          // unit of a vote / a patch frame
+#define BLOCKMAP_VOTE_MIN     3u             // reads that must agree outright
+#define BLOCKMAP_VOTE_MAX     5u             // reads for a contested piece
+
+// Start a map for a ROM of 'length' bytes. A map for the same length is
+// kept, so a resumed transfer only overwrites the blocks it streams.
+void blockmap_begin(uint32_t length, bool resume);
+
+// Bytes as sent to the host, in order. A block is recorded only when it
+// was streamed from its first byte to its last.
+void blockmap_feed(uint32_t offset, const uint8_t *data, size_t len);
+
+// Every block of a 'length'-byte ROM is recorded
+bool     blockmap_ready(uint32_t length);
+uint32_t blockmap_blocks(void);
+uint32_t blockmap_crc(uint32_t block);
+void     blockmap_set_crc(uint32_t block, uint32_t crc);
+
+// Re-read one block from the cart and return its CRC. 'running' (optional)
+// continues a CRC across blocks for a whole-image check.
+uint32_t blockmap_read_crc(uint32_t block, uint32_t *running);
+
+// Read one piece BLOCKMAP_VOTE_MIN times, and up to BLOCKMAP_VOTE_MAX if
+// the reads disagree; 'out' gets the per-word majority. Returns false if
+// some word had no majority (the most frequent value is used).
+bool blockmap_vote_piece(uint32_t offset, uint8_t *out, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* APP_BLOCKMAP_H_ */
@@ -0,0 +1,53 @@
+/* cartfs.h – the cart in the slot as a read-only FAT volume */
+#ifndef APP_CARTFS_H_
+#define APP_CARTFS_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ======================================================================
+// Cart volume
+// Purpose: Describe the cart as a small FAT16 disk for USB mass storage.
+//          It holds "<title>.z64", the save and "<title>.txt" with the
+//          header fields. Nothing is stored. The boot sector, FAT and
+//          directory are computed from the file list, and file data is
+//          read from the cart when the host asks for it. Core 1 runs the
+//          pipeline ahead of the host's position, and its ring is the
+//          read-ahead cache. Sequential copies stream, and a seek
+//          restarts the stream there.
+// ======================================================================
+
+#define CARTFS_BLOCK_BYTES   512u
+#define CARTFS_MAX_FILES     3u
+#define CARTFS_NAME_MAX      40u
+
+typedef struct {
+    char     name[CARTFS_NAME_MAX];
+    uint32_t bytes;
+    uint32_t first_lba;
+    uint8_t  region;            // PIPE_REGION_*, or CARTFS_REGION_TEXT
+} cartfs_file_t;
+
+#define CARTFS_REGION_TEXT   0xFFu
+
+// Identify the cart and lay the volume out; false without a cart. Stops
+// any stream the pipeline was running.
+bool     cartfs_mount(void);
+void     cartfs_unmount(void);
+bool     cartfs_mounted(void);
+uint32_t cartfs_blocks(void);
+
+// 'len' bytes from byte 'offset' of block 'lba' on; any length, in the
+// shape of TinyUSB's READ10 callback
+bool     cartfs_read(uint32_t lba, uint32_t offset, void *dst, uint32_t len);
+
+const cartfs_file_t *cartfs_files(unsigned *count);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* APP_CARTFS_H_ */
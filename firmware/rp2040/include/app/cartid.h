@@ -0,0 +1,62 @@
+/* cartid.h – carts seen before, ready to dump without probing */
+#ifndef APP_CARTID_H_
+#define APP_CARTID_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include <app/n64db.h>
+#include <bus/ad_bus_timing.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ======================================================================
+// Cart identification cache
+// Purpose: Skip the slow part of getting a cart ready when it has been in
+//          the slot before. That covers bus calibration, the burst probe,
+//          mirror sizing for carts not in the database, and the FlashRAM
+//          and EEPROM probes. What they found is kept in the flash log
+//          (storage/flashlog.h), keyed by the header's CRC1, CRC2, cart
+//          ID and version. A later insertion costs one header read, one
+//          lookup and a burst check: a repro shares the header of the
+//          cart it copies, so the remembered timing and burst length are
+//          tested on the cart in the slot, and probed afresh if they do
+//          not hold. A cart that does not calibrate cleanly is not
+//          remembered, so a dirty contact cannot poison the cache.
+// ======================================================================
+
+typedef struct {
+    uint32_t        crc1, crc2;     // header 0x10 / 0x14
+    char            cart_id[5];     // header 0x3B..0x3E, e.g. "NSME", printable
+    uint8_t         raw_id[4];      // the same bytes as stored
+    uint8_t         version;        // header 0x3F
+    uint8_t         save_type;      // N64DB_SAVE_*
+    uint16_t        burst_bytes;
+    uint32_t        rom_bytes;
+    uint32_t        eeprom_bytes;
+    ad_bus_timing_t timing;
+    bool            cached;         // from flash; nothing was probed
+} cartid_t;
+
+// Open the store; once at boot, before core 1 starts
+void cartid_init(void);
+
+// Identify the cart in the slot and apply its timing, burst length and
+// EEPROM size. '*entry' (optional) gets its database entry or NULL.
+// False without a cart.
+bool cartid_prepare(cartid_t *id, const n64db_entry_t **entry);
+
+// Pipeline region (PIPE_REGION_*) and size of the cart's save; false if
+// it has none
+bool cartid_save_region(const cartid_t *id, uint8_t *region, uint32_t *bytes);
+
+// Make the next cartid_prepare() of this cart probe again
+bool cartid_forget(const cartid_t *id);
+void cartid_forget_all(void);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* APP_CARTID_H_ */
@@ -0,0 +1,19 @@
+/* crc32.h – CRC-32 (IEEE 802.3, reflected, as used by zip/PNG) */
+#ifndef APP_CRC32_H_
+#define APP_CRC32_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Start with crc = 0; feed the previous result back in to continue a
+// running checksum across several buffers.
+uint32_t crc32_update(uint32_t crc, const void *data, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* APP_CRC32_H_ */
@@ -0,0 +1,39 @@
+/* ctrlstream.h – timed controller polls streamed over USB */
+#ifndef APP_CTRLSTREAM_H_
+#define APP_CTRLSTREAM_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include <app/xfer.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ======================================================================
+// Controller stream
+// Purpose: A repeating alarm queues a poll on the controller port at a
+//          fixed rate. The completion interrupt stamps the sample and
+//          puts it in a ring. The caller's loop drains the ring into
+//          SAMPLES frames (wire format in app/xfer.h). Nothing formats
+//          text, so the poll rate does not depend on the terminal.
+//          Jitter is taken from the poll start times, and latency from
+//          poll start to the moment the frame is handed to USB.
+// ======================================================================
+
+#define CTRLSTREAM_DEFAULT_HZ     1000u
+#define CTRLSTREAM_MAX_HZ         3000u     // a poll plus its timeout fits the period
+#define CTRLSTREAM_DEFAULT_BATCH  32u
+#define CTRLSTREAM_MAX_BATCH      128u
+#define CTRLSTREAM_RING           256u      // samples; power of two
+
+// Stream until ABORT, the requested duration or a USB disconnect, then
+// send DONE. 'out' (may be NULL) receives the same statistics. False,
+// after an ERROR frame, if no controller answers.
+bool ctrlstream_run(const xfer_ctrl_stream_t *rq, xfer_ctrl_done_t *out);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* APP_CTRLSTREAM_H_ */
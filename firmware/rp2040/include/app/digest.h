@@ -0,0 +1,50 @@
+/* digest.h – CRC-32 + MD5 + SHA-1 in one incremental pass (DAT matching) */
+#ifndef APP_DIGEST_H_
+#define APP_DIGEST_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define DIGEST_MD5_LEN   16u
+#define DIGEST_SHA1_LEN  20u
+
+typedef struct {
+    uint32_t state[4];
+    uint64_t bytes;
+    uint8_t  block[64];
+} md5_ctx_t;
+
+typedef struct {
+    uint32_t state[5];
+    uint64_t bytes;
+    uint8_t  block[64];
+} sha1_ctx_t;
+
+typedef struct {
+    uint32_t   crc32;
+    md5_ctx_t  md5;
+    sha1_ctx_t sha1;
+} digest_t;
+
+typedef struct __attribute__((packed)) {
+    uint32_t crc32;
+    uint8_t  md5[DIGEST_MD5_LEN];
+    uint8_t  sha1[DIGEST_SHA1_LEN];
+} digest_result_t;
+
+void digest_init(digest_t *d);
+void digest_update(digest_t *d, const void *data, size_t len);
+void digest_final(digest_t *d, digest_result_t *out);
+
+// Lower-case hex of 'n' bytes, as md5sum and sha1sum print it; 'out'
+// holds 2 * n + 1 chars
+void digest_hex(const uint8_t *b, size_t n, char *out);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* APP_DIGEST_H_ */
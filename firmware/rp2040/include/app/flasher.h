@@ -0,0 +1,60 @@
+/* flasher.h – repro cart flash programming from a USB stream */
+#ifndef APP_FLASHER_H_
+#define APP_FLASHER_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include <app/xfer.h>
+#include <devices/reproflash.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ======================================================================
+// Repro flash programmer
+// Purpose: Write an image to the flash of a repro cart as it arrives.
+//          Frames are received straight into the pipeline slots
+//          (app/pipeline.h). Core 1 erases each sector when the stream
+//          reaches it and programs whole write buffers, while core 0
+//          receives the next slot. Core 0 hashes what it received, core
+//          1 hashes what it read back from the flash, and DONE carries
+//          both. The host compares them with its own CRC of the file
+//          instead of dumping the cart again.
+//          In the differential mode the sectors are hashed first. The
+//          host sends only the ones that changed, and blank sectors skip
+//          their erase, so reflashing a patched ROM costs a read of the
+//          cart plus the sectors the patch touched.
+// ======================================================================
+
+#define FLASHER_MAX_SECTORS   640u   // 2 x Intel 4400 (2 x 259) fits
+
+// Identify the flash and start core 1 on it; with XFER_PROGRAM_DIFF in
+// 'flags' the sectors covering [0, length) are hashed first. False, with
+// a reason in 'err', if there is no known flash or the image does not fit.
+bool     flasher_begin(uint32_t length, uint32_t flags, repro_info_t *info, const char **err);
+// Sector list from the differential scan
+const xfer_sector_t *flasher_sectors(uint32_t *count);
+// Whether the next piece may start at 'offset': where the last one ended,
+// or (differential mode) the start of a later sector
+bool     flasher_accepts(uint32_t offset);
+// Slot for the next piece of the image (PIPE_SLOT_BYTES); waits while
+// every slot is still being programmed
+uint8_t *flasher_slot(void);
+// Hand the slot to core 1. Pieces come in order, with even lengths.
+// False once the flash has failed somewhere.
+bool     flasher_commit(uint32_t offset, uint16_t len);
+// Wait for the last slot, then fill 'out' (all but naks and us)
+bool     flasher_end(xfer_program_done_t *out);
+// Offset core 1 failed at, after flasher_commit() or flasher_end() failed
+uint32_t flasher_fail_offset(void);
+
+// The PROGRAM session from app/xfer.h: ACK, PDATA frames, then DONE or
+// ERROR. 'out' (may be NULL) receives the DONE payload.
+bool flasher_run(const xfer_program_t *rq, xfer_program_done_t *out);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* APP_FLASHER_H_ */
@@ -0,0 +1,38 @@
+/* gather.h – many small cart reads in one request */
+#ifndef APP_GATHER_H_
+#define APP_GATHER_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include <app/xfer.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ======================================================================
+// Scatter/gather reads
+// Purpose: Serve header readers, save probes and hex viewers, which
+//          read many small ranges all over the cart. The ranges are
+//          sorted and merged, overlaps and near neighbours included,
+//          into runs that cost one address latch each. The runs are
+//          read into one buffer, then every range goes out in request
+//          order as DATA frames (wire format in app/xfer.h). A tool
+//          pays one USB round trip for the whole list.
+// ======================================================================
+
+// Ranges closer than this are read as one run, gap included: a few
+// extra words cost less than a second latch
+#define GATHER_BRIDGE_BYTES   32u
+
+// Read the ranges and send them, then DONE. 'out' (may be NULL) gets the
+// same statistics. False, after an ERROR frame, if the list is empty,
+// too long or wraps the address space. A 'count' past
+// XFER_GATHER_MAX_RANGES is refused before 'ranges' is read.
+bool gather_run(const xfer_range_t *ranges, uint32_t count, xfer_gather_done_t *out);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* APP_GATHER_H_ */
@@ -0,0 +1,65 @@
+/* n64db.h – cartridge database (docs/n64.txt compiled in at build time) */
+#ifndef APP_N64DB_H_
+#define APP_N64DB_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ======================================================================
+// Cart database
+// Purpose: Identify a cart from the CRC1 word of its header (0x10, big-
+//          endian). cmake/n64db.cmake turns docs/n64.txt into a table
+//          sorted by (CRC1, CRC32) plus a pool of NUL-terminated names,
+//          both const so they stay in flash. A lookup is a binary search.
+// ======================================================================
+
+// Save types, same numbering as n64.txt and the ATmega firmware
+#define N64DB_SAVE_NONE      0u
+#define N64DB_SAVE_SRAM      1u
+#define N64DB_SAVE_FLASHRAM  4u
+#define N64DB_SAVE_EEP4K     5u
+#define N64DB_SAVE_EEP16K    6u
+
+typedef struct {
+    uint32_t crc1;          // header checksum word, the search key
+    uint32_t crc32;         // CRC-32 of the whole big-endian (.z64) ROM
+    uint16_t name;          // offset into n64db_names
+    uint8_t  size_mb;       // ROM size in MiB
+    uint8_t  save_type;     // N64DB_SAVE_*
+} n64db_entry_t;
+
+extern const n64db_entry_t n64db_table[];
+extern const size_t        n64db_count;
+extern const char          n64db_names[];
+
+// First entry with this CRC1, or NULL. Some dumps share a CRC1; they are
+// adjacent and '*matches' (optional) says how many there are.
+const n64db_entry_t *n64db_find(uint32_t crc1, size_t *matches);
+
+static inline const char *n64db_name(const n64db_entry_t *e) {
+    return &n64db_names[e->name];
+}
+
+// Look up the cart in the slot by the CRC1 in its header; NULL if it is
+// not in the table. 'rom_bytes' (optional) gets the ROM size from the
+// table, or from mirror probing for an unknown cart.
+const n64db_entry_t *n64db_identify(uint32_t *rom_bytes);
+
+// Save chip of the cart in the slot (N64DB_SAVE_*): the database's type
+// if that chip answers. An unknown cart reports EEPROM if one answers on
+// joybus, else none: SRAM cannot be told from open bus, and FlashRAM is
+// only probed for carts listed with it (flashram_identify() writes the
+// save window). Reading one anyway is the host's call (XFER_REGION_FLASHRAM).
+uint8_t n64db_save_type(const n64db_entry_t *e);
+
+// Human-readable N64DB_SAVE_* value
+const char *n64db_save_name(uint8_t save_type);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* APP_N64DB_H_ */
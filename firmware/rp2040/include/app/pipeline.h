@@ -0,0 +1,84 @@
+/* pipeline.h – core 1 bus producer / core 0 USB consumer */
+#ifndef APP_PIPELINE_H_
+#define APP_PIPELINE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ======================================================================
+// Dump pipeline
+// Purpose: Core 1 owns the cartridge bus while a stream is running. It
+//          reads the region front to back into a ring of slots; core 0
+//          keeps servicing USB and drains the ring. The ring is a
+//          single-producer / single-consumer queue. Start/stop commands
+//          travel through the inter-core FIFO, so core 1 only picks them
+//          up between chunks. The FIFO carries nothing else, so the
+//          SDK's multicore lockout (which eats FIFO words) is not used;
+//          flash programming parks core 1 with pipe_park() instead.
+//          The write direction turns the ring around: core 0 fills slots
+//          with what arrives over USB and core 1 writes them to the cart
+//          in order. One slot can be received while the previous one is
+//          being programmed.
+// ======================================================================
+
+#define PIPE_SLOTS        4u
+#define PIPE_SLOT_BYTES   4096u
+
+// Regions (same numbering as XFER_REGION_*)
+#define PIPE_REGION_ROM       0u
+#define PIPE_REGION_SRAM      1u
+#define PIPE_REGION_EEPROM    2u
+#define PIPE_REGION_FLASHRAM  3u
+#define PIPE_REGION_REPRO     4u     // write direction only
+
+// Reading, core 1 produces and core 0 consumes; writing, the other way round
+typedef struct {
+    uint32_t chunks;            // slots passed through the ring
+    uint32_t producer_stalls;   // ring full: reading, USB is the bottleneck;
+                                //   writing, the cart is
+    uint32_t consumer_stalls;   // ring empty: reading, the cart is the
+                                //   bottleneck; writing, USB is
+} pipe_stats_t;
+
+// Launch the producer on core 1 (once, after the bus is initialised)
+void pipe_init(void);
+
+// Stream [offset, end) of a region in chunk-byte pieces. Restarting an
+// active stream drops whatever core 1 had already queued.
+void pipe_start(uint8_t region, uint32_t offset, uint32_t end, uint16_t chunk);
+void pipe_stop(void);
+
+// Hold core 1 in RAM with its interrupts off, for flash programming.
+// Stops a running stream; no-ops before pipe_init().
+void pipe_park(void);
+void pipe_unpark(void);
+
+// Next filled chunk, waiting for core 1 if necessary. The data stays
+// valid until pipe_release().
+const uint8_t *pipe_next(uint32_t *offset, uint16_t *len);
+void pipe_release(void);
+
+// Write [offset, ...) of a region from slots that core 0 fills. Slots
+// are committed in address order; each one is read back after it is
+// written and folded into a CRC-32.
+void     pipe_start_write(uint8_t region, uint32_t offset);
+uint8_t *pipe_write_slot(void);                       // waits for a free slot
+#define PIPE_WRITE_NO_ERASE   0x01u  // the sector starting in this slot is blank
+void     pipe_write_commit(uint32_t offset, uint16_t len, uint8_t flags);
+// True once core 1 failed a write; later slots are dropped unwritten
+bool     pipe_write_failed(uint32_t *offset);
+// Wait until every committed slot is written; false if one failed.
+// 'readback_crc' is the CRC-32 of what was read back, in stream order.
+bool     pipe_write_finish(uint32_t *readback_crc);
+
+void pipe_get_stats(pipe_stats_t *out);
+void pipe_reset_stats(void);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* APP_PIPELINE_H_ */
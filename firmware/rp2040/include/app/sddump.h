@@ -0,0 +1,51 @@
+/* sddump.h – dump the cart to the SD card without a host */
+#ifndef APP_SDDUMP_H_
+#define APP_SDDUMP_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include <app/digest.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ======================================================================
+// Standalone dump to SD
+// Purpose: Write the ROM and the save of the cart in the slot to the
+//          root of the SD card, named after the database entry (or the
+//          header title). Both files are created at their final size as
+//          contiguous runs first (storage/fat32.h). The data then goes
+//          out as one multi-block write per file. Core 1 reads the next
+//          pipeline slot from the cart while core 0 sends the last one
+//          to the card, and hashes it for DAT matching. A file's size is
+//          set only after its data is written.
+// ======================================================================
+
+#define SDDUMP_NAME_MAX   96u
+
+typedef struct {
+    char     rom_name[SDDUMP_NAME_MAX];
+    char     save_name[SDDUMP_NAME_MAX];     // empty: no save found
+    uint32_t rom_bytes;
+    uint32_t save_bytes;
+    uint32_t rom_crc32;
+    uint8_t  rom_md5[DIGEST_MD5_LEN];
+    uint8_t  rom_sha1[DIGEST_SHA1_LEN];
+    uint32_t db_crc32;                       // 0: cart not in the database
+    uint32_t rom_lba, save_lba;              // first block of each file
+    uint32_t rom_us;                         // ROM stream, first slot to last block
+    uint32_t total_us;                       // card init to the end of the save
+    uint32_t producer_stalls;                // ROM: core 1 waited for the card
+    uint32_t consumer_stalls;                // ROM: the card waited for core 1
+} sddump_result_t;
+
+// Dump ROM and save. False, with a reason in 'err', if the card or the
+// file system is missing or full, or a write failed.
+bool sddump_run(sddump_result_t *out, const char **err);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* APP_SDDUMP_H_ */
@@ -0,0 +1,293 @@
+/* xfer.h – framed binary transfer mode next to the menu CLI */
+#ifndef APP_XFER_H_
+#define APP_XFER_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ======================================================================
+// Wire format (both directions, little-endian)
+//
+//   off  size  field
+//    0    2    sof      0xA5 0x5A
+//    2    1    type     XFER_T_*
+//    3    1    flags    0
+//    4    4    seq      frame number, 0 = first frame of this transfer
+//    8    4    offset   byte offset inside the region
+//   12    2    len      payload bytes that follow the header
+//   14    2    reserved 0
+//   16    4    crc      CRC-32 of bytes 0..15 and the payload
+//   20   len   payload
+//
+// A transfer starts when the host sends START. The device streams DATA
+// frames and keeps at most 'window' of them unacknowledged. It never
+// buffers them: the cart is random-access, so a resend just reads the
+// same offset again.
+//   ACK seq   every frame below seq arrived (cumulative)
+//   NAK seq   resend from seq (go-back-N), frames below seq arrived
+//   ABORT     stop the transfer
+// If the device hears nothing for XFER_ACK_TIMEOUT_US it resends from the
+// oldest unacknowledged frame. After DONE, the host ACKs seq = frames + 1.
+// To resume after a disconnect, send START again with 'offset' set to the
+// number of bytes already stored.
+//
+// While a ROM streams the device records the CRC-32 of every 64 KiB block
+// (app/blockmap.h). After the dump the host may send REPAIR for the same
+// region and length. The device reads the cart again and compares each
+// block with its map entry. Blocks that differ are read several more times
+// and settled by a per-word majority vote. Each corrected 4 KiB piece goes
+// out as a DATA frame (seq from 0, 'offset' into the ROM); the host writes
+// it into its file and ACKs seq + 1 before the next piece is sent. Last
+// comes DONE with an xfer_repair_done_t, ACKed like a transfer's DONE.
+//
+// CTRL_STREAM starts the controller stream instead (app/ctrlstream.h).
+// The device polls the controller on a timer and sends SAMPLES frames as
+// soon as polls complete, without waiting for ACKs. 'seq' counts frames
+// and 'offset' is the number of the first sample in the frame. A gap in
+// the sample numbers means samples were dropped before USB. The stream
+// ends on ABORT or when its duration is up. DONE then carries an
+// xfer_ctrl_done_t, which is not acknowledged.
+//
+// PROGRAM writes an image to a repro cart's flash (app/flasher.h) and
+// turns the data direction around. The device answers ACK 0 once the
+// flash is identified, or ERROR. The host then sends the image as PDATA
+// frames (seq from 0, 'offset' = byte offset, even lengths of at most
+// XFER_MAX_PAYLOAD) and the device ACKs seq + 1 for every frame it
+// keeps. A frame out of order gets NAK with the seq it expects, once,
+// and the host goes back to it. The device stops reading USB while the
+// flash is busy, so the host's writes block instead of piling up; it may
+// be silent for up to one sector erase (REPRO_ERASE_TIMEOUT_US). After
+// the last byte DONE carries an xfer_program_done_t, or ERROR if the
+// flash failed. It is not acknowledged.
+//
+// With XFER_PROGRAM_DIFF the device first reads every erase sector that
+// the image covers and sends the list as SECTORS frames ('offset' = index
+// of the first entry), then ACK 0. Each entry has the CRC-32 of the
+// sector as it is on the cart. The host compares it with the same span
+// of its image, padded with 0xFF past the end, and sends PDATA only for
+// sectors that differ, each one whole and from its first byte. Offsets
+// may jump forward to a sector start. An empty PDATA ends the stream
+// early. Sectors that are already blank are programmed without an erase.
+//
+// GATHER reads many small ranges in one round trip (app/gather.h). The
+// payload is a list of xfer_range_t with cart bus addresses (ROM at
+// 0x10000000, SRAM at 0x08000000), in any order, overlaps allowed. The
+// device sorts and merges them into as few bursts as it can and sends
+// the bytes of every range, in request order, as DATA frames: 'seq'
+// from 0 and 'offset' the position in that concatenation. DONE carries
+// an xfer_gather_done_t, or ERROR comes if the list is too long. Nothing
+// is acknowledged; a host that lost a frame sends the GATHER again.
+//
+// During an auto dump to the host (app/autodump.h) the device speaks
+// first. When a new cart has settled in the slot it sends CART with an
+// xfer_cart_t, and repeats it every AUTODUMP_ANNOUNCE_US until a frame
+// comes back. The host dumps what it wants with START as usual, using
+// the sizes from CART, then sends ABORT outside a transfer to say it is
+// done with the cart. An ABORT without any START skips the cart. 'seq'
+// of CART is the cart's number in this auto dump, from 1; a repeat
+// carries the same number.
+// ======================================================================
+
+#define XFER_SOF0            0xA5u
+#define XFER_SOF1            0x5Au
+#define XFER_HEADER_LEN      20u
+#define XFER_MAX_PAYLOAD     4096u
+#define XFER_DEFAULT_PAYLOAD 4096u
+#define XFER_MAX_WINDOW      32u
+#define XFER_DEFAULT_WINDOW  16u
+#define XFER_ACK_TIMEOUT_US  1000000u
+#define XFER_MAX_RETRIES     10u
+
+// Frame types, host → device
+#define XFER_T_START         0x01u
+#define XFER_T_ACK           0x02u
+#define XFER_T_NAK           0x03u
+#define XFER_T_ABORT         0x04u
+#define XFER_T_REPAIR        0x05u   // payload: xfer_repair_t
+#define XFER_T_CTRL_STREAM   0x06u   // payload: xfer_ctrl_stream_t
+#define XFER_T_PROGRAM       0x07u   // payload: xfer_program_t
+#define XFER_T_PDATA         0x08u   // payload: image bytes
+#define XFER_T_GATHER        0x09u   // payload: xfer_range_t[]
+
+// Frame types, device → host
+#define XFER_T_DATA          0x81u
+#define XFER_T_DONE          0x82u   // payload: xfer_done_t
+#define XFER_T_ERROR         0x83u   // payload: message text
+#define XFER_T_SAMPLES       0x84u   // payload: xfer_ctrl_sample_t[]
+#define XFER_T_SECTORS       0x85u   // payload: xfer_sector_t[]
+#define XFER_T_CART          0x86u   // payload: xfer_cart_t
+
+// Regions a START can ask for
+#define XFER_REGION_ROM      0x00u
+#define XFER_REGION_SRAM     0x01u
+#define XFER_REGION_EEPROM   0x02u
+#define XFER_REGION_FLASHRAM 0x03u   // frames and offsets in whole 128-byte pages
+#define XFER_REGION_NONE     0xFFu   // xfer_cart_t: the cart has no save
+
+typedef struct __attribute__((packed)) {
+    uint8_t  sof[2];
+    uint8_t  type;
+    uint8_t  flags;
+    uint32_t seq;
+    uint32_t offset;
+    uint16_t len;
+    uint16_t reserved;
+    uint32_t crc;
+} xfer_header_t;
+
+// START payload; the header's 'offset' is where to (re)start
+typedef struct __attribute__((packed)) {
+    uint8_t  region;        // XFER_REGION_*
+    uint8_t  pad[3];
+    uint32_t length;        // region bytes, 0 = region default (ROM: database
+                            // size, else detected from mirroring)
+    uint16_t frame_size;    // payload bytes per DATA frame, 0 = default
+    uint16_t window;        // frames in flight, 0 = default
+} xfer_start_t;
+
+typedef struct __attribute__((packed)) {
+    uint32_t length;        // region bytes
+    uint32_t crc32;         // CRC-32 of the bytes sent in this transfer
+    uint32_t producer_stalls;   // core 1 found the pipeline ring full
+    uint32_t consumer_stalls;   // core 0 found it empty
+    uint8_t  md5[16];       // MD5 and SHA-1 of the whole region, for DAT
+    uint8_t  sha1[20];      //   matching; zero with XFER_DONE_PARTIAL
+    uint32_t flags;         // XFER_DONE_*
+} xfer_done_t;
+
+// The transfer started past offset 0 (a resume): it cannot hash the whole
+// region, so md5 and sha1 are zero. crc32 still covers the bytes it sent.
+#define XFER_DONE_PARTIAL   0x01u
+
+// REPAIR payload: must name the ROM dump the block map was taken from
+typedef struct __attribute__((packed)) {
+    uint8_t  region;        // XFER_REGION_ROM
+    uint8_t  pad[3];
+    uint32_t length;        // ROM bytes of that dump
+} xfer_repair_t;
+
+// DONE payload after a REPAIR
+typedef struct __attribute__((packed)) {
+    uint32_t blocks;        // 64 KiB blocks checked
+    uint32_t suspects;      // blocks whose re-read did not match the map
+    uint32_t repaired;      // pieces sent as DATA
+    uint32_t unresolved;    // pieces where some word had no majority
+    uint32_t crc32;         // CRC-32 of the whole ROM with the repairs applied
+} xfer_repair_done_t;
+
+// CTRL_STREAM payload
+typedef struct __attribute__((packed)) {
+    uint16_t rate_hz;       // polls per second, 0 = 1000
+    uint16_t max_batch;     // samples per SAMPLES frame at most, 0 = 32
+    uint32_t duration_ms;   // 0 = until ABORT
+} xfer_ctrl_stream_t;
+
+typedef struct __attribute__((packed)) {
+    uint32_t t_us;          // poll sent, device clock
+    uint16_t buttons;       // controller_state_t.buttons
+    int8_t   x, y;
+} xfer_ctrl_sample_t;
+
+// Histograms: bucket i counts values of 2^i .. 2^(i+1)-1 µs. Bucket 0
+// also counts 0 and the last bucket everything above it.
+#define XFER_CTRL_HIST_BUCKETS 16u
+
+// DONE payload after a controller stream
+typedef struct __attribute__((packed)) {
+    uint32_t polls;         // polls put on the wire
+    uint32_t samples;       // samples sent
+    uint32_t timeouts;      // polls the controller did not answer
+    uint32_t overruns;      // timer ticks skipped, previous poll still busy
+    uint32_t dropped;       // samples lost to a full buffer before USB
+    uint32_t latency_max_us;
+    uint32_t jitter_max_us;
+    uint32_t latency[XFER_CTRL_HIST_BUCKETS];  // poll sent → frame handed to USB
+    uint32_t jitter[XFER_CTRL_HIST_BUCKETS];   // |poll interval - period|
+} xfer_ctrl_done_t;
+
+// PROGRAM payload
+#define XFER_PROGRAM_DIFF    0x01u   // only sectors that differ (see above)
+
+typedef struct __attribute__((packed)) {
+    uint32_t length;        // image bytes, even, at most the flash size
+    uint32_t crc32;         // CRC-32 of the PDATA bytes to come, 0 = not checked
+    uint32_t flags;         // XFER_PROGRAM_*
+} xfer_program_t;
+
+// One erase sector of the flash, as found before a XFER_PROGRAM_DIFF
+#define XFER_SECTOR_BLANK    0x01u
+
+typedef struct __attribute__((packed)) {
+    uint32_t offset;
+    uint32_t size;
+    uint32_t crc32;         // of the whole sector
+    uint8_t  flags;         // XFER_SECTOR_*
+    uint8_t  pad[3];
+} xfer_sector_t;
+
+// DONE payload after a PROGRAM
+typedef struct __attribute__((packed)) {
+    uint32_t length;
+    uint32_t crc32;         // CRC-32 of the PDATA bytes received
+    uint32_t flash_crc32;   // CRC-32 read back from the flash after each slot
+    uint32_t producer_stalls;   // USB waited for the flash
+    uint32_t consumer_stalls;   // the flash waited for USB
+    uint32_t naks;          // frames asked for again
+    uint32_t us;            // PROGRAM to DONE
+    uint32_t erased;        // sectors erased
+    uint32_t blank;         // sectors written without an erase
+} xfer_program_done_t;
+
+// GATHER limits: the request fits one frame, the answer one buffer
+#define XFER_GATHER_MAX_RANGES  64u
+#define XFER_GATHER_MAX_BYTES   16384u  // sum of the range lengths
+
+typedef struct __attribute__((packed)) {
+    uint32_t addr;          // cart bus address
+    uint32_t len;           // bytes, any alignment
+} xfer_range_t;
+
+// DONE payload after a GATHER
+typedef struct __attribute__((packed)) {
+    uint32_t ranges;        // ranges asked for
+    uint32_t runs;          // merged runs, each one burst (or a few past the burst length)
+    uint32_t bytes;         // bytes sent
+    uint32_t bus_bytes;     // bytes read from the cart, gaps included
+    uint32_t us;            // GATHER to DONE
+} xfer_gather_done_t;
+
+// CART payload
+typedef struct __attribute__((packed)) {
+    uint32_t crc1, crc2;    // header 0x10 / 0x14
+    char     cart_id[4];    // header 0x3B, as stored
+    uint8_t  version;
+    uint8_t  save_region;   // XFER_REGION_*, or XFER_REGION_NONE
+    uint8_t  pad[2];
+    uint32_t rom_bytes;     // for START
+    uint32_t save_bytes;
+} xfer_cart_t;
+
+// Frame I/O for the other binary modes
+void xfer_send(uint8_t type, uint32_t seq, uint32_t offset,
+               const void *payload, uint16_t len);
+// Type of the next complete host frame, without blocking; -1 if none yet
+int  xfer_poll(void);
+// Wait up to wait_us for the next complete frame, storing up to 'max'
+// payload bytes straight into 'payload'. Longer frames are dropped. Keep
+// passing the same buffer until a frame completes.
+bool xfer_recv(xfer_header_t *h, void *payload, uint16_t max, uint32_t wait_us);
+
+// Wait up to wait_us for a START (REPAIR, CTRL_STREAM, PROGRAM, GATHER) frame and run what it asks for.
+// 'first' is a byte the caller already consumed (the CLI passes the SOF
+// it saw in its input), or -1. Returns the type of the frame that came,
+// whether it was run or not, or -1 if none did.
+int  xfer_session(int first, uint32_t wait_us);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* APP_XFER_H_ */
@@ -28,15 +28,37 @@
 // Bitmask for GPIO AD0–AD15: (1<<16)-1 shifted by start
 #define AD_BUS_MASK          (((1u << AD_BUS_PIN_COUNT) - 1) << AD_BUS_PIN_START)
 
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
 // Declare the functions that interact directly with the N64 cartridge bus.
 void n64_reset();
 void n64_adBus_init();
+void adBus_pads_init(void);
 void adBus_dir(bool out);
 void adBus_set_address(uint32_t addr);
 uint16_t n64_read16();
+
+// Transactions: latch once, then N words with the cart auto-incrementing.
+// adBus_latch() skips ALE_H when the high half is already latched and the
+// cart's counter has not left it; adBus_set_address() always latches both.
+void adBus_latch(uint32_t addr);
+void adBus_read_words(uint32_t addr, uint16_t *dst, size_t n);
+void adBus_write_words(uint32_t addr, const uint16_t *src, size_t n);
+void adBus_note_burst(size_t words);   // a PIO burst advanced the counter
+
+typedef struct {
+    uint32_t latch_full_ns;     // ALE_H + ALE_L
+    uint32_t latch_lo_ns;       // ALE_L only (high half reused)
+    uint32_t read_word_ns;      // n64_read16() with the active timing
+    uint32_t burst_word_ns;     // PIO + DMA burst, per word
+} ad_bus_bench_t;
+
+// Time the bus primitives against ROM (read-only, so nothing is written)
+void adBus_benchmark(ad_bus_bench_t *out);
 uint16_t sram_read_word(uint32_t addr);
 void dump_sram_to_stdio(void);
 void write_first_32_bytes();
-void critical_delay_nops(int nops_count);
 
 #endif // AD_BUS_H_
\ No newline at end of file
@@ -0,0 +1,45 @@
+/* ad_bus_pio.h */
+#ifndef AD_BUS_PIO_H_
+#define AD_BUS_PIO_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// ======================================================================
+// PIO + DMA read engine for the N64 AD bus
+// Purpose: Clock sequential ROM/SRAM words with a PIO state machine that
+//          owns /RD, while a DMA channel drains the samples into memory.
+//          The CPU only latches the start address (adBus_set_address())
+//          and arms the transfer; it is free until the burst completes.
+// ======================================================================
+
+// PIO block / state machine used by the engine. pio0 sm0 and pio1 sm1 are
+// taken by the joybus EEPROM data and clock programs.
+#define AD_BUS_PIO_BLOCK         pio1
+#define AD_BUS_PIO_SM            0
+
+// Default /RD low → AD sample time in SM cycles (125 MHz → 8 ns/cycle).
+// 55 cycles = 440 ns, the same T_acs(RD) used by n64_read16(). Bursts use
+// the active profile's access time (see ad_bus_timing.h).
+// The three instruction cycles between "set pins, 0" and "in pins, 16" are
+// absorbed by the one-cycle output and two-cycle input-synchroniser latency,
+// so the descriptor delay equals the effective access time.
+#define AD_BUS_PIO_ACCESS_CYCLES 55u
+
+// Fixed SM cycles per word on top of the access delay (see ad_bus.pio)
+#define AD_BUS_PIO_WORD_OVERHEAD 12u
+
+// Largest burst one descriptor can describe (16-bit count field)
+#define AD_BUS_PIO_MAX_WORDS     65536u
+
+// Build a burst descriptor for the ad_bus_read program
+#define AD_BUS_PIO_DESC(words, access_cycles) \
+    (((uint32_t)(access_cycles) << 16) | (((uint32_t)(words) - 1u) & 0xFFFFu))
+
+void ad_bus_pio_init(void);
+void ad_bus_pio_read_start(uint8_t *dst, size_t words);
+bool ad_bus_pio_busy(void);
+void ad_bus_pio_read_wait(void);
+
+#endif // AD_BUS_PIO_H_
@@ -0,0 +1,49 @@
+/* ad_bus_timing.h */
+#ifndef AD_BUS_TIMING_H_
+#define AD_BUS_TIMING_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include <bus/ad_bus_pio.h>
+
+// ======================================================================
+// AD bus timing profile
+// Purpose: Every bus delay is a cycle count (125 MHz → 8 ns/cycle) taken
+//          from the active profile instead of a fixed NOP loop. The
+//          defaults are the datasheet values. adBus_calibrate() shortens
+//          /RD access and the ALE setup/hold for the cart in the slot and
+//          adds a safety margin back. Calibrated ROM access applies to ROM
+//          addresses only; SRAM and other regions keep the default.
+// ======================================================================
+
+typedef struct {
+    uint16_t access_cycles;      // /RD low → AD sampled (T_acs)
+    uint16_t hold_cycles;        // /RD high before the next access (T_h)
+    uint16_t latch_cycles;       // AD setup and hold around each ALE edge
+    uint16_t turnaround_cycles;  // bus released to the cart → first /RD
+} ad_bus_timing_t;
+
+// 440 ns access, 56 ns hold and latch, 32 ns turnaround
+#define AD_BUS_TIMING_DEFAULT { AD_BUS_PIO_ACCESS_CYCLES, 7u, 7u, 4u }
+
+typedef struct {
+    ad_bus_timing_t fastest;     // shortest settings that read back stable
+    ad_bus_timing_t applied;     // fastest + margin, now active
+    uint32_t        reads;       // reference reads it took
+} ad_bus_cal_result_t;
+
+extern ad_bus_timing_t adBus_timing;      // active profile
+
+// Back to the datasheet profile (new cart, failed calibration)
+void adBus_timing_reset(void);
+
+// /RD access time for the address latched last
+uint16_t adBus_access_cycles(void);
+
+// Sweep the cart in the slot and apply the result. Returns false (and
+// keeps the defaults) when the reference reads are not repeatable even
+// at the default timing, e.g. with no cart inserted.
+bool adBus_calibrate(ad_bus_cal_result_t *res);
+
+#endif // AD_BUS_TIMING_H_
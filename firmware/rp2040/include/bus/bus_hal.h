@@ -0,0 +1,40 @@
+/* bus_hal.h */
+#ifndef BUS_HAL_H_
+#define BUS_HAL_H_
+
+#include <stdint.h>
+
+// ======================================================================
+// Bus Hardware Abstraction Layer
+// Purpose: The only place the AD bus code touches GPIO registers.
+//          RP2040 builds map each call straight onto SIO; host builds
+//          (N64_HOST=1) route them into the simulated cartridge in host/.
+// ======================================================================
+
+#if defined(N64_HOST) && N64_HOST
+
+void     bus_hal_gpio_set(uint32_t mask);   // drive masked outputs HIGH
+void     bus_hal_gpio_clr(uint32_t mask);   // drive masked outputs LOW
+uint32_t bus_hal_gpio_in(void);             // sample all GPIO levels
+void     bus_hal_oe_set(uint32_t mask);     // masked pins become outputs
+void     bus_hal_oe_clr(uint32_t mask);     // masked pins become inputs
+void     bus_hal_delay_cycles(uint32_t cycles); // busy-wait at least 'cycles'
+
+#else
+
+#include "pico/platform.h"
+#include "hardware/structs/sio.h"
+
+static inline void     bus_hal_gpio_set(uint32_t mask) { sio_hw->gpio_set = mask; }
+static inline void     bus_hal_gpio_clr(uint32_t mask) { sio_hw->gpio_clr = mask; }
+static inline uint32_t bus_hal_gpio_in(void)           { return sio_hw->gpio_in; }
+static inline void     bus_hal_oe_set(uint32_t mask)   { sio_hw->gpio_oe_set = mask; }
+static inline void     bus_hal_oe_clr(uint32_t mask)   { sio_hw->gpio_oe_clr = mask; }
+
+static inline void bus_hal_delay_cycles(uint32_t cycles) {
+    busy_wait_at_least_cycles(cycles);   // 3-cycle loop, exact to a few cycles
+}
+
+#endif
+
+#endif // BUS_HAL_H_
@@ -0,0 +1,99 @@
+/* bus_perf.h – cycle counters and a trace ring for the bus hot paths */
+#ifndef BUS_PERF_H_
+#define BUS_PERF_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ======================================================================
+// Bus instrumentation
+// Purpose: Show where dump time goes. BUS_PERF_BEGIN/END wrap each hot
+//          path (address latch, AD direction change, /RD and /WR cycle,
+//          PIO burst, joybus transaction, EEPROM busy poll, USB frame
+//          write). Each pair adds one count and its cycles to a counter,
+//          and appends an event to the trace ring of the core it ran on.
+//          Cycles come from each core's SysTick at clk_sys, so a span
+//          must stay under 2^24 cycles (134 ms).
+//          Builds without N64_PERF=1 (the default) expand the macros to
+//          nothing and keep only stubs for the CLI.
+//          Spans nest: a latch includes its two direction changes.
+// ======================================================================
+
+typedef enum {
+    BUS_PERF_LATCH_FULL,        // ALE_H + ALE_L; arg: address
+    BUS_PERF_LATCH_LO,          // ALE_L only; arg: address
+    BUS_PERF_DIR,               // adBus_dir(); arg: 1 = Pico drives
+    BUS_PERF_RD,                // one /RD word cycle
+    BUS_PERF_WR,                // one /WR word cycle
+    BUS_PERF_BURST,             // PIO + DMA burst; arg: bytes
+    BUS_PERF_JOYBUS,            // EEPROM transaction; arg: command
+    BUS_PERF_EEP_BUSY,          // polling a write to completion
+    BUS_PERF_USB_TX,            // one xfer frame into the CDC; arg: bytes
+    BUS_PERF_EVENTS
+} bus_perf_event_t;
+
+typedef struct {
+    uint32_t count;
+    uint64_t cycles;
+    uint32_t max_cycles;
+} bus_perf_counter_t;
+
+typedef struct {
+    uint32_t t_us;              // end of the span, timer µs
+    uint32_t arg;
+    uint32_t cycles;
+    uint8_t  event;             // bus_perf_event_t
+    uint8_t  core;
+    uint8_t  pad[2];
+} bus_perf_trace_t;
+
+// Entries per core; 0 leaves the counters only
+#ifndef BUS_PERF_TRACE_DEPTH
+#define BUS_PERF_TRACE_DEPTH    256u
+#endif
+
+// Short name of an event, for printing
+const char *bus_perf_name(unsigned event);
+
+// Start the cycle counter on the calling core (both cores call it)
+void bus_perf_init(void);
+
+// Copy the counters, then zero them. False in builds without N64_PERF.
+bool bus_perf_take(bus_perf_counter_t out[BUS_PERF_EVENTS]);
+
+// The most recent trace entries of both cores, oldest first; returns
+// how many were copied (at most 'max'), then empties the rings
+unsigned bus_perf_take_trace(bus_perf_trace_t *out, unsigned max);
+
+#if defined(N64_PERF) && N64_PERF
+
+#define BUS_PERF_CYCLE_MASK   0x00FFFFFFu
+
+// Cycles, 24 bits, counting up
+#if defined(N64_HOST) && N64_HOST
+uint32_t bus_perf_now(void);          // the simulated clock (host/sim_core.c)
+#else
+#include "hardware/structs/systick.h"
+static inline uint32_t bus_perf_now(void) { return BUS_PERF_CYCLE_MASK - systick_hw->cvr; }
+#endif
+
+void bus_perf_end(unsigned event, uint32_t start, uint32_t arg);
+
+#define BUS_PERF_BEGIN(t)             uint32_t t = bus_perf_now()
+#define BUS_PERF_END(event, t, arg)   bus_perf_end((event), (t), (uint32_t)(arg))
+
+#else
+
+#define BUS_PERF_BEGIN(t)             do { } while (0)
+#define BUS_PERF_END(event, t, arg)   do { } while (0)
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* BUS_PERF_H_ */
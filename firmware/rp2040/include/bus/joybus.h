@@ -8,6 +8,9 @@
 
 #pragma once
 
+#include <stdint.h>
+#include <stdbool.h>
+
 // EEPROM pins
 #define EEP_DAT              21
 #define EEP_CLK              22
@@ -17,7 +20,29 @@ void n64_joyBus_reset();
 void n64_eep_init();
 void InitEeprom(uint dataPin);
 void InitEepromClock(uint clockpin);
+
+// Ask the cart for its EEPROM again (one info command, no line reset);
+// returns the size in bytes, 0 if none answers. n64_eep_set_size() takes
+// a size known from elsewhere (512 or 2048, anything else means none).
+uint32_t n64_eep_detect(void);
+void     n64_eep_set_size(uint32_t bytes);
+
+// Block = 8 bytes. 4 Kbit parts have 64 blocks, 16 Kbit parts 256.
+bool ReadEepromBlocks(uint32_t first, uint32_t count, uint8_t *buffer);
+bool WriteEepromBlocks(uint32_t first, uint32_t count, const uint8_t *buffer);
+
+// 64 blocks (512 bytes) starting at block 'offset'
 void ReadEepromData(uint32_t offset, uint8_t *buffer);
 void WriteEepromData(uint32_t offset, uint8_t *buffer);
 
+// Last ReadEepromBlocks()/WriteEepromBlocks() call
+typedef struct {
+    uint32_t blocks;
+    uint32_t us;            // wall time for all of them
+    uint32_t retries;       // commands that timed out and were resent
+    uint32_t polls;         // status polls that found a write in progress
+} eep_stats_t;
+
+void GetEepromStats(eep_stats_t *out);
+
 extern uint32_t gEepromSize;
\ No newline at end of file
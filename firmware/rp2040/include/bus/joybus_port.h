@@ -0,0 +1,81 @@
+/* joybus_port.h */
+#ifndef JOYBUS_PORT_H_
+#define JOYBUS_PORT_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "pico/stdlib.h"
+#include "hardware/pio.h"
+
+// ======================================================================
+// Joybus transaction engine
+// Purpose: One PIO state machine per joybus line (cart EEPROM,
+//          controller port). Transactions are queued per port. A DMA
+//          channel feeds the encoded command and a second drains the
+//          reply. The reply's DMA completion interrupt finishes the
+//          transaction, and an alarm starts the next one once the
+//          device's stop bit is over. A missing reply is ended by a
+//          timeout alarm. Nothing blocks on the FIFOs.
+// ======================================================================
+
+#define JOYBUS_MAX_TX      36u       // pak write: cmd + addr(2) + 32 data
+#define JOYBUS_MAX_RX      33u       // pak read: 32 data + CRC
+#define JOYBUS_MAX_PORTS   2u
+
+typedef enum {
+    JOYBUS_IDLE = 0,                 // never submitted
+    JOYBUS_QUEUED,
+    JOYBUS_ACTIVE,                   // on the wire
+    JOYBUS_OK,
+    JOYBUS_TIMEOUT,                  // no (complete) reply
+} joybus_status_t;
+
+typedef struct joybus_xfer joybus_xfer_t;
+
+// Completion callback; runs in interrupt context
+typedef void (*joybus_done_t)(joybus_xfer_t *x);
+
+struct joybus_xfer {
+    uint8_t           tx[JOYBUS_MAX_TX];
+    uint8_t           rx[JOYBUS_MAX_RX];
+    uint8_t           tx_len;
+    uint8_t           rx_len;        // at least 1
+    volatile uint8_t  status;        // joybus_status_t
+    joybus_done_t     done;          // may be NULL
+    void             *user;
+    uint32_t          t_start;       // µs: command put on the wire
+    uint32_t          t_end;         // µs: last reply byte received
+    joybus_xfer_t    *next;          // queue link, owned by the port
+};
+
+typedef struct {
+    PIO               pio;
+    uint              sm;
+    uint              pin;
+    uint              offset;        // joybus program in this PIO block
+    int               dma_tx, dma_rx;
+    joybus_xfer_t    *head, *tail;   // head is on the wire (or waiting for the guard)
+    alarm_id_t        alarm;         // timeout while active, stop guard after
+    bool              guard;         // line still busy with the device's stop bit
+    uint32_t          tx_words[JOYBUS_MAX_TX / 2u + 1u];
+    uint32_t          completed;
+    uint32_t          timeouts;
+} joybus_port_t;
+
+// Claim the state machine and two DMA channels and set the line up. The
+// program is loaded once per PIO block and shared by its ports.
+void joybus_port_init(joybus_port_t *p, PIO pio, uint sm, uint pin);
+
+// Queue a transaction; tx/tx_len/rx_len/done/user must be filled in.
+// Safe to call from a completion callback.
+void joybus_submit(joybus_port_t *p, joybus_xfer_t *x);
+
+// Spin until a submitted transaction has finished. True on a reply.
+bool joybus_wait(joybus_xfer_t *x);
+
+// Submit and wait: the blocking form for one-off commands
+bool joybus_transact(joybus_port_t *p, const uint8_t *cmd, uint len,
+                     uint8_t *reply, uint reply_len);
+
+#endif // JOYBUS_PORT_H_
@@ -4,21 +4,38 @@
 #define N64_TITLE_OFFSET 0x20
 #define N64_TITLE_LENGTH 20
 #define N64_HEADER_LENGTH 64
+#define N64_CRC1_OFFSET 0x10
+#define N64_PI_CONFIG_BYTE 0x80     // header byte 0 on every cart
+#define N64_ROM_MAX_BYTES (64u * 1024u * 1024u)
+
+// Burst reads: the ATmega reader re-latches every 512 B; the probe goes
+// below that in case a cart needs it. Past a 4 KiB pipeline slot a longer
+// burst saves nothing.
+#define N64_BURST_MIN_BYTES     64u
+#define N64_BURST_DEFAULT_BYTES 1024u
+#define N64_BURST_MAX_BYTES     4096u
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 bool n64_read_bytes(uint32_t base_addr, uint8_t *buf, size_t len);
 bool n64_read_bytes_fast(uint32_t base_addr, uint8_t *buf, size_t len);
+size_t n64_get_burst_bytes(void);
+void n64_set_burst_bytes(size_t bytes);     // rounded down to a power of two
+size_t n64_probe_burst_bytes(void);         // longest verified burst, applied
+bool n64_check_burst_bytes(size_t len);     // one such burst still reads right
 bool n64_get_header(uint8_t* buffer, size_t buffer_size);
 bool n64_get_title(uint8_t* buffer, size_t buffer_size);
+bool n64_get_crc1(uint32_t *crc1);
+bool n64_cart_present(uint32_t *crc1);  // cheap presence check; crc1 optional
+uint32_t n64_detect_rom_size(void);   // bytes, from mirror probing
 // bool n64_rom_dump     (uint32_t offset, void *dst, size_t len);
 // bool n64_sram_read    (uint32_t offset, void *dst, size_t len);
 // bool n64_sram_write   (uint32_t offset, const void *src, size_t len);
-// bool n64_flash_read   (uint32_t offset, void *dst, size_t len);
-// bool n64_flash_write  (uint32_t offset, const void *src, size_t len);
-bool n64_eeprom_read  (uint16_t addr, uint8_t *dst, size_t len);
-// bool n64_eeprom_write (uint16_t addr, const uint8_t *src, size_t len);
+bool n64_flash_read   (uint32_t offset, void *dst, size_t len);        // see flashram.h
+bool n64_flash_write  (uint32_t offset, const void *src, size_t len);
+bool n64_eeprom_read  (uint16_t addr, uint8_t *dst, size_t len);     // whole 8-byte blocks
+bool n64_eeprom_write (uint16_t addr, const uint8_t *src, size_t len);
 
 #ifdef __cplusplus
 } /* extern "C" */
@@ -1,12 +1,74 @@
 #ifndef DEVICES_CONTROLLER_H_
 #define DEVICES_CONTROLLER_H_
 
+#include <stdint.h>
 #include <stdbool.h>
 
+#include <bus/joybus_port.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+// ======================================================================
+// N64 controller port (joybus on CTRL_DAT)
+// Purpose: Status, poll and controller pak access on top of the queued
+//          joybus engine. Pak blocks are 32 bytes. The address carries a
+//          5-bit CRC in its low bits, and every data block is checked
+//          with an 8-bit CRC. Both CRCs come from lookup tables. Pak
+//          reads keep several blocks queued, so the port never idles
+//          between them.
+// ======================================================================
+
+#define CTRL_DAT                26       // controller data line, pulled up to 3V3
+#define CTRL_SM                 1        // pio0; the EEPROM has sm0
+
+#define CTRL_CMD_INFO           0x00u
+#define CTRL_CMD_POLL           0x01u
+#define CTRL_CMD_PAK_READ       0x02u
+#define CTRL_CMD_PAK_WRITE      0x03u
+
+#define CTRL_PAK_BYTES          0x8000u  // controller pak SRAM
+#define CTRL_PAK_BLOCK          32u
+
+// Info byte 2
+#define CTRL_STATUS_PAK         0x01u    // something is in the accessory slot
+#define CTRL_STATUS_NO_PAK      0x02u
+
+typedef struct {
+    uint16_t id;                // 0x0500 for a standard controller
+    uint8_t  status;            // CTRL_STATUS_*
+} controller_info_t;
+
+typedef struct {
+    uint16_t buttons;           // A B Z Start, D-pad, L R, C buttons; high byte first on the wire
+    int8_t   x, y;              // analog stick
+} controller_state_t;
+
+// Claim the port (pio0 sm1 on CTRL_DAT)
+void controller_init(void);
+joybus_port_t *controller_port(void);
+
+bool controller_info(controller_info_t *out);
+bool controller_poll(controller_state_t *out);
+
+// Queue a poll; 'done' runs in interrupt context once the reply is in
+void controller_poll_submit(joybus_xfer_t *x, joybus_done_t done, void *user);
+void controller_poll_decode(const joybus_xfer_t *x, controller_state_t *out);
+
+// One 32-byte block; addr is block aligned. False on a timeout or a data
+// CRC mismatch (the CRC comes back inverted when no pak is inserted).
+bool controller_pak_read(uint16_t addr, uint8_t *dst);
+bool controller_pak_write(uint16_t addr, const uint8_t *src);
+
+// Whole blocks, pipelined. False without a read if addr or len is not a
+// multiple of CTRL_PAK_BLOCK.
+bool controller_pak_read_range(uint16_t addr, uint32_t len, uint8_t *dst);
+
+// Address as sent: block address with its CRC in bits 4..0
+uint16_t controller_addr_crc(uint16_t addr);
+uint8_t  controller_data_crc(const uint8_t *block);
+
 #ifdef __cplusplus
 } /* extern "C" */
 #endif
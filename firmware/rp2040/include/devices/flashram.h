@@ -0,0 +1,59 @@
+#ifndef DEVICES_FLASHRAM_H_
+#define DEVICES_FLASHRAM_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// ======================================================================
+// FlashRAM saves (1 Mbit, in the save window at 0x0800'0000)
+// Purpose: Commands are written as two halfwords to the command register.
+//          Data moves in 128-byte pages, each one latch plus a sequential
+//          burst. Erase and program completion is read from the status
+//          register: the part answers with its silicon ID once it is idle,
+//          so the driver polls for that instead of sleeping a fixed time.
+// ======================================================================
+
+#define FLASHRAM_BYTES          (128u * 1024u)
+#define FLASHRAM_PAGE_BYTES     128u
+#define FLASHRAM_SECTOR_BYTES   (16u * 1024u)
+#define FLASHRAM_PAGES          (FLASHRAM_BYTES / FLASHRAM_PAGE_BYTES)
+#define FLASHRAM_CMD_REG        0x08010000u
+
+// Commands (the low half carries a page number where one is needed)
+#define FLASHRAM_CMD_EXECUTE    0xD2000000u
+#define FLASHRAM_CMD_STATUS     0xE1000000u
+#define FLASHRAM_CMD_READ       0xF0000000u
+#define FLASHRAM_CMD_PAGE_LOAD  0xB4000000u   // next 128 bytes go to the page buffer
+#define FLASHRAM_CMD_PROGRAM    0xA5000000u   // | page
+#define FLASHRAM_CMD_SECTOR     0x4B000000u   // | page inside the sector
+#define FLASHRAM_CMD_ERASE      0x78000000u   // erase the selected sector
+#define FLASHRAM_CMD_CHIP_ERASE 0x3C000000u
+
+// Longest a single operation may keep the part busy
+#define FLASHRAM_PROGRAM_TIMEOUT_US  20000u
+#define FLASHRAM_ERASE_TIMEOUT_US    3000000u
+
+typedef struct {
+    uint8_t     id[8];          // status register as read in status mode
+    const char *name;
+    uint8_t     addr_shift;     // 1 = byte addressed, 2 = MX29L1100 (half)
+} flashram_info_t;
+
+// Read the silicon ID. False when the save window does not answer with a
+// known FlashRAM; the other calls need a successful identify first. This
+// writes the command register, so only call it for carts that are meant
+// to have a FlashRAM: some SRAM boards do not decode that address fully.
+bool flashram_identify(flashram_info_t *out);
+
+// Offsets and lengths are multiples of FLASHRAM_PAGE_BYTES
+bool flashram_read(uint32_t offset, uint8_t *dst, size_t len);
+bool flashram_program_page(uint32_t page, const uint8_t *src);
+bool flashram_erase_sector(uint32_t sector);
+bool flashram_erase_chip(void);
+
+// Erase whole sectors, program and read back. Offset and length are
+// multiples of FLASHRAM_SECTOR_BYTES.
+bool flashram_write(uint32_t offset, const uint8_t *src, size_t len);
+
+#endif /* DEVICES_FLASHRAM_H_ */
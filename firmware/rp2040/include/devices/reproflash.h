@@ -0,0 +1,81 @@
+#ifndef DEVICES_REPROFLASH_H_
+#define DEVICES_REPROFLASH_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// ======================================================================
+// Repro cart flash (NOR chips in the ROM window at 0x1000'0000)
+// Purpose: Identify the flash the way the ATmega reader's idFlashrom_N64()
+//          does and describe it with a table entry: command set, chip
+//          size, sector layout and write buffer. Programming loads whole
+//          write buffers with one address latch each. Erase and program
+//          completion is polled on the chip's status bits, with only an
+//          upper bound per operation.
+// ======================================================================
+
+#define REPRO_MAX_CHIPS             2u
+#define REPRO_MAX_BUFFER_BYTES      128u
+
+#define REPRO_PROGRAM_TIMEOUT_US    20000u
+#define REPRO_ERASE_TIMEOUT_US      5000000u
+
+typedef enum {
+    REPRO_CMD_AMD = 0,          // x16, AA/55 unlock at 0x555/0x2AA
+    REPRO_CMD_AMD_X2,           // two x8 parts side by side: every command doubled
+    REPRO_CMD_INTEL,            // 60/D0 unlock, 20/D0 erase, E8 buffer, status register
+} repro_cmdset_t;
+
+typedef enum {
+    REPRO_BOOT_NONE = 0,        // uniform sectors
+    REPRO_BOOT_BOTTOM,          // small sectors at the start of the chip
+    REPRO_BOOT_TOP,             // small sectors at the end of the chip
+} repro_boot_t;
+
+typedef struct {
+    const char *name;
+    uint16_t    flash_id;       // autoselect word 1
+    uint16_t    cart_id;        // low bytes of words 0x0E and 0x0F, 0 = any
+    uint8_t     cmdset;         // repro_cmdset_t
+    uint8_t     chip_mb;        // one chip
+    uint8_t     max_chips;      // 2: a second chip may sit chip_mb further in
+    uint16_t    buffer_bytes;   // write buffer, 0 = one word per program command
+    uint32_t    sector_bytes;   // main sectors
+    uint8_t     boot;           // repro_boot_t
+    uint8_t     boot_count;
+    uint32_t    boot_bytes;     // size of each boot sector
+} repro_chip_t;
+
+typedef struct {
+    const repro_chip_t *chip[REPRO_MAX_CHIPS];   // a second chip may differ (Intel 8816 + 8813)
+    uint8_t  chips;
+    uint32_t bytes;             // whole cart
+    uint16_t vendor;
+    uint16_t flash_id;          // of the first chip
+    uint16_t cart_id;
+} repro_info_t;
+
+// Read the IDs and look the chip up; a second chip is looked for one chip
+// size in. False for a mask ROM or an unknown part ('out' still gets the
+// IDs that were read).
+bool repro_identify(repro_info_t *out);
+
+// Sector holding 'offset' (bytes from the ROM base). False past the end.
+bool repro_sector(uint32_t offset, uint32_t *start, uint32_t *size);
+
+bool repro_erase_sector(uint32_t offset);
+
+// Program an erased range; offset and len are even. Whole write buffers
+// where the range allows, single words elsewhere. Buffers (or words)
+// that are all 0xFF are left as erased.
+bool repro_program(uint32_t offset, const uint8_t *src, size_t len);
+
+// Program in stream order: each sector is erased when the writes reach
+// its first byte, unless 'erase' is false (the caller knows it is blank).
+bool repro_write(uint32_t offset, const uint8_t *src, size_t len, bool erase);
+
+// Back to read-array mode
+void repro_reset(void);
+
+#endif /* DEVICES_REPROFLASH_H_ */
@@ -0,0 +1,97 @@
+/* fat32.h – just enough FAT32 to create preallocated files */
+#ifndef STORAGE_FAT32_H_
+#define STORAGE_FAT32_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ======================================================================
+// FAT32 on the SD card
+// Purpose: Create a file in the root directory as one contiguous cluster
+//          run of its final size, so the data can go to the card as a
+//          single multi-block write to known blocks, with no FAT traffic
+//          in between. The free run is found by reading the FAT in
+//          multi-block batches, starting at the FSInfo hint. Both FAT
+//          copies are written, then the directory entries (long name
+//          plus an 8.3 alias). The entry says 0 bytes until the writer
+//          sets the size it actually wrote, so an interrupted file never
+//          looks complete.
+//          No subdirectories, no deletes, no appends; a PC does those.
+// ======================================================================
+
+#define FAT32_DIR_ENTRY_BYTES   32u
+#define FAT32_LFN_CHARS         13u           // per long-name entry
+#define FAT32_NAME_MAX          255u
+#define FAT32_MAX_ENTRIES       21u           // 255 chars of LFN + the 8.3 entry
+
+#define FAT32_ATTR_READ_ONLY    0x01u
+#define FAT32_ATTR_VOLUME_ID    0x08u
+#define FAT32_ATTR_DIRECTORY    0x10u
+#define FAT32_ATTR_ARCHIVE      0x20u
+#define FAT32_ATTR_LFN          0x0Fu
+
+// There is no clock; files get this timestamp (2024-01-01 00:00)
+#define FAT32_DATE              ((uint16_t)((2024u - 1980u) << 9 | 1u << 5 | 1u))
+#define FAT32_TIME              0u
+
+typedef struct {
+    uint32_t part_lba;          // volume boot record
+    uint32_t fat_lba;           // first FAT
+    uint32_t fat_blocks;        // per copy
+    uint8_t  fats;
+    uint8_t  spc;               // blocks per cluster
+    uint32_t data_lba;          // cluster 2
+    uint32_t clusters;          // data clusters
+    uint32_t root_cluster;
+    uint32_t fsinfo_lba;        // 0 = none
+    uint32_t free_hint;         // where to start looking for free clusters
+} fat32_vol_t;
+
+typedef struct {
+    uint32_t cluster;           // first cluster, 0 for an empty file
+    uint32_t first_lba;
+    uint32_t blocks;            // covering 'bytes'; the cluster run may be longer
+    uint32_t bytes;             // allocated
+    uint32_t dir_cluster;       // where the 8.3 entry is
+    unsigned dir_index;
+} fat32_file_t;
+
+// Find the volume: a FAT32 partition in the MBR, or a card formatted
+// without one. False, with a reason in 'err', if there is none.
+bool fat32_mount(fat32_vol_t *v, const char **err);
+
+// Whether the root directory has an entry with this name (long name or
+// 8.3 alias, case-insensitive)
+bool fat32_exists(fat32_vol_t *v, const char *name, const char **err);
+
+// Create 'name' in the root directory with 'bytes' allocated as one
+// contiguous run and a size of 0. The contents are whatever the clusters
+// held; the caller writes all of out->blocks from out->first_lba, then
+// sets the size.
+bool fat32_create(fat32_vol_t *v, const char *name, uint32_t bytes,
+                  fat32_file_t *out, const char **err);
+
+// Set the size in the file's directory entry, at most what was allocated
+bool fat32_set_size(const fat32_vol_t *v, const fat32_file_t *f, uint32_t bytes,
+                    const char **err);
+
+// ---- Directory entry helpers (also for volumes built in memory) ----
+
+// 8.3 alias for a long name, with a "~tail" when tail > 0. True if the
+// alias is lossy and the name needs long-name entries.
+bool     fat32_short_name(const char *name, unsigned tail, uint8_t sfn[11]);
+uint8_t  fat32_lfn_checksum(const uint8_t sfn[11]);
+// Long-name entries for 'name' (NULL when the alias says it all) followed
+// by the 8.3 entry, in on-disk order. 'out' holds FAT32_MAX_ENTRIES
+// entries; returns how many were written.
+unsigned fat32_dir_entries(const char *name, const uint8_t sfn[11], uint8_t attr,
+                           uint32_t cluster, uint32_t size, uint8_t *out);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* STORAGE_FAT32_H_ */
@@ -0,0 +1,61 @@
+/* flashlog.h – small keyed record log in the RP2040's own flash */
+#ifndef STORAGE_FLASHLOG_H_
+#define STORAGE_FLASHLOG_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ======================================================================
+// Flash log
+// Purpose: Keep a few hundred fixed-size records across power cycles in
+//          the last sectors of the program flash. Records are only ever
+//          appended. A newer record with the same key replaces an older
+//          one. Slots are programmed in place, because NOR bits only go
+//          from 1 to 0, so no write costs an erase. When the newest
+//          sector is full the oldest one is erased and reused, and its
+//          records that are still current move along with it. Every
+//          sector is erased equally often. A record whose check does not
+//          match (power lost mid-write) is skipped.
+//          The region is not in the linker script. The image must stay
+//          below FLASHLOG_OFFSET, which is far beyond this firmware's
+//          size. Host builds keep the flash in memory (host/sdk_flash.c).
+// ======================================================================
+
+#define FLASHLOG_SECTORS      4u
+#define FLASHLOG_SLOT_BYTES   64u
+#define FLASHLOG_DATA_BYTES   60u      // per record, key first
+#define FLASHLOG_KEY_BYTES    16u
+#define FLASHLOG_OFFSET       (PICO_FLASH_SIZE_BYTES - FLASHLOG_SECTORS * FLASH_SECTOR_SIZE)
+
+typedef struct {
+    uint32_t records;           // current records (newest per key)
+    uint32_t capacity;          // slots in all sectors
+    uint32_t used;              // slots written since the oldest erase
+    uint32_t erases;            // sector erases since the store was made
+} flashlog_stats_t;
+
+// Find the newest sector, formatting the region if it holds no log.
+// Call once at boot, before core 1 starts.
+void flashlog_init(void);
+
+// Newest record with this key into 'data'; false if there is none
+bool flashlog_find(const void *key, void *data);
+
+// Store a record, replacing any with the same key. May erase a sector
+// (tens of ms) and pauses the other core while flash is busy.
+bool flashlog_put(const void *data);
+
+// Drop the record with this key, and every record
+bool flashlog_remove(const void *key);
+void flashlog_clear(void);
+
+void flashlog_get_stats(flashlog_stats_t *out);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* STORAGE_FLASHLOG_H_ */
@@ -0,0 +1,65 @@
+/* sdcard.h – SD card in SPI mode, 512-byte blocks */
+#ifndef STORAGE_SDCARD_H_
+#define STORAGE_SDCARD_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ======================================================================
+// SD card
+// Purpose: Block access to the card slot. Bytes go through a two-
+//          instruction PIO SPI master with a DMA channel on each FIFO,
+//          so a 512-byte block costs one DMA round trip and no CPU
+//          per byte. The cart bus and the controller port take the
+//          hardware SPI pins, which is why this uses PIO; any four free
+//          GPIOs will do, on boards that have them (see below). A long write is one CMD25 multi-block
+//          write, pre-erased with ACMD23, and fed in pieces as the data
+//          arrives.
+//          Host builds (N64_HOST=1) back the same calls with a disk
+//          image file (host/sdcard_image.c).
+// ======================================================================
+
+#define SD_BLOCK_BYTES   512u
+
+// A Pico has no four GPIOs left over for the slot: the cart bus, EEPROM
+// and controller port take GPIO 0-22 and 26, and 23-25 and 29 are not
+// broken out. The slot is a board option (N64_SD_SLOT=ON in CMake, with
+// the board's four pins in N64_SD_PIN_SCK/MOSI/MISO/CS); without it
+// sd_init() reports no card and the SD features stay idle.
+#if defined(N64_SD_SLOT) && N64_SD_SLOT
+#if !defined(SD_PIN_SCK) || !defined(SD_PIN_MOSI) || !defined(SD_PIN_MISO) || !defined(SD_PIN_CS)
+#error "N64_SD_SLOT needs SD_PIN_SCK, SD_PIN_MOSI, SD_PIN_MISO and SD_PIN_CS"
+#endif
+#endif
+
+#define SD_PIO_BLOCK     pio1
+#define SD_INIT_HZ       400000u       // identification clock
+#define SD_FAST_HZ       25000000u     // default speed mode
+#define SD_BUSY_TIMEOUT_US 500000u     // a block write may take this long
+
+typedef struct {
+    uint32_t blocks;            // card capacity
+    bool     high_capacity;     // SDHC/SDXC: block addresses, else bytes
+} sd_info_t;
+
+// Power up and identify the card; false if there is none or it does not
+// answer like an SD card (MMC is not supported)
+bool sd_init(sd_info_t *out);
+
+bool sd_read_blocks(uint32_t lba, void *dst, uint32_t n);
+bool sd_write_blocks(uint32_t lba, const void *src, uint32_t n);
+
+// Streaming multi-block write of 'n' blocks from 'lba'. sd_write_next()
+// may be called with any number of whole blocks until all n are sent.
+bool sd_write_begin(uint32_t lba, uint32_t n);
+bool sd_write_next(const void *src, uint32_t n);
+bool sd_write_end(void);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* STORAGE_SDCARD_H_ */
@@ -0,0 +1,226 @@
+/* autodump.c – unattended dump of one cart after another
+ *  ---------------------------------------------------------------
+ *  • One loop step per AUTODUMP_POLL_US: the console gets a look (a key
+ *    stops), the LED moves one step of its pattern, and the slot is
+ *    checked with a few word reads
+ *  • Insertion and removal are debounced over several polls; a cart
+ *    half way in reads different on every poll
+ *  • A cart swap inside the removal debounce counts as a new insertion
+ *  • Bus timing goes back to the datasheet values whenever the slot is
+ *    empty, so the next cart is never polled at the last one's timing
+ */
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "pico/stdlib.h"
+#include "pico/stdio_usb.h"
+
+#include <app/autodump.h>
+#include <app/cartid.h>
+#include <app/digest.h>
+#include <app/n64db.h>
+#include <app/sddump.h>
+#include <app/xfer.h>
+#include <bus/ad_bus.h>
+#include <bus/ad_bus_timing.h>
+#include <devices/cartridge.h>
+
+#define SLOW_BLINK_POLLS  5u            // 1 Hz
+#define FAST_BLINK_POLLS  1u            // 5 Hz
+
+typedef enum { LED_OFF, LED_ON, LED_SLOW, LED_FAST } led_mode_t;
+
+static bool led_lit;
+
+/* ------------------------------------------------------------ */
+/*  LED                                                          */
+/* ------------------------------------------------------------ */
+static void led_put(bool on) {
+#ifdef PICO_DEFAULT_LED_PIN
+    if (on != led_lit) gpio_put(PICO_DEFAULT_LED_PIN, on);
+#endif
+    led_lit = on;
+}
+
+static void led_init(void) {
+#ifdef PICO_DEFAULT_LED_PIN
+    gpio_init(PICO_DEFAULT_LED_PIN);
+    gpio_set_dir(PICO_DEFAULT_LED_PIN, GPIO_OUT);
+#endif
+    led_lit = false;
+}
+
+// Blinks start dark, so the pull signal is an edge right after the dump
+static void led_step(led_mode_t m, uint32_t tick) {
+    switch (m) {
+    case LED_OFF:  led_put(false); break;
+    case LED_ON:   led_put(true);  break;
+    case LED_SLOW: led_put((tick / SLOW_BLINK_POLLS) & 1u); break;
+    case LED_FAST: led_put((tick / FAST_BLINK_POLLS) & 1u); break;
+    }
+}
+
+/* ------------------------------------------------------------ */
+/*  Targets                                                      */
+/* ------------------------------------------------------------ */
+static bool to_sd(uint32_t number, const char **err) {
+    sddump_result_t r;
+    if (!sddump_run(&r, err)) return false;
+    printf("Cart %lu: %s, %lu KiB, CRC32 %08lX", (unsigned long)number, r.rom_name,
+           (unsigned long)(r.rom_bytes >> 10), (unsigned long)r.rom_crc32);
+    if (r.db_crc32 && r.db_crc32 == r.rom_crc32) printf(" (good dump)");
+    else if (r.db_crc32) printf(" (BAD: database %08lX)", (unsigned long)r.db_crc32);
+    if (r.save_name[0]) printf(", %s", r.save_name);
+    char md5[2 * DIGEST_MD5_LEN + 1], sha1[2 * DIGEST_SHA1_LEN + 1];
+    digest_hex(r.rom_md5,  DIGEST_MD5_LEN,  md5);
+    digest_hex(r.rom_sha1, DIGEST_SHA1_LEN, sha1);
+    printf("\r\n  MD5 %s  SHA-1 %s\r\n", md5, sha1);
+    return true;
+}
+
+static void announce(uint32_t number, const xfer_cart_t *c) {
+    stdio_set_translate_crlf(&stdio_usb, false);    // frames are raw bytes
+    xfer_send(XFER_T_CART, number, 0, c, sizeof(*c));
+    stdio_set_translate_crlf(&stdio_usb, true);
+}
+
+// Announce the cart until the host answers, then serve its transfers
+// until it says it is done with ABORT
+static bool to_host(uint32_t number, const char **err) {
+    cartid_t id;
+    if (!cartid_prepare(&id, NULL)) {
+        *err = "no cart";
+        return false;
+    }
+    xfer_cart_t c;
+    memset(&c, 0, sizeof(c));
+    c.crc1      = id.crc1;
+    c.crc2      = id.crc2;
+    memcpy(c.cart_id, id.raw_id, sizeof(c.cart_id));
+    c.version   = id.version;
+    c.rom_bytes = id.rom_bytes;
+    uint8_t  region;                    // PIPE_REGION_* numbers are XFER_REGION_*
+    uint32_t bytes;
+    c.save_region = cartid_save_region(&id, &region, &bytes) ? region : XFER_REGION_NONE;
+    c.save_bytes  = c.save_region == XFER_REGION_NONE ? 0 : bytes;
+
+    bool     answered = false;
+    uint32_t last     = time_us_32() - AUTODUMP_ANNOUNCE_US;
+    for (;;) {
+        if (!answered && time_us_32() - last >= AUTODUMP_ANNOUNCE_US) {
+            announce(number, &c);
+            last = time_us_32();
+        }
+        int type = xfer_session(-1, AUTODUMP_POLL_US);
+        if (type == XFER_T_ABORT) break;
+        if (type >= 0) {
+            answered = true;
+            last     = time_us_32();
+            continue;
+        }
+        if (answered && time_us_32() - last >= AUTODUMP_HOST_QUIET_US) {
+            *err = "the host stopped answering";
+            return false;
+        }
+        if (!answered && !n64_cart_present(NULL)) {
+            *err = "pulled before the host took it";
+            return false;
+        }
+    }
+    printf("Cart %lu: %s v%u, %lu KiB, save %s, taken by the host\r\n", (unsigned long)number,
+           id.cart_id, id.version, (unsigned long)(id.rom_bytes >> 10),
+           n64db_save_name(id.save_type));
+    return true;
+}
+
+/* ------------------------------------------------------------ */
+/*  Loop                                                         */
+/* ------------------------------------------------------------ */
+void autodump_run(autodump_target_t target, uint32_t max_carts, autodump_stats_t *out) {
+    autodump_stats_t st;
+    memset(&st, 0, sizeof(st));
+    uint32_t t_start = time_us_32();
+
+    led_init();
+    adBus_timing_reset();
+    printf("\nAuto dump to %s: insert a cart; any key stops\r\n",
+           target == AUTODUMP_TO_SD ? "the SD card" : "the host");
+
+    bool       in_slot = false;         // a dumped cart is still in
+    led_mode_t led     = LED_OFF;
+    uint32_t   cand = 0, done_crc = 0;
+    unsigned   same = 0, gone = 0;
+    for (uint32_t tick = 0; ; ++tick) {
+        led_step(led, tick);
+        int ch = getchar_timeout_us(AUTODUMP_POLL_US);
+        if (ch == XFER_SOF0 && target == AUTODUMP_TO_HOST) {
+            xfer_session(ch, 0);                    // a host request between carts
+            continue;
+        }
+        if (ch != PICO_ERROR_TIMEOUT) break;
+
+        uint32_t crc1;
+        bool present = n64_cart_present(&crc1);
+        if (in_slot) {
+            if (present && crc1 == done_crc) {
+                gone = 0;
+                continue;
+            }
+            if (++gone < AUTODUMP_GONE_POLLS) continue;      // or another cart, steadily
+            in_slot = false;
+            led     = LED_OFF;
+            same    = 0;
+            adBus_timing_reset();
+            if (!present) continue;
+        }
+
+        // Waiting for a cart that reads the same several polls in a row
+        if (!present) {
+            same = 0;
+            continue;
+        }
+        if (!same || crc1 != cand) {
+            cand = crc1;
+            same = 1;
+            continue;
+        }
+        if (++same < AUTODUMP_SETTLE_POLLS) continue;
+
+        uint32_t number = st.carts + st.failed + 1u;
+        uint32_t t0     = time_us_32();
+        const char *err = NULL;
+        led_put(true);
+        n64_reset();                        // the cart came up while being pushed in
+        bool ok = target == AUTODUMP_TO_SD ? to_sd(number, &err) : to_host(number, &err);
+        uint32_t ms = (time_us_32() - t0) / 1000u;
+        st.busy_ms += ms;
+        if (ok) st.carts++;
+        else {
+            st.failed++;
+            printf("Cart %lu: FAILED, %s\r\n", (unsigned long)number, err);
+        }
+        printf("  %lu.%03lu s; pull the cart\r\n", (unsigned long)(ms / 1000u),
+               (unsigned long)(ms % 1000u));
+
+        in_slot  = true;
+        done_crc = crc1;
+        gone     = 0;
+        led      = ok ? LED_SLOW : LED_FAST;
+        tick     = 0;
+        if (max_carts && st.carts + st.failed >= max_carts) break;
+    }
+    led_put(false);
+
+    st.total_ms = (time_us_32() - t_start) / 1000u;
+    printf("Auto dump stopped: %lu carts, %lu failed", (unsigned long)st.carts,
+           (unsigned long)st.failed);
+    if (st.carts && st.total_ms) {
+        uint32_t per = st.busy_ms / st.carts;
+        printf(", %lu.%lu s per dump, %lu carts/hour", (unsigned long)(per / 1000u),
+               (unsigned long)(per % 1000u / 100u),
+               (unsigned long)((uint64_t)st.carts * 3600000u / st.total_ms));
+    }
+    printf("\r\n");
+    if (out) *out = st;
+}
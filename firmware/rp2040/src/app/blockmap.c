@@ -0,0 +1,142 @@
+/* blockmap.c – per-block CRC map of the last ROM dump, and its repair
+ *  ---------------------------------------------------------------
+ *  • Fed from the same in-order path as the transfer digests, so a map
+ *    entry is the CRC of exactly what the host stored
+ *  • Repair reads run on core 0 with the pipeline stopped; the cart is
+ *    read straight into RAM, nothing goes over USB
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include "pico/stdlib.h"
+
+#include <app/blockmap.h>
+#include <app/crc32.h>
+#include <bus/ad_bus.h>
+#include <devices/cartridge.h>
+
+static uint32_t crc_map[BLOCKMAP_MAX_BLOCKS];
+static uint32_t valid[BLOCKMAP_MAX_BLOCKS / 32u];
+static uint32_t map_length;
+
+// In-progress block
+static uint32_t feed_next;        // offset the next fed byte must have
+static uint32_t feed_crc;
+static bool     feed_whole;       // current block started at its first byte
+
+static uint8_t  votes[BLOCKMAP_VOTE_MAX][BLOCKMAP_PIECE_BYTES] __attribute__((aligned(4)));
+
+static inline void set_valid(uint32_t b, bool v) {
+    if (v) valid[b / 32u] |=  (1u << (b % 32u));
+    else   valid[b / 32u] &= ~(1u << (b % 32u));
+}
+
+static inline bool is_valid(uint32_t b) {
+    return (valid[b / 32u] >> (b % 32u)) & 1u;
+}
+
+uint32_t blockmap_blocks(void) {
+    return (map_length + BLOCKMAP_BLOCK_BYTES - 1u) / BLOCKMAP_BLOCK_BYTES;
+}
+
+void blockmap_begin(uint32_t length, bool resume) {
+    if (!resume || length != map_length) {
+        memset(valid, 0, sizeof(valid));
+        map_length = length > BLOCKMAP_MAX_BLOCKS * BLOCKMAP_BLOCK_BYTES
+                   ? BLOCKMAP_MAX_BLOCKS * BLOCKMAP_BLOCK_BYTES : length;
+    }
+    feed_next  = UINT32_MAX;        // first feed decides where we are
+    feed_whole = false;
+}
+
+void blockmap_feed(uint32_t offset, const uint8_t *data, size_t len) {
+    if (offset != feed_next) {
+        // A jump (first frame, resume): only a block boundary starts clean
+        feed_whole = (offset % BLOCKMAP_BLOCK_BYTES) == 0;
+        feed_crc   = 0;
+    }
+
+    while (len > 0 && offset < map_length) {
+        uint32_t b     = offset / BLOCKMAP_BLOCK_BYTES;
+        uint32_t end   = (b + 1u) * BLOCKMAP_BLOCK_BYTES;
+        if (end > map_length) end = map_length;
+        uint32_t take  = end - offset;
+        if (take > len) take = (uint32_t)len;
+
+        feed_crc = crc32_update(feed_crc, data, take);
+        offset  += take;
+        data    += take;
+        len     -= take;
+
+        if (offset == end) {
+            crc_map[b] = feed_crc;
+            set_valid(b, feed_whole);
+            feed_crc   = 0;
+            feed_whole = true;
+        }
+    }
+    feed_next = offset;
+}
+
+bool blockmap_ready(uint32_t length) {
+    if (length != map_length || length == 0) return false;
+    for (uint32_t b = 0; b < blockmap_blocks(); ++b) {
+        if (!is_valid(b)) return false;
+    }
+    return true;
+}
+
+uint32_t blockmap_crc(uint32_t block) { return crc_map[block]; }
+
+void blockmap_set_crc(uint32_t block, uint32_t crc) {
+    crc_map[block] = crc;
+    set_valid(block, true);
+}
+
+uint32_t blockmap_read_crc(uint32_t block, uint32_t *running) {
+    uint32_t off = block * BLOCKMAP_BLOCK_BYTES;
+    uint32_t end = off + BLOCKMAP_BLOCK_BYTES;
+    if (end > map_length) end = map_length;
+
+    uint32_t crc = 0;
+    for (; off < end; off += BLOCKMAP_PIECE_BYTES) {
+        uint32_t n = end - off < BLOCKMAP_PIECE_BYTES ? end - off : BLOCKMAP_PIECE_BYTES;
+        n64_read_bytes_fast(N64_ROM_BASE + off, votes[0], n);
+        crc = crc32_update(crc, votes[0], n);
+        if (running) *running = crc32_update(*running, votes[0], n);
+    }
+    return crc;
+}
+
+bool blockmap_vote_piece(uint32_t offset, uint8_t *out, size_t len) {
+    unsigned reads = BLOCKMAP_VOTE_MIN;
+    for (unsigned r = 0; r < reads; ++r) {
+        n64_read_bytes_fast(N64_ROM_BASE + offset, votes[r], len);
+        // Any disagreement: take the full set of reads for the vote
+        if (r > 0 && reads < BLOCKMAP_VOTE_MAX && memcmp(votes[r], votes[0], len) != 0) {
+            reads = BLOCKMAP_VOTE_MAX;
+        }
+    }
+
+    bool clear = true;
+    for (size_t i = 0; i < len; i += 2) {
+        uint16_t best = 0;
+        unsigned best_n = 0;
+        for (unsigned a = 0; a < reads; ++a) {
+            uint16_t w = (uint16_t)(votes[a][i] << 8 | votes[a][i + 1]);
+            unsigned n = 0;
+            for (unsigned c = 0; c < reads; ++c) {
+                n += (votes[c][i] == votes[a][i] && votes[c][i + 1] == votes[a][i + 1]);
+            }
+            if (n > best_n) {
+                best   = w;
+                best_n = n;
+            }
+        }
+        if (best_n * 2u <= reads) clear = false;   // no majority
+        out[i]     = (uint8_t)(best >> 8);
+        out[i + 1] = (uint8_t)best;
+    }
+    return clear;
+}
@@ -0,0 +1,335 @@
+/* cartfs.c – synthesized FAT16 volume over the cart
+ *  ---------------------------------------------------------------
+ *  • Layout: boot sector, two FATs, a 512-entry root directory, then
+ *    the files back to back, each one contiguous. The ROM comes first,
+ *    so it starts on the first cluster.
+ *  • FAT blocks are generated on the fly from the file list; only the
+ *    directory entries and the text file are kept in RAM
+ *  • Below 4085 clusters a volume would be FAT12, so small carts get
+ *    free padding clusters. They read as zeros.
+ *  • The read-ahead only moves forward. A read up to a ring's length
+ *    ahead takes slots off the ring; anything else restarts core 1 at
+ *    the slot holding the new position.
+ */
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "pico/stdlib.h"
+
+#include <app/cartfs.h>
+#include <app/cartid.h>
+#include <app/n64db.h>
+#include <app/pipeline.h>
+#include <bus/ad_bus.h>
+#include <bus/joybus.h>
+#include <devices/cartridge.h>
+#include <devices/flashram.h>
+#include <storage/fat32.h>
+
+#define RESERVED_BLOCKS   1u
+#define NUM_FATS          2u
+#define ROOT_ENTRIES      512u
+#define ROOT_BLOCKS       (ROOT_ENTRIES * FAT32_DIR_ENTRY_BYTES / CARTFS_BLOCK_BYTES)
+#define MIN_CLUSTERS      4200u          // clear of the FAT12 limit (4085)
+#define MAX_CLUSTERS      65524u
+#define FAT16_EOC         0xFFFFu
+#define SRAM_BYTES        (32u * 1024u)
+#define TEXT_MAX          1024u
+#define DIR_MAX           ((1u + CARTFS_MAX_FILES * FAT32_MAX_ENTRIES) * FAT32_DIR_ENTRY_BYTES)
+
+static bool          mounted;
+static cartfs_file_t files[CARTFS_MAX_FILES];
+static uint32_t      file_cluster[CARTFS_MAX_FILES];
+static uint32_t      file_clusters[CARTFS_MAX_FILES];
+static unsigned      n_files;
+
+static uint32_t spc;                     // blocks per cluster
+static uint32_t clusters;
+static uint32_t fat_blocks;              // per copy
+static uint32_t root_lba, data_lba, total_blocks;
+static uint32_t vol_id;
+
+static uint8_t  dir[DIR_MAX];
+static uint32_t dir_bytes;
+static char     text[TEXT_MAX];
+static uint32_t text_len;
+static uint8_t  blk[CARTFS_BLOCK_BYTES] __attribute__((aligned(4)));
+
+// Read-ahead: the pipeline slot the host is reading from
+static const uint8_t *s_data;
+static uint8_t        s_region;
+static uint32_t       s_off;
+static uint16_t       s_len;
+
+static inline void wr16(uint8_t *p, uint16_t v) { p[0] = (uint8_t)v; p[1] = (uint8_t)(v >> 8); }
+static inline void wr32(uint8_t *p, uint32_t v) { wr16(p, (uint16_t)v); wr16(p + 2, (uint16_t)(v >> 16)); }
+
+/* ------------------------------------------------------------ */
+/*  Metadata blocks                                              */
+/* ------------------------------------------------------------ */
+static void boot_sector(uint8_t *b) {
+    memset(b, 0, CARTFS_BLOCK_BYTES);
+    memcpy(b, "\xEB\x3C\x90" "N64DUMP ", 11);
+    wr16(&b[11], CARTFS_BLOCK_BYTES);
+    b[13] = (uint8_t)spc;
+    wr16(&b[14], RESERVED_BLOCKS);
+    b[16] = NUM_FATS;
+    wr16(&b[17], ROOT_ENTRIES);
+    if (total_blocks < 0x10000u) wr16(&b[19], (uint16_t)total_blocks);
+    else                         wr32(&b[32], total_blocks);
+    b[21] = 0xF8;                                   // fixed disk
+    wr16(&b[22], (uint16_t)fat_blocks);
+    wr16(&b[24], 63);
+    wr16(&b[26], 255);
+    b[36] = 0x80;
+    b[38] = 0x29;
+    wr32(&b[39], vol_id);
+    memcpy(&b[43], "N64 CART   FAT16   ", 19);
+    wr16(&b[510], 0xAA55u);
+}
+
+static void fat_block(uint32_t k, uint8_t *b) {
+    for (uint32_t i = 0; i < CARTFS_BLOCK_BYTES / 2u; ++i) {
+        uint32_t c = k * (CARTFS_BLOCK_BYTES / 2u) + i;
+        uint16_t v = 0;
+        if (c == 0)      v = 0xFFF8u;               // media byte
+        else if (c == 1) v = FAT16_EOC;
+        for (unsigned f = 0; f < n_files; ++f) {
+            uint32_t end = file_cluster[f] + file_clusters[f];
+            if (c >= file_cluster[f] && c < end) v = (c + 1u == end) ? FAT16_EOC : (uint16_t)(c + 1u);
+        }
+        wr16(&b[i * 2u], v);
+    }
+}
+
+/* ------------------------------------------------------------ */
+/*  File data                                                    */
+/* ------------------------------------------------------------ */
+static void stream_stop(void) {
+    if (s_data) pipe_stop();
+    s_data = NULL;
+}
+
+static bool stream_read(const cartfs_file_t *f, uint32_t off, uint8_t *dst, uint32_t n) {
+    while (n) {
+        bool here = s_data && s_region == f->region && off >= s_off && off < s_off + s_len;
+        if (!here) {
+            bool ahead = s_data && s_region == f->region && off >= s_off + s_len &&
+                         off < s_off + s_len + PIPE_SLOTS * PIPE_SLOT_BYTES;
+            if (ahead) {
+                pipe_release();
+            } else {
+                pipe_start(f->region, off / PIPE_SLOT_BYTES * PIPE_SLOT_BYTES, f->bytes,
+                           PIPE_SLOT_BYTES);
+                s_region = f->region;
+            }
+            s_data = pipe_next(&s_off, &s_len);
+            if (!s_data) return false;
+            continue;
+        }
+        uint32_t k = s_off + s_len - off;
+        if (k > n) k = n;
+        memcpy(dst, s_data + (off - s_off), k);
+        dst += k;
+        off += k;
+        n   -= k;
+    }
+    return true;
+}
+
+static bool file_read(const cartfs_file_t *f, uint32_t off, uint8_t *dst, uint32_t n) {
+    if (f->region == CARTFS_REGION_TEXT) {
+        memcpy(dst, &text[off], n);
+        return true;
+    }
+    return stream_read(f, off, dst, n);
+}
+
+/* ------------------------------------------------------------ */
+/*  Layout                                                       */
+/* ------------------------------------------------------------ */
+static void add_file(const char *base, const char *ext, uint8_t region, uint32_t bytes) {
+    cartfs_file_t *f = &files[n_files++];
+    snprintf(f->name, sizeof(f->name), "%s.%s", base, ext);
+    f->region = region;
+    f->bytes  = bytes;
+}
+
+static void title_name(char *out, size_t max) {
+    uint8_t title[N64_TITLE_LENGTH + 1];
+    size_t  n = 0;
+    if (n64_get_title(title, sizeof(title))) {
+        for (const uint8_t *p = title; *p && n + 1 < max; ++p)
+            out[n++] = (*p < 0x20 || *p > 0x7E || strchr("\\/:*?\"<>|", *p)) ? '_' : (char)*p;
+    }
+    while (n && (out[n - 1] == ' ' || out[n - 1] == '.')) --n;
+    out[n] = '\0';
+    if (n == 0) snprintf(out, max, "N64 cart");
+}
+
+static char printable(uint8_t c) { return (c < 0x20 || c > 0x7E) ? '?' : (char)c; }
+
+static void info_text(const char *title, const n64db_entry_t *e, uint8_t save, uint32_t rom_bytes) {
+    uint8_t h[N64_HEADER_LENGTH];
+    int     n = 0;
+    if (!n64_get_header(h, sizeof(h))) memset(h, 0, sizeof(h));
+
+    n += snprintf(&text[n], TEXT_MAX - (size_t)n, "Title     : %s\r\n", title);
+    n += snprintf(&text[n], TEXT_MAX - (size_t)n, "Game code : %c%c%c%c, version %u\r\n",
+                  printable(h[0x3B]), printable(h[0x3C]), printable(h[0x3D]), printable(h[0x3E]),
+                  h[0x3F]);
+    n += snprintf(&text[n], TEXT_MAX - (size_t)n, "CRC1/CRC2 : %02X%02X%02X%02X %02X%02X%02X%02X\r\n",
+                  h[0x10], h[0x11], h[0x12], h[0x13], h[0x14], h[0x15], h[0x16], h[0x17]);
+    n += snprintf(&text[n], TEXT_MAX - (size_t)n, "ROM size  : %lu MiB (%s)\r\n",
+                  (unsigned long)(rom_bytes >> 20), e ? "database" : "mirror probe");
+    n += snprintf(&text[n], TEXT_MAX - (size_t)n, "Save      : %s\r\n", n64db_save_name(save));
+    if (e) {
+        n += snprintf(&text[n], TEXT_MAX - (size_t)n, "Database  : %s\r\n            CRC32 %08lX\r\n",
+                      n64db_name(e), (unsigned long)e->crc32);
+    } else {
+        n += snprintf(&text[n], TEXT_MAX - (size_t)n, "Database  : not found\r\n");
+    }
+    n += snprintf(&text[n], TEXT_MAX - (size_t)n, "Header    :\r\n");
+    for (unsigned i = 0; i < N64_HEADER_LENGTH; i += 16u) {
+        n += snprintf(&text[n], TEXT_MAX - (size_t)n, "  %02X:", i);
+        for (unsigned j = 0; j < 16u; ++j)
+            n += snprintf(&text[n], TEXT_MAX - (size_t)n, " %02X", h[i + j]);
+        n += snprintf(&text[n], TEXT_MAX - (size_t)n, "\r\n");
+    }
+    text_len = (uint32_t)n;
+}
+
+static void build_dir(void) {
+    uint8_t label[11];
+    memcpy(label, "N64 CART   ", 11);
+    dir_bytes = fat32_dir_entries(NULL, label, FAT32_ATTR_VOLUME_ID, 0, 0, dir) *
+                FAT32_DIR_ENTRY_BYTES;
+    for (unsigned f = 0; f < n_files; ++f) {
+        // The extensions differ, so one tail keeps the aliases apart
+        uint8_t sfn[11];
+        bool    lossy = fat32_short_name(files[f].name, 0, sfn);
+        if (lossy) fat32_short_name(files[f].name, 1, sfn);
+        dir_bytes += fat32_dir_entries(lossy ? files[f].name : NULL, sfn,
+                                       FAT32_ATTR_READ_ONLY | FAT32_ATTR_ARCHIVE,
+                                       file_cluster[f], files[f].bytes,
+                                       &dir[dir_bytes]) * FAT32_DIR_ENTRY_BYTES;
+    }
+}
+
+bool cartfs_mount(void) {
+    cartfs_unmount();
+
+    // Same bus preparation as a USB dump
+    cartid_t id;
+    const n64db_entry_t *e;
+    if (!cartid_prepare(&id, &e)) return false;
+    uint32_t rom_bytes = id.rom_bytes;
+    uint8_t  save      = id.save_type;
+
+    char base[CARTFS_NAME_MAX - 4];
+    title_name(base, sizeof(base));
+    n_files = 0;
+    add_file(base, "z64", PIPE_REGION_ROM, rom_bytes);
+    switch (save) {
+    case N64DB_SAVE_SRAM:     add_file(base, "sra", PIPE_REGION_SRAM, SRAM_BYTES);         break;
+    case N64DB_SAVE_FLASHRAM: add_file(base, "fla", PIPE_REGION_FLASHRAM, FLASHRAM_BYTES); break;
+    case N64DB_SAVE_EEP4K:
+    case N64DB_SAVE_EEP16K:   add_file(base, "eep", PIPE_REGION_EEPROM, gEepromSize);      break;
+    default:                  break;
+    }
+    add_file(base, "txt", CARTFS_REGION_TEXT, 0);
+    info_text(base, e, save, rom_bytes);
+    files[n_files - 1u].bytes = text_len;
+
+    // Smallest cluster that keeps the volume FAT16
+    uint32_t need;
+    for (spc = 1; ; spc <<= 1) {
+        uint32_t cb = spc * CARTFS_BLOCK_BYTES;
+        need = 0;
+        for (unsigned f = 0; f < n_files; ++f) need += (files[f].bytes + cb - 1u) / cb;
+        if (need <= MAX_CLUSTERS || spc == 64u) break;
+    }
+    clusters   = need < MIN_CLUSTERS ? MIN_CLUSTERS : need;
+    fat_blocks = ((clusters + 2u) * 2u + CARTFS_BLOCK_BYTES - 1u) / CARTFS_BLOCK_BYTES;
+    root_lba   = RESERVED_BLOCKS + NUM_FATS * fat_blocks;
+    data_lba   = root_lba + ROOT_BLOCKS;
+    total_blocks = data_lba + clusters * spc;
+    vol_id     = id.crc1;
+
+    uint32_t c = 2;
+    for (unsigned f = 0; f < n_files; ++f) {
+        file_clusters[f]   = (files[f].bytes + spc * CARTFS_BLOCK_BYTES - 1u) / (spc * CARTFS_BLOCK_BYTES);
+        file_cluster[f]    = file_clusters[f] ? c : 0;
+        files[f].first_lba = data_lba + (c - 2u) * spc;
+        c += file_clusters[f];
+    }
+    build_dir();
+    mounted = true;
+    return true;
+}
+
+void cartfs_unmount(void) {
+    stream_stop();
+    mounted = false;
+}
+
+bool cartfs_mounted(void)    { return mounted; }
+uint32_t cartfs_blocks(void) { return mounted ? total_blocks : 0; }
+
+const cartfs_file_t *cartfs_files(unsigned *count) {
+    *count = mounted ? n_files : 0;
+    return files;
+}
+
+/* ------------------------------------------------------------ */
+/*  Reads                                                        */
+/* ------------------------------------------------------------ */
+bool cartfs_read(uint32_t lba, uint32_t offset, void *dst, uint32_t len) {
+    uint8_t *p = dst;
+    if (!mounted) return false;
+    lba    += offset / CARTFS_BLOCK_BYTES;
+    offset %= CARTFS_BLOCK_BYTES;
+
+    while (len) {
+        uint32_t n = CARTFS_BLOCK_BYTES - offset;
+        if (n > len) n = len;
+
+        if (lba >= total_blocks) {
+            return false;
+        } else if (lba < RESERVED_BLOCKS) {
+            boot_sector(blk);
+            memcpy(p, &blk[offset], n);
+        } else if (lba < root_lba) {
+            fat_block((lba - RESERVED_BLOCKS) % fat_blocks, blk);
+            memcpy(p, &blk[offset], n);
+        } else if (lba < data_lba) {
+            uint32_t at = (lba - root_lba) * CARTFS_BLOCK_BYTES + offset;
+            uint32_t k  = at < dir_bytes ? dir_bytes - at : 0;
+            if (k > n) k = n;
+            memcpy(p, &dir[at < dir_bytes ? at : 0], k);
+            memset(p + k, 0, n - k);
+        } else {
+            // File data: one copy up to the end of the request or the file
+            const cartfs_file_t *f = NULL;
+            for (unsigned i = 0; i < n_files && !f; ++i) {
+                uint32_t end = files[i].first_lba + file_clusters[i] * spc;
+                if (file_clusters[i] && lba >= files[i].first_lba && lba < end) f = &files[i];
+            }
+            uint32_t fo = f ? (lba - f->first_lba) * CARTFS_BLOCK_BYTES + offset : 0;
+            if (f && fo < f->bytes) {
+                n = len < f->bytes - fo ? len : f->bytes - fo;
+                if (!file_read(f, fo, p, n)) return false;
+            } else {
+                memset(p, 0, n);                    // cluster slack and padding
+            }
+        }
+
+        p      += n;
+        len    -= n;
+        offset += n;
+        lba    += offset / CARTFS_BLOCK_BYTES;
+        offset %= CARTFS_BLOCK_BYTES;
+    }
+    return true;
+}
@@ -0,0 +1,176 @@
+/* cartid.c – per-cart bus settings remembered in the flash log
+ *  ---------------------------------------------------------------
+ *  • The key is the header's CRC1, CRC2, cart ID and version; a
+ *    re-release or another region is another cart
+ *  • On a hit only the header and one burst per probe point are read,
+ *    the burst checked against word reads at the remembered timing; on
+ *    a miss, or a failed check, everything is probed and stored
+ *  • Records carry a layout number. One written by a firmware with a
+ *    different record layout reads as a miss and is replaced
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include "pico/stdlib.h"
+
+#include <app/cartid.h>
+#include <app/n64db.h>
+#include <app/pipeline.h>
+#include <bus/ad_bus_timing.h>
+#include <bus/joybus.h>
+#include <devices/cartridge.h>
+#include <devices/flashram.h>
+#include <storage/flashlog.h>
+
+#define RECORD_LAYOUT  1u
+#define SRAM_BYTES     (32u * 1024u)
+
+typedef struct {
+    // Key: the first FLASHLOG_KEY_BYTES
+    uint32_t        crc1, crc2;
+    char            cart_id[4];
+    uint8_t         version;
+    uint8_t         key_pad[3];
+    // What the probes found
+    uint32_t        rom_bytes;
+    uint32_t        eeprom_bytes;
+    ad_bus_timing_t timing;
+    uint16_t        burst_bytes;
+    uint8_t         save_type;
+    uint8_t         layout;
+    uint8_t         pad[FLASHLOG_DATA_BYTES - 36u];
+} record_t;
+
+_Static_assert(sizeof(record_t) == FLASHLOG_DATA_BYTES, "record layout");
+_Static_assert(offsetof(record_t, rom_bytes) == FLASHLOG_KEY_BYTES, "record key");
+
+static uint32_t be32(const uint8_t *p) {
+    return (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 8 | p[3];
+}
+
+// Open bus reads back one value everywhere
+static bool header_blank(const uint8_t *h) {
+    for (unsigned i = 1; i < N64_HEADER_LENGTH; ++i)
+        if (h[i] != h[0]) return false;
+    return true;
+}
+
+static void make_key(record_t *r, const uint8_t *h) {
+    memset(r, 0, sizeof(*r));
+    r->crc1 = be32(&h[N64_CRC1_OFFSET]);
+    r->crc2 = be32(&h[N64_CRC1_OFFSET + 4u]);
+    memcpy(r->cart_id, &h[0x3B], sizeof(r->cart_id));
+    r->version = h[0x3F];
+}
+
+static void to_id(const record_t *r, cartid_t *id, bool cached) {
+    id->crc1 = r->crc1;
+    id->crc2 = r->crc2;
+    for (unsigned i = 0; i < sizeof(r->cart_id); ++i) {
+        char c = r->cart_id[i];
+        id->cart_id[i] = (c >= 0x20 && c <= 0x7E) ? c : '?';
+    }
+    id->cart_id[4]   = '\0';
+    memcpy(id->raw_id, r->cart_id, sizeof(id->raw_id));
+    id->version      = r->version;
+    id->save_type    = r->save_type;
+    id->burst_bytes  = r->burst_bytes;
+    id->rom_bytes    = r->rom_bytes;
+    id->eeprom_bytes = r->eeprom_bytes;
+    id->timing       = r->timing;
+    id->cached       = cached;
+}
+
+// Everything a dump needs, measured on the cart in the slot. False if
+// the bus did not calibrate: the result is used but not remembered.
+static bool probe(record_t *r, const n64db_entry_t **entry) {
+    bool calibrated = adBus_calibrate(NULL);
+    n64_probe_burst_bytes();
+    const n64db_entry_t *e = n64db_identify(&r->rom_bytes);
+    n64_eep_detect();                  // a hot-swapped cart may have another chip
+    r->save_type    = n64db_save_type(e);
+    r->eeprom_bytes = gEepromSize;
+    r->timing       = adBus_timing;
+    r->burst_bytes  = (uint16_t)n64_get_burst_bytes();
+    r->layout       = RECORD_LAYOUT;
+    *entry = e;
+    return calibrated;
+}
+
+// A repro shares its header with the original, so a hit may be another
+// board. Apply the remembered timing and burst length and check one burst
+// of that length against word reads before trusting them.
+static bool still_fits(const record_t *r) {
+    adBus_timing = r->timing;
+    n64_set_burst_bytes(r->burst_bytes);
+    return n64_check_burst_bytes(r->burst_bytes);
+}
+
+/* ------------------------------------------------------------ */
+/*  API                                                          */
+/* ------------------------------------------------------------ */
+void cartid_init(void) {
+    flashlog_init();
+}
+
+bool cartid_prepare(cartid_t *id, const n64db_entry_t **entry) {
+    uint8_t h[N64_HEADER_LENGTH];
+    const n64db_entry_t *e = NULL;
+    if (entry) *entry = NULL;
+
+    // The header is read at the datasheet timing, whatever the last cart had
+    adBus_timing_reset();
+    if (!n64_get_header(h, sizeof(h)) || header_blank(h)) return false;
+
+    record_t key, r;
+    make_key(&key, h);
+    if (flashlog_find(&key, &r) && r.layout == RECORD_LAYOUT && still_fits(&r)) {
+        n64_eep_set_size(r.eeprom_bytes);
+        e = n64db_find(r.crc1, NULL);
+        to_id(&r, id, true);
+    } else {
+        // Unknown, or a cart with the same header that the record does not
+        // fit (a repro of a cart seen before): probe and replace the record
+        adBus_timing_reset();
+        r = key;
+        if (probe(&r, &e)) flashlog_put(&r);
+        to_id(&r, id, false);
+    }
+    if (entry) *entry = e;
+    return true;
+}
+
+bool cartid_save_region(const cartid_t *id, uint8_t *region, uint32_t *bytes) {
+    switch (id->save_type) {
+    case N64DB_SAVE_SRAM:
+        *region = PIPE_REGION_SRAM;
+        *bytes  = SRAM_BYTES;
+        return true;
+    case N64DB_SAVE_FLASHRAM:
+        *region = PIPE_REGION_FLASHRAM;
+        *bytes  = FLASHRAM_BYTES;
+        return true;
+    case N64DB_SAVE_EEP4K:
+    case N64DB_SAVE_EEP16K:
+        *region = PIPE_REGION_EEPROM;
+        *bytes  = id->eeprom_bytes;
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool cartid_forget(const cartid_t *id) {
+    record_t key;
+    memset(&key, 0, sizeof(key));
+    key.crc1 = id->crc1;
+    key.crc2 = id->crc2;
+    memcpy(key.cart_id, id->raw_id, sizeof(key.cart_id));
+    key.version = id->version;
+    return flashlog_remove(&key);
+}
+
+void cartid_forget_all(void) {
+    flashlog_clear();
+}
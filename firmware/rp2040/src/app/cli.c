@@ -5,22 +5,115 @@
 #include "pico/stdlib.h"
 #include "tusb.h"
 
+#include <app/autodump.h>
+#include <app/cartfs.h>
+#include <app/cartid.h>
 #include <app/cli.h>
+#include <app/crc32.h>
+#include <app/digest.h>
+#include <app/n64db.h>
+#include <app/pipeline.h>
+#include <app/sddump.h>
+#include <app/xfer.h>
 #include <bus/ad_bus.h>
+#include <bus/ad_bus_timing.h>
+#include <bus/bus_perf.h>
 #include <bus/joybus.h>
 #include <devices/cartridge.h>
+#include <devices/controller.h>
+#include <devices/flashram.h>
+#include <devices/reproflash.h>
+#include <storage/flashlog.h>
+#include <storage/sdcard.h>
+
+#define CLI_XFER_WAIT_US  30000000u    /* binary modes wait 30 s for the host tool */
+
+// More debug menu functions; static, so they stay out of cli.h
+static void dbg_pipe_stats(void);
+static void dbg_identify(void);
+static void dbg_calibrate(void);
+static void dbg_bus_bench(void);
+static void dbg_flashram(void);
+static void dbg_perf_stats(void);
+static void dbg_cart_cache(void);
+static void dbg_cart_forget(void);
 
 /* ------------------------------------------------------------ */
 /*  Menu actions                                                */
 /* ------------------------------------------------------------ */
-static void cli_rom_dump   (void){ printf("\n(stub) Dump Rom\r\n"); }
+static void cli_rom_dump   (void){
+    printf("\nWaiting for the host tool (binary transfer)...\r\n");
+    xfer_session(-1, CLI_XFER_WAIT_US);
+}
 static void cli_save_read  (void){ printf("\n(stub) Read Save\r\n"); }
 static void cli_save_write (void){ printf("\n(stub) Write Save\r\n"); }
-static void cli_test_ctrl  (void){ printf("\n(stub) Test Controller\r\n"); }
+static void cli_sd_dump    (void){
+    sddump_result_t r;
+    const char *err;
+    printf("\nDumping to SD card...\r\n");
+    if (!sddump_run(&r, &err)) {
+        printf("SD dump failed: %s\r\n", err);
+        return;
+    }
+    printf("  %s: %lu KiB in %lu ms, CRC32 %08lX", r.rom_name,
+           (unsigned long)(r.rom_bytes >> 10), (unsigned long)(r.rom_us / 1000u),
+           (unsigned long)r.rom_crc32);
+    if (r.db_crc32 && r.db_crc32 == r.rom_crc32) printf(" (good dump)");
+    else if (r.db_crc32) printf(" (BAD: database %08lX)", (unsigned long)r.db_crc32);
+    printf("\r\n");
+    char md5[2 * DIGEST_MD5_LEN + 1], sha1[2 * DIGEST_SHA1_LEN + 1];
+    digest_hex(r.rom_md5,  DIGEST_MD5_LEN,  md5);
+    digest_hex(r.rom_sha1, DIGEST_SHA1_LEN, sha1);
+    printf("  MD5 %s  SHA-1 %s\r\n", md5, sha1);
+    if (r.save_name[0]) printf("  %s: %lu bytes\r\n", r.save_name, (unsigned long)r.save_bytes);
+}
+static void cli_auto_dump  (void){
+    // The SD card if there is one, else the host tool (n64dump -a)
+    sd_info_t si;
+    autodump_run(sd_init(&si) ? AUTODUMP_TO_SD : AUTODUMP_TO_HOST, 0, NULL);
+}
+static void cli_usb_drive  (void){
+    if (!cartfs_mount()) {
+        printf("\nNo cartridge\r\n");
+        return;
+    }
+    unsigned n;
+    const cartfs_file_t *f = cartfs_files(&n);
+    printf("\nCart drive attached (%lu MiB):\r\n", (unsigned long)(cartfs_blocks() >> 11));
+    for (unsigned i = 0; i < n; ++i)
+        printf("  %-40s %8lu bytes\r\n", f[i].name, (unsigned long)f[i].bytes);
+    printf("Press any key to eject\r\n");
+    // tud_task() serves the drive from its IRQ meanwhile
+    while (tud_cdc_connected() && getchar_timeout_us(100000) == PICO_ERROR_TIMEOUT) {}
+    cartfs_unmount();
+    printf("Ejected\r\n");
+}
+static void cli_test_ctrl  (void){
+    controller_info_t ci;
+    if (!controller_info(&ci)) {
+        printf("\nNo controller on the port\r\n");
+        return;
+    }
+    printf("\nController %04X, pak: %s\r\n", ci.id,
+           (ci.status & CTRL_STATUS_PAK) ? "yes" : "no");
+    printf("Waiting for the host tool (controller stream)...\r\n");
+    xfer_session(-1, CLI_XFER_WAIT_US);
+}
 static void cli_mpk_read   (void){ printf("\n(stub) Read MPK\r\n"); }
 static void cli_mpk_write  (void){ printf("\n(stub) Write MPK\r\n"); }
 static void cli_gameshark  (void){ printf("\n(stub) Gameshark\r\n"); }
-static void cli_repro      (void){ printf("\n(stub) Repro Tool\r\n"); }
+static void cli_repro      (void){
+    repro_info_t ri;
+    if (!repro_identify(&ri)) {
+        printf("\nNo known flash (vendor %04X, id %04X, cart %04X)\r\n",
+               ri.vendor, ri.flash_id, ri.cart_id);
+        return;
+    }
+    printf("\n%s x%u, %u MiB, %u-byte write buffer\r\n", ri.chip[0]->name,
+           ri.chips, (unsigned)(ri.bytes >> 20), ri.chip[0]->buffer_bytes);
+    printf("Waiting for the host tool (flash program)...\r\n");
+    xfer_session(-1, CLI_XFER_WAIT_US);
+}
 static void cli_reset_pico (void){ printf("\n(stub) Reset Pico\r\n"); }
 
 /* ------------------------------------------------------------ */
@@ -37,6 +130,17 @@ static const menu_t menu_dbg[] = {
     {'4', "Ping (EEPROM)", dbg_ping_eep},
     {'5', "Write (SRAM)", dbg_write_sram},
     {'6', "Dump SRAM to Stdout", dbg_dump_sram},
+    {'7', "Pipeline Stats", dbg_pipe_stats},
+    {'8', "Identify Cart", dbg_identify},
+    {'9', "Calibrate Bus", dbg_calibrate},
+    {'a', "Bus Benchmark", dbg_bus_bench},
+    {'c', "FlashRAM Info", dbg_flashram},
+    {'d', "Perf Stats", dbg_perf_stats},
+    {'e', "Cart Cache", dbg_cart_cache},
+    {'f', "Clear Cart Cache", dbg_cart_forget},
+#ifdef DEBUG
+    {'g', "Game Cartridge", menu_cartridge},    /* this is the root menu */
+#endif
     {'b', "Back",      NULL}
 };
 #define DBG_COUNT (sizeof menu_dbg / sizeof menu_dbg[0])
@@ -55,6 +159,9 @@ static const menu_t menu_cart[] = {
     {'1', "Dump ROM",    cli_rom_dump},
     {'2', "Read Save",   cli_save_read},
     {'3', "Write Save",  cli_save_write},
+    {'4', "Dump to SD",  cli_sd_dump},
+    {'5', "USB Drive",   cli_usb_drive},
+    {'6', "Auto Dump",   cli_auto_dump},
     {'b', "Back",        NULL}           /* NULL ⇒ pop menu */
 };
 #define CART_COUNT (sizeof menu_cart / sizeof menu_cart[0])
@@ -168,6 +275,13 @@ void cli_task(void)
     int ch;
     while ((ch = getchar_timeout_us(0)) != PICO_ERROR_TIMEOUT)
     {
+        /* Binary frame from a host tool: hand the port to xfer */
+        if (ch == XFER_SOF0) {
+            xfer_session(ch, 0);
+            show_menu();
+            continue;
+        }
+
         /* CR / LF just refresh the prompt */
         if (ch == '\r' || ch == '\n') {
             show_menu();
@@ -270,20 +384,29 @@ static void dbg_ping_sram(void) {
 }
 
 static void dbg_ping_eep(void) {
-    uint8_t Buffer[512];
+    static uint8_t Buffer[2048];                 // a 16 Kbit part
     char    title[ N64_TITLE_LENGTH + 1 ];
     bool    got;
 
-    ReadEepromData(0, Buffer);
-
     // Fill `title[]`; got == true if a valid title was read
     got = n64_get_title((uint8_t*)title, sizeof(title));
 
+    if (!ReadEepromBlocks(0, gEepromSize / 8u, Buffer)) {
+        printf("%s: no EEPROM\r\n", got ? title : "NOCART");
+        return;
+    }
+
     // Now print the buffer, not the bool
     printf("%s.eep contents:\n",
            got ? title : "NOCART");
 
-    print_hex_buffer(Buffer, sizeof(Buffer));
+    print_hex_buffer(Buffer, gEepromSize);
+
+    eep_stats_t st;
+    GetEepromStats(&st);
+    printf("%lu blocks in %lu us (%lu us/block, %lu retries)\r\n",
+           (unsigned long)st.blocks, (unsigned long)st.us,
+           (unsigned long)(st.us / st.blocks), (unsigned long)st.retries);
 }
 
 static void dbg_dump_sram(void) {
@@ -292,4 +415,152 @@ static void dbg_dump_sram(void) {
 
 static void dbg_write_sram(void) {
     write_first_32_bytes();
-}
\ No newline at end of file
+}
+
+static void dbg_pipe_stats(void) {
+    pipe_stats_t ps;
+    pipe_get_stats(&ps);
+    printf("\nLast transfer: %lu chunks\r\n", (unsigned long)ps.chunks);
+    printf("  core 1 (bus) waited for USB : %lu\r\n", (unsigned long)ps.producer_stalls);
+    printf("  core 0 (USB) waited for bus : %lu\r\n", (unsigned long)ps.consumer_stalls);
+}
+
+#define PERF_TRACE_SHOWN  16u
+
+static void dbg_perf_stats(void) {
+    static bus_perf_trace_t trace[PERF_TRACE_SHOWN];
+    bus_perf_counter_t c[BUS_PERF_EVENTS];
+    if (!bus_perf_take(c)) {
+        printf("\nBuilt without N64_PERF; no counters\r\n");
+        return;
+    }
+    printf("\n%-16s %10s %12s %8s %8s\r\n", "event", "count", "cycles", "avg", "max");
+    for (unsigned e = 0; e < BUS_PERF_EVENTS; ++e) {
+        if (!c[e].count) continue;
+        printf("%-16s %10lu %12llu %8lu %8lu\r\n", bus_perf_name(e), (unsigned long)c[e].count,
+               (unsigned long long)c[e].cycles, (unsigned long)(c[e].cycles / c[e].count),
+               (unsigned long)c[e].max_cycles);
+    }
+    unsigned n = bus_perf_take_trace(trace, PERF_TRACE_SHOWN);
+    if (n) printf("Last %u events (core, us, event, cycles, arg):\r\n", n);
+    for (unsigned i = 0; i < n; ++i) {
+        printf("  %u %10lu %-16s %6lu %08lX\r\n", trace[i].core, (unsigned long)trace[i].t_us,
+               bus_perf_name(trace[i].event), (unsigned long)trace[i].cycles,
+               (unsigned long)trace[i].arg);
+    }
+    printf("Counters reset\r\n");
+}
+
+static void dbg_cart_cache(void) {
+    cartid_t id;
+    uint32_t t0 = time_us_32();
+    bool     ok = cartid_prepare(&id, NULL);
+    uint32_t dt = time_us_32() - t0;
+    flashlog_stats_t st;
+    flashlog_get_stats(&st);
+
+    if (!ok) printf("\nNo cartridge\r\n");
+    else {
+        printf("\n%s %s v%u (CRC %08lX %08lX): ready in %lu us\r\n",
+               id.cached ? "Known cart" : "New cart", id.cart_id, id.version,
+               (unsigned long)id.crc1, (unsigned long)id.crc2, (unsigned long)dt);
+        printf("  ROM %lu KiB, save %s, EEPROM %lu bytes, bursts of %u bytes\r\n",
+               (unsigned long)(id.rom_bytes >> 10), n64db_save_name(id.save_type),
+               (unsigned long)id.eeprom_bytes, id.burst_bytes);
+        printf("  /RD access %u, ALE latch %u cycles\r\n",
+               id.timing.access_cycles, id.timing.latch_cycles);
+    }
+    printf("Cache: %lu carts, %lu of %lu slots used, %lu sector erases\r\n",
+           (unsigned long)st.records, (unsigned long)st.used,
+           (unsigned long)st.capacity, (unsigned long)st.erases);
+}
+
+static void dbg_cart_forget(void) {
+    cartid_forget_all();
+    printf("\nCart cache cleared\r\n");
+}
+
+static void dbg_identify(void) {
+    uint32_t crc1;
+    if (!n64_get_crc1(&crc1)) {
+        printf("Error: Failed to read N64 header\n");
+        return;
+    }
+
+    size_t   matches;
+    uint32_t t0 = time_us_32();
+    const n64db_entry_t *e = n64db_find(crc1, &matches);
+    uint32_t dt = time_us_32() - t0;
+
+    printf("\nCRC1 %08lX: ", (unsigned long)crc1);
+    if (!e) {
+        printf("not in the database (%u entries, %lu us)\r\n",
+               (unsigned)n64db_count, (unsigned long)dt);
+        t0 = time_us_32();
+        uint32_t size = n64_detect_rom_size();
+        dt = time_us_32() - t0;
+        printf("  Size: %lu MB (mirror probe, %lu us)\r\n",
+               (unsigned long)(size >> 20), (unsigned long)dt);
+        return;
+    }
+    printf("%u match(es) in %lu us\r\n", (unsigned)matches, (unsigned long)dt);
+    for (size_t i = 0; i < matches; ++i, ++e) {
+        printf("  %s\r\n", n64db_name(e));
+        printf("    Size: %u MB  Save: %s  CRC32: %08lX\r\n", e->size_mb,
+               n64db_save_name(e->save_type), (unsigned long)e->crc32);
+    }
+}
+
+static void dbg_calibrate(void) {
+    ad_bus_cal_result_t r;
+    uint32_t t0 = time_us_32();
+    bool     ok = adBus_calibrate(&r);
+    uint32_t dt = time_us_32() - t0;
+
+    if (!ok) {
+        printf("\nCalibration failed (no cart?), using default timing\r\n");
+        return;
+    }
+    printf("\nCalibrated in %lu us (%lu reference reads)\r\n",
+           (unsigned long)dt, (unsigned long)r.reads);
+    printf("  /RD access : %u cycles (stable down to %u)\r\n",
+           r.applied.access_cycles, r.fastest.access_cycles);
+    printf("  ALE latch  : %u cycles (stable down to %u)\r\n",
+           r.applied.latch_cycles, r.fastest.latch_cycles);
+    printf("  Burst      : %u bytes per address latch\r\n",
+           (unsigned)n64_probe_burst_bytes());
+}
+
+static void dbg_bus_bench(void) {
+    ad_bus_bench_t b;
+    adBus_benchmark(&b);
+    printf("\nAD bus (ROM, active timing):\r\n");
+    printf("  latch ALE_H+ALE_L : %lu ns\r\n", (unsigned long)b.latch_full_ns);
+    printf("  latch ALE_L only  : %lu ns\r\n", (unsigned long)b.latch_lo_ns);
+    printf("  CPU word read     : %lu ns\r\n", (unsigned long)b.read_word_ns);
+    printf("  PIO burst word    : %lu ns\r\n", (unsigned long)b.burst_word_ns);
+}
+
+static void dbg_flashram(void) {
+    static uint8_t buf[4096] __attribute__((aligned(4)));
+    flashram_info_t fi;
+
+    if (!flashram_identify(&fi)) {
+        printf("\nNo FlashRAM found\r\n");
+        return;
+    }
+    printf("\nFlashRAM %s, ID", fi.name);
+    for (int i = 0; i < 8; ++i) printf(" %02X", fi.id[i]);
+    printf("\r\n");
+
+    // Time a full backup read; the CRC lets two reads be compared
+    uint32_t crc = 0;
+    uint32_t t0  = time_us_32();
+    for (uint32_t off = 0; off < FLASHRAM_BYTES; off += sizeof(buf)) {
+        flashram_read(off, buf, sizeof(buf));
+        crc = crc32_update(crc, buf, sizeof(buf));
+    }
+    uint32_t dt = time_us_32() - t0;
+    printf("  Read %u KiB in %lu us, CRC32 %08lX\r\n", FLASHRAM_BYTES / 1024u,
+           (unsigned long)dt, (unsigned long)crc);
+}
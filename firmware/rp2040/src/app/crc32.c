@@ -0,0 +1,34 @@
+/* crc32.c – table-driven CRC-32, table built on first use (1 KiB RAM) */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "pico/platform.h"
+
+#include <app/crc32.h>
+
+#define CRC32_POLY 0xEDB88320u
+
+static uint32_t crc_table[256];
+static bool     crc_table_ready;
+
+static void crc32_build_table(void) {
+    for (uint32_t i = 0; i < 256; ++i) {
+        uint32_t c = i;
+        for (int k = 0; k < 8; ++k) {
+            c = (c & 1u) ? (c >> 1) ^ CRC32_POLY : (c >> 1);
+        }
+        crc_table[i] = c;
+    }
+    crc_table_ready = true;
+}
+
+uint32_t __time_critical_func(crc32_update)(uint32_t crc, const void *data, size_t len) {
+    if (!crc_table_ready) crc32_build_table();
+
+    const uint8_t *p = (const uint8_t *)data;
+    crc = ~crc;
+    while (len--) {
+        crc = crc_table[(crc ^ *p++) & 0xFFu] ^ (crc >> 8);
+    }
+    return ~crc;
+}
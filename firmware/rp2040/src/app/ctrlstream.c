@@ -0,0 +1,164 @@
+/* ctrlstream.c – controller polls at a fixed rate, streamed as binary frames
+ *  ---------------------------------------------------------------
+ *  • The poll timer and the joybus completion both run in interrupt
+ *    context; the USB loop only copies finished samples out of the ring
+ *  • head is only written by the completion interrupt, tail only by the
+ *    loop. Every slot carries its sample number, so a frame never spans
+ *    a drop or an unanswered poll and the host sees the gap.
+ *  • A tick that finds the previous poll still on the wire is skipped
+ *    and counted, rather than queued behind it
+ */
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "pico/stdlib.h"
+#include "pico/platform.h"
+#include "hardware/sync.h"
+#include "tusb.h"
+
+#include <app/ctrlstream.h>
+#include <app/xfer.h>
+#include <bus/joybus_port.h>
+#include <devices/controller.h>
+
+#define CTRLSTREAM_RX_EVERY_US  10000u     // how often the loop looks for ABORT
+
+static joybus_xfer_t       poll_x;
+static xfer_ctrl_sample_t  ring[CTRLSTREAM_RING];
+static uint32_t            ring_no[CTRLSTREAM_RING];   // sample number per slot
+static volatile uint32_t   head;           // written by the completion
+static volatile uint32_t   tail;           // written by the loop
+static uint32_t            sample_no;      // next sample number, drops included
+static uint32_t            period_us;
+static uint32_t            last_start;
+static bool                have_last;      // last_start belongs to the previous tick
+static xfer_ctrl_done_t    st;
+static xfer_ctrl_sample_t  batch[CTRLSTREAM_MAX_BATCH];
+
+static uint bucket(uint32_t us) {
+    if (us == 0) return 0;
+    uint b = 31u - (uint)__builtin_clz(us);
+    return b < XFER_CTRL_HIST_BUCKETS ? b : XFER_CTRL_HIST_BUCKETS - 1u;
+}
+
+/* ------------------------------------------------------------ */
+/*  Interrupt side                                               */
+/* ------------------------------------------------------------ */
+static void __time_critical_func(on_poll)(joybus_xfer_t *x) {
+    if (have_last) {
+        uint32_t dt = x->t_start - last_start;
+        uint32_t j  = dt > period_us ? dt - period_us : period_us - dt;
+        st.jitter[bucket(j)]++;
+        if (j > st.jitter_max_us) st.jitter_max_us = j;
+    }
+    last_start = x->t_start;
+    have_last  = true;
+
+    if (x->status != JOYBUS_OK) {
+        st.timeouts++;
+        sample_no++;                          // a gap, like a drop
+        return;
+    }
+    uint32_t h = head;
+    if (h - tail == CTRLSTREAM_RING) {
+        st.dropped++;
+        sample_no++;
+        return;
+    }
+    controller_state_t cs;
+    controller_poll_decode(x, &cs);
+    ring[h % CTRLSTREAM_RING]    = (xfer_ctrl_sample_t){ x->t_start, cs.buttons, cs.x, cs.y };
+    ring_no[h % CTRLSTREAM_RING] = sample_no++;
+    __dmb();                                  // slot contents before head
+    head = h + 1u;
+}
+
+static int64_t on_tick(alarm_id_t id, void *user) {
+    (void)id;
+    (void)user;
+    if (poll_x.status == JOYBUS_QUEUED || poll_x.status == JOYBUS_ACTIVE) {
+        st.overruns++;
+        have_last = false;                    // the next interval spans two periods
+    } else {
+        st.polls++;
+        controller_poll_submit(&poll_x, on_poll, NULL);
+    }
+    return -(int64_t)period_us;               // fixed rate, not fixed gap
+}
+
+/* ------------------------------------------------------------ */
+/*  USB side                                                     */
+/* ------------------------------------------------------------ */
+// Send the next run of consecutive samples; false if the ring was empty
+static bool send_batch(uint32_t *seq, uint16_t max_batch) {
+    uint32_t t = tail;
+    uint32_t h = head;
+    __dmb();                                  // head before slot contents
+    if (t == h) return false;
+
+    uint32_t first = ring_no[t % CTRLSTREAM_RING];
+    uint16_t n     = 0;
+    while (t + n != h && n < max_batch && ring_no[(t + n) % CTRLSTREAM_RING] == first + n) {
+        batch[n] = ring[(t + n) % CTRLSTREAM_RING];
+        n++;
+    }
+    __dmb();                                  // done reading before the slots are reused
+    tail = t + n;
+
+    xfer_send(XFER_T_SAMPLES, (*seq)++, first, batch, (uint16_t)(n * sizeof(batch[0])));
+    uint32_t now = time_us_32();
+    for (uint16_t i = 0; i < n; ++i) {
+        uint32_t lat = now - batch[i].t_us;
+        st.latency[bucket(lat)]++;
+        if (lat > st.latency_max_us) st.latency_max_us = lat;
+    }
+    st.samples += n;
+    return true;
+}
+
+bool ctrlstream_run(const xfer_ctrl_stream_t *rq, xfer_ctrl_done_t *out) {
+    controller_info_t ci;
+    if (!controller_info(&ci)) {
+        static const char msg[] = "no controller";
+        xfer_send(XFER_T_ERROR, 0, 0, msg, sizeof(msg) - 1u);
+        return false;
+    }
+
+    uint32_t hz = rq->rate_hz ? rq->rate_hz : CTRLSTREAM_DEFAULT_HZ;
+    if (hz > CTRLSTREAM_MAX_HZ) hz = CTRLSTREAM_MAX_HZ;
+    uint16_t max_batch = rq->max_batch ? rq->max_batch : CTRLSTREAM_DEFAULT_BATCH;
+    if (max_batch > CTRLSTREAM_MAX_BATCH) max_batch = CTRLSTREAM_MAX_BATCH;
+
+    memset(&st, 0, sizeof(st));
+    head = tail = 0;
+    sample_no     = 0;
+    have_last     = false;
+    period_us     = 1000000u / hz;
+    poll_x.status = JOYBUS_IDLE;
+
+    uint32_t   seq     = 0;
+    uint32_t   rx_last = time_us_32();
+    uint64_t   end     = time_us_64() + (uint64_t)rq->duration_ms * 1000u;  // 32-bit µs wrap at 71 min
+    alarm_id_t tick    = add_alarm_in_us(period_us, on_tick, NULL, true);
+
+    for (;;) {
+        if (send_batch(&seq, max_batch)) continue;
+
+        uint32_t now = time_us_32();
+        if (rq->duration_ms && time_us_64() >= end) break;
+        if (now - rx_last >= CTRLSTREAM_RX_EVERY_US) {
+            rx_last = now;
+            if (xfer_poll() == XFER_T_ABORT || !tud_cdc_connected()) break;
+        }
+        tight_loop_contents();
+    }
+
+    cancel_alarm(tick);
+    joybus_wait(&poll_x);
+    while (send_batch(&seq, max_batch)) {}
+
+    xfer_send(XFER_T_DONE, seq, st.samples, &st, sizeof(st));
+    if (out) *out = st;
+    return true;
+}
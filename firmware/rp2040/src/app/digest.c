@@ -0,0 +1,196 @@
+/* digest.c – CRC-32, MD5 (RFC 1321) and SHA-1 (FIPS 180-4), incremental
+ *  ---------------------------------------------------------------
+ *  • One update call feeds all three, so a dump is hashed exactly once
+ *    as it streams and the host never re-reads the file
+ *  • Block functions run from RAM: the M0+ has no cache for XIP misses
+ *    to hide behind while core 1 keeps the bus busy
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include "pico/platform.h"
+
+#include <app/crc32.h>
+#include <app/digest.h>
+
+static inline uint32_t rol32(uint32_t x, unsigned n) {
+    return (x << n) | (x >> (32u - n));
+}
+
+/* ------------------------------------------------------------ */
+/*  MD5                                                         */
+/* ------------------------------------------------------------ */
+static const uint32_t md5_k[64] = {
+    0xd76aa478, 0xe8c7b756, 0x242070db, 0xc1bdceee, 0xf57c0faf, 0x4787c62a, 0xa8304613, 0xfd469501,
+    0x698098d8, 0x8b44f7af, 0xffff5bb1, 0x895cd7be, 0x6b901122, 0xfd987193, 0xa679438e, 0x49b40821,
+    0xf61e2562, 0xc040b340, 0x265e5a51, 0xe9b6c7aa, 0xd62f105d, 0x02441453, 0xd8a1e681, 0xe7d3fbc8,
+    0x21e1cde6, 0xc33707d6, 0xf4d50d87, 0x455a14ed, 0xa9e3e905, 0xfcefa3f8, 0x676f02d9, 0x8d2a4c8a,
+    0xfffa3942, 0x8771f681, 0x6d9d6122, 0xfde5380c, 0xa4beea44, 0x4bdecfa9, 0xf6bb4b60, 0xbebfbc70,
+    0x289b7ec6, 0xeaa127fa, 0xd4ef3085, 0x04881d05, 0xd9d4d039, 0xe6db99e5, 0x1fa27cf8, 0xc4ac5665,
+    0xf4292244, 0x432aff97, 0xab9423a7, 0xfc93a039, 0x655b59c3, 0x8f0ccc92, 0xffeff47d, 0x85845dd1,
+    0x6fa87e4f, 0xfe2ce6e0, 0xa3014314, 0x4e0811a1, 0xf7537e82, 0xbd3af235, 0x2ad7d2bb, 0xeb86d391,
+};
+
+#define MD5_STEP(f, a, b, c, d, x, k, s) \
+    do { (a) += f((b), (c), (d)) + (x) + (k); (a) = rol32((a), (s)) + (b); } while (0)
+#define MD5_F(b, c, d) ((d) ^ ((b) & ((c) ^ (d))))
+#define MD5_G(b, c, d) ((c) ^ ((d) & ((b) ^ (c))))
+#define MD5_H(b, c, d) ((b) ^ (c) ^ (d))
+#define MD5_I(b, c, d) ((c) ^ ((b) | ~(d)))
+
+static void __time_critical_func(md5_block)(uint32_t st[4], const uint8_t *p) {
+    uint32_t x[16];
+    for (unsigned i = 0; i < 16; ++i, p += 4) {
+        x[i] = (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+    }
+    uint32_t a = st[0], b = st[1], c = st[2], d = st[3];
+    const uint32_t *k = md5_k;
+
+    // Four rounds of 16 steps; the message index pattern differs per round
+    for (unsigned i = 0; i < 16; i += 4, k += 4) {
+        MD5_STEP(MD5_F, a, b, c, d, x[i],      k[0],  7);
+        MD5_STEP(MD5_F, d, a, b, c, x[i + 1],  k[1], 12);
+        MD5_STEP(MD5_F, c, d, a, b, x[i + 2],  k[2], 17);
+        MD5_STEP(MD5_F, b, c, d, a, x[i + 3],  k[3], 22);
+    }
+    for (unsigned i = 0; i < 16; i += 4, k += 4) {
+        MD5_STEP(MD5_G, a, b, c, d, x[(5 * i + 1)  & 15], k[0],  5);
+        MD5_STEP(MD5_G, d, a, b, c, x[(5 * i + 6)  & 15], k[1],  9);
+        MD5_STEP(MD5_G, c, d, a, b, x[(5 * i + 11) & 15], k[2], 14);
+        MD5_STEP(MD5_G, b, c, d, a, x[(5 * i)      & 15], k[3], 20);
+    }
+    for (unsigned i = 0; i < 16; i += 4, k += 4) {
+        MD5_STEP(MD5_H, a, b, c, d, x[(3 * i + 5)  & 15], k[0],  4);
+        MD5_STEP(MD5_H, d, a, b, c, x[(3 * i + 8)  & 15], k[1], 11);
+        MD5_STEP(MD5_H, c, d, a, b, x[(3 * i + 11) & 15], k[2], 16);
+        MD5_STEP(MD5_H, b, c, d, a, x[(3 * i + 14) & 15], k[3], 23);
+    }
+    for (unsigned i = 0; i < 16; i += 4, k += 4) {
+        MD5_STEP(MD5_I, a, b, c, d, x[(7 * i)      & 15], k[0],  6);
+        MD5_STEP(MD5_I, d, a, b, c, x[(7 * i + 7)  & 15], k[1], 10);
+        MD5_STEP(MD5_I, c, d, a, b, x[(7 * i + 14) & 15], k[2], 15);
+        MD5_STEP(MD5_I, b, c, d, a, x[(7 * i + 5)  & 15], k[3], 21);
+    }
+    st[0] += a; st[1] += b; st[2] += c; st[3] += d;
+}
+
+/* ------------------------------------------------------------ */
+/*  SHA-1                                                       */
+/* ------------------------------------------------------------ */
+static void __time_critical_func(sha1_block)(uint32_t st[5], const uint8_t *p) {
+    uint32_t w[16];                           // rolling schedule, 64 B of stack
+    for (unsigned i = 0; i < 16; ++i, p += 4) {
+        w[i] = (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 8 | (uint32_t)p[3];
+    }
+    uint32_t a = st[0], b = st[1], c = st[2], d = st[3], e = st[4];
+
+    for (unsigned t = 0; t < 80; ++t) {
+        uint32_t wt;
+        if (t < 16) {
+            wt = w[t];
+        } else {
+            wt = rol32(w[(t + 13) & 15] ^ w[(t + 8) & 15] ^ w[(t + 2) & 15] ^ w[t & 15], 1);
+            w[t & 15] = wt;
+        }
+
+        uint32_t f, k;
+        if      (t < 20) { f = d ^ (b & (c ^ d));           k = 0x5A827999u; }
+        else if (t < 40) { f = b ^ c ^ d;                   k = 0x6ED9EBA1u; }
+        else if (t < 60) { f = (b & c) | (d & (b | c));     k = 0x8F1BBCDCu; }
+        else             { f = b ^ c ^ d;                   k = 0xCA62C1D6u; }
+
+        uint32_t tmp = rol32(a, 5) + f + e + k + wt;
+        e = d;
+        d = c;
+        c = rol32(b, 30);
+        b = a;
+        a = tmp;
+    }
+    st[0] += a; st[1] += b; st[2] += c; st[3] += d; st[4] += e;
+}
+
+/* ------------------------------------------------------------ */
+/*  Block buffering (both hashes use 64-byte blocks)            */
+/* ------------------------------------------------------------ */
+typedef void (*block_fn_t)(uint32_t *st, const uint8_t *p);
+
+static void feed(uint32_t *st, uint8_t block[64], uint64_t *bytes, block_fn_t fn,
+                 const uint8_t *p, size_t len)
+{
+    size_t used = (size_t)(*bytes & 63u);
+    *bytes += len;
+
+    if (used) {
+        size_t take = 64u - used;
+        if (take > len) take = len;
+        memcpy(&block[used], p, take);
+        p   += take;
+        len -= take;
+        if (used + take < 64u) return;
+        fn(st, block);
+    }
+    for (; len >= 64u; p += 64, len -= 64u) fn(st, p);
+    if (len) memcpy(block, p, len);
+}
+
+// Pad with 0x80, zeros and the bit count (little-endian for MD5, big for SHA-1)
+static void pad(uint32_t *st, uint8_t block[64], uint64_t bytes, block_fn_t fn, bool big) {
+    size_t   used = (size_t)(bytes & 63u);
+    uint64_t bits = bytes * 8u;
+
+    block[used++] = 0x80;
+    if (used > 56u) {
+        memset(&block[used], 0, 64u - used);
+        fn(st, block);
+        used = 0;
+    }
+    memset(&block[used], 0, 56u - used);
+    for (unsigned i = 0; i < 8; ++i) {
+        block[big ? 63u - i : 56u + i] = (uint8_t)(bits >> (8u * i));
+    }
+    fn(st, block);
+}
+
+/* ------------------------------------------------------------ */
+/*  Public API                                                  */
+/* ------------------------------------------------------------ */
+void digest_init(digest_t *d) {
+    static const uint32_t md5_iv[4]  = { 0x67452301u, 0xEFCDAB89u, 0x98BADCFEu, 0x10325476u };
+    static const uint32_t sha1_iv[5] = { 0x67452301u, 0xEFCDAB89u, 0x98BADCFEu, 0x10325476u,
+                                         0xC3D2E1F0u };
+    d->crc32 = 0;
+    memcpy(d->md5.state, md5_iv, sizeof(md5_iv));
+    memcpy(d->sha1.state, sha1_iv, sizeof(sha1_iv));
+    d->md5.bytes  = 0;
+    d->sha1.bytes = 0;
+}
+
+void digest_update(digest_t *d, const void *data, size_t len) {
+    const uint8_t *p = (const uint8_t *)data;
+    d->crc32 = crc32_update(d->crc32, p, len);
+    feed(d->md5.state,  d->md5.block,  &d->md5.bytes,  md5_block,  p, len);
+    feed(d->sha1.state, d->sha1.block, &d->sha1.bytes, sha1_block, p, len);
+}
+
+void digest_final(digest_t *d, digest_result_t *out) {
+    pad(d->md5.state,  d->md5.block,  d->md5.bytes,  md5_block,  false);
+    pad(d->sha1.state, d->sha1.block, d->sha1.bytes, sha1_block, true);
+
+    out->crc32 = d->crc32;
+    for (unsigned i = 0; i < 4; ++i) {
+        for (unsigned j = 0; j < 4; ++j) out->md5[4 * i + j] = (uint8_t)(d->md5.state[i] >> (8u * j));
+    }
+    for (unsigned i = 0; i < 5; ++i) {
+        for (unsigned j = 0; j < 4; ++j) out->sha1[4 * i + j] = (uint8_t)(d->sha1.state[i] >> (24u - 8u * j));
+    }
+}
+
+void digest_hex(const uint8_t *b, size_t n, char *out) {
+    static const char hex[] = "0123456789abcdef";
+    for (size_t i = 0; i < n; ++i) {
+        out[2 * i]      = hex[b[i] >> 4];
+        out[2 * i + 1u] = hex[b[i] & 0x0Fu];
+    }
+    out[2 * n] = '\0';
+}
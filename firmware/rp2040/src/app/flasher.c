@@ -0,0 +1,246 @@
+/* flasher.c – program a repro cart from PDATA frames
+ *  ---------------------------------------------------------------
+ *  • Payloads land in the pipeline slot they will be programmed from;
+ *    nothing is copied on the way to the flash
+ *  • While every slot is busy, core 0 stops reading USB. The host's
+ *    writes block on USB flow control, so the link runs at the speed
+ *    of the flash, not ahead of it
+ *  • Go-back-N like xfer.c, with the roles swapped: one NAK per gap,
+ *    duplicates are ACKed again
+ *  • The differential scan runs on core 0 before core 1 takes the bus,
+ *    with the burst reader; 64 MiB is a few seconds
+ */
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "pico/stdlib.h"
+
+#include <app/crc32.h>
+#include <app/flasher.h>
+#include <app/pipeline.h>
+#include <app/xfer.h>
+#include <bus/ad_bus.h>
+#include <bus/ad_bus_timing.h>
+#include <devices/cartridge.h>
+#include <devices/reproflash.h>
+
+#define SCAN_BYTES  4096u
+
+static uint8_t       *cur_slot;
+static uint32_t       rx_crc;
+static uint32_t       total;
+static uint32_t       next_off;        // where the last committed piece ended
+static uint32_t       fail_offset;
+static uint32_t       n_erased, n_blank;
+static bool           diff;
+static xfer_sector_t  map[FLASHER_MAX_SECTORS];
+static uint32_t       map_n;
+static uint32_t       map_i;           // entry holding next_off
+static uint8_t        scan_buf[SCAN_BYTES] __attribute__((aligned(4)));
+
+/* ------------------------------------------------------------ */
+/*  Differential scan                                            */
+/* ------------------------------------------------------------ */
+static bool scan(uint32_t length) {
+    map_n = 0;
+    for (uint32_t off = 0; off < length;) {
+        uint32_t start, size;
+        if (!repro_sector(off, &start, &size) || map_n == FLASHER_MAX_SECTORS) return false;
+        uint32_t crc   = 0;
+        bool     blank = true;
+        for (uint32_t p = start; p < start + size; p += SCAN_BYTES) {
+            n64_read_bytes_fast(N64_ROM_BASE + p, scan_buf, SCAN_BYTES);
+            crc = crc32_update(crc, scan_buf, SCAN_BYTES);
+            for (uint32_t i = 0; blank && i < SCAN_BYTES; ++i) blank = scan_buf[i] == 0xFFu;
+        }
+        map[map_n++] = (xfer_sector_t){
+            .offset = start, .size = size, .crc32 = crc,
+            .flags  = blank ? XFER_SECTOR_BLANK : 0,
+        };
+        off = start + size;
+    }
+    return true;
+}
+
+const xfer_sector_t *flasher_sectors(uint32_t *count) {
+    *count = diff ? map_n : 0;
+    return map;
+}
+
+// Map entry for 'offset', moving forward only like the stream does
+static const xfer_sector_t *entry_at(uint32_t offset) {
+    while (map_i < map_n && map[map_i].offset + map[map_i].size <= offset) map_i++;
+    return (map_i < map_n && map[map_i].offset <= offset) ? &map[map_i] : NULL;
+}
+
+bool flasher_accepts(uint32_t offset) {
+    if (offset == next_off) return true;
+    if (!diff || offset < next_off) return false;
+    uint32_t start, size;
+    return repro_sector(offset, &start, &size) && start == offset;
+}
+
+/* ------------------------------------------------------------ */
+/*  Programming                                                  */
+/* ------------------------------------------------------------ */
+bool flasher_begin(uint32_t length, uint32_t flags, repro_info_t *info, const char **err) {
+    repro_info_t ri;
+    bool found = repro_identify(&ri);
+    if (info) *info = ri;
+    if (!found) {
+        *err = "no known repro flash";
+        return false;
+    }
+    if (length == 0 || (length & 1u) || length > ri.bytes) {
+        *err = "image does not fit the flash";
+        return false;
+    }
+
+    // Flash is faster than mask ROM; the scan and every read-back gain
+    adBus_calibrate(NULL);
+    n64_probe_burst_bytes();
+    diff = (flags & XFER_PROGRAM_DIFF) != 0;
+    if (diff && !scan(length)) {
+        *err = "too many sectors";
+        return false;
+    }
+    rx_crc      = 0;
+    total       = length;
+    next_off    = 0;
+    map_i       = 0;
+    fail_offset = 0;
+    n_erased    = 0;
+    n_blank     = 0;
+    pipe_reset_stats();
+    pipe_start_write(PIPE_REGION_REPRO, 0);
+    return true;
+}
+
+uint8_t *flasher_slot(void) {
+    cur_slot = pipe_write_slot();
+    return cur_slot;
+}
+
+bool flasher_commit(uint32_t offset, uint16_t len) {
+    uint8_t  flags = 0;
+    uint32_t start, size;
+    if (repro_sector(offset, &start, &size) && start == offset) {
+        const xfer_sector_t *e = diff ? entry_at(offset) : NULL;
+        if (e && (e->flags & XFER_SECTOR_BLANK)) {
+            flags = PIPE_WRITE_NO_ERASE;
+            n_blank++;
+        } else {
+            n_erased++;
+        }
+    }
+    rx_crc   = crc32_update(rx_crc, cur_slot, len);   // core 1 only reads the slot too
+    next_off = offset + len;
+    pipe_write_commit(offset, len, flags);
+    return !pipe_write_failed(&fail_offset);
+}
+
+bool flasher_end(xfer_program_done_t *out) {
+    uint32_t flash_crc = 0;
+    bool ok = pipe_write_finish(&flash_crc);
+    if (!ok) pipe_write_failed(&fail_offset);
+    repro_reset();
+
+    pipe_stats_t ps;
+    pipe_get_stats(&ps);
+    if (out) {
+        memset(out, 0, sizeof(*out));
+        out->length          = total;
+        out->crc32           = rx_crc;
+        out->flash_crc32     = flash_crc;
+        out->producer_stalls = ps.producer_stalls;
+        out->consumer_stalls = ps.consumer_stalls;
+        out->erased          = n_erased;
+        out->blank           = n_blank;
+    }
+    return ok;
+}
+
+uint32_t flasher_fail_offset(void) {
+    return fail_offset;
+}
+
+/* ------------------------------------------------------------ */
+/*  USB session                                                  */
+/* ------------------------------------------------------------ */
+static void tx_fail(void) {
+    char msg[40];
+    int n = snprintf(msg, sizeof(msg), "flash write failed at 0x%08X", (unsigned)fail_offset);
+    xfer_send(XFER_T_ERROR, 0, fail_offset, msg, (uint16_t)n);
+}
+
+bool flasher_run(const xfer_program_t *rq, xfer_program_done_t *out) {
+    const char *err;
+    uint32_t t0 = time_us_32();
+    if (!flasher_begin(rq->length, rq->flags, NULL, &err)) {
+        xfer_send(XFER_T_ERROR, 0, 0, err, (uint16_t)strlen(err));
+        return false;
+    }
+
+    uint32_t n;
+    const xfer_sector_t *sec = flasher_sectors(&n);
+    for (uint32_t i = 0, fseq = 0; i < n; i += XFER_MAX_PAYLOAD / sizeof(*sec)) {
+        uint32_t k = n - i < XFER_MAX_PAYLOAD / sizeof(*sec) ? n - i : XFER_MAX_PAYLOAD / sizeof(*sec);
+        xfer_send(XFER_T_SECTORS, fseq++, i, &sec[i], (uint16_t)(k * sizeof(*sec)));
+    }
+
+    uint32_t seq     = 0;       // next frame expected
+    uint32_t off     = 0;
+    uint32_t naks    = 0;
+    uint32_t retries = 0;
+    bool     nak_out = false;   // a NAK for 'seq' is already on its way
+    bool     ok      = true;
+    xfer_send(XFER_T_ACK, 0, 0, NULL, 0);
+
+    while (ok && off < rq->length) {
+        uint8_t *buf = flasher_slot();
+        xfer_header_t h;
+        if (!xfer_recv(&h, buf, PIPE_SLOT_BYTES, XFER_ACK_TIMEOUT_US)) {
+            if (++retries > XFER_MAX_RETRIES) ok = false;             // host gone
+            else xfer_send(XFER_T_ACK, seq, off, NULL, 0);            // where we are
+            continue;
+        }
+        retries = 0;
+        if (h.type == XFER_T_ABORT) ok = false;
+        if (h.type != XFER_T_PDATA) continue;
+
+        if (h.seq < seq) {
+            xfer_send(XFER_T_ACK, seq, off, NULL, 0);
+            continue;
+        }
+        if (h.seq == seq && h.len == 0) break;       // differential: nothing more
+        if (h.seq > seq || !flasher_accepts(h.offset) || (h.len & 1u) ||
+            h.offset > rq->length || h.len > rq->length - h.offset) {
+            if (!nak_out) {
+                xfer_send(XFER_T_NAK, seq, off, NULL, 0);
+                nak_out = true;
+                naks++;
+            }
+            continue;
+        }
+        nak_out = false;
+        ok  = flasher_commit(h.offset, h.len);
+        off = h.offset + h.len;
+        seq++;
+        if (ok) xfer_send(XFER_T_ACK, seq, off, NULL, 0);
+    }
+
+    xfer_program_done_t done;
+    bool written = flasher_end(&done);
+    if (!written) {
+        tx_fail();
+        return false;
+    }
+    if (!ok) return false;                    // aborted, or the host went away
+
+    done.naks = naks;
+    done.us   = time_us_32() - t0;
+    xfer_send(XFER_T_DONE, seq, done.length, &done, sizeof(done));
+    if (out) *out = done;
+    return !rq->crc32 || (done.crc32 == rq->crc32 && done.flash_crc32 == rq->crc32);
+}
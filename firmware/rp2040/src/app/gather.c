@@ -0,0 +1,142 @@
+/* gather.c – sorted, merged scatter/gather reads
+ *  ---------------------------------------------------------------
+ *  • Insertion sort of the range indices by address; 64 entries at
+ *    most, so nothing cleverer pays off
+ *  • Runs never span from the ROM window into the domains below it:
+ *    the ROM is read in PIO bursts, the rest one latched word at a
+ *    time (SRAM is not known to auto-increment)
+ *  • Runs are word-aligned and start on 4-byte boundaries in the buffer
+ *    so the DMA can store halfwords; the buffer is sized for the worst
+ *    case of bridged gaps and alignment, so a valid list always fits
+ */
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "pico/stdlib.h"
+
+#include <app/gather.h>
+#include <app/xfer.h>
+#include <bus/ad_bus.h>
+#include <devices/cartridge.h>
+
+#define GATHER_BUF_BYTES  (XFER_GATHER_MAX_BYTES + XFER_GATHER_MAX_RANGES * (GATHER_BRIDGE_BYTES + 4u))
+
+typedef struct {
+    uint32_t addr, end;      // word-aligned bus addresses
+    uint32_t buf_off;
+} gather_run_t;
+
+static uint8_t      buf[GATHER_BUF_BYTES] __attribute__((aligned(4)));
+static uint8_t      frame[XFER_MAX_PAYLOAD];
+static uint8_t      order[XFER_GATHER_MAX_RANGES];
+static uint8_t      run_of[XFER_GATHER_MAX_RANGES];
+static gather_run_t runs[XFER_GATHER_MAX_RANGES];
+
+static void tx_error(const char *msg) {
+    xfer_send(XFER_T_ERROR, 0, 0, msg, (uint16_t)strlen(msg));
+}
+
+static inline bool in_rom(uint32_t addr) { return addr >= N64_ROM_BASE; }
+
+/* ------------------------------------------------------------ */
+/*  Plan                                                         */
+/* ------------------------------------------------------------ */
+static void sort_ranges(const xfer_range_t *r, uint32_t n) {
+    for (uint32_t i = 0; i < n; ++i) {
+        uint32_t j = i;
+        for (; j > 0 && r[order[j - 1]].addr > r[i].addr; --j) order[j] = order[j - 1];
+        order[j] = (uint8_t)i;
+    }
+}
+
+static uint32_t merge_runs(const xfer_range_t *r, uint32_t n) {
+    uint32_t nr = 0;
+    for (uint32_t k = 0; k < n; ++k) {
+        uint32_t i = order[k];
+        if (r[i].len == 0) continue;
+        uint32_t a = r[i].addr & ~1u;
+        uint32_t e = (r[i].addr + r[i].len + 1u) & ~1u;
+        gather_run_t *cur = nr ? &runs[nr - 1u] : NULL;
+        if (cur && in_rom(a) == in_rom(cur->addr) && (a <= cur->end || a - cur->end <= GATHER_BRIDGE_BYTES)) {
+            if (e > cur->end) cur->end = e;
+        } else {
+            cur = &runs[nr++];
+            cur->addr = a;
+            cur->end  = e;
+        }
+        run_of[i] = (uint8_t)(nr - 1u);
+    }
+
+    uint32_t off = 0;
+    for (uint32_t k = 0; k < nr; ++k) {
+        runs[k].buf_off = off;
+        off = (off + runs[k].end - runs[k].addr + 3u) & ~3u;
+    }
+    return nr;
+}
+
+/* ------------------------------------------------------------ */
+/*  Run                                                          */
+/* ------------------------------------------------------------ */
+bool gather_run(const xfer_range_t *r, uint32_t n, xfer_gather_done_t *out) {
+    uint32_t t0 = time_us_32();
+    xfer_gather_done_t done = { .ranges = n };
+
+    if (n == 0 || n > XFER_GATHER_MAX_RANGES) {
+        tx_error(n == 0 ? "empty GATHER" : "GATHER too large");
+        return false;
+    }
+    uint64_t total = 0;
+    for (uint32_t i = 0; i < n; ++i) {
+        total += r[i].len;
+        if ((uint64_t)r[i].addr + r[i].len + 1u > UINT32_MAX) {
+            tx_error("range wraps");
+            return false;
+        }
+    }
+    if (total > XFER_GATHER_MAX_BYTES) {
+        tx_error("GATHER too large");
+        return false;
+    }
+
+    sort_ranges(r, n);
+    done.runs = merge_runs(r, n);
+    for (uint32_t k = 0; k < done.runs; ++k) {
+        uint32_t len = runs[k].end - runs[k].addr;
+        if (in_rom(runs[k].addr)) n64_read_bytes_fast(runs[k].addr, &buf[runs[k].buf_off], len);
+        else                      n64_read_bytes(runs[k].addr, &buf[runs[k].buf_off], len);
+        done.bus_bytes += len;
+    }
+
+    // Request order; frames are filled to the brim across range borders
+    uint32_t seq = 0, fill = 0;
+    for (uint32_t i = 0; i < n; ++i) {
+        if (r[i].len == 0) continue;
+        const gather_run_t *g = &runs[run_of[i]];
+        const uint8_t *src = &buf[g->buf_off + (r[i].addr - g->addr)];
+        uint32_t left = r[i].len;
+        while (left) {
+            uint32_t k = XFER_MAX_PAYLOAD - fill;
+            if (k > left) k = left;
+            memcpy(&frame[fill], src, k);
+            src  += k;
+            left -= k;
+            fill += k;
+            if (fill == XFER_MAX_PAYLOAD) {
+                xfer_send(XFER_T_DATA, seq++, done.bytes, frame, (uint16_t)fill);
+                done.bytes += fill;
+                fill = 0;
+            }
+        }
+    }
+    if (fill) {
+        xfer_send(XFER_T_DATA, seq++, done.bytes, frame, (uint16_t)fill);
+        done.bytes += fill;
+    }
+
+    done.us = time_us_32() - t0;
+    xfer_send(XFER_T_DONE, seq, done.bytes, &done, sizeof(done));
+    if (out) *out = done;
+    return true;
+}
@@ -1,31 +1,44 @@
 /*  main.c – RP2040 / Pico
  *  ---------------------------------------------------------------
- *  • Single CDC ACM port (stdio-USB) – VID 2E8A, PID 000A
+ *  • CDC ACM console (stdio-USB) + mass storage – VID 2E8A, PID 000A
+ *    (descriptors in src/usb)
  *  • Works with `picotool reboot/load` (no BOOTSEL button)
+ *  • tud_task() runs from stdio-USB's background IRQ, also while a
+ *    modal loop (xfer, ctrlstream) owns the CLI
  */
 #include <stdio.h>
 #include "pico/stdlib.h"
 #include "tusb.h"
 
+#include <app/cartid.h>
 #include <app/cli.h>
+#include <app/pipeline.h>
 #include <bus/ad_bus.h>
+#include <bus/bus_perf.h>
 #include <bus/joybus.h>
+#include <devices/controller.h>
 
 /*------------------------------------------------------------------*/
 /* Main                                                             */
 /*------------------------------------------------------------------*/
 int main(void)
 {
-    stdio_init_all();        // routes printf to USB CDC (adds vendor iface)
-    tusb_init();             // TinyUSB device stack
+    tusb_init();             // TinyUSB device stack, before stdio attaches
+    stdio_init_all();        // routes printf to USB CDC
+
+    bus_perf_init();         // cycle counter (N64_PERF builds)
 
     // Initialize AD Bus and Joybus
     n64_adBus_init();
     n64_eep_init();
+    controller_init();
+    cartid_init();           // carts seen before, kept in flash
+
+    // Core 1 takes over the bus whenever a dump is streaming
+    pipe_init();
 
     while (true)
     {
-        tud_task();          // TinyUSB polling
         cli_task();           // CLI
     }
 }
\ No newline at end of file
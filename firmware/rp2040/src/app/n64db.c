@@ -0,0 +1,65 @@
+/* n64db.c – binary search over the generated cartridge table */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "pico/stdlib.h"
+
+#include <app/n64db.h>
+#include <bus/joybus.h>
+#include <devices/cartridge.h>
+#include <devices/flashram.h>
+
+const n64db_entry_t *n64db_find(uint32_t crc1, size_t *matches) {
+    // Lower bound: first entry whose crc1 is not below the key
+    size_t lo = 0, hi = n64db_count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2u;
+        if (n64db_table[mid].crc1 < crc1) lo = mid + 1u;
+        else                              hi = mid;
+    }
+    if (lo == n64db_count || n64db_table[lo].crc1 != crc1) {
+        if (matches) *matches = 0;
+        return NULL;
+    }
+
+    if (matches) {
+        size_t n = 1;
+        while (lo + n < n64db_count && n64db_table[lo + n].crc1 == crc1) ++n;
+        *matches = n;
+    }
+    return &n64db_table[lo];
+}
+
+const n64db_entry_t *n64db_identify(uint32_t *rom_bytes) {
+    uint32_t crc1;
+    const n64db_entry_t *e = n64_get_crc1(&crc1) ? n64db_find(crc1, NULL) : NULL;
+    if (rom_bytes) *rom_bytes = e ? (uint32_t)e->size_mb * 1024u * 1024u : n64_detect_rom_size();
+    return e;
+}
+
+uint8_t n64db_save_type(const n64db_entry_t *e) {
+    uint8_t eep = (gEepromSize > 512u) ? N64DB_SAVE_EEP16K : N64DB_SAVE_EEP4K;
+    if (e) {
+        switch (e->save_type) {
+        case N64DB_SAVE_SRAM:     return N64DB_SAVE_SRAM;
+        case N64DB_SAVE_FLASHRAM: return flashram_identify(NULL) ? N64DB_SAVE_FLASHRAM : N64DB_SAVE_NONE;
+        case N64DB_SAVE_EEP4K:
+        case N64DB_SAVE_EEP16K:   return gEepromSize ? eep : N64DB_SAVE_NONE;
+        default:                  return N64DB_SAVE_NONE;
+        }
+    }
+    // Unknown cart: only the joybus probe is safe. A FlashRAM probe writes
+    // the save window, which an SRAM board may take as a save write.
+    return gEepromSize ? eep : N64DB_SAVE_NONE;
+}
+
+const char *n64db_save_name(uint8_t save_type) {
+    switch (save_type) {
+    case N64DB_SAVE_NONE:     return "None";
+    case N64DB_SAVE_SRAM:     return "SRAM";
+    case N64DB_SAVE_FLASHRAM: return "FlashRAM";
+    case N64DB_SAVE_EEP4K:    return "4K EEPROM";
+    case N64DB_SAVE_EEP16K:   return "16K EEPROM";
+    default:                  return "unknown";
+    }
+}
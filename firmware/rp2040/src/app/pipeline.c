@@ -0,0 +1,332 @@
+/* pipeline.c – overlap cartridge reads (core 1) with USB transmission (core 0)
+ *  ---------------------------------------------------------------
+ *  • head is only written by core 1, tail only by core 0; a slot is
+ *    published with a barrier before head moves, so no locks are needed
+ *  • Stall counters count episodes, not spin iterations
+ *  • Writing swaps the roles: core 0 moves head, core 1 moves tail once
+ *    a slot is programmed and read back
+ */
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include "pico/stdlib.h"
+#include "pico/multicore.h"
+#include "hardware/sync.h"
+
+#include <app/crc32.h>
+#include <app/pipeline.h>
+#include <bus/ad_bus.h>
+#include <bus/bus_perf.h>
+#include <bus/joybus.h>
+#include <devices/cartridge.h>
+#include <devices/flashram.h>
+#include <devices/reproflash.h>
+
+#define PIPE_CMD_START   0x50495031u   // "PIP1"
+#define PIPE_CMD_STOP    0x50495030u   // "PIP0"
+#define PIPE_CMD_PARK    0x5049504Bu   // "PIPK"
+#define PIPE_ACK         0x50495041u   // "PIPA"
+#define PIPE_EEP_BYTES   2048u
+
+typedef struct {
+    uint32_t offset;
+    uint16_t len;
+    uint8_t  flags;          // PIPE_WRITE_*
+} slot_info_t;
+
+// DMA stores halfwords into the slots, keep them aligned
+static uint8_t            slots[PIPE_SLOTS][PIPE_SLOT_BYTES] __attribute__((aligned(4)));
+static slot_info_t        slot_info[PIPE_SLOTS];
+static volatile uint32_t  head;          // slots filled  (core 1 writes; core 0 when writing)
+static volatile uint32_t  tail;          // slots drained (core 0 writes; core 1 when writing)
+static volatile pipe_stats_t stats;
+
+// Written by core 0 before PIPE_CMD_START, read by core 1 afterwards
+static struct {
+    uint8_t  region;
+    bool     write;
+    uint32_t offset;
+    uint32_t end;
+    uint16_t chunk;
+} job;
+
+// Write direction results, owned by core 1 while a job runs
+static volatile bool      w_failed;
+static volatile uint32_t  w_fail_offset;
+static volatile uint32_t  w_crc;
+
+static uint8_t  eep_cache[PIPE_EEP_BYTES];
+static uint8_t  readback[PIPE_SLOT_BYTES] __attribute__((aligned(4)));
+static uint32_t next_offset;             // core 0: offset of the next chunk it expects
+
+// Core 0 holds core 1 in park() while it programs flash
+static volatile bool park_req;
+static volatile bool parked;
+static bool     launched;
+
+/* ------------------------------------------------------------ */
+/*  Core 1                                                      */
+/* ------------------------------------------------------------ */
+static void produce(uint32_t off, uint8_t *dst, uint16_t len) {
+    switch (job.region) {
+    case PIPE_REGION_ROM:
+        n64_read_bytes_fast(N64_ROM_BASE + off, dst, len);
+        break;
+    case PIPE_REGION_SRAM:
+        n64_read_bytes(N64_SRAM_BASE + off, dst, len);
+        break;
+    case PIPE_REGION_FLASHRAM:
+        flashram_read(off, dst, len);
+        break;
+    default:
+        memcpy(dst, &eep_cache[off], len);
+        break;
+    }
+}
+
+// Write one slot, then read it back for the running CRC
+static void consume(const slot_info_t *si, const uint8_t *src) {
+    uint32_t off = si->offset;
+    uint16_t len = si->len;
+    bool     ok  = false;
+    switch (job.region) {
+    case PIPE_REGION_REPRO:
+        ok = repro_write(off, src, len, !(si->flags & PIPE_WRITE_NO_ERASE));
+        if (ok) {
+            n64_read_bytes_fast(N64_ROM_BASE + off, readback, len);
+            w_crc = crc32_update(w_crc, readback, len);
+        }
+        break;
+    default:
+        break;
+    }
+    if (!ok) {
+        w_fail_offset = off;
+        w_failed      = true;
+    }
+}
+
+// One step of a write job; the ring is drained even after a failure so
+// core 0 never waits on a slot that will not come back
+static void write_step(bool *stalled) {
+    if (head == tail) {
+        if (!*stalled) {
+            stats.consumer_stalls++;
+            *stalled = true;
+        }
+        tight_loop_contents();
+        return;
+    }
+    *stalled = false;
+    __dmb();                                  // head before slot contents
+
+    uint32_t i = tail % PIPE_SLOTS;
+    if (!w_failed) consume(&slot_info[i], slots[i]);
+    __dmb();                                  // done with the slot before it is reused
+    tail = tail + 1;
+    stats.chunks++;
+}
+
+// Flash is not readable while core 0 programs it: wait in RAM with
+// interrupts off until it is done
+static void __not_in_flash_func(park)(void) {
+    uint32_t irq = save_and_disable_interrupts();
+    parked = true;
+    while (park_req) tight_loop_contents();
+    parked = false;
+    restore_interrupts(irq);
+}
+
+static void core1_main(void) {
+    bool     active  = false;
+    bool     stalled = false;
+    uint32_t off     = 0;
+
+    bus_perf_init();                          // this core's SysTick
+
+    for (;;) {
+        // Commands are only taken between chunks
+        if (multicore_fifo_rvalid()) {
+            uint32_t cmd = multicore_fifo_pop_blocking();
+            active  = (cmd == PIPE_CMD_START);
+            stalled = false;
+            if (active) {
+                off = job.offset;
+                if (job.region == PIPE_REGION_EEPROM) {
+                    // Joybus is slow per block; fetch it once per stream
+                    uint32_t n = gEepromSize < PIPE_EEP_BYTES ? gEepromSize : PIPE_EEP_BYTES;
+                    ReadEepromBlocks(0, n / 8u, eep_cache);
+                }
+            }
+            multicore_fifo_push_blocking(PIPE_ACK);
+            if (cmd == PIPE_CMD_PARK) park();
+            continue;
+        }
+
+        if (!active) {
+            tight_loop_contents();
+            continue;
+        }
+        if (job.write) {
+            write_step(&stalled);
+            continue;
+        }
+        if (head - tail == PIPE_SLOTS) {
+            if (!stalled) {
+                stats.producer_stalls++;
+                stalled = true;
+            }
+            tight_loop_contents();
+            continue;
+        }
+        stalled = false;
+
+        uint32_t i   = head % PIPE_SLOTS;
+        uint32_t rem = job.end - off;
+        uint16_t len = (uint16_t)(rem < job.chunk ? rem : job.chunk);
+        produce(off, slots[i], len);
+        slot_info[i] = (slot_info_t){ off, len, 0 };
+        __dmb();                              // slot contents before head
+        head = head + 1;
+        stats.chunks++;
+
+        off += len;
+        if (off >= job.end) active = false;
+    }
+}
+
+/* ------------------------------------------------------------ */
+/*  Core 0                                                      */
+/* ------------------------------------------------------------ */
+static void send_cmd(uint32_t cmd) {
+    multicore_fifo_push_blocking(cmd);
+    while (multicore_fifo_pop_blocking() != PIPE_ACK) {
+        // stale word; keep waiting for our acknowledgement
+    }
+}
+
+void pipe_init(void) {
+    if (launched) return;
+    launched = true;
+    multicore_launch_core1(core1_main);
+}
+
+void pipe_stop(void) {
+    send_cmd(PIPE_CMD_STOP);                  // core 1 is idle once this returns
+    head = 0;
+    tail = 0;
+}
+
+void pipe_park(void) {
+    if (!launched) return;
+    park_req = true;
+    send_cmd(PIPE_CMD_PARK);                  // stops a running job, too
+    head = 0;
+    tail = 0;
+    while (!parked) tight_loop_contents();    // the ACK comes from flash code
+}
+
+void pipe_unpark(void) {
+    if (!launched) return;
+    park_req = false;
+    while (parked) tight_loop_contents();     // a quick re-park must not race it
+}
+
+void pipe_start(uint8_t region, uint32_t offset, uint32_t end, uint16_t chunk) {
+    pipe_stop();
+    job.region  = region;
+    job.write   = false;
+    job.offset  = offset;
+    job.end     = end;
+    job.chunk   = (chunk > PIPE_SLOT_BYTES) ? (uint16_t)PIPE_SLOT_BYTES : chunk;
+    next_offset = offset;
+    __dmb();
+    send_cmd(PIPE_CMD_START);
+}
+
+const uint8_t *pipe_next(uint32_t *offset, uint16_t *len) {
+    if (next_offset >= job.end) return NULL;  // stream exhausted
+
+    bool stalled = false;
+    while (head == tail) {
+        if (!stalled) {
+            stats.consumer_stalls++;
+            stalled = true;
+        }
+        tight_loop_contents();
+    }
+    __dmb();                                  // head before slot contents
+
+    uint32_t i = tail % PIPE_SLOTS;
+    *offset     = slot_info[i].offset;
+    *len        = slot_info[i].len;
+    next_offset = slot_info[i].offset + slot_info[i].len;
+    return slots[i];
+}
+
+void pipe_release(void) {
+    __dmb();                                  // done reading before the slot is reused
+    tail = tail + 1;
+}
+
+/* ------------------------------------------------------------ */
+/*  Core 0, write direction                                     */
+/* ------------------------------------------------------------ */
+void pipe_start_write(uint8_t region, uint32_t offset) {
+    pipe_stop();
+    job.region    = region;
+    job.write     = true;
+    job.offset    = offset;
+    w_failed      = false;
+    w_fail_offset = 0;
+    w_crc         = 0;
+    __dmb();
+    send_cmd(PIPE_CMD_START);
+}
+
+uint8_t *pipe_write_slot(void) {
+    bool stalled = false;
+    while (head - tail == PIPE_SLOTS) {
+        if (!stalled) {
+            stats.producer_stalls++;
+            stalled = true;
+        }
+        tight_loop_contents();
+    }
+    __dmb();                                  // core 1 is done with the slot
+    return slots[head % PIPE_SLOTS];
+}
+
+void pipe_write_commit(uint32_t offset, uint16_t len, uint8_t flags) {
+    slot_info[head % PIPE_SLOTS] = (slot_info_t){ offset, len, flags };
+    __dmb();                                  // slot contents before head
+    head = head + 1;
+}
+
+bool pipe_write_failed(uint32_t *offset) {
+    if (!w_failed) return false;
+    if (offset) *offset = w_fail_offset;
+    return true;
+}
+
+bool pipe_write_finish(uint32_t *readback_crc) {
+    while (head != tail) tight_loop_contents();
+    __dmb();
+    if (readback_crc) *readback_crc = w_crc;
+    bool ok = !w_failed;
+    pipe_stop();
+    return ok;
+}
+
+void pipe_get_stats(pipe_stats_t *out) {
+    out->chunks          = stats.chunks;
+    out->producer_stalls = stats.producer_stalls;
+    out->consumer_stalls = stats.consumer_stalls;
+}
+
+void pipe_reset_stats(void) {
+    stats.chunks          = 0;
+    stats.producer_stalls = 0;
+    stats.consumer_stalls = 0;
+}
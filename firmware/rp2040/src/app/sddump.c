@@ -0,0 +1,200 @@
+/* sddump.c – ROM and save to SD card files through the pipeline
+ *  ---------------------------------------------------------------
+ *  • Names come from the database ("Name (USA).z64"), else the header
+ *    title; a name already on the card gets " (2)", " (3)", ...
+ *  • Files are allocated before any data moves, so a full card fails
+ *    up front and the card sees nothing but data blocks afterwards.
+ *    Each says 0 bytes until its data is down, so a pulled card or a
+ *    failed write never leaves a dump that looks finished
+ *  • Slots are whole 512-byte blocks; a short tail is padded with
+ *    zeros (no region here has one)
+ */
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "pico/stdlib.h"
+
+#include <app/cartid.h>
+#include <app/digest.h>
+#include <app/n64db.h>
+#include <app/pipeline.h>
+#include <app/sddump.h>
+#include <bus/ad_bus.h>
+#include <devices/cartridge.h>
+#include <storage/fat32.h>
+#include <storage/sdcard.h>
+
+#define MAX_SUFFIX      99u
+
+static fat32_vol_t vol;
+static uint8_t     tail_blk[SD_BLOCK_BYTES] __attribute__((aligned(4)));
+
+/* ------------------------------------------------------------ */
+/*  Names                                                        */
+/* ------------------------------------------------------------ */
+static void base_name(const n64db_entry_t *e, char *out, size_t max) {
+    uint8_t title[N64_TITLE_LENGTH + 1];
+    const char *src = "N64 cart";
+    if (e) src = n64db_name(e);
+    else if (n64_get_title(title, sizeof(title)) && title[0]) src = (const char *)title;
+
+    size_t n = 0;
+    for (; *src && n + 1 < max; ++src) {
+        char c = *src;
+        out[n++] = (c < 0x20 || strchr("\\/:*?\"<>|", c)) ? '_' : c;
+    }
+    out[n] = '\0';
+    // The database names carry ".z64"; drop it and any trailing dots or spaces
+    if (n >= 4 && !strcmp(&out[n - 4], ".z64")) out[n -= 4] = '\0';
+    while (n && (out[n - 1] == ' ' || out[n - 1] == '.')) out[--n] = '\0';
+}
+
+// "<base>.<ext>" or "<base> (<k>).<ext>", cut so it fits SDDUMP_NAME_MAX
+static void file_name(char *out, const char *base, unsigned k, const char *ext) {
+    char tail[24];
+    int  t = k > 1 ? snprintf(tail, sizeof(tail), " (%u).%.8s", k, ext)
+                   : snprintf(tail, sizeof(tail), ".%.8s", ext);
+    size_t tn   = (t > 0 && (size_t)t < sizeof(tail)) ? (size_t)t : 0;
+    size_t room = SDDUMP_NAME_MAX - 1u - tn;
+    size_t n    = strlen(base);
+    if (n > room) n = room;
+    memcpy(out, base, n);
+    memcpy(&out[n], tail, tn);
+    out[n + tn] = '\0';
+}
+
+// First suffix for which neither file exists yet
+static bool pick_names(const char *base, const char *save_ext, sddump_result_t *r,
+                       const char **err) {
+    for (unsigned k = 1; k <= MAX_SUFFIX; ++k) {
+        file_name(r->rom_name, base, k, "z64");
+        if (fat32_exists(&vol, r->rom_name, err)) continue;
+        if (save_ext) {
+            file_name(r->save_name, base, k, save_ext);
+            if (fat32_exists(&vol, r->save_name, err)) continue;
+        }
+        return true;
+    }
+    *err = "too many dumps of this cart";
+    return false;
+}
+
+/* ------------------------------------------------------------ */
+/*  Saves                                                        */
+/* ------------------------------------------------------------ */
+static const char *save_ext(uint8_t region) {
+    switch (region) {
+    case PIPE_REGION_SRAM:     return "sra";
+    case PIPE_REGION_FLASHRAM: return "fla";
+    default:                   return "eep";
+    }
+}
+
+/* ------------------------------------------------------------ */
+/*  Streaming                                                    */
+/* ------------------------------------------------------------ */
+// Core 1 fills the next slot from the cart while this one goes to the card.
+// The directory entry then gets the bytes the card took, all of them or
+// the slots before a failed write.
+static bool stream(uint8_t region, const fat32_file_t *f, digest_result_t *dg, const char **err) {
+    if (!sd_write_begin(f->first_lba, f->blocks)) {
+        *err = "card write failed";
+        return false;
+    }
+
+    pipe_start(region, 0, f->bytes, PIPE_SLOT_BYTES);
+    static digest_t d;
+    digest_init(&d);
+    uint32_t written = 0;
+    bool     ok      = true;
+    uint32_t off;
+    uint16_t len;
+    const uint8_t *p;
+    while (ok && (p = pipe_next(&off, &len)) != NULL) {
+        if (dg) digest_update(&d, p, len);
+        uint32_t whole = len / SD_BLOCK_BYTES;
+        ok = sd_write_next(p, whole);
+        if (ok && len % SD_BLOCK_BYTES) {
+            memset(tail_blk, 0, sizeof(tail_blk));
+            memcpy(tail_blk, p + whole * SD_BLOCK_BYTES, len % SD_BLOCK_BYTES);
+            ok = sd_write_next(tail_blk, 1);
+        }
+        if (ok) written += len;
+        pipe_release();
+    }
+    pipe_stop();
+
+    ok = sd_write_end() && ok;
+    if (!ok) *err = "card write failed";
+    const char *size_err;
+    if (!fat32_set_size(&vol, f, written, &size_err) && ok) {
+        *err = size_err;
+        ok   = false;
+    }
+    if (dg) digest_final(&d, dg);
+    return ok;
+}
+
+/* ------------------------------------------------------------ */
+/*  Dump                                                         */
+/* ------------------------------------------------------------ */
+bool sddump_run(sddump_result_t *r, const char **err) {
+    memset(r, 0, sizeof(*r));
+    uint32_t t0 = time_us_32();
+
+    sd_info_t si;
+    if (!sd_init(&si)) {
+        *err = "no SD card";
+        return false;
+    }
+    if (!fat32_mount(&vol, err)) return false;
+
+    // Same bus preparation as a USB dump
+    cartid_t id;
+    const n64db_entry_t *e;
+    if (!cartid_prepare(&id, &e)) {
+        *err = "no cart";
+        return false;
+    }
+    uint32_t rom_bytes = id.rom_bytes;
+
+    uint8_t     save_region = 0;
+    uint32_t    save_bytes  = 0;
+    const char *ext         = NULL;
+    if (cartid_save_region(&id, &save_region, &save_bytes)) ext = save_ext(save_region);
+
+    char base[SDDUMP_NAME_MAX];
+    base_name(e, base, sizeof(base));
+    if (!pick_names(base, ext, r, err)) return false;
+
+    fat32_file_t rom, save;
+    if (!fat32_create(&vol, r->rom_name, rom_bytes, &rom, err)) return false;
+    if (ext && !fat32_create(&vol, r->save_name, save_bytes, &save, err)) return false;
+
+    pipe_reset_stats();
+    uint32_t t1 = time_us_32();
+    digest_result_t dg;
+    if (!stream(PIPE_REGION_ROM, &rom, &dg, err)) return false;
+    r->rom_us    = time_us_32() - t1;
+    r->rom_crc32 = dg.crc32;
+    memcpy(r->rom_md5,  dg.md5,  sizeof(r->rom_md5));
+    memcpy(r->rom_sha1, dg.sha1, sizeof(r->rom_sha1));
+    r->rom_bytes = rom_bytes;
+    r->rom_lba   = rom.first_lba;
+    r->db_crc32  = e ? e->crc32 : 0;
+    pipe_stats_t ps;
+    pipe_get_stats(&ps);
+    r->producer_stalls = ps.producer_stalls;
+    r->consumer_stalls = ps.consumer_stalls;
+
+    if (ext) {
+        if (!stream(save_region, &save, NULL, err)) return false;
+        r->save_bytes = save_bytes;
+        r->save_lba   = save.first_lba;
+    } else {
+        r->save_name[0] = '\0';
+    }
+    r->total_us = time_us_32() - t0;
+    return true;
+}
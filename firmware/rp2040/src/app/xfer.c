@@ -0,0 +1,469 @@
+/* xfer.c – framed binary ROM / save transfers over the CDC port
+ *  ---------------------------------------------------------------
+ *  • Raw frames instead of printf hex: half the bytes on the wire and
+ *    no formatting in the read loop
+ *  • Sliding window + cumulative ACKs hide the USB round trip; resends
+ *    re-read the cart instead of keeping a copy of every frame
+ *  • A START with a non-zero offset resumes an interrupted dump
+ *  • CRC-32/MD5/SHA-1 of the stream are hashed here on core 0 while
+ *    core 1 reads ahead, and returned in DONE
+ *  • The same pass records a CRC per ROM block; REPAIR re-reads only the
+ *    blocks that come back different and patches them by majority vote
+ *  • CTRL_STREAM hands the port to the controller stream (ctrlstream.c),
+ *    PROGRAM to the repro flash programmer (flasher.c), GATHER to the
+ *    scatter/gather reader (gather.c)
+ */
+#include <stdio.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include "pico/stdlib.h"
+#include "pico/stdio_usb.h"
+
+#include <app/blockmap.h>
+#include <app/cartid.h>
+#include <app/crc32.h>
+#include <app/ctrlstream.h>
+#include <app/digest.h>
+#include <app/gather.h>
+#include <app/flasher.h>
+#include <app/n64db.h>
+#include <app/pipeline.h>
+#include <app/xfer.h>
+#include <bus/ad_bus.h>
+#include <bus/bus_perf.h>
+#include <bus/joybus.h>
+#include <devices/cartridge.h>
+#include <devices/flashram.h>
+
+#define XFER_SRAM_BYTES      (32u * 1024u)
+#define XFER_RX_MAX_PAYLOAD  (XFER_GATHER_MAX_RANGES * sizeof(xfer_range_t))
+#define XFER_SOF_WAIT_US     100000u   // rest of a START after the CLI saw its SOF
+
+typedef struct {
+    uint8_t  region;
+    uint32_t start;          // first byte offset of this transfer
+    uint32_t length;         // end of the region
+    uint16_t frame_size;
+    uint16_t window;
+    uint32_t frames;
+} xfer_job_t;
+
+typedef struct {
+    xfer_header_t hdr;
+    uint8_t       payload[XFER_RX_MAX_PAYLOAD];
+} xfer_rx_frame_t;
+
+static uint8_t  rx_buf[XFER_HEADER_LEN + XFER_RX_MAX_PAYLOAD];
+static size_t   rx_len;
+static xfer_header_t rx_hdr;     // header of the frame being received
+static uint32_t rx_crc;          // running CRC past the kept part of a long frame
+static uint8_t  piece[BLOCKMAP_PIECE_BYTES] __attribute__((aligned(4)));
+
+/* ------------------------------------------------------------ */
+/*  Frame I/O                                                   */
+/* ------------------------------------------------------------ */
+static uint32_t frame_crc_part(const xfer_header_t *h, const uint8_t *payload, uint16_t n) {
+    uint32_t crc = crc32_update(0, h, offsetof(xfer_header_t, crc));
+    return crc32_update(crc, payload, n);
+}
+
+static uint32_t frame_crc(const xfer_header_t *h, const uint8_t *payload) {
+    return frame_crc_part(h, payload, h->len);
+}
+
+static void tx_frame(uint8_t type, uint32_t seq, uint32_t offset,
+                     const void *payload, uint16_t len)
+{
+    xfer_header_t h = {
+        .sof = { XFER_SOF0, XFER_SOF1 }, .type = type,
+        .seq = seq, .offset = offset, .len = len,
+    };
+    h.crc = frame_crc(&h, (const uint8_t *)payload);
+    BUS_PERF_BEGIN(t0);
+    fwrite(&h, 1, sizeof(h), stdout);
+    if (len) fwrite(payload, 1, len, stdout);
+    fflush(stdout);
+    BUS_PERF_END(BUS_PERF_USB_TX, t0, len);
+}
+
+static void tx_error(const char *msg) {
+    tx_frame(XFER_T_ERROR, 0, 0, msg, (uint16_t)strlen(msg));
+}
+
+void xfer_send(uint8_t type, uint32_t seq, uint32_t offset,
+               const void *payload, uint16_t len)
+{
+    tx_frame(type, seq, offset, payload, len);
+}
+
+// Feed one byte to the frame parser; true once a frame with a good CRC
+// is complete. The header collects in rx_buf, the payload in 'dst'.
+// Anything that does not parse is dropped byte by byte. Frames longer
+// than 'limit' are dropped at the header; of a frame longer than 'max'
+// (up to 'limit') only the first 'max' bytes are kept, but the whole
+// payload is checked and 'out->len' tells its real length.
+static bool rx_byte_to(uint8_t b, xfer_header_t *out, uint8_t *dst, uint16_t max,
+                       uint16_t limit)
+{
+    if (rx_len == 0 && b != XFER_SOF0) return false;
+    if (rx_len == 1 && b != XFER_SOF1) {
+        rx_len = (b == XFER_SOF0) ? 1 : 0;
+        return false;
+    }
+
+    if (rx_len < XFER_HEADER_LEN) {
+        rx_buf[rx_len++] = b;
+        if (rx_len < XFER_HEADER_LEN) return false;
+        memcpy(&rx_hdr, rx_buf, sizeof(rx_hdr));
+        if (rx_hdr.len > limit) {
+            rx_len = 0;
+            return false;
+        }
+    } else {
+        size_t i = rx_len++ - XFER_HEADER_LEN;
+        if (i < max) dst[i] = b;
+        else {
+            if (i == max) rx_crc = frame_crc_part(&rx_hdr, dst, max);
+            rx_crc = crc32_update(rx_crc, &b, 1);
+        }
+    }
+    if (rx_len < XFER_HEADER_LEN + rx_hdr.len) return false;
+
+    rx_len = 0;
+    uint32_t crc = rx_hdr.len > max ? rx_crc : frame_crc(&rx_hdr, dst);
+    if (crc != rx_hdr.crc) return false;
+    *out = rx_hdr;
+    return true;
+}
+
+static bool rx_byte(uint8_t b, xfer_rx_frame_t *out) {
+    if (!rx_byte_to(b, &out->hdr, &rx_buf[XFER_HEADER_LEN], XFER_RX_MAX_PAYLOAD,
+                    XFER_MAX_PAYLOAD)) return false;
+    uint16_t n = out->hdr.len < XFER_RX_MAX_PAYLOAD ? out->hdr.len : XFER_RX_MAX_PAYLOAD;
+    memcpy(out->payload, &rx_buf[XFER_HEADER_LEN], n);
+    return true;
+}
+
+// Drain pending input without blocking
+static bool rx_poll(xfer_rx_frame_t *out) {
+    int ch;
+    while ((ch = getchar_timeout_us(0)) != PICO_ERROR_TIMEOUT) {
+        if (rx_byte((uint8_t)ch, out)) return true;
+    }
+    return false;
+}
+
+int xfer_poll(void) {
+    xfer_rx_frame_t f;
+    return rx_poll(&f) ? f.hdr.type : -1;
+}
+
+static bool rx_wait(xfer_rx_frame_t *out, uint32_t wait_us) {
+    uint32_t t0 = time_us_32();
+    do {
+        if (rx_poll(out)) return true;
+    } while (time_us_32() - t0 < wait_us);
+    return false;
+}
+
+bool xfer_recv(xfer_header_t *h, void *payload, uint16_t max, uint32_t wait_us) {
+    uint32_t t0 = time_us_32();
+    do {
+        int ch;
+        while ((ch = getchar_timeout_us(0)) != PICO_ERROR_TIMEOUT) {
+            if (rx_byte_to((uint8_t)ch, h, payload, max, max)) return true;
+        }
+    } while (time_us_32() - t0 < wait_us);
+    return false;
+}
+
+/* ------------------------------------------------------------ */
+/*  Regions                                                     */
+/* ------------------------------------------------------------ */
+static bool job_setup(const xfer_rx_frame_t *f, xfer_job_t *job) {
+    xfer_start_t st;
+    if (f->hdr.len < sizeof(st)) {
+        tx_error("short START");
+        return false;
+    }
+    memcpy(&st, f->payload, sizeof(st));
+
+    uint32_t def, max;
+    cartid_t id;
+    switch (st.region) {
+    case XFER_REGION_ROM:
+        // Bus timing, burst length and size for this cart: remembered
+        // from an earlier insertion, else calibrated and probed (tens of
+        // ms) and remembered now
+        if (!cartid_prepare(&id, NULL)) {
+            tx_error("no cart");
+            return false;
+        }
+        def = id.rom_bytes;
+        max = N64_ROM_MAX_BYTES;
+        break;
+    case XFER_REGION_SRAM:
+        def = max = XFER_SRAM_BYTES;
+        break;
+    case XFER_REGION_EEPROM:
+        if (gEepromSize == 0) {
+            tx_error("no EEPROM");
+            return false;
+        }
+        def = max = gEepromSize;
+        break;
+    case XFER_REGION_FLASHRAM:
+        if (!flashram_identify(NULL)) {
+            tx_error("no FlashRAM");
+            return false;
+        }
+        def = max = FLASHRAM_BYTES;
+        break;
+    default:
+        tx_error("unknown region");
+        return false;
+    }
+
+    job->region = st.region;
+    job->length = st.length ? st.length : def;
+    job->start  = f->hdr.offset;
+    if (job->length == 0 || job->length > max || (job->length & 1u) ||
+        job->start > job->length || (job->start & 1u)) {
+        tx_error("bad length/offset");
+        return false;
+    }
+
+    uint16_t fs = st.frame_size ? st.frame_size : XFER_DEFAULT_PAYLOAD;
+    if (fs > XFER_MAX_PAYLOAD) fs = XFER_MAX_PAYLOAD;
+    if (fs < 64u)              fs = 64u;
+    job->frame_size = (uint16_t)(fs & ~1u);
+    if (st.region == XFER_REGION_FLASHRAM) {
+        // The part is read a page at a time
+        fs = (fs < FLASHRAM_PAGE_BYTES) ? FLASHRAM_PAGE_BYTES : fs;
+        job->frame_size = (uint16_t)(fs / FLASHRAM_PAGE_BYTES * FLASHRAM_PAGE_BYTES);
+        if (job->start % FLASHRAM_PAGE_BYTES || job->length % FLASHRAM_PAGE_BYTES) {
+            tx_error("FlashRAM needs whole pages");
+            return false;
+        }
+    }
+
+    uint16_t win = st.window ? st.window : XFER_DEFAULT_WINDOW;
+    job->window  = (win > XFER_MAX_WINDOW) ? XFER_MAX_WINDOW : win;
+    job->frames  = (job->length - job->start + job->frame_size - 1u) / job->frame_size;
+    return true;
+}
+
+/* ------------------------------------------------------------ */
+/*  Transfer                                                    */
+/* ------------------------------------------------------------ */
+// Rewind the core 1 reader to frame 'seq' after a NAK or a timeout
+static void xfer_rewind(const xfer_job_t *job, uint32_t seq) {
+    pipe_start(job->region, job->start + seq * job->frame_size,
+               job->length, job->frame_size);
+}
+
+// Stream one job; returns true if the host sent a new START (resume with
+// other parameters) that 'f' now holds.
+static bool xfer_run(const xfer_job_t *job, xfer_rx_frame_t *f) {
+    uint32_t base = 0;       // oldest frame not yet acknowledged
+    uint32_t next = 0;       // next frame to send
+    uint32_t hash_seq = 0;   // frames folded into the running digests
+    uint32_t retries = 0;
+    bool     done_sent = false;
+    uint32_t last = time_us_32();
+    digest_t dg;
+
+    digest_init(&dg);
+    if (job->region == XFER_REGION_ROM) blockmap_begin(job->length, job->start != 0);
+
+    // Core 1 reads ahead into the pipeline ring while frames go out here
+    pipe_reset_stats();
+    xfer_rewind(job, 0);
+
+    for (;;) {
+        // 1) fill the window
+        while (next < job->frames && next - base < job->window) {
+            uint32_t off;
+            uint16_t len;
+            const uint8_t *data = pipe_next(&off, &len);
+            if (!data) break;
+            if (next == hash_seq) {
+                // Resent frames (NAK, timeout) were hashed the first time
+                digest_update(&dg, data, len);
+                if (job->region == XFER_REGION_ROM) blockmap_feed(off, data, len);
+                hash_seq++;
+            }
+            tx_frame(XFER_T_DATA, next, off, data, len);
+            pipe_release();
+            next++;
+        }
+        if (base >= job->frames && !done_sent) {
+            pipe_stats_t ps;
+            pipe_get_stats(&ps);
+            digest_result_t r;
+            digest_t        tmp = dg;             // a resend may follow; keep dg open
+            digest_final(&tmp, &r);
+            xfer_done_t done = {
+                .length          = job->length,
+                .crc32           = r.crc32,
+                .producer_stalls = ps.producer_stalls,
+                .consumer_stalls = ps.consumer_stalls,
+            };
+            if (job->start == 0) {
+                memcpy(done.md5,  r.md5,  sizeof(done.md5));
+                memcpy(done.sha1, r.sha1, sizeof(done.sha1));
+            } else {
+                done.flags = XFER_DONE_PARTIAL;             // tail only: no DAT match
+            }
+            tx_frame(XFER_T_DONE, job->frames, job->length, &done, sizeof(done));
+            done_sent = true;
+        }
+
+        // 2) acknowledgements
+        while (rx_poll(f)) {
+            uint32_t seq = f->hdr.seq;
+            switch (f->hdr.type) {
+            case XFER_T_ACK:
+                if (seq > job->frames) return false;          // DONE arrived
+                if (seq > next) seq = next;
+                if (seq > base) {
+                    base    = seq;
+                    retries = 0;
+                    last    = time_us_32();
+                }
+                break;
+            case XFER_T_NAK:
+                if (seq >= base && seq <= next) {
+                    base = next = seq;
+                    last = time_us_32();
+                    xfer_rewind(job, next);
+                }
+                break;
+            case XFER_T_START:
+                return true;
+            case XFER_T_ABORT:
+                return false;
+            default:
+                break;
+            }
+        }
+
+        // 3) nothing heard for a while: go back to the oldest frame
+        if (time_us_32() - last > XFER_ACK_TIMEOUT_US) {
+            if (++retries > XFER_MAX_RETRIES) return false;   // host gone
+            next      = base;
+            done_sent = false;
+            last      = time_us_32();
+            xfer_rewind(job, next);
+        }
+    }
+}
+
+/* ------------------------------------------------------------ */
+/*  Repair                                                      */
+/* ------------------------------------------------------------ */
+// Stop-and-wait: the host ACKs seq + 1 once the frame is stored
+static bool tx_acked(uint8_t type, uint32_t seq, uint32_t offset,
+                     const void *payload, uint16_t len)
+{
+    xfer_rx_frame_t f;
+    for (uint32_t tries = 0; tries <= XFER_MAX_RETRIES; ++tries) {
+        tx_frame(type, seq, offset, payload, len);
+        uint32_t t0 = time_us_32();
+        while (time_us_32() - t0 < XFER_ACK_TIMEOUT_US) {
+            if (!rx_poll(&f)) continue;
+            if (f.hdr.type == XFER_T_ABORT) return false;
+            if (f.hdr.type == XFER_T_ACK && f.hdr.seq == seq + 1u) return true;
+        }
+    }
+    return false;
+}
+
+static void xfer_repair(const xfer_rx_frame_t *f) {
+    xfer_repair_t rq;
+    if (f->hdr.len < sizeof(rq)) {
+        tx_error("short REPAIR");
+        return;
+    }
+    memcpy(&rq, f->payload, sizeof(rq));
+    if (rq.region != XFER_REGION_ROM || !blockmap_ready(rq.length)) {
+        tx_error("no block map for this dump");
+        return;
+    }
+
+    xfer_repair_done_t done = { .blocks = blockmap_blocks() };
+    uint32_t running = 0;       // CRC of the image as the host will hold it
+    uint32_t seq = 0;
+
+    for (uint32_t b = 0; b < done.blocks; ++b) {
+        uint32_t before = running;
+        if (blockmap_read_crc(b, &running) == blockmap_crc(b)) continue;
+
+        // Either the dump or this read hit an error; vote the whole block
+        // and send every piece, the host cannot tell which one was bad
+        done.suspects++;
+        running = before;
+        uint32_t off = b * BLOCKMAP_BLOCK_BYTES;
+        uint32_t end = off + BLOCKMAP_BLOCK_BYTES;
+        if (end > rq.length) end = rq.length;
+        uint32_t crc = 0;
+        for (; off < end; off += BLOCKMAP_PIECE_BYTES) {
+            uint16_t n = (uint16_t)(end - off < BLOCKMAP_PIECE_BYTES ? end - off : BLOCKMAP_PIECE_BYTES);
+            if (!blockmap_vote_piece(off, piece, n)) done.unresolved++;
+            crc     = crc32_update(crc, piece, n);
+            running = crc32_update(running, piece, n);
+            if (!tx_acked(XFER_T_DATA, seq++, off, piece, n)) return;
+            done.repaired++;
+        }
+        blockmap_set_crc(b, crc);
+    }
+
+    done.crc32 = running;
+    tx_acked(XFER_T_DONE, seq, rq.length, &done, sizeof(done));
+}
+
+int xfer_session(int first, uint32_t wait_us) {
+    xfer_rx_frame_t f;
+    bool have = false;
+
+    rx_len = 0;
+    if (first >= 0) {
+        have    = rx_byte((uint8_t)first, &f);
+        wait_us = wait_us ? wait_us : XFER_SOF_WAIT_US;
+    }
+    if (!have && !rx_wait(&f, wait_us)) return -1;
+    if (f.hdr.type != XFER_T_START && f.hdr.type != XFER_T_REPAIR &&
+        f.hdr.type != XFER_T_CTRL_STREAM && f.hdr.type != XFER_T_PROGRAM &&
+        f.hdr.type != XFER_T_GATHER) return f.hdr.type;
+
+    stdio_set_translate_crlf(&stdio_usb, false);    // frames are raw bytes
+    if (f.hdr.type == XFER_T_PROGRAM) {
+        xfer_program_t rq = { 0 };
+        memcpy(&rq, f.payload, f.hdr.len < sizeof(rq) ? f.hdr.len : sizeof(rq));
+        flasher_run(&rq, NULL);
+    } else if (f.hdr.type == XFER_T_CTRL_STREAM) {
+        xfer_ctrl_stream_t rq = { 0 };
+        memcpy(&rq, f.payload, f.hdr.len < sizeof(rq) ? f.hdr.len : sizeof(rq));
+        ctrlstream_run(&rq, NULL);
+    } else if (f.hdr.type == XFER_T_GATHER) {
+        // A list past XFER_GATHER_MAX_RANGES arrives cut short; gather_run()
+        // sees its real count and answers ERROR
+        xfer_range_t ranges[XFER_GATHER_MAX_RANGES];
+        memcpy(ranges, f.payload, sizeof(ranges) < f.hdr.len ? sizeof(ranges) : f.hdr.len);
+        pipe_stop();                                 // gather reads on core 0
+        gather_run(ranges, f.hdr.len / sizeof(xfer_range_t), NULL);
+    } else if (f.hdr.type == XFER_T_REPAIR) {
+        pipe_stop();                                 // repair reads on core 0
+        xfer_repair(&f);
+    } else {
+        xfer_job_t job;
+        while (job_setup(&f, &job) && xfer_run(&job, &f)) {
+            // host restarted with a new START; loop with its parameters
+        }
+        pipe_stop();                                 // bus back to core 0
+    }
+    stdio_set_translate_crlf(&stdio_usb, true);
+    return f.hdr.type;
+}
@@ -2,10 +2,13 @@
 #include <stdio.h>
 #include <stdbool.h>
 #include "pico/stdlib.h"
-#include "hardware/structs/sio.h"
 #include "hardware/gpio.h"
 
 #include <bus/ad_bus.h>
+#include <bus/bus_hal.h>
+#include <bus/ad_bus_pio.h>
+#include <bus/ad_bus_timing.h>
+#include <bus/bus_perf.h>
 
 // ======================================================================
 // N64 Cartridge Hardware Definitions & Pin Assignments (Definitions)
@@ -36,99 +39,165 @@ void n64_adBus_init() {
         gpio_put(p, 1); // Set these pins HIGH to their inactive state
     }
 
-    // --- Initialize AD bus pins to input with pullups ---
-    adBus_dir(false);
+    // --- Configure the AD pads once: SIO, pull-ups, input ---
+    adBus_pads_init();
+
+    // --- Load the PIO + DMA burst read engine ---
+    ad_bus_pio_init();
 
     // --- Perform N64 cartridge hardware reset sequence ---
     n64_reset();
 }
 
-void adBus_dir(bool out) {
-  if (out) { // Configure for OUTPUT (Pico drives the bus)
-    // First, ensure all AD bus pins are explicitly set to GPIO_FUNC_SIO
-    // and have their pulls disabled, as is standard for digital outputs.
-    for (int i = 0; i < AD_BUS_PIN_COUNT; ++i) {
-        uint current_pin = AD_BUS_PIN_START + i;
-        gpio_set_function(current_pin, GPIO_FUNC_SIO); // Set function to Software I/O.
-        gpio_disable_pulls(current_pin);                // Disable pull-ups/downs for output.
-    }
-    // Set Output Enable for all pins in AD_BUS_MASK simultaneously using SIO.
-    sio_hw->gpio_oe_set = AD_BUS_MASK;
-
-    // Set the initial output value of these pins to LOW simultaneously using SIO.
-    sio_hw->gpio_clr = AD_BUS_MASK;     // Sets output low for masked pins.
-
-  } else { // Configure for INPUT with PULLUPS (Pico reads from the bus)
-    // First, ensure all AD bus pins are set to GPIO_FUNC_SIO and have pull-ups enabled.
-    // Pull-ups are important for stability when reading from a bus that might otherwise float.
+// The only place the AD pads are configured. The pull-ups stay on while
+// the Pico drives the bus (a few µA against a push-pull output) so that
+// a direction change is a single SIO write.
+void adBus_pads_init(void) {
     for (int i = 0; i < AD_BUS_PIN_COUNT; ++i) {
         uint current_pin = AD_BUS_PIN_START + i;
         gpio_set_function(current_pin, GPIO_FUNC_SIO); // Set function to Software I/O.
         gpio_pull_up(current_pin);                      // Enable internal pull-up resistor.
     }
-    // Clear Output Enable for all pins in AD_BUS_MASK simultaneously using SIO.
-    // This makes all specified AD bus pins function as inputs.
-    sio_hw->gpio_oe_clr = AD_BUS_MASK;
+    bus_hal_oe_clr(AD_BUS_MASK);
+}
+
+void adBus_dir(bool out) {
+  BUS_PERF_BEGIN(t0);
+  if (out) { // Pico drives the bus, starting from all-low
+    bus_hal_gpio_clr(AD_BUS_MASK);
+    bus_hal_oe_set(AD_BUS_MASK);
+  } else {   // Cartridge drives the bus
+    bus_hal_oe_clr(AD_BUS_MASK);
   }
+  BUS_PERF_END(BUS_PERF_DIR, t0, out);
 }
 
-// number of NOPs for a ~56 ns latch delay
-#define LATCH_NOPS     7
-// NOPs for the ~32 ns bus turnaround
-#define TURNAROUND_NOPS 4
 // mask of all four control lines in their inactive (HIGH) state
 #define CTRL_INACTIVE_MASK  \
    ((1UL<<WR_PIN)|(1UL<<RD_PIN)|(1UL<<ALE_H_PIN)|(1UL<<ALE_L_PIN))
 
+// Writes are never calibrated: 56 ns data setup/hold, 440 ns /WR low
+#define WR_SETUP_CYCLES  7u
+#define WR_PULSE_CYCLES  55u
+
+// Last latched address is in ROM, so the calibrated access time applies
+static bool rom_latched;
+
+// Where the cart's address counter points, and whether its high half is
+// still the one latched by the last ALE_H. A transfer that carries the
+// counter into another 64 KiB half invalidates it.
+static uint32_t bus_addr;
+static bool     hi_valid;
+
+static inline void adBus_advance(uint32_t bytes) {
+    uint32_t next = bus_addr + bytes;
+    if ((next ^ bus_addr) >> 16) hi_valid = false;
+    bus_addr = next;
+}
+
 // helper to drive a 16-bit word onto AD0–15 and pulse ALE↓
 static inline void adBus_latch_word(uint16_t word, uint32_t ale_mask) {
     uint32_t v = (uint32_t)word << AD_BUS_PIN_START;
-    sio_hw->gpio_clr = AD_BUS_MASK;   // clear bus
-    sio_hw->gpio_set = v;            // set new value
-    critical_delay_nops(LATCH_NOPS); // setup time
-    sio_hw->gpio_clr = ale_mask;     // pulse ALE low
-    critical_delay_nops(LATCH_NOPS); // hold time
+    bus_hal_gpio_clr(AD_BUS_MASK);   // clear bus
+    bus_hal_gpio_set(v);            // set new value
+    bus_hal_delay_cycles(adBus_timing.latch_cycles); // setup time
+    bus_hal_gpio_clr(ale_mask);     // pulse ALE low
+    bus_hal_delay_cycles(adBus_timing.latch_cycles); // hold time
 }
 
-void adBus_set_address(uint32_t addr) {
+void adBus_latch(uint32_t addr) {
     uint16_t hi = addr >> 16;
     uint16_t lo = (uint16_t)addr;
+    bool     reuse_hi = hi_valid && (bus_addr >> 16) == hi;
+    BUS_PERF_BEGIN(t0);
 
-    // 1) make sure no bus cycles happen while we’re setting up
-    sio_hw->gpio_set = CTRL_INACTIVE_MASK;
+    // 1) make sure no bus cycles happen while we’re setting up; ALE_H
+    //    stays low when its half is reused
+    bus_hal_gpio_set(reuse_hi ? (CTRL_INACTIVE_MASK & ~(1UL<<ALE_H_PIN))
+                              : CTRL_INACTIVE_MASK);
 
     // 2) drive AD0–15
     adBus_dir(true);
 
-    // 3) latch high then low half
-    adBus_latch_word(hi, (1UL<<ALE_H_PIN));
+    // 3) latch high (if it changed) then low half
+    if (!reuse_hi) adBus_latch_word(hi, (1UL<<ALE_H_PIN));
     adBus_latch_word(lo, (1UL<<ALE_L_PIN));
 
     // 4) release bus to the cartridge
     adBus_dir(false);
-    critical_delay_nops(TURNAROUND_NOPS);
+    bus_hal_delay_cycles(adBus_timing.turnaround_cycles);
+
+    rom_latched = (addr >= N64_ROM_BASE);
+    bus_addr    = addr;
+    hi_valid    = true;
+    BUS_PERF_END(reuse_hi ? BUS_PERF_LATCH_LO : BUS_PERF_LATCH_FULL, t0, addr);
+}
+
+// Full latch of both halves, whatever the bus state
+void adBus_set_address(uint32_t addr) {
+    hi_valid = false;
+    adBus_latch(addr);
+}
+
+void adBus_note_burst(size_t words) {
+    adBus_advance((uint32_t)words * 2u);
+}
+
+uint16_t adBus_access_cycles(void) {
+    static const ad_bus_timing_t defaults = AD_BUS_TIMING_DEFAULT;
+    return rom_latched ? adBus_timing.access_cycles : defaults.access_cycles;
 }
 
 uint16_t n64_read16() {
-  sio_hw->gpio_clr = (1UL << RD_PIN); // Assert /RD (drive RD_PIN LOW) to initiate the read cycle.
+  BUS_PERF_BEGIN(t0);
+  bus_hal_gpio_clr(1UL << RD_PIN); // Assert /RD (drive RD_PIN LOW) to initiate the read cycle.
 
-  // Wait for N64 Read Access Time (T_acs(RD) max ~440ns for ROM).
-  // 55 NOPs * 8ns/NOP = 440ns. This is the critical delay from /RD going low
-  // until data is guaranteed to be valid on the bus.
-  critical_delay_nops(55);
+  // Wait for the read access time (T_acs(RD), ~440 ns max for ROM before
+  // calibration) until data is guaranteed to be valid on the bus.
+  bus_hal_delay_cycles(adBus_access_cycles());
 
-  uint32_t port_val = sio_hw->gpio_in; // Read the state of all GPIO pins at once.
+  uint32_t port_val = bus_hal_gpio_in(); // Read the state of all GPIO pins at once.
   // Extract the 16 bits corresponding to the AD bus (AD_BUS_MASK) from the full
   // 32-bit `gpio_in` register value. Then, shift these bits down so that the
   // bit from AD0 (AD_BUS_PIN_START) is at bit 0 of the `v` result.
   uint16_t v = (uint16_t)((port_val & AD_BUS_MASK) >> AD_BUS_PIN_START);
 
-  sio_hw->gpio_set = (1UL << RD_PIN); // De-assert /RD (drive RD_PIN HIGH) to end the read cycle.
-  critical_delay_nops(7); // Data Hold Time (T_h(RD-AD) min ~30ns for N64).
-                          // 7 NOPs = 56ns, ensuring the cartridge keeps data valid briefly.
+  bus_hal_gpio_set(1UL << RD_PIN); // De-assert /RD (drive RD_PIN HIGH) to end the read cycle.
+  bus_hal_delay_cycles(adBus_timing.hold_cycles); // Data Hold Time (T_h(RD-AD) min ~30ns for N64).
+  adBus_advance(2);                // /RD↑ moved the cart to the next word
+  BUS_PERF_END(BUS_PERF_RD, t0, 0);
   return v;
 }
 
+void adBus_read_words(uint32_t addr, uint16_t *dst, size_t n) {
+    adBus_latch(addr);
+    for (size_t i = 0; i < n; ++i) dst[i] = n64_read16();
+}
+
+// Drive one word and pulse /WR; the bus must already be an output
+static inline void adBus_write_cycle(uint16_t data) {
+  uint32_t data_bits = ((uint32_t)data << AD_BUS_PIN_START) & AD_BUS_MASK;
+  BUS_PERF_BEGIN(t0);
+  bus_hal_gpio_clr(AD_BUS_MASK);    // clear old bits
+  bus_hal_gpio_set(data_bits);      // drive new data
+  bus_hal_delay_cycles(WR_SETUP_CYCLES);
+
+  // Pulse WR low/high
+  bus_hal_gpio_clr(1UL << WR_PIN);
+  bus_hal_delay_cycles(WR_PULSE_CYCLES);
+  bus_hal_gpio_set(1UL << WR_PIN);
+  bus_hal_delay_cycles(WR_SETUP_CYCLES);
+  adBus_advance(2);                 // /WR↑ moved the cart to the next word
+  BUS_PERF_END(BUS_PERF_WR, t0, data);
+}
+
+void adBus_write_words(uint32_t addr, const uint16_t *src, size_t n) {
+    adBus_latch(addr);
+    adBus_dir(true);
+    for (size_t i = 0; i < n; ++i) adBus_write_cycle(src[i]);
+    adBus_dir(false);
+}
+
 uint16_t sram_read_word(uint32_t addr) {
     // 1) Drive address onto AD[0..15] and strobe ALE_H/ALE_L
     adBus_set_address(addr);
@@ -136,40 +205,21 @@ uint16_t sram_read_word(uint32_t addr) {
     return n64_read16();
 }
 
-// --- Write one 16-bit word: place on bus, assert WR low for ~440 ns, release ---
-//    (This parallels readWord_SIO but driving WR instead of RD.)
+// --- Write one 16-bit word at the latched address ---
 void writeWord_SIO(uint16_t data) {
-  // Drive AD bus as output
   adBus_dir(true);
-
-  uint32_t data_bits = ((uint32_t)data << AD_BUS_PIN_START) & AD_BUS_MASK;
-  sio_hw->gpio_clr = AD_BUS_MASK;    // clear old bits
-  sio_hw->gpio_set = data_bits;      // drive new data
-  critical_delay_nops(7);
-
-  // Pulse WR low/high
-  sio_hw->gpio_clr = (1UL << WR_PIN);
-  critical_delay_nops(55);
-  sio_hw->gpio_set = (1UL << WR_PIN);
-  critical_delay_nops(7);
-
-  // Float bus again
+  adBus_write_cycle(data);
   adBus_dir(false);
 }
 
 // --- Write the first 32 bytes of SRAM with the pattern DE AD BE EF repeated ---
 //    => that's 16 words: {0xDEAD, 0xBEEF, 0xDEAD, ...}
 void write_first_32_bytes() {
-  bool writeDEAD = true;
-  for (uint32_t offset = 0; offset < 32; offset += 2) {
-    uint32_t curr_addr = N64_SRAM_BASE + offset;
-    adBus_set_address(curr_addr);
-
-    uint16_t word_to_write = writeDEAD ? 0xDEAD : 0xBEEF;
-    writeWord_SIO(word_to_write);
-
-    writeDEAD = !writeDEAD;
+  uint16_t words[16];
+  for (size_t i = 0; i < 16; ++i) {
+    words[i] = (i & 1) ? 0xBEEF : 0xDEAD;
   }
+  adBus_write_words(N64_SRAM_BASE, words, 16);
   printf("SRAM write complete.");
 }
 
@@ -206,8 +256,46 @@ void dump_sram_to_stdio(void) {
     printf("SRAM dump complete.\n");
 }
 
-void critical_delay_nops(int nops_count) {
-  for (int i = 0; i < nops_count; ++i) {
-    __asm volatile("nop\n"); // Inline assembly for a single NOP instruction.
-  }
-}
\ No newline at end of file
+/* ------------------------------------------------------------ */
+/*  Microbenchmark                                              */
+/* ------------------------------------------------------------ */
+#define BENCH_LATCHES     1000u
+#define BENCH_WORDS       1000u
+#define BENCH_BURSTS      8u
+#define BENCH_BURST_WORDS 512u
+
+static uint16_t bench_buf[BENCH_BURST_WORDS];
+
+static uint32_t per_op_ns(uint32_t t0, uint32_t ops) {
+    return (uint32_t)(((uint64_t)(time_us_32() - t0) * 1000u) / ops);
+}
+
+void adBus_benchmark(ad_bus_bench_t *out) {
+    // Alternate between two 64 KiB halves so every latch needs ALE_H
+    uint32_t t0 = time_us_32();
+    for (uint32_t i = 0; i < BENCH_LATCHES; ++i) {
+        adBus_latch(N64_ROM_BASE + ((i & 1u) << 16));
+    }
+    out->latch_full_ns = per_op_ns(t0, BENCH_LATCHES);
+
+    t0 = time_us_32();
+    for (uint32_t i = 0; i < BENCH_LATCHES; ++i) {
+        adBus_latch(N64_ROM_BASE + ((i & 0x7FFu) << 4));
+    }
+    out->latch_lo_ns = per_op_ns(t0, BENCH_LATCHES);
+
+    adBus_latch(N64_ROM_BASE);
+    t0 = time_us_32();
+    for (uint32_t i = 0; i < BENCH_WORDS; ++i) {
+        bench_buf[i % BENCH_BURST_WORDS] = n64_read16();
+    }
+    out->read_word_ns = per_op_ns(t0, BENCH_WORDS);
+
+    t0 = time_us_32();
+    for (uint32_t b = 0; b < BENCH_BURSTS; ++b) {
+        adBus_latch(N64_ROM_BASE + b * BENCH_BURST_WORDS * 2u);
+        ad_bus_pio_read_start((uint8_t *)bench_buf, BENCH_BURST_WORDS);
+        ad_bus_pio_read_wait();
+    }
+    out->burst_word_ns = per_op_ns(t0, BENCH_BURSTS * BENCH_BURST_WORDS);
+}
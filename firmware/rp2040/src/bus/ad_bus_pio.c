@@ -0,0 +1,72 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "pico/stdlib.h"
+#include "hardware/pio.h"
+#include "hardware/dma.h"
+#include "hardware/gpio.h"
+
+#include "ad_bus.pio.h"
+#include <bus/ad_bus.h>
+#include <bus/ad_bus_pio.h>
+#include <bus/ad_bus_timing.h>
+
+static PIO  bus_pio = AD_BUS_PIO_BLOCK;
+static uint bus_sm  = AD_BUS_PIO_SM;
+static int  bus_dma = -1;
+static bool bus_active = false;
+
+void ad_bus_pio_init(void) {
+    uint offset = pio_add_program(bus_pio, &ad_bus_read_program);
+    pio_sm_claim(bus_pio, bus_sm);
+
+    pio_sm_config c = ad_bus_read_program_get_default_config(offset);
+    sm_config_set_in_pins(&c, AD_BUS_PIN_START);
+    sm_config_set_set_pins(&c, RD_PIN, 1);
+    sm_config_set_in_shift(&c, false, true, 16);   // autopush every sample
+    sm_config_set_out_shift(&c, true, false, 32);  // descriptor shifts right
+    sm_config_set_clkdiv(&c, 1);
+
+    // /RD stays on SIO until a burst starts; preload the PIO copy HIGH so
+    // the hand-over is glitch free.
+    pio_sm_set_pins_with_mask(bus_pio, bus_sm, 1u << RD_PIN, 1u << RD_PIN);
+    pio_sm_set_pindirs_with_mask(bus_pio, bus_sm, 1u << RD_PIN, 1u << RD_PIN);
+
+    pio_sm_init(bus_pio, bus_sm, offset, &c);
+    pio_sm_set_enabled(bus_pio, bus_sm, true);
+
+    bus_dma = dma_claim_unused_channel(true);
+}
+
+// Start a burst of 'words' sequential reads from the address already latched
+// on the bus. Samples land in dst big-endian (cart byte order).
+void ad_bus_pio_read_start(uint8_t *dst, size_t words) {
+    if (words == 0) return;
+
+    dma_channel_config c = dma_channel_get_default_config((uint)bus_dma);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_16);
+    channel_config_set_read_increment(&c, false);
+    channel_config_set_write_increment(&c, true);
+    channel_config_set_bswap(&c, true);            // AD15..8 first in memory
+    channel_config_set_dreq(&c, pio_get_dreq(bus_pio, bus_sm, false));
+    dma_channel_configure((uint)bus_dma, &c, dst, &bus_pio->rxf[bus_sm],
+                          (uint)words, true);
+
+    // Hand /RD to the state machine and kick off the burst
+    gpio_set_function(RD_PIN, pio_get_index(bus_pio) ? GPIO_FUNC_PIO1 : GPIO_FUNC_PIO0);
+    pio_sm_put(bus_pio, bus_sm, AD_BUS_PIO_DESC(words, adBus_access_cycles()));
+    adBus_note_burst(words);
+    bus_active = true;
+}
+
+bool ad_bus_pio_busy(void) {
+    return bus_active && dma_channel_is_busy((uint)bus_dma);
+}
+
+// Block until the current burst is in memory and return /RD to SIO
+void ad_bus_pio_read_wait(void) {
+    if (!bus_active) return;
+    dma_channel_wait_for_finish_blocking((uint)bus_dma);
+    gpio_set_function(RD_PIN, GPIO_FUNC_SIO);
+    bus_active = false;
+}
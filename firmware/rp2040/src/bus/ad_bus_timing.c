@@ -0,0 +1,113 @@
+/* ad_bus_timing.c – per-cartridge AD bus timing calibration
+ *  ---------------------------------------------------------------
+ *  • The reference is the IPL3 boot code right after the header: dense,
+ *    never padding, and present on every cart
+ *  • Each setting must return the golden copy on every pass; the first
+ *    failure ends the sweep for that parameter
+ *  • Reads go through the PIO burst engine, the path the dump uses
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include "pico/stdlib.h"
+
+#include <bus/ad_bus.h>
+#include <bus/ad_bus_pio.h>
+#include <bus/ad_bus_timing.h>
+
+#define CAL_REF_OFFSET     0x40u      // IPL3 starts after the 64-byte header
+#define CAL_REF_BURSTS     4u         // separately latched bursts per pass
+#define CAL_BURST_BYTES    256u
+#define CAL_REF_BYTES      (CAL_REF_BURSTS * CAL_BURST_BYTES)
+#define CAL_PASSES         4u         // identical reads needed per setting
+#define CAL_MIN_ACCESS     4u
+#define CAL_MIN_LATCH      1u
+
+ad_bus_timing_t adBus_timing = AD_BUS_TIMING_DEFAULT;
+
+static uint8_t golden[CAL_REF_BYTES] __attribute__((aligned(4)));
+static uint8_t sample[CAL_REF_BYTES] __attribute__((aligned(4)));
+static uint32_t reads;
+
+void adBus_timing_reset(void) {
+    static const ad_bus_timing_t defaults = AD_BUS_TIMING_DEFAULT;
+    adBus_timing = defaults;
+}
+
+// One pass over the reference: a fresh address latch per burst so the ALE
+// timing is exercised as well as /RD
+static void read_reference(uint8_t *dst) {
+    for (uint32_t b = 0; b < CAL_REF_BURSTS; ++b) {
+        adBus_set_address(N64_ROM_BASE + CAL_REF_OFFSET + b * CAL_BURST_BYTES);
+        ad_bus_pio_read_start(&dst[b * CAL_BURST_BYTES], CAL_BURST_BYTES / 2u);
+        ad_bus_pio_read_wait();
+    }
+    reads++;
+}
+
+static bool stable(void) {
+    for (uint32_t pass = 0; pass < CAL_PASSES; ++pass) {
+        read_reference(sample);
+        if (memcmp(sample, golden, sizeof(golden)) != 0) return false;
+    }
+    return true;
+}
+
+// Shortest value of one field that still reads back stable; the other
+// fields stay at whatever the profile holds
+static uint16_t sweep(uint16_t *field, uint16_t from, uint16_t floor) {
+    uint16_t best = from;
+    for (uint16_t v = from; v >= floor; --v) {
+        *field = v;
+        if (!stable()) break;
+        best = v;
+        if (v == 0) break;
+    }
+    *field = best;
+    return best;
+}
+
+// A quarter of the measured value on top, at least a couple of cycles,
+// never slower than the datasheet default
+static uint16_t with_margin(uint16_t fastest, uint16_t def) {
+    uint32_t v = fastest + (fastest / 4u > 2u ? fastest / 4u : 2u);
+    return (uint16_t)(v < def ? v : def);
+}
+
+bool adBus_calibrate(ad_bus_cal_result_t *res) {
+    static const ad_bus_timing_t defaults = AD_BUS_TIMING_DEFAULT;
+    adBus_timing_reset();
+    reads = 0;
+
+    // Golden copy at the datasheet timing; it must itself be repeatable
+    read_reference(golden);
+    if (!stable()) {
+        adBus_timing_reset();
+        return false;
+    }
+
+    // /RD access first (the bulk of every word), then the ALE edges with
+    // the access already at its limit
+    ad_bus_timing_t fastest = defaults;
+    fastest.access_cycles = sweep(&adBus_timing.access_cycles, defaults.access_cycles, CAL_MIN_ACCESS);
+    fastest.latch_cycles  = sweep(&adBus_timing.latch_cycles,  defaults.latch_cycles,  CAL_MIN_LATCH);
+
+    ad_bus_timing_t applied = defaults;
+    applied.access_cycles = with_margin(fastest.access_cycles, defaults.access_cycles);
+    applied.latch_cycles  = with_margin(fastest.latch_cycles,  defaults.latch_cycles);
+
+    // Confirm the profile we are about to use, not just the sweep points
+    adBus_timing = applied;
+    if (!stable()) {
+        adBus_timing_reset();
+        return false;
+    }
+
+    if (res) {
+        res->fastest = fastest;
+        res->applied = applied;
+        res->reads   = reads;
+    }
+    return true;
+}
@@ -0,0 +1,132 @@
+/* bus_perf.c – counters and per-core trace rings behind bus_perf.h
+ *  ---------------------------------------------------------------
+ *  • SysTick runs from the processor clock with the full 24-bit
+ *    reload and no interrupt; each core has its own
+ *  • One ring per core: the M0+ has no atomic increment, and the cores
+ *    only ever share the counter array for different events (the bus
+ *    owner counts bus events, core 0 counts USB)
+ *  • Without N64_PERF only the stubs below the #else remain
+ */
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "pico/stdlib.h"
+#include "pico/multicore.h"
+
+#include <bus/bus_perf.h>
+
+static const char *const names[BUS_PERF_EVENTS] = {
+    [BUS_PERF_LATCH_FULL] = "latch (ALE_H+L)",
+    [BUS_PERF_LATCH_LO]   = "latch (ALE_L)",
+    [BUS_PERF_DIR]        = "AD direction",
+    [BUS_PERF_RD]         = "/RD word",
+    [BUS_PERF_WR]         = "/WR word",
+    [BUS_PERF_BURST]      = "PIO burst",
+    [BUS_PERF_JOYBUS]     = "joybus xact",
+    [BUS_PERF_EEP_BUSY]   = "EEPROM busy",
+    [BUS_PERF_USB_TX]     = "USB frame",
+};
+
+const char *bus_perf_name(unsigned event) {
+    return event < BUS_PERF_EVENTS ? names[event] : "?";
+}
+
+#if defined(N64_PERF) && N64_PERF
+
+static bus_perf_counter_t counters[BUS_PERF_EVENTS];
+
+#if BUS_PERF_TRACE_DEPTH
+static bus_perf_trace_t ring[2][BUS_PERF_TRACE_DEPTH];
+static uint32_t         ring_head[2];        // entries written, ever
+#endif
+
+void bus_perf_init(void) {
+#if !(defined(N64_HOST) && N64_HOST)
+    systick_hw->csr = 0;
+    systick_hw->rvr = BUS_PERF_CYCLE_MASK;
+    systick_hw->cvr = 0;
+    systick_hw->csr = M0PLUS_SYST_CSR_CLKSOURCE_BITS | M0PLUS_SYST_CSR_ENABLE_BITS;
+#endif
+}
+
+void __not_in_flash_func(bus_perf_end)(unsigned event, uint32_t start, uint32_t arg) {
+    uint32_t cycles = (bus_perf_now() - start) & BUS_PERF_CYCLE_MASK;
+    bus_perf_counter_t *c = &counters[event];
+    c->count++;
+    c->cycles += cycles;
+    if (cycles > c->max_cycles) c->max_cycles = cycles;
+
+#if BUS_PERF_TRACE_DEPTH
+    uint32_t core = get_core_num();
+    bus_perf_trace_t *t = &ring[core][ring_head[core]++ % BUS_PERF_TRACE_DEPTH];
+    t->t_us   = time_us_32();
+    t->arg    = arg;
+    t->cycles = cycles;
+    t->event  = (uint8_t)event;
+    t->core   = (uint8_t)core;
+#else
+    (void)arg;
+#endif
+}
+
+bool bus_perf_take(bus_perf_counter_t out[BUS_PERF_EVENTS]) {
+    memcpy(out, counters, sizeof(counters));
+    memset(counters, 0, sizeof(counters));
+    return true;
+}
+
+#if BUS_PERF_TRACE_DEPTH
+// Ring whose next entry is older; 'have' counts what is left in each
+static unsigned older_ring(const uint32_t have[2], const uint32_t idx[2]) {
+    if (!have[0]) return 1u;
+    if (!have[1]) return 0u;
+    int32_t d = (int32_t)(ring[1][idx[1] % BUS_PERF_TRACE_DEPTH].t_us -
+                          ring[0][idx[0] % BUS_PERF_TRACE_DEPTH].t_us);
+    return d < 0 ? 1u : 0u;
+}
+#endif
+
+unsigned bus_perf_take_trace(bus_perf_trace_t *out, unsigned max) {
+    unsigned n = 0;
+#if BUS_PERF_TRACE_DEPTH
+    uint32_t have[2], idx[2];
+    for (unsigned c = 0; c < 2; ++c) {
+        have[c] = ring_head[c] < BUS_PERF_TRACE_DEPTH ? ring_head[c] : BUS_PERF_TRACE_DEPTH;
+        idx[c]  = ring_head[c] - have[c];
+    }
+    // Skip the oldest until the newest 'max' remain, then merge by time
+    while (have[0] + have[1] > max) {
+        unsigned c = older_ring(have, idx);
+        idx[c]++;
+        have[c]--;
+    }
+    while (have[0] || have[1]) {
+        unsigned c = older_ring(have, idx);
+        out[n++] = ring[c][idx[c]++ % BUS_PERF_TRACE_DEPTH];
+        have[c]--;
+    }
+    ring_head[0] = ring_head[1] = 0;
+#else
+    (void)out;
+    (void)max;
+#endif
+    return n;
+}
+
+#else
+
+void bus_perf_init(void) {}
+
+bool bus_perf_take(bus_perf_counter_t out[BUS_PERF_EVENTS]) {
+    memset(out, 0, sizeof(bus_perf_counter_t) * BUS_PERF_EVENTS);
+    return false;
+}
+
+unsigned bus_perf_take_trace(bus_perf_trace_t *out, unsigned max) {
+    (void)out;
+    (void)max;
+    return 0;
+}
+
+#endif
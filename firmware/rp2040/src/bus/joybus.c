@@ -1,4 +1,3 @@
-
 /**
  * SPX-License-Identifier: BSD-2-Clause 
  * Copyright (c) 2023 - NopJne
@@ -14,7 +13,16 @@
 //0x04    Read EEPROM   N64 Cartridge    2        8
 //0x05    Write EEPROM  N64 Cartridge    10       1
 
+/* EEPROM driver
+ *  ---------------------------------------------------------------
+ *  • Transactions go through the shared joybus engine (joybus_port.c):
+ *    table-encoded, DMA-fed, completed by interrupt
+ *  • The next command starts as soon as the cart's stop bit is over;
+ *    writes poll the status byte instead of sleeping
+ */
+
 #include <stdlib.h>
+#include <string.h>
 #include "pico/stdlib.h"
 #include "pico/platform.h"
 #include "hardware/gpio.h"
@@ -22,10 +30,27 @@
 
 #include "joybus.pio.h"
 #include <bus/joybus.h>
+#include <bus/joybus_port.h>
+#include <bus/bus_perf.h>
+
+#define JB_SM               0
+#define CLK_SM              1        // pio1; claimed so later users skip it
+#define JB_RETRIES          10u
+
+#define EEP_CMD_INFO        0x00u
+#define EEP_CMD_READ        0x04u
+#define EEP_CMD_WRITE       0x05u
+#define EEP_STATUS_BUSY     0x80u    // info byte 2: a write is still in progress
+#define EEP_WRITE_TIMEOUT_US 50000u
 
 uint32_t ReadCount = 0;
 uint32_t gEepromSize = 0;
 
+static PIO pio = pio0;
+static PIO pio_1 = pio1;
+static joybus_port_t eep_port;
+static eep_stats_t stats;
+
 void n64_joyBus_reset() {
     sleep_ms(300);
     gpio_put(EEP_RST, true);
@@ -38,28 +63,15 @@ void n64_eep_init() {
     InitEeprom(EEP_DAT);
 }
 
-void __time_critical_func(convertToPio)(const uint8_t* command, const int len, uint32_t* result, int* resultLen) {
-    if (len == 0) {
-        *resultLen = 0;
-        return;
-    }
-    *resultLen = len/2 + 1;
-    int i;
-    for (i = 0; i < *resultLen; i++) {
-        result[i] = 0;
-    }
-    for (i = 0; i < len; i++) {
-        for (int j = 0; j < 8; j++) {
-            result[i / 2] += (uint32_t)(1 << (2 * (8 * (i % 2) + j) + 1));
-            result[i / 2] += (uint32_t)((!!(command[i] & (0x80u >> j))) << (2 * (8 * (i % 2) + j)));
-        }
-    }
-    // End bit
-    result[len / 2] += 3 << (2 * (8 * (len % 2)));
+// Send one command and collect 'reply_len' bytes. False on a timeout
+// (no device, or a device still busy writing).
+static bool transact(const uint8_t *cmd, uint len, uint8_t *reply, uint reply_len) {
+    BUS_PERF_BEGIN(t0);
+    bool ok = joybus_transact(&eep_port, cmd, len, reply, reply_len);
+    BUS_PERF_END(BUS_PERF_JOYBUS, t0, cmd[0]);
+    return ok;
 }
 
-static PIO pio = pio0;
-static PIO pio_1 = pio1;
 void __time_critical_func(InitEepromClock)(uint clockpin)
 {
     gpio_init(clockpin);
@@ -75,174 +87,112 @@ void __time_critical_func(InitEepromClock)(uint clockpin)
     //sm_config_set_out_shift(&config1, true, false, 32);
     //sm_config_set_in_shift(&config1, false, true, 8);
     
-    pio_sm_init(pio_1, 1, offset_1 + joybus_offset_clockgen, &config1);
-    pio_sm_set_enabled(pio_1, 1, true);
-}
-
-uint32_t GetInputWithTimeout(void)
-{
-    uint32_t lastWriteTime = time_us_32();
-    while (1) {
-        if(pio_sm_is_rx_fifo_empty(pio, 0)) {
-            uint32_t now = time_us_32();
-            uint32_t diff = now - lastWriteTime;
-
-            // Send the eeprom data if it's been ?Seconds since the last eeprom write
-            // Reset the lastWriteTime to 0 and don't sent the data unless we get another write
-            if (lastWriteTime != 0 && diff > 1000) {
-                lastWriteTime = 0;
-                break;
-            }
-        } else {
-            return pio_sm_get(pio, 0);
-        }
-    }
-
-    return 0xFFFFFFFF;
+    pio_sm_claim(pio_1, CLK_SM);
+    pio_sm_init(pio_1, CLK_SM, offset_1 + joybus_offset_clockgen, &config1);
+    pio_sm_set_enabled(pio_1, CLK_SM, true);
 }
 
-static pio_sm_config config;
-static uint piooffset;
 void __time_critical_func(InitEeprom)(uint dataPin)
 {
-    gpio_init(dataPin);
-    gpio_set_dir(dataPin, GPIO_IN);
-    gpio_pull_up(dataPin);
+    joybus_port_init(&eep_port, pio, JB_SM, dataPin);
 
     sleep_us(100); // Stabilize voltages
+    n64_eep_detect();
+}
 
-    pio_gpio_init(pio, dataPin);
-
-    piooffset = (uint)pio_add_program(pio, &joybus_program);
-    config = joybus_program_get_default_config(piooffset);
-    sm_config_set_in_pins(&config, dataPin);
-    sm_config_set_out_pins(&config, dataPin, 1);
-    sm_config_set_set_pins(&config, dataPin, 1);
-    sm_config_set_clkdiv(&config, 5);
-    sm_config_set_out_shift(&config, true, false, 32);
-    sm_config_set_in_shift(&config, false, true, 8);
-
-    pio_sm_init(pio, 0, piooffset, &config);
-    pio_sm_set_enabled(pio, 0, true);
-
-    // Send the info command
-    {
-        uint8_t probeResponse[1] = {0x00};
-        uint32_t result[8];
-        int resultLen;
-        convertToPio(probeResponse, 1, result, &resultLen);
+// Send the info command and determine the size of the EEPROM
+uint32_t n64_eep_detect(void)
+{
+    const uint8_t cmd = EEP_CMD_INFO;
+    uint8_t info[3];
+    n64_eep_set_size(0);
+    if (!transact(&cmd, 1, info, sizeof(info))) return 0;
+
+    if (info[1] == 0x80) {
+        // 4K Eeprom.
+        n64_eep_set_size(512);
+    } else if (info[1] == 0xC0) {
+        // 16K Eeprom.
+        n64_eep_set_size(512 * 4);
+    }
+    return gEepromSize;
+}
 
-        pio_sm_set_enabled(pio, 0, false);
-        pio_sm_init(pio, 0, piooffset + joybus_offset_outmode, &config);
-        pio_sm_set_enabled(pio, 0, true);
+void n64_eep_set_size(uint32_t bytes)
+{
+    gEepromSize = (bytes == 512u || bytes == 2048u) ? bytes : 0;
+    ReadCount   = gEepromSize / 8u;
+}
 
-        for (int i = 0; i < resultLen; i++) pio_sm_put_blocking(pio, 0, result[i]);
-    }
+// Poll the status byte until the last write has been committed
+static bool wait_ready(void) {
+    const uint8_t cmd = EEP_CMD_INFO;
+    uint8_t  info[3];
+    uint32_t t0 = time_us_32();
+    bool     ready = false;
+    BUS_PERF_BEGIN(c0);
+    do {
+        ready = transact(&cmd, 1, info, sizeof(info)) && !(info[2] & EEP_STATUS_BUSY);
+        if (!ready) stats.polls++;
+    } while (!ready && time_us_32() - t0 < EEP_WRITE_TIMEOUT_US);
+    BUS_PERF_END(BUS_PERF_EEP_BUSY, c0, 0);
+    return ready;
+}
 
-    // Check response
-    uint32_t buffer[3];
-    buffer[0] = GetInputWithTimeout();
-    if (buffer[0] == 0) {
-        buffer[1] = pio_sm_get_blocking(pio, 0);
-        buffer[2] = pio_sm_get_blocking(pio, 0);
-
-        // Determine the size of the EEPROM.
-        if (buffer[1] == 0x80) {
-            // 4K Eeprom.
-            ReadCount = 64;
-            gEepromSize = 512;
-        } else if (buffer[1] == 0xC0) {
-            // 16K Eeprom.
-            ReadCount = 256;
-            gEepromSize = 512 * 4;
-        } else {
-            // Unknown SI eeprom type.
-            ReadCount = 0;
-            gEepromSize = 0;
+bool __time_critical_func(ReadEepromBlocks)(uint32_t first, uint32_t count, uint8_t *buffer)
+{
+    stats = (eep_stats_t){ 0 };                 // a refused call reports nothing
+    if (gEepromSize == 0 || first + count > ReadCount) return false;
+
+    uint32_t t0 = time_us_32();
+    for (uint32_t b = first; b < first + count; ++b) {
+        const uint8_t cmd[2] = { EEP_CMD_READ, (uint8_t)b };
+        uint32_t tries = 0;
+        while (!transact(cmd, sizeof(cmd), &buffer[(b - first) * 8u], 8)) {
+            if (++tries > JB_RETRIES) return false;
+            stats.retries++;
         }
     }
+    stats.blocks = count;
+    stats.us     = time_us_32() - t0;
+    return true;
 }
 
-void __time_critical_func(ReadEepromData)(uint32_t offset, uint8_t *buffer) 
+bool __time_critical_func(WriteEepromBlocks)(uint32_t first, uint32_t count, const uint8_t *buffer)
 {
-    if (gEepromSize == 0) {
-        return;
-    }
-
-    // Read the eeprom.
-    for (uint32_t ReadIndex = 0; ReadIndex < 64; ReadIndex += 1) {
-        // Construct the read command.
-        uint8_t probeResponse[] = {0x04, (uint8_t)(ReadIndex + offset)};
-        uint32_t result[8];
-        int resultLen;
-        convertToPio(probeResponse, 2, result, &resultLen);
-
-        uint32_t firstInput;
-        uint32_t retries = 0;
-        do {
-            // Send the read command
-            pio_sm_set_enabled(pio, 0, false);
-            pio_sm_init(pio, 0, piooffset + joybus_offset_outmode, &config);
-            pio_sm_set_enabled(pio, 0, true);
-
-            for (int i = 0; i < resultLen; i++) pio_sm_put_blocking(pio, 0, result[i]);
-
-            firstInput = GetInputWithTimeout();
-            if (retries > 10) {
-                gEepromSize = 0;
-                return;
-            }
-            retries += 1;
-
-        } while (firstInput == 0xFFFFFFFF);
-        // Read the incoming data from the cart.
-        buffer[(uint)ReadIndex * 8] = (uint8_t)firstInput;
-        for (int i = 1; i < 8; i += 1) {
-            buffer[(uint)i + (uint)ReadIndex * 8] = (uint8_t)pio_sm_get_blocking(pio, 0);
+    stats = (eep_stats_t){ 0 };                 // a refused call reports nothing
+    if (gEepromSize == 0 || first + count > ReadCount) return false;
+
+    uint32_t t0 = time_us_32();
+    for (uint32_t b = first; b < first + count; ++b) {
+        uint8_t cmd[10] = { EEP_CMD_WRITE, (uint8_t)b };
+        memcpy(&cmd[2], &buffer[(b - first) * 8u], 8);
+
+        // The previous write must be committed before the next is taken
+        uint8_t  status;
+        uint32_t tries = 0;
+        while (!wait_ready() || !transact(cmd, sizeof(cmd), &status, 1)) {
+            if (++tries > JB_RETRIES) return false;
+            stats.retries++;
         }
-        sleep_us(200);
     }
+    bool ok = wait_ready();
+    stats.blocks = count;
+    stats.us     = time_us_32() - t0;
+    return ok;
 }
 
-void __time_critical_func(WriteEepromData)(uint32_t offset, uint8_t *buffer)
+void ReadEepromData(uint32_t offset, uint8_t *buffer)
 {
-    // Write the eeprom.
-    for (uint32_t WriteIndex = 0; WriteIndex < 64; WriteIndex += 1) {
-        // Construct the write command.
-        uint8_t probeResponse[10] = {0x05, (uint8_t)(WriteIndex + offset)};
-        for (uint i = 0; i < 8; i += 1) {
-            probeResponse[i + 2] = buffer[i + (WriteIndex * 8)];
-        }
+    ReadEepromBlocks(offset, 64, buffer);
+}
 
-        uint32_t result[10];
-        int resultLen;
-        convertToPio(probeResponse, 10, result, &resultLen);
-
-        uint32_t firstInput;
-        uint32_t retries = 0;
-        do {
-            // Send the read command
-            pio_sm_set_enabled(pio, 0, false);
-            pio_sm_init(pio, 0, piooffset + joybus_offset_outmode, &config);
-            pio_sm_set_enabled(pio, 0, true);
-
-            for (int i = 0; i < resultLen; i++) pio_sm_put_blocking(pio, 0, result[i]);
-
-            firstInput = GetInputWithTimeout();
-            if (retries > 10) {
-                gEepromSize = 0;
-                return;
-            }
-            retries += 1;
-
-        } while (firstInput == 0xFFFFFFFF);
-        // Read the incoming data from the cart.
-        uint8_t response[2];
-        response[0] = (uint8_t)firstInput;
-        if (response[0] != 0) {
-            sleep_ms(10);
-        }
+void WriteEepromData(uint32_t offset, uint8_t *buffer)
+{
+    WriteEepromBlocks(offset, 64, buffer);
+}
 
-        sleep_us(200);
-    }
-}
\ No newline at end of file
+void GetEepromStats(eep_stats_t *out)
+{
+    *out = stats;
+}
@@ -0,0 +1,224 @@
+/* joybus_port.c – queued, interrupt-driven joybus transactions
+ *  ---------------------------------------------------------------
+ *  • Commands are encoded with a 256-entry table (two bits per console
+ *    bit, LSB first: value, then "drive this bit") and fed by DMA
+ *  • The RX channel's completion raises DMA_IRQ_1; the handler ends the
+ *    transaction and arms the stop-bit guard, whose alarm starts the
+ *    next queued one
+ *  • A timeout alarm covers a device that never answers
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "pico/stdlib.h"
+#include "pico/platform.h"
+#include "pico/critical_section.h"
+#include "hardware/dma.h"
+#include "hardware/gpio.h"
+#include "hardware/irq.h"
+#include "hardware/pio.h"
+
+#include "joybus.pio.h"
+#include <bus/joybus_port.h>
+
+#define JB_BIT_US          4u        // one bit cell on the wire
+#define JB_REPLY_SLACK_US  100u      // console stop bit → first reply bit, with margin
+#define JB_STOP_GUARD_US   6u        // rest of the last reply cell + the device's stop bit
+#define JB_CLKDIV          5
+
+static uint16_t           enc_table[256];
+static int                prog_offset[NUM_PIOS] = { -1, -1 };
+static joybus_port_t     *ports[JOYBUS_MAX_PORTS];
+static uint               port_count;
+static critical_section_t lock;
+
+static void build_enc_table(void) {
+    for (uint b = 0; b < 256; ++b) {
+        uint16_t w = 0;
+        for (uint j = 0; j < 8; ++j) {
+            w |= (uint16_t)((2u | ((b >> (7u - j)) & 1u)) << (2u * j));
+        }
+        enc_table[b] = w;
+    }
+}
+
+// Command bytes → TX FIFO words, two bytes per word, then the stop bit
+static uint __time_critical_func(encode)(uint32_t *words, const uint8_t *cmd, uint len) {
+    uint n = 0;
+    for (uint i = 0; i < len; i += 2) {
+        uint32_t w = enc_table[cmd[i]];
+        w |= (i + 1 < len) ? (uint32_t)enc_table[cmd[i + 1]] << 16 : 3u << 16;
+        words[n++] = w;
+    }
+    if ((len & 1u) == 0) words[n++] = 3u;
+    return n;
+}
+
+static int64_t on_timeout(alarm_id_t id, void *user);
+static int64_t on_guard(alarm_id_t id, void *user);
+
+// Put the head of the queue on the wire
+static void __time_critical_func(start_head)(joybus_port_t *p) {
+    joybus_xfer_t *x = p->head;
+    uint n = encode(p->tx_words, x->tx, x->tx_len);
+
+    pio_sm_set_enabled(p->pio, p->sm, false);
+    pio_sm_clear_fifos(p->pio, p->sm);
+    pio_sm_restart(p->pio, p->sm);
+    pio_sm_exec(p->pio, p->sm, pio_encode_jmp(p->offset + joybus_offset_outmode));
+
+    dma_channel_config rx = dma_channel_get_default_config((uint)p->dma_rx);
+    channel_config_set_transfer_data_size(&rx, DMA_SIZE_8);
+    channel_config_set_read_increment(&rx, false);
+    channel_config_set_write_increment(&rx, true);
+    channel_config_set_dreq(&rx, pio_get_dreq(p->pio, p->sm, false));
+    dma_channel_configure((uint)p->dma_rx, &rx, x->rx, &p->pio->rxf[p->sm], x->rx_len, true);
+
+    dma_channel_config tx = dma_channel_get_default_config((uint)p->dma_tx);
+    channel_config_set_transfer_data_size(&tx, DMA_SIZE_32);
+    channel_config_set_read_increment(&tx, true);
+    channel_config_set_write_increment(&tx, false);
+    channel_config_set_dreq(&tx, pio_get_dreq(p->pio, p->sm, true));
+    dma_channel_configure((uint)p->dma_tx, &tx, &p->pio->txf[p->sm], p->tx_words, n, true);
+
+    x->status  = JOYBUS_ACTIVE;
+    x->t_start = time_us_32();
+    pio_sm_set_enabled(p->pio, p->sm, true);
+
+    uint32_t limit = (x->tx_len + x->rx_len + 1u) * 8u * JB_BIT_US + JB_REPLY_SLACK_US;
+    p->alarm = add_alarm_in_us(limit, on_timeout, p, true);
+}
+
+// Pop the head, hold the line for the stop bit and report it. The status
+// is the last write to the transaction: a waiter may reuse it right after.
+static void __time_critical_func(finish_head)(joybus_port_t *p, joybus_status_t st) {
+    critical_section_enter_blocking(&lock);
+    joybus_xfer_t *x = p->head;
+    p->head = x->next;
+    if (!p->head) p->tail = NULL;
+    p->guard = true;
+    p->alarm = add_alarm_in_us(JB_STOP_GUARD_US, on_guard, p, true);
+    critical_section_exit(&lock);
+
+    if (st == JOYBUS_OK) p->completed++;
+    else                 p->timeouts++;
+
+    joybus_done_t done = x->done;
+    x->t_end  = time_us_32();
+    x->status = (uint8_t)st;
+    if (done) done(x);
+}
+
+static int64_t on_guard(alarm_id_t id, void *user) {
+    (void)id;
+    joybus_port_t *p = user;
+    critical_section_enter_blocking(&lock);
+    p->alarm = 0;
+    p->guard = false;
+    if (p->head) start_head(p);
+    critical_section_exit(&lock);
+    return 0;
+}
+
+static int64_t on_timeout(alarm_id_t id, void *user) {
+    (void)id;
+    joybus_port_t *p = user;
+    p->alarm = 0;
+
+    // An abort can raise a spurious completion; keep it off the IRQ line
+    dma_channel_set_irq1_enabled((uint)p->dma_rx, false);
+    dma_channel_abort((uint)p->dma_rx);
+    dma_channel_abort((uint)p->dma_tx);
+    dma_channel_acknowledge_irq1((uint)p->dma_rx);
+    dma_channel_set_irq1_enabled((uint)p->dma_rx, true);
+
+    finish_head(p, JOYBUS_TIMEOUT);
+    return 0;
+}
+
+static void __time_critical_func(dma_irq_handler)(void) {
+    for (uint i = 0; i < port_count; ++i) {
+        joybus_port_t *p = ports[i];
+        if (!dma_channel_get_irq1_status((uint)p->dma_rx)) continue;
+        dma_channel_acknowledge_irq1((uint)p->dma_rx);
+        if (!p->head || p->head->status != JOYBUS_ACTIVE) continue;
+        cancel_alarm(p->alarm);
+        p->alarm = 0;
+        finish_head(p, JOYBUS_OK);
+    }
+}
+
+void joybus_port_init(joybus_port_t *p, PIO pio, uint sm, uint pin) {
+    if (port_count == 0) {
+        build_enc_table();
+        critical_section_init(&lock);
+        irq_set_exclusive_handler(DMA_IRQ_1, dma_irq_handler);
+        irq_set_enabled(DMA_IRQ_1, true);
+    }
+
+    uint idx = pio_get_index(pio);
+    if (prog_offset[idx] < 0) prog_offset[idx] = (int)pio_add_program(pio, &joybus_program);
+
+    bool known = false;
+    for (uint i = 0; i < port_count; ++i) known |= (ports[i] == p);
+    if (!known) {
+        memset(p, 0, sizeof(*p));
+        p->dma_tx = dma_claim_unused_channel(true);
+        p->dma_rx = dma_claim_unused_channel(true);
+        ports[port_count++] = p;
+    }
+    p->pio    = pio;
+    p->sm     = sm;
+    p->pin    = pin;
+    p->offset = (uint)prog_offset[idx];
+
+    gpio_init(pin);
+    gpio_set_dir(pin, GPIO_IN);
+    gpio_pull_up(pin);
+    pio_gpio_init(pio, pin);
+
+    pio_sm_config c = joybus_program_get_default_config(p->offset);
+    sm_config_set_in_pins(&c, pin);
+    sm_config_set_out_pins(&c, pin, 1);
+    sm_config_set_set_pins(&c, pin, 1);
+    sm_config_set_clkdiv(&c, JB_CLKDIV);
+    sm_config_set_out_shift(&c, true, false, 32);
+    sm_config_set_in_shift(&c, false, true, 8);
+    pio_sm_init(pio, sm, p->offset, &c);
+
+    dma_channel_set_irq1_enabled((uint)p->dma_rx, true);
+}
+
+void joybus_submit(joybus_port_t *p, joybus_xfer_t *x) {
+    x->next   = NULL;
+    x->status = JOYBUS_QUEUED;
+
+    critical_section_enter_blocking(&lock);
+    bool idle = !p->head && !p->guard;
+    if (p->tail) p->tail->next = x;
+    else         p->head = x;
+    p->tail = x;
+    if (idle) start_head(p);
+    critical_section_exit(&lock);
+}
+
+bool joybus_wait(joybus_xfer_t *x) {
+    while (x->status == JOYBUS_QUEUED || x->status == JOYBUS_ACTIVE) {
+        tight_loop_contents();
+    }
+    return x->status == JOYBUS_OK;
+}
+
+bool joybus_transact(joybus_port_t *p, const uint8_t *cmd, uint len,
+                     uint8_t *reply, uint reply_len) {
+    joybus_xfer_t x;
+    memcpy(x.tx, cmd, len);
+    x.tx_len = (uint8_t)len;
+    x.rx_len = (uint8_t)reply_len;
+    x.done   = NULL;
+    x.user   = NULL;
+    joybus_submit(p, &x);
+    bool ok = joybus_wait(&x);
+    if (ok) memcpy(reply, x.rx, reply_len);
+    return ok;
+}
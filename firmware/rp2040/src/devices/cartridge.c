@@ -7,18 +7,36 @@
 #include "pico/stdlib.h"
 
 #include <bus/ad_bus.h>             /* 16-bit multiplexed bus */
+#include <bus/ad_bus_pio.h>         /* PIO + DMA burst reads  */
+#include <bus/bus_perf.h>           /* N64_PERF counters      */
 #include <bus/joybus.h>             /* 1-wire serial + clock  */
 #include <devices/cartridge.h>
+#include <devices/flashram.h>
 
-// N64 ROM constants
-#define N64_FAST_CHUNK_BYTES 1024u    // 1 KiB burst
-#define N64_FAST_CHUNK_WORDS (N64_FAST_CHUNK_BYTES/2)
+// Burst length probing: bursts are aligned to their own length, so a
+// burst of L bytes only ever runs across boundaries finer than L
+#define N64_BURST_PROBE_POINTS 3u
+
+// Test points well inside the smallest (1 MiB) ROM, off the header
+static const uint32_t burst_probe_offsets[N64_BURST_PROBE_POINTS] = { 0x1000u, 0x20000u, 0x80000u };
+
+static size_t   burst_bytes = N64_BURST_DEFAULT_BYTES;
+static uint8_t  burst_test[N64_BURST_MAX_BYTES] __attribute__((aligned(4)));
+
+// ROM size probing
+#define N64_SIZE_MIN_BYTES   (1024u * 1024u)   // sizes are whole MiB
+#define N64_PROBE_BYTES      32u               // one sampled window
+#define N64_PROBE_WINDOWS    3u
+
+// Window offsets inside a 1 MiB step: the header, the boot code and a
+// point well into the game data
+static const uint32_t probe_offsets[N64_PROBE_WINDOWS] = { 0x0000u, 0x1000u, 0x80000u };
 
 // Primitive byte reader: reads 'len' even bytes starting at base_addr
 bool n64_read_bytes(uint32_t base_addr, uint8_t *buf, size_t len) {
     if (!buf || (len & 1)) return false;   // length must be even
     for (size_t i = 0; i < len; i += 2) {
-        adBus_set_address(base_addr + i);
+        adBus_latch(base_addr + i);
         uint16_t w = n64_read16();
         buf[i]   = (uint8_t)(w >> 8);
         buf[i+1] = (uint8_t)(w & 0xFF);
@@ -26,30 +44,92 @@ bool n64_read_bytes(uint32_t base_addr, uint8_t *buf, size_t len) {
     return true;
 }
 
-// Read larger chunks of data
-bool n64_read_bytes_fast(uint32_t base_addr, uint8_t *buf, size_t len) {
-    if (!buf || (len & 1)) return false;
+// Burst reader with an explicit maximum burst length (power of two)
+static void read_bursts(uint32_t base_addr, uint8_t *buf, size_t len, size_t max_burst) {
     while (len > 0) {
-        // how many bytes to do in this chunk?
-        size_t chunk = (len < N64_FAST_CHUNK_BYTES ? len : N64_FAST_CHUNK_BYTES);
-        size_t words = chunk / 2;
+        // up to the next multiple of max_burst, so no burst crosses one
+        size_t chunk = max_burst - ((base_addr - N64_ROM_BASE) & (max_burst - 1u));
+        if (chunk > len) chunk = len;
 
         // 1) latch the start address for this burst
-        adBus_set_address(base_addr);
-        adBus_dir(false);  // release bus to the cartridge
-
-        // 2) read 'words' sequential 16-bit values
-        for (size_t i = 0; i < words; ++i) {
-            uint16_t w = n64_read16();      // toggles /RD, waits, samples
-            buf[2*i]   = (uint8_t)(w >> 8);   // MSB
-            buf[2*i+1] = (uint8_t)(w & 0xFF); // LSB
-        }
+        adBus_latch(base_addr);
+
+        // 2) arm DMA + PIO for 'chunk/2' sequential 16-bit reads, then wait
+        BUS_PERF_BEGIN(t0);
+        ad_bus_pio_read_start(buf, chunk / 2);
+        ad_bus_pio_read_wait();
+        BUS_PERF_END(BUS_PERF_BURST, t0, chunk);
 
         // advance pointers
         base_addr += chunk;
         buf       += chunk;
         len       -= chunk;
     }
+}
+
+// Read larger chunks of data: latch once per burst, then let the PIO engine
+// clock /RD while DMA stores the words. The CPU is idle until the burst lands.
+bool n64_read_bytes_fast(uint32_t base_addr, uint8_t *buf, size_t len) {
+    if (!buf || (len & 1)) return false;
+    // DMA stores halfwords, so an odd destination falls back to the CPU path
+    if ((uintptr_t)buf & 1) return n64_read_bytes(base_addr, buf, len);
+
+    read_bursts(base_addr, buf, len, burst_bytes);
+    return true;
+}
+
+size_t n64_get_burst_bytes(void) { return burst_bytes; }
+
+void n64_set_burst_bytes(size_t bytes) {
+    size_t b = N64_BURST_MIN_BYTES;
+    while (b * 2u <= bytes && b < N64_BURST_MAX_BYTES) b *= 2u;
+    burst_bytes = b;
+}
+
+// Some carts stop auto-incrementing correctly at an internal page
+// boundary. The reference is read one latched word at a time, which no
+// boundary can break; then each test point is read with ever longer
+// aligned bursts, and the first length that disagrees anywhere ends the
+// search. Failures are monotonic: a longer burst spans every boundary a
+// shorter one does.
+size_t n64_probe_burst_bytes(void) {
+    static uint8_t ref[N64_BURST_PROBE_POINTS][N64_BURST_MAX_BYTES] __attribute__((aligned(4)));
+    uint32_t win[N64_BURST_PROBE_POINTS];
+
+    for (unsigned i = 0; i < N64_BURST_PROBE_POINTS; ++i) {
+        win[i] = N64_ROM_BASE + (burst_probe_offsets[i] & ~(N64_BURST_MAX_BYTES - 1u));
+        n64_read_bytes(win[i], ref[i], N64_BURST_MAX_BYTES);
+    }
+
+    size_t best = N64_BURST_MIN_BYTES;
+    for (size_t len = N64_BURST_MIN_BYTES; len <= N64_BURST_MAX_BYTES; len *= 2u) {
+        bool ok = true;
+        for (unsigned i = 0; i < N64_BURST_PROBE_POINTS && ok; ++i) {
+            // the 'len'-aligned piece of the window that holds the point
+            uint32_t off = (burst_probe_offsets[i] & (N64_BURST_MAX_BYTES - 1u)) & ~(uint32_t)(len - 1u);
+            read_bursts(win[i] + off, burst_test, len, len);
+            ok = memcmp(&ref[i][off], burst_test, len) == 0;
+        }
+        if (!ok) break;
+        best = len;
+    }
+    n64_set_burst_bytes(best);
+    return best;
+}
+
+// One 'len'-byte burst at each test point against single-word reads of
+// the same bytes, at whatever timing is applied. Settings remembered from
+// an earlier cart go through this before they are trusted.
+bool n64_check_burst_bytes(size_t len) {
+    static uint8_t ref[N64_BURST_MAX_BYTES] __attribute__((aligned(4)));
+    if (len < N64_BURST_MIN_BYTES || len > N64_BURST_MAX_BYTES || (len & (len - 1u))) return false;
+
+    for (unsigned i = 0; i < N64_BURST_PROBE_POINTS; ++i) {
+        uint32_t a = N64_ROM_BASE + (burst_probe_offsets[i] & ~(uint32_t)(len - 1u));
+        n64_read_bytes(a, ref, len);
+        read_bursts(a, burst_test, len, len);
+        if (memcmp(ref, burst_test, len) != 0) return false;
+    }
     return true;
 }
 
@@ -59,6 +139,23 @@ bool n64_get_header(uint8_t *buffer, size_t buffer_size) {
     return n64_read_bytes(N64_ROM_BASE, buffer, N64_HEADER_LENGTH);
 }
 
+// Header checksum word (CRC1), the cart database key
+bool n64_get_crc1(uint32_t *crc1) {
+    uint8_t b[4];
+    if (!crc1 || !n64_read_bytes(N64_ROM_BASE + N64_CRC1_OFFSET, b, sizeof(b))) return false;
+    *crc1 = (uint32_t)b[0] << 24 | (uint32_t)b[1] << 16 | (uint32_t)b[2] << 8 | b[3];
+    return true;
+}
+
+// Cheap slot check, a few word reads. The first header byte sets up the
+// PI and is 0x80 on every cart; an empty slot reads the pull-ups (0xFF)
+// or the address just driven (0x00). CRC1 tells one cart from the next.
+bool n64_cart_present(uint32_t *crc1) {
+    uint8_t pi[4];
+    if (!n64_read_bytes(N64_ROM_BASE, pi, sizeof(pi)) || pi[0] != N64_PI_CONFIG_BYTE) return false;
+    return !crc1 || n64_get_crc1(crc1);
+}
+
 // Read the 20-byte title field, sanitize, trim trailing spaces, and apply a "no cart" check
 bool n64_get_title(uint8_t *buffer, size_t buffer_size) {
     if (!buffer || buffer_size < (N64_TITLE_LENGTH + 1)) return false;
@@ -97,4 +194,108 @@ bool n64_get_title(uint8_t *buffer, size_t buffer_size) {
     }
 
     return true;
-}
\ No newline at end of file
+}
+
+/* ------------------------------------------------------------ */
+/*  ROM size detection                                          */
+/* ------------------------------------------------------------ */
+typedef struct {
+    uint8_t w[N64_PROBE_WINDOWS][N64_PROBE_BYTES];
+} rom_probe_t;
+
+static void probe_read(uint32_t off, rom_probe_t *p) {
+    for (unsigned i = 0; i < N64_PROBE_WINDOWS; ++i) {
+        n64_read_bytes(N64_ROM_BASE + off + probe_offsets[i], p->w[i], N64_PROBE_BYTES);
+    }
+}
+
+static bool window_uniform(const uint8_t *w) {
+    for (unsigned i = 1; i < N64_PROBE_BYTES; ++i) {
+        if (w[i] != w[0]) return false;
+    }
+    return true;
+}
+
+// Unmapped space reads back the low address half the reader just drove
+static bool probe_open_bus(uint32_t off, const rom_probe_t *p) {
+    for (unsigned i = 0; i < N64_PROBE_WINDOWS; ++i) {
+        uint32_t a = N64_ROM_BASE + off + probe_offsets[i];
+        for (unsigned j = 0; j < N64_PROBE_BYTES; j += 2) {
+            uint16_t w = (uint16_t)(p->w[i][j] << 8 | p->w[i][j + 1]);
+            if (w != (uint16_t)(a + j)) return false;
+        }
+    }
+    return true;
+}
+
+// 'p' repeats 'ref'. Uniform windows (0xFF padding, erased areas) prove
+// nothing, so at least one compared window must carry real data; without
+// that the step counts as ROM and the dump errs on the long side.
+static bool probe_mirrors(const rom_probe_t *p, const rom_probe_t *ref) {
+    bool evidence = false;
+    for (unsigned i = 0; i < N64_PROBE_WINDOWS; ++i) {
+        if (memcmp(p->w[i], ref->w[i], N64_PROBE_BYTES) != 0) return false;
+        if (!window_uniform(ref->w[i])) evidence = true;
+    }
+    return evidence;
+}
+
+// Carts decode fewer address lines than the 64 MiB window, so the data
+// repeats past the end (or reads back as open bus). First find the power
+// of two where the start of the ROM comes back, then binary-search the
+// upper half for boards built from two chips (12, 24, 40, 48 MiB), whose
+// smaller chip aliases onto its own start.
+uint32_t n64_detect_rom_size(void) {
+    rom_probe_t base, p;
+    probe_read(0, &base);
+
+    uint32_t hi = N64_ROM_MAX_BYTES;
+    for (uint32_t s = N64_SIZE_MIN_BYTES; s < N64_ROM_MAX_BYTES; s <<= 1) {
+        probe_read(s, &p);
+        if (probe_mirrors(&p, &base) || probe_open_bus(s, &p)) {
+            hi = s;
+            break;
+        }
+    }
+    if (hi <= N64_SIZE_MIN_BYTES) return hi;
+
+    // [lo, hi): lo is known to hold data, hi is known to be past the end.
+    // A smaller chip aliases onto its own start, which is either where the
+    // upper half begins or the last step found to hold data.
+    uint32_t    lo = hi / 2;
+    rom_probe_t upper, lo_probe;
+    probe_read(lo, &upper);
+    lo_probe = upper;
+    for (uint32_t step = hi / 4; step >= N64_SIZE_MIN_BYTES; step /= 2) {
+        uint32_t x = lo + step;
+        probe_read(x, &p);
+        if (probe_mirrors(&p, &base) || probe_mirrors(&p, &upper) ||
+            probe_mirrors(&p, &lo_probe) || probe_open_bus(x, &p)) {
+            hi = x;
+        } else {
+            lo = x;
+            lo_probe = p;
+        }
+    }
+    return hi;
+}
+
+// FlashRAM saves: identify first so a cart swap picks up the new part
+bool n64_flash_read(uint32_t offset, void *dst, size_t len) {
+    return flashram_identify(NULL) && flashram_read(offset, (uint8_t *)dst, len);
+}
+
+bool n64_flash_write(uint32_t offset, const void *src, size_t len) {
+    return flashram_identify(NULL) && flashram_write(offset, (const uint8_t *)src, len);
+}
+
+// EEPROM saves: byte address and length in whole 8-byte blocks
+bool n64_eeprom_read(uint16_t addr, uint8_t *dst, size_t len) {
+    if ((addr | len) & 7u) return false;
+    return ReadEepromBlocks(addr / 8u, (uint32_t)(len / 8u), dst);
+}
+
+bool n64_eeprom_write(uint16_t addr, const uint8_t *src, size_t len) {
+    if ((addr | len) & 7u) return false;
+    return WriteEepromBlocks(addr / 8u, (uint32_t)(len / 8u), src);
+}
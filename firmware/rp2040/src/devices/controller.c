@@ -1,7 +1,189 @@
-#include <stdio.h>
+/* controller.c – N64 controller and controller pak over joybus
+ *  ---------------------------------------------------------------
+ *  • Address CRC: XOR of a fixed 5-bit value per address bit 15..5
+ *    (addrCRC() on the ATmega reader), folded into a 256-entry table for
+ *    bits 15..8 and an 8-entry one for bits 7..5
+ *  • Data CRC: CRC-8, polynomial 0x85, over the 32-byte block. The
+ *    ATmega loop shifts in 8 extra zero bits; the table form gives the
+ *    same value.
+ *  • Pak reads keep CTRL_PAK_WINDOW blocks queued on the port
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "pico/stdlib.h"
+
+#include <bus/joybus_port.h>
 #include <devices/controller.h>
 
-void controller_menu(void)
-{
-    printf("controller_menu() stub\n");
+#define CTRL_PAK_WINDOW  4u       // pak reads in flight
+#define CTRL_RETRIES     3u
+
+static joybus_port_t port;
+
+// addr bits 15..8
+static const uint8_t addr_crc_hi[256] = {
+    0x00, 0x16, 0x19, 0x0F, 0x07, 0x11, 0x1E, 0x08, 0x0E, 0x18, 0x17, 0x01, 0x09, 0x1F, 0x10, 0x06,
+    0x1C, 0x0A, 0x05, 0x13, 0x1B, 0x0D, 0x02, 0x14, 0x12, 0x04, 0x0B, 0x1D, 0x15, 0x03, 0x0C, 0x1A,
+    0x0D, 0x1B, 0x14, 0x02, 0x0A, 0x1C, 0x13, 0x05, 0x03, 0x15, 0x1A, 0x0C, 0x04, 0x12, 0x1D, 0x0B,
+    0x11, 0x07, 0x08, 0x1E, 0x16, 0x00, 0x0F, 0x19, 0x1F, 0x09, 0x06, 0x10, 0x18, 0x0E, 0x01, 0x17,
+    0x1A, 0x0C, 0x03, 0x15, 0x1D, 0x0B, 0x04, 0x12, 0x14, 0x02, 0x0D, 0x1B, 0x13, 0x05, 0x0A, 0x1C,
+    0x06, 0x10, 0x1F, 0x09, 0x01, 0x17, 0x18, 0x0E, 0x08, 0x1E, 0x11, 0x07, 0x0F, 0x19, 0x16, 0x00,
+    0x17, 0x01, 0x0E, 0x18, 0x10, 0x06, 0x09, 0x1F, 0x19, 0x0F, 0x00, 0x16, 0x1E, 0x08, 0x07, 0x11,
+    0x0B, 0x1D, 0x12, 0x04, 0x0C, 0x1A, 0x15, 0x03, 0x05, 0x13, 0x1C, 0x0A, 0x02, 0x14, 0x1B, 0x0D,
+    0x01, 0x17, 0x18, 0x0E, 0x06, 0x10, 0x1F, 0x09, 0x0F, 0x19, 0x16, 0x00, 0x08, 0x1E, 0x11, 0x07,
+    0x1D, 0x0B, 0x04, 0x12, 0x1A, 0x0C, 0x03, 0x15, 0x13, 0x05, 0x0A, 0x1C, 0x14, 0x02, 0x0D, 0x1B,
+    0x0C, 0x1A, 0x15, 0x03, 0x0B, 0x1D, 0x12, 0x04, 0x02, 0x14, 0x1B, 0x0D, 0x05, 0x13, 0x1C, 0x0A,
+    0x10, 0x06, 0x09, 0x1F, 0x17, 0x01, 0x0E, 0x18, 0x1E, 0x08, 0x07, 0x11, 0x19, 0x0F, 0x00, 0x16,
+    0x1B, 0x0D, 0x02, 0x14, 0x1C, 0x0A, 0x05, 0x13, 0x15, 0x03, 0x0C, 0x1A, 0x12, 0x04, 0x0B, 0x1D,
+    0x07, 0x11, 0x1E, 0x08, 0x00, 0x16, 0x19, 0x0F, 0x09, 0x1F, 0x10, 0x06, 0x0E, 0x18, 0x17, 0x01,
+    0x16, 0x00, 0x0F, 0x19, 0x11, 0x07, 0x08, 0x1E, 0x18, 0x0E, 0x01, 0x17, 0x1F, 0x09, 0x06, 0x10,
+    0x0A, 0x1C, 0x13, 0x05, 0x0D, 0x1B, 0x14, 0x02, 0x04, 0x12, 0x1D, 0x0B, 0x03, 0x15, 0x1A, 0x0C,
+};
+
+// addr bits 7..5
+static const uint8_t addr_crc_lo[8] = {
+    0x00, 0x15, 0x1F, 0x0A, 0x0B, 0x1E, 0x14, 0x01,
+};
+
+static const uint8_t data_crc_table[256] = {
+    0x00, 0x85, 0x8F, 0x0A, 0x9B, 0x1E, 0x14, 0x91, 0xB3, 0x36, 0x3C, 0xB9, 0x28, 0xAD, 0xA7, 0x22,
+    0xE3, 0x66, 0x6C, 0xE9, 0x78, 0xFD, 0xF7, 0x72, 0x50, 0xD5, 0xDF, 0x5A, 0xCB, 0x4E, 0x44, 0xC1,
+    0x43, 0xC6, 0xCC, 0x49, 0xD8, 0x5D, 0x57, 0xD2, 0xF0, 0x75, 0x7F, 0xFA, 0x6B, 0xEE, 0xE4, 0x61,
+    0xA0, 0x25, 0x2F, 0xAA, 0x3B, 0xBE, 0xB4, 0x31, 0x13, 0x96, 0x9C, 0x19, 0x88, 0x0D, 0x07, 0x82,
+    0x86, 0x03, 0x09, 0x8C, 0x1D, 0x98, 0x92, 0x17, 0x35, 0xB0, 0xBA, 0x3F, 0xAE, 0x2B, 0x21, 0xA4,
+    0x65, 0xE0, 0xEA, 0x6F, 0xFE, 0x7B, 0x71, 0xF4, 0xD6, 0x53, 0x59, 0xDC, 0x4D, 0xC8, 0xC2, 0x47,
+    0xC5, 0x40, 0x4A, 0xCF, 0x5E, 0xDB, 0xD1, 0x54, 0x76, 0xF3, 0xF9, 0x7C, 0xED, 0x68, 0x62, 0xE7,
+    0x26, 0xA3, 0xA9, 0x2C, 0xBD, 0x38, 0x32, 0xB7, 0x95, 0x10, 0x1A, 0x9F, 0x0E, 0x8B, 0x81, 0x04,
+    0x89, 0x0C, 0x06, 0x83, 0x12, 0x97, 0x9D, 0x18, 0x3A, 0xBF, 0xB5, 0x30, 0xA1, 0x24, 0x2E, 0xAB,
+    0x6A, 0xEF, 0xE5, 0x60, 0xF1, 0x74, 0x7E, 0xFB, 0xD9, 0x5C, 0x56, 0xD3, 0x42, 0xC7, 0xCD, 0x48,
+    0xCA, 0x4F, 0x45, 0xC0, 0x51, 0xD4, 0xDE, 0x5B, 0x79, 0xFC, 0xF6, 0x73, 0xE2, 0x67, 0x6D, 0xE8,
+    0x29, 0xAC, 0xA6, 0x23, 0xB2, 0x37, 0x3D, 0xB8, 0x9A, 0x1F, 0x15, 0x90, 0x01, 0x84, 0x8E, 0x0B,
+    0x0F, 0x8A, 0x80, 0x05, 0x94, 0x11, 0x1B, 0x9E, 0xBC, 0x39, 0x33, 0xB6, 0x27, 0xA2, 0xA8, 0x2D,
+    0xEC, 0x69, 0x63, 0xE6, 0x77, 0xF2, 0xF8, 0x7D, 0x5F, 0xDA, 0xD0, 0x55, 0xC4, 0x41, 0x4B, 0xCE,
+    0x4C, 0xC9, 0xC3, 0x46, 0xD7, 0x52, 0x58, 0xDD, 0xFF, 0x7A, 0x70, 0xF5, 0x64, 0xE1, 0xEB, 0x6E,
+    0xAF, 0x2A, 0x20, 0xA5, 0x34, 0xB1, 0xBB, 0x3E, 0x1C, 0x99, 0x93, 0x16, 0x87, 0x02, 0x08, 0x8D,
+};
+
+uint16_t controller_addr_crc(uint16_t addr) {
+    addr &= (uint16_t)~0x1Fu;
+    return (uint16_t)(addr | (addr_crc_hi[addr >> 8] ^ addr_crc_lo[(addr >> 5) & 7u]));
+}
+
+uint8_t controller_data_crc(const uint8_t *block) {
+    uint8_t crc = 0;
+    for (uint i = 0; i < CTRL_PAK_BLOCK; ++i) crc = data_crc_table[crc ^ block[i]];
+    return crc;
+}
+
+void controller_init(void) {
+    joybus_port_init(&port, pio0, CTRL_SM, CTRL_DAT);
+}
+
+joybus_port_t *controller_port(void) { return &port; }
+
+bool controller_info(controller_info_t *out) {
+    const uint8_t cmd = CTRL_CMD_INFO;
+    uint8_t r[3];
+    if (!joybus_transact(&port, &cmd, 1, r, sizeof(r))) return false;
+    out->id     = (uint16_t)(r[0] << 8 | r[1]);
+    out->status = r[2];
+    return true;
+}
+
+void controller_poll_submit(joybus_xfer_t *x, joybus_done_t done, void *user) {
+    x->tx[0]  = CTRL_CMD_POLL;
+    x->tx_len = 1;
+    x->rx_len = 4;
+    x->done   = done;
+    x->user   = user;
+    joybus_submit(&port, x);
+}
+
+void controller_poll_decode(const joybus_xfer_t *x, controller_state_t *out) {
+    out->buttons = (uint16_t)(x->rx[0] << 8 | x->rx[1]);
+    out->x       = (int8_t)x->rx[2];
+    out->y       = (int8_t)x->rx[3];
+}
+
+bool controller_poll(controller_state_t *out) {
+    joybus_xfer_t x;
+    controller_poll_submit(&x, NULL, NULL);
+    if (!joybus_wait(&x)) return false;
+    controller_poll_decode(&x, out);
+    return true;
+}
+
+/* ------------------------------------------------------------ */
+/*  Controller pak                                               */
+/* ------------------------------------------------------------ */
+static void pak_read_submit(joybus_xfer_t *x, uint16_t addr) {
+    uint16_t a = controller_addr_crc(addr);
+    x->tx[0]  = CTRL_CMD_PAK_READ;
+    x->tx[1]  = (uint8_t)(a >> 8);
+    x->tx[2]  = (uint8_t)a;
+    x->tx_len = 3;
+    x->rx_len = CTRL_PAK_BLOCK + 1u;
+    x->done   = NULL;
+    x->user   = NULL;
+    joybus_submit(&port, x);
+}
+
+static bool pak_read_ok(const joybus_xfer_t *x) {
+    return x->status == JOYBUS_OK && controller_data_crc(x->rx) == x->rx[CTRL_PAK_BLOCK];
+}
+
+bool controller_pak_read(uint16_t addr, uint8_t *dst) {
+    return controller_pak_read_range(addr, CTRL_PAK_BLOCK, dst);
+}
+
+bool controller_pak_write(uint16_t addr, const uint8_t *src) {
+    uint16_t a = controller_addr_crc(addr);
+    uint8_t  cmd[3 + CTRL_PAK_BLOCK] = { CTRL_CMD_PAK_WRITE, (uint8_t)(a >> 8), (uint8_t)a };
+    memcpy(&cmd[3], src, CTRL_PAK_BLOCK);
+    uint8_t crc = controller_data_crc(src);
+
+    for (uint tries = 0; tries < CTRL_RETRIES; ++tries) {
+        uint8_t r;
+        if (joybus_transact(&port, cmd, sizeof(cmd), &r, 1) && r == crc) return true;
+    }
+    return false;
+}
+
+bool controller_pak_read_range(uint16_t addr, uint32_t len, uint8_t *dst) {
+    static joybus_xfer_t win[CTRL_PAK_WINDOW];
+    if (addr % CTRL_PAK_BLOCK || len % CTRL_PAK_BLOCK) return false;
+
+    uint32_t blocks = len / CTRL_PAK_BLOCK;
+    uint32_t queued = 0;
+    bool     ok     = true;
+
+    for (; queued < blocks && queued < CTRL_PAK_WINDOW; ++queued) {
+        pak_read_submit(&win[queued], (uint16_t)(addr + queued * CTRL_PAK_BLOCK));
+    }
+    for (uint32_t b = 0; b < blocks; ++b) {
+        joybus_xfer_t *x = &win[b % CTRL_PAK_WINDOW];
+        uint16_t       a = (uint16_t)(addr + b * CTRL_PAK_BLOCK);
+
+        joybus_wait(x);
+        for (uint tries = 0; ok && !pak_read_ok(x); ++tries) {
+            if (tries == CTRL_RETRIES) {
+                ok = false;
+                break;
+            }
+            pak_read_submit(x, a);          // goes behind the ones in flight
+            joybus_wait(x);
+        }
+        if (!ok) break;
+        memcpy(&dst[b * CTRL_PAK_BLOCK], x->rx, CTRL_PAK_BLOCK);
+
+        if (queued < blocks) {
+            pak_read_submit(x, (uint16_t)(addr + queued * CTRL_PAK_BLOCK));
+            queued++;
+        }
+    }
+
+    // The next call reuses the window; let whatever is still queued drain
+    for (uint i = 0; i < CTRL_PAK_WINDOW; ++i) joybus_wait(&win[i]);
+    return ok;
 }
@@ -0,0 +1,152 @@
+/* flashram.c – FlashRAM save engine on the AD bus
+ *  ---------------------------------------------------------------
+ *  • One latch per 128-byte page, then a PIO burst (reads) or 64
+ *    auto-incremented /WR cycles (page buffer loads)
+ *  • Erase and program end when the status register reads back the ID;
+ *    no fixed delays, only an upper bound per operation
+ *  • MX29L1100 parts take the data address at half the byte offset
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include "pico/stdlib.h"
+
+#include <bus/ad_bus.h>
+#include <bus/ad_bus_pio.h>
+#include <devices/flashram.h>
+
+static const struct {
+    uint8_t     code;           // last ID byte
+    const char *name;
+    uint8_t     addr_shift;
+} known[] = {
+    { 0x1E, "MX29L1100",      2 },
+    { 0x1D, "MX29L1101",      1 },
+    { 0xF1, "MN63F81MPN",     1 },
+    { 0x8E, "29L1100KC-15B0", 1 },   // MX29L1101 compatible
+    { 0x84, "29L1100KC-15B0", 1 },
+};
+
+static flashram_info_t chip;
+static bool            identified;
+static uint8_t         verify_buf[FLASHRAM_PAGE_BYTES] __attribute__((aligned(4)));
+
+static void send_cmd(uint32_t cmd) {
+    const uint16_t w[2] = { (uint16_t)(cmd >> 16), (uint16_t)cmd };
+    adBus_write_words(FLASHRAM_CMD_REG, w, 2);
+}
+
+static void read_status(uint8_t id[8]) {
+    uint16_t w[4];
+    send_cmd(FLASHRAM_CMD_STATUS);
+    adBus_read_words(N64_SRAM_BASE, w, 4);
+    for (unsigned i = 0; i < 4; ++i) {
+        id[2 * i]     = (uint8_t)(w[i] >> 8);
+        id[2 * i + 1] = (uint8_t)w[i];
+    }
+}
+
+// Busy until the part shows its ID again
+static bool wait_ready(uint32_t timeout_us) {
+    uint8_t  st[8];
+    uint32_t t0 = time_us_32();
+    do {
+        read_status(st);
+        if (memcmp(st, chip.id, sizeof(st)) == 0) return true;
+    } while (time_us_32() - t0 < timeout_us);
+    return false;
+}
+
+static bool execute(uint32_t timeout_us) {
+    send_cmd(FLASHRAM_CMD_EXECUTE);
+    return wait_ready(timeout_us);
+}
+
+bool flashram_identify(flashram_info_t *out) {
+    identified = false;
+    read_status(chip.id);
+
+    static const uint8_t prefix[4] = { 0x11, 0x11, 0x80, 0x01 };
+    if (memcmp(chip.id, prefix, sizeof(prefix)) != 0) return false;
+    for (size_t i = 0; i < sizeof(known) / sizeof(known[0]); ++i) {
+        if (known[i].code == chip.id[7]) {
+            chip.name       = known[i].name;
+            chip.addr_shift = known[i].addr_shift;
+            identified      = true;
+            if (out) *out = chip;
+            return true;
+        }
+    }
+    return false;
+}
+
+static inline bool page_aligned(uint32_t v) {
+    return (v % FLASHRAM_PAGE_BYTES) == 0;
+}
+
+bool flashram_read(uint32_t offset, uint8_t *dst, size_t len) {
+    if (!identified || !page_aligned(offset) || !page_aligned(len) ||
+        offset + len > FLASHRAM_BYTES || ((uintptr_t)dst & 1u)) return false;
+
+    send_cmd(FLASHRAM_CMD_READ);
+    for (size_t done = 0; done < len; done += FLASHRAM_PAGE_BYTES) {
+        adBus_latch(N64_SRAM_BASE + (offset + done) / chip.addr_shift);
+        ad_bus_pio_read_start(&dst[done], FLASHRAM_PAGE_BYTES / 2u);
+        ad_bus_pio_read_wait();
+    }
+    return true;
+}
+
+bool flashram_program_page(uint32_t page, const uint8_t *src) {
+    if (!identified || page >= FLASHRAM_PAGES) return false;
+
+    uint16_t w[FLASHRAM_PAGE_BYTES / 2u];
+    for (size_t i = 0; i < FLASHRAM_PAGE_BYTES / 2u; ++i) {
+        w[i] = (uint16_t)(src[2 * i] << 8 | src[2 * i + 1]);
+    }
+    send_cmd(FLASHRAM_CMD_PAGE_LOAD);
+    adBus_write_words(N64_SRAM_BASE, w, FLASHRAM_PAGE_BYTES / 2u);
+    send_cmd(FLASHRAM_CMD_PROGRAM | page);
+    return execute(FLASHRAM_PROGRAM_TIMEOUT_US);
+}
+
+bool flashram_erase_sector(uint32_t sector) {
+    const uint32_t pages = FLASHRAM_SECTOR_BYTES / FLASHRAM_PAGE_BYTES;
+    if (!identified || sector >= FLASHRAM_BYTES / FLASHRAM_SECTOR_BYTES) return false;
+
+    send_cmd(FLASHRAM_CMD_SECTOR | (sector * pages + pages - 1u));
+    send_cmd(FLASHRAM_CMD_ERASE);
+    return execute(FLASHRAM_ERASE_TIMEOUT_US);
+}
+
+bool flashram_erase_chip(void) {
+    if (!identified) return false;
+    send_cmd(FLASHRAM_CMD_CHIP_ERASE);
+    return execute(FLASHRAM_ERASE_TIMEOUT_US);
+}
+
+bool flashram_write(uint32_t offset, const uint8_t *src, size_t len) {
+    if (!identified || (offset % FLASHRAM_SECTOR_BYTES) || (len % FLASHRAM_SECTOR_BYTES) ||
+        offset + len > FLASHRAM_BYTES) return false;
+
+    // Flush whatever the part was left doing, as the ATmega reader does
+    // before every write, then erase: one chip erase beats eight sectors
+    send_cmd(FLASHRAM_CMD_EXECUTE);
+    bool ok = execute(FLASHRAM_ERASE_TIMEOUT_US);
+    if (ok && len == FLASHRAM_BYTES) {
+        ok = flashram_erase_chip();
+    } else {
+        for (uint32_t s = offset; ok && s < offset + len; s += FLASHRAM_SECTOR_BYTES) {
+            ok = flashram_erase_sector(s / FLASHRAM_SECTOR_BYTES);
+        }
+    }
+
+    for (uint32_t p = 0; ok && p < len; p += FLASHRAM_PAGE_BYTES) {
+        ok = flashram_program_page((offset + p) / FLASHRAM_PAGE_BYTES, &src[p]) &&
+             flashram_read(offset + p, verify_buf, FLASHRAM_PAGE_BYTES) &&
+             memcmp(verify_buf, &src[p], FLASHRAM_PAGE_BYTES) == 0;
+    }
+    send_cmd(FLASHRAM_CMD_READ);
+    return ok;
+}
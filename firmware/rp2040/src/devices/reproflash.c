@@ -0,0 +1,320 @@
+/* reproflash.c – NOR flash on repro carts, over the AD bus
+ *  ---------------------------------------------------------------
+ *  • IDs are read like the ATmega reader: autoselect at the ROM base,
+ *    then again one chip size further in for a second chip. Parts made
+ *    of two x8 chips only answer doubled commands (0xAAAA ...).
+ *  • A write buffer is loaded with one latch and auto-incremented /WR
+ *    cycles. AMD parts are polled on DQ7 of the last word, Intel parts
+ *    on status register bit 7.
+ *  • Erase takes hundreds of ms, so its status is polled at a coarser
+ *    interval than a buffer program
+ *  • Buffers of 0xFF are skipped; ROM images are often padded with them
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include "pico/stdlib.h"
+
+#include <bus/ad_bus.h>
+#include <devices/reproflash.h>
+
+#define MB                  (1024u * 1024u)
+#define AMD_UNLOCK1         (0x555u << 1)
+#define AMD_UNLOCK2         (0x2AAu << 1)
+#define ID_CART_OFFSET      0x1Cu          // words 0x0E/0x0F
+#define ERASE_POLL_US       50u
+#define INTEL_PARTITION     0x20000u
+#define INTEL_SR_READY      0x0080u
+#define INTEL_SR_ERRORS     0x003Au        // erase, program, VPP, block locked
+
+static const repro_chip_t known[] = {
+    // name                 flash   cart    cmdset            MB  chips buf  sector    boot             n  boot bytes
+    { "Spansion S29GL256N", 0x227E, 0x2201, REPRO_CMD_AMD,    32, 2,  32,  0x20000u, REPRO_BOOT_NONE,   0, 0 },
+    { "Spansion S29GL128N", 0x227E, 0x2101, REPRO_CMD_AMD,    16, 1,  32,  0x20000u, REPRO_BOOT_NONE,   0, 0 },
+    { "ST M29W128GL",       0x227E, 0x2100, REPRO_CMD_AMD,    16, 1,  64,  0x20000u, REPRO_BOOT_NONE,   0, 0 },
+    { "Fujitsu MSP55LV512", 0x227E, 0x2301, REPRO_CMD_AMD,    64, 1,  32,  0x20000u, REPRO_BOOT_NONE,   0, 0 },
+    { "Intel 512M29EW",     0x227E, 0x3901, REPRO_CMD_AMD,    64, 1,  128, 0x20000u, REPRO_BOOT_NONE,   0, 0 },
+    { "Macronix MX29LV640", 0x22C9, 0,      REPRO_CMD_AMD,    8,  2,  0,   0x10000u, REPRO_BOOT_TOP,    8, 0x2000u },
+    { "Macronix MX29LV640", 0x22CB, 0,      REPRO_CMD_AMD,    8,  2,  0,   0x10000u, REPRO_BOOT_BOTTOM, 8, 0x2000u },
+    { "Intel 4400L0ZDQ0",   0x8816, 0,      REPRO_CMD_INTEL,  32, 2,  64,  0x20000u, REPRO_BOOT_BOTTOM, 4, 0x8000u },
+    { "Intel 4400L0ZDQ0",   0x8813, 0,      REPRO_CMD_INTEL,  32, 1,  64,  0x20000u, REPRO_BOOT_TOP,    4, 0x8000u },
+    { "Fujitsu MSP55LV100S",0x7E7E, 0,      REPRO_CMD_AMD_X2, 64, 1,  32,  0x20000u, REPRO_BOOT_NONE,   0, 0 },
+};
+
+static repro_info_t info;
+static bool         identified;
+
+/* ------------------------------------------------------------ */
+/*  Bus helpers                                                  */
+/* ------------------------------------------------------------ */
+static uint16_t read_word(uint32_t off) {
+    uint16_t w;
+    adBus_read_words(N64_ROM_BASE + off, &w, 1);
+    return w;
+}
+
+static void write_word(uint32_t off, uint16_t v) {
+    adBus_write_words(N64_ROM_BASE + off, &v, 1);
+}
+
+// Command multiplier: doubled parts take every byte on both halves
+static inline uint16_t dbl(const repro_chip_t *c) {
+    return c->cmdset == REPRO_CMD_AMD_X2 ? 0x0101u : 0x0001u;
+}
+
+static void amd_cmd(uint32_t base, uint16_t k, uint16_t cmd) {
+    write_word(base + AMD_UNLOCK1, (uint16_t)(0xAAu * k));
+    write_word(base + AMD_UNLOCK2, (uint16_t)(0x55u * k));
+    write_word(base + AMD_UNLOCK1, (uint16_t)(cmd * k));
+}
+
+static void read_ids(uint32_t base, uint16_t k, uint16_t *vendor, uint16_t *flash, uint16_t *cart) {
+    uint16_t w[2];
+    amd_cmd(base, k, 0x90u);
+    adBus_read_words(N64_ROM_BASE + base, w, 2);
+    *vendor = w[0];
+    *flash  = w[1];
+    adBus_read_words(N64_ROM_BASE + base + ID_CART_OFFSET, w, 2);
+    *cart = (uint16_t)((w[0] & 0xFFu) << 8 | (w[1] & 0xFFu));
+}
+
+static void reset_chip(const repro_chip_t *c, uint32_t base) {
+    if (c->cmdset == REPRO_CMD_INTEL) {
+        uint32_t end = base + (uint32_t)c->chip_mb * MB;
+        for (uint32_t p = base; p < end; p += INTEL_PARTITION) write_word(p, 0xFFu);
+    } else {
+        write_word(base, (uint16_t)(0xF0u * dbl(c)));
+    }
+}
+
+// AMD: done once DQ7 of 'off' shows the data written there
+static bool wait_data(uint32_t off, uint16_t expect, uint16_t dq7,
+                      uint32_t timeout_us, uint32_t gap_us) {
+    uint32_t t0 = time_us_32();
+    do {
+        if (((read_word(off) ^ expect) & dq7) == 0) return true;
+        if (gap_us) sleep_us(gap_us);
+    } while (time_us_32() - t0 < timeout_us);
+    return false;
+}
+
+// Intel: status register ready, then no error bits
+static bool wait_status(uint32_t off, uint32_t timeout_us, uint32_t gap_us) {
+    uint32_t t0 = time_us_32();
+    do {
+        uint16_t sr = read_word(off);
+        if (sr & INTEL_SR_READY) return (sr & INTEL_SR_ERRORS) == 0;
+        if (gap_us) sleep_us(gap_us);
+    } while (time_us_32() - t0 < timeout_us);
+    return false;
+}
+
+/* ------------------------------------------------------------ */
+/*  Identification and geometry                                  */
+/* ------------------------------------------------------------ */
+static const repro_chip_t *lookup(uint16_t flash, uint16_t cart, bool doubled) {
+    for (size_t i = 0; i < sizeof(known) / sizeof(known[0]); ++i) {
+        const repro_chip_t *c = &known[i];
+        if ((c->cmdset == REPRO_CMD_AMD_X2) != doubled || c->flash_id != flash) continue;
+        if (c->cart_id && c->cart_id != cart) continue;
+        return c;
+    }
+    return NULL;
+}
+
+bool repro_identify(repro_info_t *out) {
+    identified = false;
+    memset(&info, 0, sizeof(info));
+
+    read_ids(0, 0x0001u, &info.vendor, &info.flash_id, &info.cart_id);
+    const repro_chip_t *c = lookup(info.flash_id, info.cart_id, false);
+    if (!c) {
+        write_word(0, 0xF0u);
+        uint16_t vendor, flash, cart;
+        read_ids(0, 0x0101u, &vendor, &flash, &cart);
+        c = lookup(flash, cart, true);
+        if (c) {
+            info.vendor   = vendor;
+            info.flash_id = flash;
+        }
+    }
+    if (!c) {
+        write_word(0, 0xF0u);
+        if (out) *out = info;
+        return false;
+    }
+    reset_chip(c, 0);
+
+    info.chip[0] = c;
+    info.chips   = 1;
+    uint32_t chip_bytes = (uint32_t)c->chip_mb * MB;
+    if (c->max_chips > 1) {
+        uint16_t vendor, flash, cart;
+        read_ids(chip_bytes, dbl(c), &vendor, &flash, &cart);
+        const repro_chip_t *c2 = lookup(flash, cart, c->cmdset == REPRO_CMD_AMD_X2);
+        if (c2 && c2->cmdset == c->cmdset && c2->chip_mb == c->chip_mb) {
+            info.chip[1] = c2;
+            info.chips   = 2;
+        }
+        reset_chip(c2 ? c2 : c, chip_bytes);
+    }
+    info.bytes = info.chips * chip_bytes;
+    identified = true;
+    if (out) *out = info;
+    return true;
+}
+
+// Chip holding 'offset' and where it starts
+static const repro_chip_t *chip_at(uint32_t offset, uint32_t *base) {
+    if (!identified || offset >= info.bytes) return NULL;
+    uint32_t chip_bytes = (uint32_t)info.chip[0]->chip_mb * MB;
+    uint32_t i = offset / chip_bytes;
+    *base = i * chip_bytes;
+    return info.chip[i];
+}
+
+bool repro_sector(uint32_t offset, uint32_t *start, uint32_t *size) {
+    uint32_t base;
+    const repro_chip_t *c = chip_at(offset, &base);
+    if (!c) return false;
+
+    uint32_t rel        = offset - base;
+    uint32_t chip_bytes = (uint32_t)c->chip_mb * MB;
+    uint32_t boot_span  = (uint32_t)c->boot_count * c->boot_bytes;
+    bool     in_boot    = (c->boot == REPRO_BOOT_BOTTOM && rel < boot_span) ||
+                          (c->boot == REPRO_BOOT_TOP && rel >= chip_bytes - boot_span);
+    uint32_t sz = in_boot ? c->boot_bytes : c->sector_bytes;
+    *start = base + rel / sz * sz;
+    *size  = sz;
+    return true;
+}
+
+/* ------------------------------------------------------------ */
+/*  Erase and program                                            */
+/* ------------------------------------------------------------ */
+bool repro_erase_sector(uint32_t offset) {
+    uint32_t base, start, size;
+    const repro_chip_t *c = chip_at(offset, &base);
+    if (!c || !repro_sector(offset, &start, &size)) return false;
+
+    if (c->cmdset == REPRO_CMD_INTEL) {
+        write_word(start, 0x60u);              // unlock the block
+        write_word(start, 0xD0u);
+        write_word(start, 0x20u);
+        write_word(start, 0xD0u);
+        bool ok = wait_status(start, REPRO_ERASE_TIMEOUT_US, ERASE_POLL_US);
+        write_word(start, 0xFFu);
+        return ok;
+    }
+
+    uint16_t k = dbl(c);
+    amd_cmd(base, k, 0x80u);
+    write_word(base + AMD_UNLOCK1, (uint16_t)(0xAAu * k));
+    write_word(base + AMD_UNLOCK2, (uint16_t)(0x55u * k));
+    write_word(start, (uint16_t)(0x30u * k));
+    bool ok = wait_data(start, 0xFFFFu, (uint16_t)(0x80u * k), REPRO_ERASE_TIMEOUT_US, ERASE_POLL_US);
+    if (!ok) reset_chip(c, base);
+    return ok;
+}
+
+// n bytes inside one write buffer
+static bool blank(const uint8_t *src, uint32_t n) {
+    for (uint32_t i = 0; i < n; ++i) {
+        if (src[i] != 0xFFu) return false;
+    }
+    return true;
+}
+
+static bool program_buffer(const repro_chip_t *c, uint32_t base, uint32_t off,
+                           const uint8_t *src, uint32_t n) {
+    uint16_t w[REPRO_MAX_BUFFER_BYTES / 2u];
+    uint32_t words = n / 2u;
+    for (uint32_t i = 0; i < words; ++i) w[i] = (uint16_t)(src[2 * i] << 8 | src[2 * i + 1]);
+    uint32_t last = off + n - 2u;
+
+    if (c->cmdset == REPRO_CMD_INTEL) {
+        write_word(off, 0xE8u);
+        if (!wait_status(off, REPRO_PROGRAM_TIMEOUT_US, 0)) return false;
+        write_word(off, (uint16_t)(words - 1u));
+        adBus_write_words(N64_ROM_BASE + off, w, words);
+        write_word(last, 0xD0u);
+        bool ok = wait_status(last, REPRO_PROGRAM_TIMEOUT_US, 0);
+        write_word(last, 0xFFu);
+        return ok;
+    }
+
+    uint16_t k = dbl(c);
+    write_word(base + AMD_UNLOCK1, (uint16_t)(0xAAu * k));
+    write_word(base + AMD_UNLOCK2, (uint16_t)(0x55u * k));
+    write_word(off, (uint16_t)(0x25u * k));
+    write_word(off, (uint16_t)((words - 1u) * k));
+    adBus_write_words(N64_ROM_BASE + off, w, words);
+    write_word(last, (uint16_t)(0x29u * k));
+    bool ok = wait_data(last, w[words - 1u], (uint16_t)(0x80u * k), REPRO_PROGRAM_TIMEOUT_US, 0);
+    if (!ok) reset_chip(c, base);
+    return ok;
+}
+
+static bool program_word(const repro_chip_t *c, uint32_t base, uint32_t off, uint16_t v) {
+    if (c->cmdset == REPRO_CMD_INTEL) {
+        write_word(off, 0x40u);
+        write_word(off, v);
+        bool ok = wait_status(off, REPRO_PROGRAM_TIMEOUT_US, 0);
+        write_word(off, 0xFFu);
+        return ok;
+    }
+    uint16_t k = dbl(c);
+    amd_cmd(base, k, 0xA0u);
+    write_word(off, v);
+    bool ok = wait_data(off, v, (uint16_t)(0x80u * k), REPRO_PROGRAM_TIMEOUT_US, 0);
+    if (!ok) reset_chip(c, base);
+    return ok;
+}
+
+bool repro_program(uint32_t offset, const uint8_t *src, size_t len) {
+    if ((offset | len) & 1u) return false;
+    while (len) {
+        uint32_t base;
+        const repro_chip_t *c = chip_at(offset, &base);
+        if (!c) return false;
+
+        uint32_t buf = c->buffer_bytes;
+        uint32_t n   = 2u;
+        bool     ok  = true;
+        if (buf) {
+            n = buf - offset % buf;            // up to the end of this buffer page
+            if (n > len) n = (uint32_t)len;
+        }
+        if (blank(src, n)) {
+            // padding: the erased array already reads 0xFF
+        } else if (buf) {
+            ok = program_buffer(c, base, offset, src, n);
+        } else {
+            ok = program_word(c, base, offset, (uint16_t)(src[0] << 8 | src[1]));
+        }
+        if (!ok) return false;
+        offset += n;
+        src    += n;
+        len    -= n;
+    }
+    return true;
+}
+
+bool repro_write(uint32_t offset, const uint8_t *src, size_t len, bool erase) {
+    uint32_t end = offset + (uint32_t)len;
+    for (uint32_t p = offset; p < end;) {
+        uint32_t start, size;
+        if (!repro_sector(p, &start, &size)) return false;
+        if (erase && start == p && !repro_erase_sector(start)) return false;
+        uint32_t n = (start + size < end ? start + size : end) - p;
+        if (!repro_program(p, &src[p - offset], n)) return false;
+        p += n;
+    }
+    return true;
+}
+
+void repro_reset(void) {
+    uint32_t chip_bytes = identified ? (uint32_t)info.chip[0]->chip_mb * MB : 0;
+    for (uint32_t i = 0; i < info.chips; ++i) reset_chip(info.chip[i], i * chip_bytes);
+}
@@ -0,0 +1,558 @@
+/* fat32.c – FAT32 root directory files, allocated contiguously up front
+ *  ---------------------------------------------------------------
+ *  • One 512-byte buffer for directory blocks and one batch buffer for
+ *    the FAT; the batch doubles as a cache for chain walks
+ *  • A file's directory entries are kept inside one cluster, so they
+ *    are contiguous blocks; when the root has no such gap it grows by
+ *    a zeroed cluster
+ *  • Long names are stored as ASCII; anything else becomes '_'
+ *  • New files say 0 bytes; fat32_set_size() rewrites just the 8.3
+ *    entry once the writer knows how much landed
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <ctype.h>
+
+#include <storage/fat32.h>
+#include <storage/sdcard.h>
+
+#define FAT_BATCH_BLOCKS   8u
+#define ENTRIES_PER_BLOCK  (SD_BLOCK_BYTES / FAT32_DIR_ENTRY_BYTES)
+#define FAT_ENTRY_MASK     0x0FFFFFFFu
+#define FAT_EOC            0x0FFFFFFFu
+#define MAX_TAIL           31u           // ~1 .. ~31 per 8.3 basis
+
+#define FSI_LEAD_SIG       0x41615252u
+#define FSI_STRUC_SIG      0x61417272u
+
+static uint8_t  blk[SD_BLOCK_BYTES] __attribute__((aligned(4)));
+static uint8_t  fatbuf[FAT_BATCH_BLOCKS * SD_BLOCK_BYTES] __attribute__((aligned(4)));
+static uint32_t fatbuf_first = UINT32_MAX;   // FAT block index held in fatbuf
+static uint32_t fatbuf_n;
+static uint8_t  ents[FAT32_MAX_ENTRIES * FAT32_DIR_ENTRY_BYTES];
+
+static inline uint16_t rd16(const uint8_t *p) { return (uint16_t)(p[0] | p[1] << 8); }
+static inline uint32_t rd32(const uint8_t *p) {
+    return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+static inline void wr16(uint8_t *p, uint16_t v) { p[0] = (uint8_t)v; p[1] = (uint8_t)(v >> 8); }
+static inline void wr32(uint8_t *p, uint32_t v) {
+    p[0] = (uint8_t)v; p[1] = (uint8_t)(v >> 8); p[2] = (uint8_t)(v >> 16); p[3] = (uint8_t)(v >> 24);
+}
+
+static inline uint32_t cluster_lba(const fat32_vol_t *v, uint32_t c) {
+    return v->data_lba + (c - 2u) * v->spc;
+}
+
+/* ------------------------------------------------------------ */
+/*  Mount                                                        */
+/* ------------------------------------------------------------ */
+static bool is_fat32_vbr(const uint8_t *b) {
+    return (b[0] == 0xEBu || b[0] == 0xE9u) && rd16(&b[510]) == 0xAA55u &&
+           rd16(&b[11]) == SD_BLOCK_BYTES && b[13] != 0 && b[16] != 0 &&
+           rd16(&b[17]) == 0 && rd16(&b[22]) == 0 && rd32(&b[36]) != 0;
+}
+
+bool fat32_mount(fat32_vol_t *v, const char **err) {
+    fatbuf_first = UINT32_MAX;
+    if (!sd_read_blocks(0, blk, 1)) {
+        *err = "card read failed";
+        return false;
+    }
+
+    uint32_t lba = 0;
+    if (!is_fat32_vbr(blk)) {
+        if (rd16(&blk[510]) != 0xAA55u) {
+            *err = "no partition table";
+            return false;
+        }
+        for (unsigned i = 0; i < 4 && lba == 0; ++i) {
+            const uint8_t *pe = &blk[446 + 16 * i];
+            if (pe[4] == 0x0Bu || pe[4] == 0x0Cu) lba = rd32(&pe[8]);
+        }
+        if (lba == 0 || !sd_read_blocks(lba, blk, 1) || !is_fat32_vbr(blk)) {
+            *err = "no FAT32 partition";
+            return false;
+        }
+    }
+
+    uint32_t rsvd  = rd16(&blk[14]);
+    uint32_t total = rd16(&blk[19]) ? rd16(&blk[19]) : rd32(&blk[32]);
+    v->part_lba     = lba;
+    v->spc          = blk[13];
+    v->fats         = blk[16];
+    v->fat_blocks   = rd32(&blk[36]);
+    v->fat_lba      = lba + rsvd;
+    v->data_lba     = v->fat_lba + v->fats * v->fat_blocks;
+    v->clusters     = (total - rsvd - v->fats * v->fat_blocks) / v->spc;
+    v->root_cluster = rd32(&blk[44]);
+    v->fsinfo_lba   = rd16(&blk[48]) ? lba + rd16(&blk[48]) : 0;
+    v->free_hint    = 2;
+    if (v->clusters < 65525u) {
+        *err = "not FAT32";
+        return false;
+    }
+
+    if (v->fsinfo_lba && sd_read_blocks(v->fsinfo_lba, blk, 1) &&
+        rd32(&blk[0]) == FSI_LEAD_SIG && rd32(&blk[484]) == FSI_STRUC_SIG) {
+        uint32_t hint = rd32(&blk[492]);
+        if (hint >= 2 && hint < v->clusters + 2u) v->free_hint = hint;
+    }
+    return true;
+}
+
+/* ------------------------------------------------------------ */
+/*  FAT                                                          */
+/* ------------------------------------------------------------ */
+static bool fat_load(const fat32_vol_t *v, uint32_t block) {
+    uint32_t first = block / FAT_BATCH_BLOCKS * FAT_BATCH_BLOCKS;
+    if (first == fatbuf_first) return true;
+    uint32_t n = v->fat_blocks - first;
+    if (n > FAT_BATCH_BLOCKS) n = FAT_BATCH_BLOCKS;
+    fatbuf_first = UINT32_MAX;
+    if (!sd_read_blocks(v->fat_lba + first, fatbuf, n)) return false;
+    fatbuf_first = first;
+    fatbuf_n     = n;
+    return true;
+}
+
+static bool fat_get(const fat32_vol_t *v, uint32_t c, uint32_t *val) {
+    if (!fat_load(v, c / (SD_BLOCK_BYTES / 4u))) return false;
+    *val = rd32(&fatbuf[(c - fatbuf_first * (SD_BLOCK_BYTES / 4u)) * 4u]) & FAT_ENTRY_MASK;
+    return true;
+}
+
+// Write the batch back to every FAT copy
+static bool fat_flush(const fat32_vol_t *v) {
+    for (unsigned i = 0; i < v->fats; ++i) {
+        if (!sd_write_blocks(v->fat_lba + i * v->fat_blocks + fatbuf_first, fatbuf, fatbuf_n))
+            return false;
+    }
+    return true;
+}
+
+// Chain [first, first + n) in order and terminate it
+static bool fat_chain(const fat32_vol_t *v, uint32_t first, uint32_t n) {
+    const uint32_t per_block = SD_BLOCK_BYTES / 4u;
+    for (uint32_t c = first; c < first + n; ) {
+        if (!fat_load(v, c / per_block)) return false;
+        uint32_t batch_end = (fatbuf_first + fatbuf_n) * per_block;
+        for (; c < first + n && c < batch_end; ++c) {
+            uint8_t *e = &fatbuf[(c - fatbuf_first * per_block) * 4u];
+            uint32_t next = (c + 1u == first + n) ? FAT_EOC : c + 1u;
+            wr32(e, (rd32(e) & ~FAT_ENTRY_MASK) | next);
+        }
+        if (!fat_flush(v)) return false;
+    }
+    return true;
+}
+
+static bool fat_set(const fat32_vol_t *v, uint32_t c, uint32_t val) {
+    if (!fat_load(v, c / (SD_BLOCK_BYTES / 4u))) return false;
+    uint8_t *e = &fatbuf[(c - fatbuf_first * (SD_BLOCK_BYTES / 4u)) * 4u];
+    wr32(e, (rd32(e) & ~FAT_ENTRY_MASK) | val);
+    return fat_flush(v);
+}
+
+// First fit for n free clusters in a row: from the hint to the end, then
+// from the start
+static bool fat_find_run(const fat32_vol_t *v, uint32_t n, uint32_t *first) {
+    uint32_t end   = v->clusters + 2u;
+    uint32_t start = v->free_hint;
+    for (unsigned pass = 0; pass < 2; ++pass) {
+        uint32_t run = 0;
+        for (uint32_t c = pass ? 2u : start; c < end; ++c) {
+            uint32_t e;
+            if (!fat_get(v, c, &e)) return false;
+            if (e != 0) {
+                run = 0;
+                continue;
+            }
+            if (run++ == 0) *first = c;
+            if (run == n) return true;
+        }
+        if (start == 2u) break;
+    }
+    return false;
+}
+
+static void fsinfo_update(fat32_vol_t *v, uint32_t used) {
+    v->free_hint = v->free_hint < v->clusters + 2u ? v->free_hint : 2u;
+    if (!v->fsinfo_lba || !sd_read_blocks(v->fsinfo_lba, blk, 1) ||
+        rd32(&blk[0]) != FSI_LEAD_SIG || rd32(&blk[484]) != FSI_STRUC_SIG) return;
+    uint32_t free_count = rd32(&blk[488]);
+    if (free_count != 0xFFFFFFFFu) wr32(&blk[488], free_count >= used ? free_count - used : 0);
+    wr32(&blk[492], v->free_hint);
+    sd_write_blocks(v->fsinfo_lba, blk, 1);   // only a hint; a stale one is harmless
+}
+
+static bool alloc_run(fat32_vol_t *v, uint32_t n, uint32_t *first, const char **err) {
+    if (!fat_find_run(v, n, first)) {
+        *err = (fatbuf_first == UINT32_MAX) ? "card read failed" : "no contiguous free space";
+        return false;
+    }
+    if (!fat_chain(v, *first, n)) {
+        *err = "FAT write failed";
+        return false;
+    }
+    v->free_hint = *first + n;
+    fsinfo_update(v, n);
+    return true;
+}
+
+/* ------------------------------------------------------------ */
+/*  Names                                                        */
+/* ------------------------------------------------------------ */
+static bool sfn_char_ok(char c) {
+    return isupper((unsigned char)c) || isdigit((unsigned char)c) ||
+           (c && strchr("$%'-_@~`!(){}^#&", c) != NULL);
+}
+
+bool fat32_short_name(const char *name, unsigned tail, uint8_t sfn[11]) {
+    const char *dot = strrchr(name, '.');
+    if (dot == name) dot = NULL;                   // ".profile": no extension
+    bool lossy = tail > 0;
+    memset(sfn, ' ', 11);
+
+    unsigned n = 0;
+    for (const char *p = name; *p && p != dot; ++p) {
+        char c = *p;
+        if (c == ' ' || c == '.') { lossy = true; continue; }
+        if (islower((unsigned char)c)) { lossy = true; c = (char)toupper((unsigned char)c); }
+        if (!sfn_char_ok(c)) { lossy = true; c = '_'; }
+        if (n == 8) { lossy = true; break; }
+        sfn[n++] = (uint8_t)c;
+    }
+    if (n == 0) { lossy = true; sfn[n++] = '_'; }
+
+    if (dot) {
+        unsigned e = 0;
+        for (const char *p = dot + 1; *p; ++p) {
+            char c = *p;
+            if (c == ' ') { lossy = true; continue; }
+            if (islower((unsigned char)c)) { lossy = true; c = (char)toupper((unsigned char)c); }
+            if (!sfn_char_ok(c)) { lossy = true; c = '_'; }
+            if (e == 3) { lossy = true; break; }
+            sfn[8 + e++] = (uint8_t)c;
+        }
+    }
+
+    if (tail) {
+        char t[8];
+        unsigned len = 0;
+        for (unsigned x = tail; x; x /= 10) t[len++] = (char)('0' + x % 10);
+        unsigned at = (n + len + 1u > 8u) ? 8u - len - 1u : n;
+        sfn[at++] = '~';
+        while (len) sfn[at++] = (uint8_t)t[--len];
+        while (at < 8) sfn[at++] = ' ';
+    }
+    return lossy;
+}
+
+uint8_t fat32_lfn_checksum(const uint8_t sfn[11]) {
+    uint8_t sum = 0;
+    for (unsigned i = 0; i < 11; ++i) sum = (uint8_t)(((sum & 1u) << 7) + (sum >> 1) + sfn[i]);
+    return sum;
+}
+
+// UCS-2 offsets of the 13 characters in a long-name entry
+static const uint8_t lfn_pos[FAT32_LFN_CHARS] = { 1, 3, 5, 7, 9, 14, 16, 18, 20, 22, 24, 28, 30 };
+
+unsigned fat32_dir_entries(const char *name, const uint8_t sfn[11], uint8_t attr,
+                           uint32_t cluster, uint32_t size, uint8_t *out) {
+    unsigned k = 0;
+    if (name) {
+        size_t   len  = strlen(name);
+        unsigned nlfn = (unsigned)((len + FAT32_LFN_CHARS - 1u) / FAT32_LFN_CHARS);
+        uint8_t  sum  = fat32_lfn_checksum(sfn);
+        for (unsigned ord = nlfn; ord >= 1; --ord, ++k) {
+            uint8_t *e = &out[k * FAT32_DIR_ENTRY_BYTES];
+            memset(e, 0, FAT32_DIR_ENTRY_BYTES);
+            e[0]  = (uint8_t)(ord | (ord == nlfn ? 0x40u : 0u));
+            e[11] = FAT32_ATTR_LFN;
+            e[13] = sum;
+            for (unsigned i = 0; i < FAT32_LFN_CHARS; ++i) {
+                size_t   at = (ord - 1u) * FAT32_LFN_CHARS + i;
+                uint16_t ch = at < len ? (uint8_t)name[at] : (at == len ? 0x0000u : 0xFFFFu);
+                if (ch > 0x7Eu && ch != 0xFFFFu) ch = '_';
+                wr16(&e[lfn_pos[i]], ch);
+            }
+        }
+    }
+
+    uint8_t *e = &out[k++ * FAT32_DIR_ENTRY_BYTES];
+    memset(e, 0, FAT32_DIR_ENTRY_BYTES);
+    memcpy(e, sfn, 11);
+    e[11] = attr;
+    wr16(&e[14], FAT32_TIME);
+    wr16(&e[16], FAT32_DATE);
+    wr16(&e[18], FAT32_DATE);
+    wr16(&e[20], (uint16_t)(cluster >> 16));
+    wr16(&e[22], FAT32_TIME);
+    wr16(&e[24], FAT32_DATE);
+    wr16(&e[26], (uint16_t)cluster);
+    wr32(&e[28], size);
+    return k;
+}
+
+/* ------------------------------------------------------------ */
+/*  Root directory                                               */
+/* ------------------------------------------------------------ */
+typedef struct {
+    // in
+    const char *name;
+    uint8_t     basis[MAX_TAIL + 1u][11];   // [0] = plain alias, [t] = with ~t
+    unsigned    need;                       // free entries wanted, 0 = lookup only
+    // out
+    bool        exists;
+    uint32_t    tails_used;                 // bit t: basis ~t taken
+    uint32_t    gap_cluster;                // 0 = no gap found
+    unsigned    gap_index;                  // entry within the cluster
+    uint32_t    end_cluster;                // where the 0x00 end marker is, 0 = none
+    unsigned    end_index;
+    uint32_t    end_next;                   // chain cluster after that, 0 = none
+    uint32_t    last_cluster;
+} dir_scan_t;
+
+static void sfn_to_name(const uint8_t *sfn, char *out) {
+    unsigned n = 0;
+    for (unsigned i = 0; i < 8 && sfn[i] != ' '; ++i) out[n++] = (char)sfn[i];
+    if (sfn[8] != ' ') {
+        out[n++] = '.';
+        for (unsigned i = 8; i < 11 && sfn[i] != ' '; ++i) out[n++] = (char)sfn[i];
+    }
+    out[n] = '\0';
+}
+
+static bool name_eq(const char *a, const char *b) {
+    while (*a && toupper((unsigned char)*a) == toupper((unsigned char)*b)) { a++; b++; }
+    return toupper((unsigned char)*a) == toupper((unsigned char)*b);
+}
+
+static bool dir_scan(const fat32_vol_t *v, dir_scan_t *s) {
+    static char lfn[FAT32_NAME_MAX + 1u];
+    char     alias[13];
+    uint8_t  lfn_sum  = 0;
+    bool     lfn_ok   = false;
+    bool     at_end   = false;
+    uint32_t end      = v->clusters + 2u;
+    uint32_t c        = v->root_cluster;
+
+    s->exists = false;
+    s->tails_used = 0;
+    s->gap_cluster = 0;
+    s->end_cluster = 0;
+    s->end_next = 0;
+    while (c >= 2u && c < end) {
+        unsigned run = 0, run_start = 0;
+        for (unsigned b = 0; b < v->spc; ++b) {
+            if (!at_end && !sd_read_blocks(cluster_lba(v, c) + b, blk, 1)) return false;
+            for (unsigned i = 0; i < ENTRIES_PER_BLOCK; ++i) {
+                const uint8_t *e   = &blk[i * FAT32_DIR_ENTRY_BYTES];
+                unsigned       idx = b * ENTRIES_PER_BLOCK + i;
+                if (!at_end && e[0] == 0x00) {
+                    at_end         = true;
+                    s->end_cluster = c;
+                    s->end_index   = idx;
+                }
+
+                if (at_end || e[0] == 0xE5u) {
+                    if (run++ == 0) run_start = idx;
+                    if (s->need && run == s->need && !s->gap_cluster) {
+                        s->gap_cluster = c;
+                        s->gap_index   = run_start;
+                    }
+                    lfn_ok = false;
+                    continue;
+                }
+                run = 0;
+
+                if (e[11] == FAT32_ATTR_LFN) {
+                    unsigned ord = e[0] & 0x1Fu;
+                    if (e[0] & 0x40u) {
+                        memset(lfn, 0, sizeof(lfn));
+                        lfn_sum = e[13];
+                        lfn_ok  = true;
+                    }
+                    if (ord == 0 || e[13] != lfn_sum) lfn_ok = false;
+                    for (unsigned k = 0; lfn_ok && k < FAT32_LFN_CHARS; ++k) {
+                        size_t   at = (ord - 1u) * FAT32_LFN_CHARS + k;
+                        uint16_t ch = rd16(&e[lfn_pos[k]]);
+                        if (at < FAT32_NAME_MAX && ch != 0xFFFFu)
+                            lfn[at] = (char)(ch && ch < 0x80u ? ch : (ch ? '_' : 0));
+                    }
+                    continue;
+                }
+                if (e[11] & FAT32_ATTR_VOLUME_ID) {
+                    lfn_ok = false;
+                    continue;
+                }
+
+                if (lfn_ok && fat32_lfn_checksum(e) == lfn_sum && name_eq(lfn, s->name))
+                    s->exists = true;
+                sfn_to_name(e, alias);
+                if (name_eq(alias, s->name)) s->exists = true;
+                for (unsigned t = 0; t <= MAX_TAIL; ++t) {
+                    if (!memcmp(e, s->basis[t], 11)) s->tails_used |= 1u << t;
+                }
+                lfn_ok = false;
+            }
+        }
+        uint32_t next;
+        if (!fat_get(v, c, &next)) return false;
+        s->last_cluster = c;
+        if (at_end) {                              // the rest is free by definition
+            s->end_next = (next >= 2u && next < end) ? next : 0;
+            break;
+        }
+        c = next;
+    }
+    return true;
+}
+
+static bool dir_zero(const fat32_vol_t *v, uint32_t c) {
+    memset(blk, 0, sizeof(blk));
+    for (unsigned b = 0; b < v->spc; ++b) {
+        if (!sd_write_blocks(cluster_lba(v, c) + b, blk, 1)) return false;
+    }
+    return true;
+}
+
+// Turn the end marker and the free entries after it into deleted ones, so
+// entries placed in a later cluster stay visible
+static bool dir_unterminate(const fat32_vol_t *v, uint32_t c, unsigned index) {
+    for (unsigned b = index / ENTRIES_PER_BLOCK; b < v->spc; ++b) {
+        uint32_t lba = cluster_lba(v, c) + b;
+        if (!sd_read_blocks(lba, blk, 1)) return false;
+        for (unsigned i = 0; i < ENTRIES_PER_BLOCK; ++i) {
+            if (b * ENTRIES_PER_BLOCK + i >= index) blk[i * FAT32_DIR_ENTRY_BYTES] = 0xE5u;
+        }
+        if (!sd_write_blocks(lba, blk, 1)) return false;
+    }
+    return true;
+}
+
+// No gap before the end of the directory: continue in the next cluster of
+// the chain, or chain a new one on
+static bool dir_extend(fat32_vol_t *v, dir_scan_t *s, const char **err) {
+    uint32_t c = s->end_next;
+    if (!c && !alloc_run(v, 1, &c, err)) return false;
+    if (!dir_zero(v, c) ||
+        (s->end_cluster && !dir_unterminate(v, s->end_cluster, s->end_index))) {
+        *err = "card write failed";
+        return false;
+    }
+    if (!s->end_next && !fat_set(v, s->last_cluster, c)) {
+        *err = "FAT write failed";
+        return false;
+    }
+    s->gap_cluster = c;
+    s->gap_index   = 0;
+    return true;
+}
+
+static bool dir_write(const fat32_vol_t *v, uint32_t c, unsigned index, unsigned n) {
+    unsigned done = 0;
+    while (done < n) {
+        unsigned b     = (index + done) / ENTRIES_PER_BLOCK;
+        unsigned first = (index + done) % ENTRIES_PER_BLOCK;
+        unsigned cnt   = ENTRIES_PER_BLOCK - first;
+        if (cnt > n - done) cnt = n - done;
+        uint32_t lba = cluster_lba(v, c) + b;
+        if (!sd_read_blocks(lba, blk, 1)) return false;
+        memcpy(&blk[first * FAT32_DIR_ENTRY_BYTES], &ents[done * FAT32_DIR_ENTRY_BYTES],
+               cnt * FAT32_DIR_ENTRY_BYTES);
+        if (!sd_write_blocks(lba, blk, 1)) return false;
+        done += cnt;
+    }
+    return true;
+}
+
+static void scan_prepare(dir_scan_t *s, const char *name, bool *lossy) {
+    s->name = name;
+    *lossy  = fat32_short_name(name, 0, s->basis[0]);
+    for (unsigned t = 1; t <= MAX_TAIL; ++t) fat32_short_name(name, t, s->basis[t]);
+}
+
+bool fat32_exists(fat32_vol_t *v, const char *name, const char **err) {
+    static dir_scan_t s;
+    bool lossy;
+    scan_prepare(&s, name, &lossy);
+    s.need = 0;
+    if (!dir_scan(v, &s)) {
+        *err = "card read failed";
+        return false;
+    }
+    return s.exists;
+}
+
+bool fat32_create(fat32_vol_t *v, const char *name, uint32_t bytes,
+                  fat32_file_t *out, const char **err) {
+    static dir_scan_t s;
+    size_t len = strlen(name);
+    if (len == 0 || len > FAT32_NAME_MAX || strpbrk(name, "\\/:*?\"<>|")) {
+        *err = "bad file name";
+        return false;
+    }
+
+    bool lossy;
+    scan_prepare(&s, name, &lossy);
+    s.need = lossy ? (unsigned)((len + FAT32_LFN_CHARS - 1u) / FAT32_LFN_CHARS) + 1u : 1u;
+    if (!dir_scan(v, &s)) {
+        *err = "card read failed";
+        return false;
+    }
+    if (s.exists) {
+        *err = "file exists";
+        return false;
+    }
+
+    // The plain alias if it is free, else the first free ~tail
+    unsigned tail = 0;
+    if (lossy) {
+        tail = 1;
+        while (tail <= MAX_TAIL && (s.tails_used & (1u << tail))) tail++;
+        if (tail > MAX_TAIL) {
+            *err = "too many similar names";
+            return false;
+        }
+    }
+    if (!s.gap_cluster && !dir_extend(v, &s, err)) return false;
+
+    uint32_t cluster_bytes = (uint32_t)v->spc * SD_BLOCK_BYTES;
+    uint32_t n = (uint32_t)(((uint64_t)bytes + cluster_bytes - 1u) / cluster_bytes);
+    uint32_t first = 0;
+    if (n && !alloc_run(v, n, &first, err)) return false;
+
+    unsigned k = fat32_dir_entries(lossy ? name : NULL, s.basis[tail], FAT32_ATTR_ARCHIVE,
+                                   first, 0, ents);
+    if (!dir_write(v, s.gap_cluster, s.gap_index, k)) {
+        *err = "card write failed";
+        return false;
+    }
+
+    out->cluster     = first;
+    out->first_lba   = n ? cluster_lba(v, first) : 0;
+    out->blocks      = (bytes + SD_BLOCK_BYTES - 1u) / SD_BLOCK_BYTES;
+    out->bytes       = bytes;
+    out->dir_cluster = s.gap_cluster;
+    out->dir_index   = s.gap_index + k - 1u;       // the 8.3 entry comes last
+    return true;
+}
+
+bool fat32_set_size(const fat32_vol_t *v, const fat32_file_t *f, uint32_t bytes,
+                    const char **err) {
+    if (bytes > f->bytes) bytes = f->bytes;
+    uint32_t lba = cluster_lba(v, f->dir_cluster) + f->dir_index / ENTRIES_PER_BLOCK;
+    if (!sd_read_blocks(lba, blk, 1)) {
+        *err = "card read failed";
+        return false;
+    }
+    wr32(&blk[(f->dir_index % ENTRIES_PER_BLOCK) * FAT32_DIR_ENTRY_BYTES + 28u], bytes);
+    if (!sd_write_blocks(lba, blk, 1)) {
+        *err = "card write failed";
+        return false;
+    }
+    return true;
+}
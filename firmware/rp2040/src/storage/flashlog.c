@@ -0,0 +1,265 @@
+/* flashlog.c – append-only record log in the last flash sectors
+ *  ---------------------------------------------------------------
+ *  • Slot 0 of each sector is its header: a magic word and a sequence
+ *    number. The sector with the highest sequence takes new records,
+ *    and the others are older in ring order after it
+ *  • A record goes into its slot with a single page program. The rest
+ *    of the page is 0xFF, which leaves the neighbouring slots alone
+ *  • A lookup scans from the newest slot backwards, so the first key
+ *    match is the current record, or the tombstone that removed it
+ *  • Flash is read through XIP; programming pauses core 1 (which runs
+ *    from flash) and interrupts for the few ms it takes
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include "pico/stdlib.h"
+#include "hardware/flash.h"
+#include "hardware/sync.h"
+
+#include <app/crc32.h>
+#include <app/pipeline.h>
+#include <storage/flashlog.h>
+
+#define LOG_MAGIC         0x4C343646u       // "F64L"
+#define SLOTS_PER_SECTOR  (FLASH_SECTOR_SIZE / FLASHLOG_SLOT_BYTES)
+#define SLOT_LIVE         0x5AA5u
+#define SLOT_DEAD         0x0AA0u           // tombstone: key removed
+
+typedef struct {
+    uint8_t  data[FLASHLOG_DATA_BYTES];
+    uint16_t state;                         // SLOT_LIVE / SLOT_DEAD
+    uint16_t check;                         // CRC-32 of data and state, low half
+} slot_t;
+
+typedef struct {
+    uint32_t magic;
+    uint32_t seq;
+    uint32_t seq_inv;                       // ~seq: a torn header is no header
+} sector_hdr_t;
+
+_Static_assert(sizeof(slot_t) == FLASHLOG_SLOT_BYTES, "slot layout");
+_Static_assert(FLASH_PAGE_SIZE % FLASHLOG_SLOT_BYTES == 0, "slots straddle pages");
+
+static unsigned head;                       // sector taking new records
+static unsigned fill;                       // its next free slot
+static uint32_t head_seq;
+static slot_t   carry[SLOTS_PER_SECTOR];
+static uint8_t  page[FLASH_PAGE_SIZE] __attribute__((aligned(4)));
+
+/* ------------------------------------------------------------ */
+/*  Flash access                                                 */
+/* ------------------------------------------------------------ */
+static uint32_t sector_offset(unsigned s) {
+    return FLASHLOG_OFFSET + s * FLASH_SECTOR_SIZE;
+}
+
+static const void *flash_ptr(uint32_t off) {
+    return (const void *)(XIP_BASE + off);
+}
+
+static const slot_t *slot_at(unsigned s, unsigned i) {
+    return flash_ptr(sector_offset(s) + i * FLASHLOG_SLOT_BYTES);
+}
+
+// Core 1 must not fetch from flash while it is being written
+static uint32_t flash_begin(void) {
+    pipe_park();
+    return save_and_disable_interrupts();
+}
+
+static void flash_end(uint32_t irq) {
+    restore_interrupts(irq);
+    pipe_unpark();
+}
+
+static void erase_sector(unsigned s) {
+    uint32_t irq = flash_begin();
+    flash_range_erase(sector_offset(s), FLASH_SECTOR_SIZE);
+    flash_end(irq);
+}
+
+// One slot-sized piece, programmed through its page with 0xFF around it
+static void program_slot(unsigned s, unsigned i, const void *src) {
+    uint32_t off = sector_offset(s) + i * FLASHLOG_SLOT_BYTES;
+    memset(page, 0xFF, sizeof(page));
+    memcpy(&page[off % FLASH_PAGE_SIZE], src, FLASHLOG_SLOT_BYTES);
+    uint32_t irq = flash_begin();
+    flash_range_program(off - off % FLASH_PAGE_SIZE, page, FLASH_PAGE_SIZE);
+    flash_end(irq);
+}
+
+/* ------------------------------------------------------------ */
+/*  Slots                                                        */
+/* ------------------------------------------------------------ */
+static uint16_t slot_check(const slot_t *s) {
+    return (uint16_t)crc32_update(0, s, offsetof(slot_t, check));
+}
+
+static bool slot_erased(const slot_t *s) {
+    const uint32_t *w = (const uint32_t *)s;
+    for (unsigned i = 0; i < FLASHLOG_SLOT_BYTES / 4u; ++i)
+        if (w[i] != 0xFFFFFFFFu) return false;
+    return true;
+}
+
+static bool slot_valid(const slot_t *s) {
+    return (s->state == SLOT_LIVE || s->state == SLOT_DEAD) && s->check == slot_check(s);
+}
+
+static bool sector_valid(unsigned s, uint32_t *seq) {
+    const sector_hdr_t *h = flash_ptr(sector_offset(s));
+    if (h->magic != LOG_MAGIC || h->seq != ~h->seq_inv) return false;
+    if (seq) *seq = h->seq;
+    return true;
+}
+
+static void make_head(unsigned s, uint32_t seq) {
+    slot_t hdr;
+    memset(&hdr, 0xFF, sizeof(hdr));
+    sector_hdr_t h = { LOG_MAGIC, seq, ~seq };
+    memcpy(&hdr, &h, sizeof(h));
+    erase_sector(s);
+    program_slot(s, 0, &hdr);
+    head     = s;
+    head_seq = seq;
+    fill     = 1;
+}
+
+// Slots in use in sector 's' (its header included)
+static unsigned sector_fill(unsigned s) {
+    if (s == head) return fill;
+    return sector_valid(s, NULL) ? SLOTS_PER_SECTOR : 0;
+}
+
+// Newest valid slot with this key, looking only at what is older than
+// slot 'i' of sector 'k' steps back from the head; NULL if there is none
+static const slot_t *find_from(const void *key, unsigned k, unsigned i) {
+    for (; k < FLASHLOG_SECTORS; ++k, i = SLOTS_PER_SECTOR) {
+        unsigned s = (head + FLASHLOG_SECTORS - k) % FLASHLOG_SECTORS;
+        unsigned n = sector_fill(s);
+        if (i > n) i = n;
+        while (i-- > 1) {
+            const slot_t *sl = slot_at(s, i);
+            if (slot_valid(sl) && !memcmp(sl->data, key, FLASHLOG_KEY_BYTES)) return sl;
+        }
+    }
+    return NULL;
+}
+
+// True if slot 'i' of the oldest sector has a newer record for its key
+static bool superseded(unsigned s, unsigned i) {
+    const uint8_t *key = slot_at(s, i)->data;
+    for (unsigned j = i + 1u; j < SLOTS_PER_SECTOR; ++j) {
+        const slot_t *sl = slot_at(s, j);
+        if (slot_valid(sl) && !memcmp(sl->data, key, FLASHLOG_KEY_BYTES)) return true;
+    }
+    for (unsigned k = 0; k + 1u < FLASHLOG_SECTORS; ++k) {
+        unsigned o = (head + FLASHLOG_SECTORS - k) % FLASHLOG_SECTORS;
+        unsigned n = sector_fill(o);
+        for (unsigned j = 1; j < n; ++j) {
+            const slot_t *sl = slot_at(o, j);
+            if (slot_valid(sl) && !memcmp(sl->data, key, FLASHLOG_KEY_BYTES)) return true;
+        }
+    }
+    return false;
+}
+
+// Reuse the oldest sector as the head. Its current records come along;
+// tombstones do not, since nothing older than them is left. If they
+// would fill it, the oldest of them are dropped to leave room.
+static void advance(void) {
+    unsigned victim = (head + 1u) % FLASHLOG_SECTORS;
+    unsigned n = 0;
+    if (sector_valid(victim, NULL)) {
+        for (unsigned i = 1; i < SLOTS_PER_SECTOR; ++i) {
+            const slot_t *sl = slot_at(victim, i);
+            if (!slot_valid(sl) || sl->state != SLOT_LIVE || superseded(victim, i)) continue;
+            carry[n++] = *sl;
+        }
+    }
+    unsigned room = SLOTS_PER_SECTOR - 1u - SLOTS_PER_SECTOR / 8u;
+    unsigned skip = n > room ? n - room : 0;
+
+    make_head(victim, head_seq + 1u);
+    for (unsigned i = skip; i < n; ++i) program_slot(head, fill++, &carry[i]);
+}
+
+static bool append(const uint8_t *data, uint16_t state) {
+    if (fill >= SLOTS_PER_SECTOR) advance();
+    slot_t sl;
+    memcpy(sl.data, data, sizeof(sl.data));
+    sl.state = state;
+    sl.check = slot_check(&sl);
+    program_slot(head, fill, &sl);
+    return !memcmp(slot_at(head, fill++), &sl, sizeof(sl));
+}
+
+/* ------------------------------------------------------------ */
+/*  API                                                          */
+/* ------------------------------------------------------------ */
+void flashlog_init(void) {
+    bool     found = false;
+    uint32_t best  = 0;
+    for (unsigned s = 0; s < FLASHLOG_SECTORS; ++s) {
+        uint32_t seq;
+        if (sector_valid(s, &seq) && (!found || seq > best)) {
+            found = true;
+            best  = seq;
+            head  = s;
+        }
+    }
+    if (!found) {
+        flashlog_clear();
+        return;
+    }
+
+    // After the last slot that was written, torn or not
+    head_seq = best;
+    fill     = SLOTS_PER_SECTOR;
+    while (fill > 1u && slot_erased(slot_at(head, fill - 1u))) --fill;
+}
+
+bool flashlog_find(const void *key, void *data) {
+    const slot_t *sl = find_from(key, 0, fill);
+    if (!sl || sl->state != SLOT_LIVE) return false;
+    memcpy(data, sl->data, FLASHLOG_DATA_BYTES);
+    return true;
+}
+
+bool flashlog_put(const void *data) {
+    // Same record already current: nothing to wear
+    const slot_t *sl = find_from(data, 0, fill);
+    if (sl && sl->state == SLOT_LIVE && !memcmp(sl->data, data, FLASHLOG_DATA_BYTES)) return true;
+    return append(data, SLOT_LIVE);
+}
+
+bool flashlog_remove(const void *key) {
+    const slot_t *sl = find_from(key, 0, fill);
+    if (!sl || sl->state != SLOT_LIVE) return true;
+    uint8_t data[FLASHLOG_DATA_BYTES] = { 0 };
+    memcpy(data, key, FLASHLOG_KEY_BYTES);
+    return append(data, SLOT_DEAD);
+}
+
+// The sequence number counts sector erases, so it doubles as the wear count
+void flashlog_clear(void) {
+    for (unsigned s = 1; s < FLASHLOG_SECTORS; ++s) erase_sector(s);
+    make_head(0, head_seq + FLASHLOG_SECTORS);
+}
+
+void flashlog_get_stats(flashlog_stats_t *out) {
+    memset(out, 0, sizeof(*out));
+    out->capacity = FLASHLOG_SECTORS * (SLOTS_PER_SECTOR - 1u);
+    out->erases   = head_seq;
+    for (unsigned s = 0; s < FLASHLOG_SECTORS; ++s) {
+        unsigned n = sector_fill(s);
+        if (n) out->used += n - 1u;
+        for (unsigned i = 1; i < n; ++i) {
+            const slot_t *sl = slot_at(s, i);
+            if (slot_valid(sl) && sl->state == SLOT_LIVE && find_from(sl->data, 0, fill) == sl)
+                out->records++;
+        }
+    }
+}
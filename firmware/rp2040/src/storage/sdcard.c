@@ -0,0 +1,344 @@
+/* sdcard.c – SD card over a PIO SPI master with DMA
+ *  ---------------------------------------------------------------
+ *  • Every transfer, one byte or one block, is a pair of DMA channels:
+ *    TX from memory (or a constant 0xFF), RX into memory (or a dummy
+ *    byte). The CPU waits on the RX channel, which finishes last.
+ *  • Commands carry a real CRC7; the card ignores it in SPI mode after
+ *    CMD8, but some cards check CMD0/CMD8 only and that costs nothing
+ *  • Only SD v1/v2 cards; SDHC/SDXC take block addresses, older cards
+ *    byte addresses
+ *  • Without N64_SD_SLOT only the stubs below the #else remain
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "pico/stdlib.h"
+#include "hardware/pio.h"
+#include "hardware/dma.h"
+#include "hardware/gpio.h"
+#include "hardware/clocks.h"
+
+#include "sd_spi.pio.h"
+#include <storage/sdcard.h>
+
+#if defined(N64_SD_SLOT) && N64_SD_SLOT
+
+#define CMD_GO_IDLE           0u
+#define CMD_SEND_IF_COND      8u
+#define CMD_SEND_CSD          9u
+#define CMD_STOP_TRANSMISSION 12u
+#define CMD_SET_BLOCKLEN      16u
+#define CMD_READ_MULTIPLE     18u
+#define CMD_WRITE_MULTIPLE    25u
+#define CMD_APP               55u
+#define CMD_READ_OCR          58u
+#define ACMD_SET_WR_ERASE     23u
+#define ACMD_SEND_OP_COND     41u
+
+#define R1_IDLE               0x01u
+#define TOKEN_START           0xFEu   // single read/write, multi-block read
+#define TOKEN_MULTI_WRITE     0xFCu
+#define TOKEN_STOP_TRAN       0xFDu
+#define DATA_ACCEPTED         0x05u
+
+#define INIT_TIMEOUT_US       1000000u
+#define TOKEN_TIMEOUT_US      100000u
+
+static PIO      sd_pio = SD_PIO_BLOCK;
+static uint     sd_sm;
+static int      dma_tx = -1;
+static int      dma_rx = -1;
+static bool     hc;                  // block addressing
+static uint32_t w_left;              // blocks still due in a multi-block write
+static uint8_t  ff = 0xFFu;
+static uint8_t  sink;
+
+/* ------------------------------------------------------------ */
+/*  SPI                                                          */
+/* ------------------------------------------------------------ */
+static void set_clock(uint32_t hz) {
+    float div = (float)clock_get_hz(clk_sys) / (4.0f * (float)hz);
+    pio_sm_set_clkdiv(sd_pio, sd_sm, div < 1.0f ? 1.0f : div);
+}
+
+// Full duplex: n bytes out of 'tx' (NULL = 0xFF), n bytes into 'rx'
+// (NULL = dropped)
+static void xfer(const uint8_t *tx, uint8_t *rx, uint32_t n) {
+    dma_channel_config c = dma_channel_get_default_config((uint)dma_rx);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_8);
+    channel_config_set_read_increment(&c, false);
+    channel_config_set_write_increment(&c, rx != NULL);
+    channel_config_set_dreq(&c, pio_get_dreq(sd_pio, sd_sm, false));
+    dma_channel_configure((uint)dma_rx, &c, rx ? rx : &sink,
+                          (io_rw_8 *)&sd_pio->rxf[sd_sm], n, true);
+
+    c = dma_channel_get_default_config((uint)dma_tx);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_8);
+    channel_config_set_read_increment(&c, tx != NULL);
+    channel_config_set_write_increment(&c, false);
+    channel_config_set_dreq(&c, pio_get_dreq(sd_pio, sd_sm, true));
+    dma_channel_configure((uint)dma_tx, &c, (io_rw_8 *)&sd_pio->txf[sd_sm],
+                          tx ? tx : &ff, n, true);
+
+    dma_channel_wait_for_finish_blocking((uint)dma_rx);
+}
+
+static uint8_t byte_xfer(uint8_t b) {
+    uint8_t r;
+    xfer(&b, &r, 1);
+    return r;
+}
+
+static void cs_select(void)   { gpio_put(SD_PIN_CS, false); byte_xfer(0xFF); }
+static void cs_deselect(void) { gpio_put(SD_PIN_CS, true);  byte_xfer(0xFF); }
+
+// The card holds MISO low while it is programming
+static bool wait_ready(uint32_t timeout_us) {
+    uint32_t t0 = time_us_32();
+    while (byte_xfer(0xFF) != 0xFF) {
+        if (time_us_32() - t0 > timeout_us) return false;
+    }
+    return true;
+}
+
+static bool wait_token(uint8_t token) {
+    uint32_t t0 = time_us_32();
+    uint8_t  b;
+    while ((b = byte_xfer(0xFF)) == 0xFF) {
+        if (time_us_32() - t0 > TOKEN_TIMEOUT_US) return false;
+    }
+    return b == token;
+}
+
+/* ------------------------------------------------------------ */
+/*  Commands                                                     */
+/* ------------------------------------------------------------ */
+static uint8_t crc7(const uint8_t *p, unsigned n) {
+    uint8_t crc = 0;
+    for (unsigned i = 0; i < n; ++i) {
+        uint8_t d = p[i];
+        for (unsigned b = 0; b < 8; ++b, d <<= 1) {
+            crc <<= 1;
+            if ((d ^ crc) & 0x80u) crc ^= 0x09u;
+        }
+    }
+    return (uint8_t)(crc << 1 | 1u);
+}
+
+// R1 response, 0xFF if the card never answered. The card stays selected.
+static uint8_t cmd(uint8_t idx, uint32_t arg) {
+    uint8_t f[6] = { (uint8_t)(0x40u | idx), (uint8_t)(arg >> 24), (uint8_t)(arg >> 16),
+                     (uint8_t)(arg >> 8), (uint8_t)arg, 0 };
+    f[5] = crc7(f, 5);
+    if (idx != CMD_GO_IDLE && idx != CMD_STOP_TRANSMISSION) wait_ready(SD_BUSY_TIMEOUT_US);
+    xfer(f, NULL, sizeof(f));
+    if (idx == CMD_STOP_TRANSMISSION) byte_xfer(0xFF);    // stuff byte
+
+    uint8_t r = 0xFF;
+    for (unsigned i = 0; i < 10 && (r & 0x80u); ++i) r = byte_xfer(0xFF);
+    return r;
+}
+
+static uint8_t acmd(uint8_t idx, uint32_t arg) {
+    uint8_t r = cmd(CMD_APP, 0);
+    return (r & ~R1_IDLE) ? r : cmd(idx, arg);
+}
+
+static uint32_t csd_blocks(const uint8_t *csd) {
+    if ((csd[0] >> 6) == 1u) {                       // CSD 2.0
+        uint32_t c_size = ((uint32_t)(csd[7] & 0x3Fu) << 16) | ((uint32_t)csd[8] << 8) | csd[9];
+        return (c_size + 1u) * 1024u;
+    }
+    uint32_t read_bl_len = csd[5] & 0x0Fu;
+    uint32_t c_size      = ((uint32_t)(csd[6] & 0x03u) << 10) | ((uint32_t)csd[7] << 2) | (csd[8] >> 6);
+    uint32_t c_size_mult = ((csd[9] & 0x03u) << 1) | (csd[10] >> 7);
+    return ((c_size + 1u) << (c_size_mult + 2u + read_bl_len)) / SD_BLOCK_BYTES;
+}
+
+/* ------------------------------------------------------------ */
+/*  Init                                                         */
+/* ------------------------------------------------------------ */
+static void spi_init_once(void) {
+    if (dma_tx >= 0) return;
+
+    gpio_init(SD_PIN_CS);
+    gpio_put(SD_PIN_CS, true);
+    gpio_set_dir(SD_PIN_CS, GPIO_OUT);
+    gpio_pull_up(SD_PIN_MISO);
+
+    uint offset = pio_add_program(sd_pio, &sd_spi_program);
+    sd_sm = (uint)pio_claim_unused_sm(sd_pio, true);
+    pio_sm_config c = sd_spi_program_get_default_config(offset);
+    sm_config_set_out_pins(&c, SD_PIN_MOSI, 1);
+    sm_config_set_in_pins(&c, SD_PIN_MISO);
+    sm_config_set_sideset_pins(&c, SD_PIN_SCK);
+    sm_config_set_out_shift(&c, false, true, 8);     // MSB first, autopull
+    sm_config_set_in_shift(&c, false, true, 8);      // autopush
+    pio_sm_set_pins_with_mask(sd_pio, sd_sm, 1u << SD_PIN_MOSI, (1u << SD_PIN_SCK) | (1u << SD_PIN_MOSI));
+    pio_sm_set_pindirs_with_mask(sd_pio, sd_sm, (1u << SD_PIN_SCK) | (1u << SD_PIN_MOSI),
+                                 (1u << SD_PIN_SCK) | (1u << SD_PIN_MOSI) | (1u << SD_PIN_MISO));
+    pio_gpio_init(sd_pio, SD_PIN_SCK);
+    pio_gpio_init(sd_pio, SD_PIN_MOSI);
+    pio_gpio_init(sd_pio, SD_PIN_MISO);
+    pio_sm_init(sd_pio, sd_sm, offset, &c);
+    pio_sm_set_enabled(sd_pio, sd_sm, true);
+
+    dma_tx = dma_claim_unused_channel(true);
+    dma_rx = dma_claim_unused_channel(true);
+}
+
+bool sd_init(sd_info_t *out) {
+    spi_init_once();
+    set_clock(SD_INIT_HZ);
+    w_left = 0;
+
+    // 74+ clocks with CS high put the card in native mode, CMD0 in SPI mode
+    gpio_put(SD_PIN_CS, true);
+    for (unsigned i = 0; i < 10; ++i) byte_xfer(0xFF);
+    cs_select();
+    bool ok = cmd(CMD_GO_IDLE, 0) == R1_IDLE;
+
+    bool v2 = false;
+    if (ok && cmd(CMD_SEND_IF_COND, 0x1AAu) == R1_IDLE) {
+        uint8_t r7[4];
+        xfer(NULL, r7, sizeof(r7));
+        ok = (r7[2] & 0x0Fu) == 0x01u && r7[3] == 0xAAu;   // 2.7-3.6 V, echo
+        v2 = true;
+    }
+    if (ok) {
+        uint32_t t0 = time_us_32();
+        uint8_t  r;
+        while ((r = acmd(ACMD_SEND_OP_COND, v2 ? 0x40000000u : 0)) == R1_IDLE) {
+            if (time_us_32() - t0 > INIT_TIMEOUT_US) break;
+        }
+        ok = (r == 0);
+    }
+
+    hc = false;
+    if (ok && v2 && cmd(CMD_READ_OCR, 0) == 0) {
+        uint8_t ocr[4];
+        xfer(NULL, ocr, sizeof(ocr));
+        hc = (ocr[0] & 0x40u) != 0;
+    }
+    if (ok && !hc) ok = cmd(CMD_SET_BLOCKLEN, SD_BLOCK_BYTES) == 0;
+
+    uint8_t csd[18];
+    ok = ok && cmd(CMD_SEND_CSD, 0) == 0 && wait_token(TOKEN_START);
+    if (ok) xfer(NULL, csd, sizeof(csd));                  // 16 bytes + CRC16
+    cs_deselect();
+    if (!ok) return false;
+
+    set_clock(SD_FAST_HZ);
+    if (out) {
+        out->blocks        = csd_blocks(csd);
+        out->high_capacity = hc;
+    }
+    return true;
+}
+
+/* ------------------------------------------------------------ */
+/*  Blocks                                                       */
+/* ------------------------------------------------------------ */
+static inline uint32_t card_addr(uint32_t lba) {
+    return hc ? lba : lba * SD_BLOCK_BYTES;
+}
+
+bool sd_read_blocks(uint32_t lba, void *dst, uint32_t n) {
+    uint8_t *p = dst;
+    cs_select();
+    bool ok = cmd(CMD_READ_MULTIPLE, card_addr(lba)) == 0;
+    for (uint32_t i = 0; ok && i < n; ++i, p += SD_BLOCK_BYTES) {
+        ok = wait_token(TOKEN_START);
+        if (ok) {
+            xfer(NULL, p, SD_BLOCK_BYTES);
+            xfer(NULL, NULL, 2);                          // CRC16, not checked
+        }
+    }
+    cmd(CMD_STOP_TRANSMISSION, 0);
+    ok = wait_ready(SD_BUSY_TIMEOUT_US) && ok;
+    cs_deselect();
+    return ok;
+}
+
+bool sd_write_begin(uint32_t lba, uint32_t n) {
+    cs_select();
+    // Telling the card how much is coming lets it erase ahead
+    acmd(ACMD_SET_WR_ERASE, n);
+    if (cmd(CMD_WRITE_MULTIPLE, card_addr(lba)) != 0) {
+        cs_deselect();
+        return false;
+    }
+    w_left = n;
+    return true;
+}
+
+bool sd_write_next(const void *src, uint32_t n) {
+    static const uint8_t token = TOKEN_MULTI_WRITE;
+    const uint8_t *p = src;
+    if (n > w_left) return false;
+    for (uint32_t i = 0; i < n; ++i, p += SD_BLOCK_BYTES) {
+        if (!wait_ready(SD_BUSY_TIMEOUT_US)) return false;
+        xfer(&token, NULL, 1);
+        xfer(p, NULL, SD_BLOCK_BYTES);
+        xfer(NULL, NULL, 2);                              // CRC16, ignored in SPI mode
+        if ((byte_xfer(0xFF) & 0x1Fu) != DATA_ACCEPTED) return false;
+        w_left--;
+    }
+    return true;
+}
+
+bool sd_write_end(void) {
+    static const uint8_t token = TOKEN_STOP_TRAN;
+    bool ok = w_left == 0 && wait_ready(SD_BUSY_TIMEOUT_US);
+    xfer(&token, NULL, 1);
+    byte_xfer(0xFF);
+    ok = wait_ready(SD_BUSY_TIMEOUT_US) && ok;
+    cs_deselect();
+    w_left = 0;
+    return ok;
+}
+
+bool sd_write_blocks(uint32_t lba, const void *src, uint32_t n) {
+    if (!sd_write_begin(lba, n)) return false;
+    bool ok = sd_write_next(src, n);
+    return sd_write_end() && ok;
+}
+
+#else
+
+bool sd_init(sd_info_t *out) {
+    (void)out;
+    return false;
+}
+
+bool sd_read_blocks(uint32_t lba, void *dst, uint32_t n) {
+    (void)lba;
+    (void)dst;
+    (void)n;
+    return false;
+}
+
+bool sd_write_begin(uint32_t lba, uint32_t n) {
+    (void)lba;
+    (void)n;
+    return false;
+}
+
+bool sd_write_next(const void *src, uint32_t n) {
+    (void)src;
+    (void)n;
+    return false;
+}
+
+bool sd_write_end(void) {
+    return false;
+}
+
+bool sd_write_blocks(uint32_t lba, const void *src, uint32_t n) {
+    (void)lba;
+    (void)src;
+    (void)n;
+    return false;
+}
+
+#endif
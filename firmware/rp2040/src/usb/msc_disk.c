@@ -0,0 +1,78 @@
+/* msc_disk.c – TinyUSB mass-storage callbacks over app/cartfs
+ *  ---------------------------------------------------------------
+ *  • Read-only; writes fail with a write-protect sense
+ *  • "Medium not present" until the CLI mounts the cart, and again
+ *    after it unmounts, so the host drops its cached FAT
+ *  • READ10 runs inside tud_task(): a block is read from the cart
+ *    while the host waits, and core 1 keeps the next slots coming
+ */
+#include <string.h>
+#include "pico/stdlib.h"
+#include "tusb.h"
+
+#include <app/cartfs.h>
+
+void tud_msc_inquiry_cb(uint8_t lun, uint8_t vendor_id[8], uint8_t product_id[16],
+                        uint8_t product_rev[4]) {
+    (void)lun;
+    memcpy(vendor_id, "N64     ", 8);
+    memcpy(product_id, "Cartridge       ", 16);
+    memcpy(product_rev, "1.0 ", 4);
+}
+
+bool tud_msc_test_unit_ready_cb(uint8_t lun) {
+    if (!cartfs_mounted()) {
+        tud_msc_set_sense(lun, SCSI_SENSE_NOT_READY, 0x3A, 0x00);   // medium not present
+        return false;
+    }
+    return true;
+}
+
+void tud_msc_capacity_cb(uint8_t lun, uint32_t *block_count, uint16_t *block_size) {
+    (void)lun;
+    *block_count = cartfs_blocks();
+    *block_size  = CARTFS_BLOCK_BYTES;
+}
+
+bool tud_msc_start_stop_cb(uint8_t lun, uint8_t power_condition, bool start, bool load_eject) {
+    (void)lun;
+    (void)power_condition;
+    if (load_eject && !start) cartfs_unmount();
+    return true;
+}
+
+bool tud_msc_is_writable_cb(uint8_t lun) {
+    (void)lun;
+    return false;
+}
+
+int32_t tud_msc_read10_cb(uint8_t lun, uint32_t lba, uint32_t offset, void *buffer,
+                          uint32_t bufsize) {
+    if (!cartfs_read(lba, offset, buffer, bufsize)) {
+        tud_msc_set_sense(lun, SCSI_SENSE_MEDIUM_ERROR, 0x11, 0x00);  // unrecovered read
+        return -1;
+    }
+    return (int32_t)bufsize;
+}
+
+int32_t tud_msc_write10_cb(uint8_t lun, uint32_t lba, uint32_t offset, uint8_t *buffer,
+                           uint32_t bufsize) {
+    (void)lba;
+    (void)offset;
+    (void)buffer;
+    (void)bufsize;
+    tud_msc_set_sense(lun, SCSI_SENSE_DATA_PROTECT, 0x27, 0x00);      // write protected
+    return -1;
+}
+
+int32_t tud_msc_scsi_cb(uint8_t lun, const uint8_t scsi_cmd[16], void *buffer, uint16_t bufsize) {
+    (void)buffer;
+    (void)bufsize;
+    switch (scsi_cmd[0]) {
+    case SCSI_CMD_PREVENT_ALLOW_MEDIUM_REMOVAL:
+        return 0;
+    default:
+        tud_msc_set_sense(lun, SCSI_SENSE_ILLEGAL_REQUEST, 0x20, 0x00);  // invalid opcode
+        return -1;
+    }
+}
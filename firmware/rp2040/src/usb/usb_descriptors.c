@@ -0,0 +1,121 @@
+/* usb_descriptors.c – CDC console + mass storage, one composite device
+ *  ---------------------------------------------------------------
+ *  • Replaces the SDK's stdio-USB descriptors (tinyusb_device is linked
+ *    directly); the CDC interface stays the stdio console
+ *  • Interfaces: CDC control + data, MSC, and the picotool reset
+ *    interface when PICO_STDIO_USB_ENABLE_RESET_VIA_VENDOR_INTERFACE is set
+ *  • VID 2E8A / PID 000A as before, so host drivers keep matching
+ */
+#include <string.h>
+#include "pico/stdlib.h"
+#include "pico/unique_id.h"
+#include "tusb.h"
+#if PICO_STDIO_USB_ENABLE_RESET_VIA_VENDOR_INTERFACE
+#include "pico/usb_reset_interface.h"
+#endif
+
+#define USBD_VID            0x2E8Au
+#define USBD_PID            0x000Au
+#define USBD_MAX_POWER_MA   250u
+
+#define EP_CDC_NOTIF        0x81u
+#define EP_CDC_OUT          0x02u
+#define EP_CDC_IN           0x82u
+#define EP_MSC_OUT          0x03u
+#define EP_MSC_IN           0x83u
+
+enum {
+    ITF_CDC = 0,
+    ITF_CDC_DATA,
+    ITF_MSC,
+#if PICO_STDIO_USB_ENABLE_RESET_VIA_VENDOR_INTERFACE
+    ITF_RESET,
+#endif
+    ITF_COUNT
+};
+
+enum { STR_LANG = 0, STR_MANUF, STR_PRODUCT, STR_SERIAL, STR_CDC, STR_MSC, STR_RESET };
+
+#if PICO_STDIO_USB_ENABLE_RESET_VIA_VENDOR_INTERFACE
+#define CONFIG_LEN  (TUD_CONFIG_DESC_LEN + TUD_CDC_DESC_LEN + TUD_MSC_DESC_LEN + TUD_RPI_RESET_DESC_LEN)
+#else
+#define CONFIG_LEN  (TUD_CONFIG_DESC_LEN + TUD_CDC_DESC_LEN + TUD_MSC_DESC_LEN)
+#endif
+
+/* ------------------------------------------------------------ */
+/*  Device / configuration                                       */
+/* ------------------------------------------------------------ */
+static const tusb_desc_device_t desc_device = {
+    .bLength            = sizeof(tusb_desc_device_t),
+    .bDescriptorType    = TUSB_DESC_DEVICE,
+    .bcdUSB             = 0x0200,
+    // IAD for the CDC pair
+    .bDeviceClass       = TUSB_CLASS_MISC,
+    .bDeviceSubClass    = MISC_SUBCLASS_COMMON,
+    .bDeviceProtocol    = MISC_PROTOCOL_IAD,
+    .bMaxPacketSize0    = CFG_TUD_ENDPOINT0_SIZE,
+    .idVendor           = USBD_VID,
+    .idProduct          = USBD_PID,
+    .bcdDevice          = 0x0200,
+    .iManufacturer      = STR_MANUF,
+    .iProduct           = STR_PRODUCT,
+    .iSerialNumber      = STR_SERIAL,
+    .bNumConfigurations = 1
+};
+
+static const uint8_t desc_config[CONFIG_LEN] = {
+    TUD_CONFIG_DESCRIPTOR(1, ITF_COUNT, 0, CONFIG_LEN, 0, USBD_MAX_POWER_MA),
+    TUD_CDC_DESCRIPTOR(ITF_CDC, STR_CDC, EP_CDC_NOTIF, 8, EP_CDC_OUT, EP_CDC_IN, 64),
+    TUD_MSC_DESCRIPTOR(ITF_MSC, STR_MSC, EP_MSC_OUT, EP_MSC_IN, 64),
+#if PICO_STDIO_USB_ENABLE_RESET_VIA_VENDOR_INTERFACE
+    TUD_RPI_RESET_DESCRIPTOR(ITF_RESET, STR_RESET),
+#endif
+};
+
+const uint8_t *tud_descriptor_device_cb(void) {
+    return (const uint8_t *)&desc_device;
+}
+
+const uint8_t *tud_descriptor_configuration_cb(uint8_t index) {
+    (void)index;
+    return desc_config;
+}
+
+/* ------------------------------------------------------------ */
+/*  Strings                                                      */
+/* ------------------------------------------------------------ */
+static const char *const strings[] = {
+    [STR_MANUF]   = "Raspberry Pi",
+    [STR_PRODUCT] = "N64 Dumper",
+    [STR_CDC]     = "N64 Dumper Console",
+    [STR_MSC]     = "N64 Cartridge",
+    [STR_RESET]   = "Reset",
+};
+
+static uint16_t desc_str[33];
+
+const uint16_t *tud_descriptor_string_cb(uint8_t index, uint16_t langid) {
+    (void)langid;
+    char        serial[2 * PICO_UNIQUE_BOARD_ID_SIZE_BYTES + 1];
+    const char *s;
+    size_t      n;
+
+    if (index == STR_LANG) {
+        desc_str[1] = 0x0409;                       // English (US)
+        n = 1;
+    } else {
+        if (index == STR_SERIAL) {
+            pico_get_unique_board_id_string(serial, sizeof(serial));
+            s = serial;
+        } else if (index < sizeof(strings) / sizeof(strings[0]) && strings[index]) {
+            s = strings[index];
+        } else {
+            return NULL;
+        }
+        n = strlen(s);
+        if (n > 32) n = 32;
+        for (size_t i = 0; i < n; ++i) desc_str[1 + i] = (uint8_t)s[i];
+    }
+    desc_str[0] = (uint16_t)((TUSB_DESC_STRING << 8) | (2u * n + 2u));
+    return desc_str;
+}
@@ -0,0 +1,50 @@
+/* discover.cpp – sysfs walk behind discover.h
+ *  ---------------------------------------------------------------
+ *  • /sys/class/tty/ttyACMn/device is the CDC interface; the USB
+ *    device with idVendor/idProduct/serial is its parent directory
+ *  • Other boards with the Raspberry Pi VID use other PIDs and are
+ *    skipped
+ */
+#include "discover.h"
+
+#include <algorithm>
+#include <fstream>
+#include <limits.h>
+#include <stdlib.h>
+#include <dirent.h>
+
+static const char *const USB_VID = "2e8a";
+static const char *const USB_PID = "000a";
+
+static std::string read_line(const std::string &path) {
+    std::ifstream f(path);
+    std::string s;
+    std::getline(f, s);
+    return s;
+}
+
+std::vector<reader_port> discover_readers() {
+    std::vector<reader_port> out;
+    DIR *d = opendir("/sys/class/tty");
+    if (!d) return out;
+
+    while (struct dirent *e = readdir(d)) {
+        std::string name = e->d_name;
+        if (name.compare(0, 6, "ttyACM") != 0) continue;
+
+        char real[PATH_MAX];
+        std::string intf = "/sys/class/tty/" + name + "/device";
+        if (!realpath(intf.c_str(), real)) continue;
+        std::string usb = real;
+        usb = usb.substr(0, usb.rfind('/'));        // interface → device
+
+        if (read_line(usb + "/idVendor") != USB_VID || read_line(usb + "/idProduct") != USB_PID)
+            continue;
+        out.push_back({ "/dev/" + name, read_line(usb + "/serial") });
+    }
+    closedir(d);
+
+    std::sort(out.begin(), out.end(),
+              [](const reader_port &a, const reader_port &b) { return a.path < b.path; });
+    return out;
+}
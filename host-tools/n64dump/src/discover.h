@@ -0,0 +1,24 @@
+/* discover.h – find the readers plugged into this machine */
+#ifndef N64DUMP_DISCOVER_H_
+#define N64DUMP_DISCOVER_H_
+
+#include <string>
+#include <vector>
+
+// ======================================================================
+// Discovery
+// Purpose: List the CDC ports whose USB device is a reader (VID 2E8A,
+//          PID 000A, as in the firmware's descriptors) by walking
+//          /sys/class/tty. The serial number tells boards apart across
+//          replugs, where the ttyACM number does not.
+// ======================================================================
+
+struct reader_port {
+    std::string path;       // /dev/ttyACMn
+    std::string serial;     // USB serial number, empty if unknown
+};
+
+// Sorted by path
+std::vector<reader_port> discover_readers();
+
+#endif /* N64DUMP_DISCOVER_H_ */
@@ -0,0 +1,82 @@
+/* image_writer.cpp – buffered sequential file output */
+#include "image_writer.h"
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+#define MAX_SUFFIX 99u
+
+image_writer::~image_writer() {
+    if (fd_ >= 0) finish();
+}
+
+bool image_writer::create(const std::string &dir, const std::string &stem, const std::string &ext,
+                          std::string &path, std::string &err) {
+    for (unsigned k = 1; k <= MAX_SUFFIX; ++k) {
+        path = dir + "/" + stem + (k > 1 ? " (" + std::to_string(k) + ")" : "") + "." + ext;
+        // O_EXCL: two readers with the same cart race for the same name
+        fd_ = ::open(path.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+        if (fd_ >= 0) break;
+        if (errno != EEXIST) {
+            err = path + ": " + std::strerror(errno);
+            return false;
+        }
+    }
+    if (fd_ < 0) {
+        err = "too many dumps named " + stem;
+        return false;
+    }
+    path_  = path;
+    bytes_ = 0;
+    ok_    = true;
+    buf_.clear();
+    buf_.reserve(BUFFER_BYTES);
+    return true;
+}
+
+bool image_writer::append(const void *data, size_t len) {
+    const uint8_t *p = static_cast<const uint8_t *>(data);
+    while (len) {
+        size_t n = BUFFER_BYTES - buf_.size();
+        if (n > len) n = len;
+        buf_.insert(buf_.end(), p, p + n);
+        p      += n;
+        len    -= n;
+        bytes_ += n;
+        if (buf_.size() == BUFFER_BYTES && !flush()) return false;
+    }
+    return ok_;
+}
+
+bool image_writer::flush() {
+    const uint8_t *p = buf_.data();
+    size_t left = buf_.size();
+    while (ok_ && left) {
+        ssize_t n = ::write(fd_, p, left);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) ok_ = false;
+        else {
+            p    += n;
+            left -= static_cast<size_t>(n);
+        }
+    }
+    buf_.clear();
+    return ok_;
+}
+
+bool image_writer::finish() {
+    if (fd_ < 0) return ok_;
+    flush();
+    if (::close(fd_) != 0) ok_ = false;
+    fd_ = -1;
+    return ok_;
+}
+
+void image_writer::discard() {
+    if (fd_ >= 0) ::close(fd_);
+    fd_ = -1;
+    if (!path_.empty()) ::unlink(path_.c_str());
+    buf_.clear();
+}
@@ -0,0 +1,50 @@
+/* image_writer.h – one dump file, written front to back in big pieces */
+#ifndef N64DUMP_IMAGE_WRITER_H_
+#define N64DUMP_IMAGE_WRITER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// ======================================================================
+// Image writer
+// Purpose: Collect 4 KiB frames into a large buffer and hand it to the
+//          kernel one big write() at a time, so several readers
+//          dumping at once do not interleave small writes on the disk.
+//          The go-back-N protocol only ever delivers the next byte, so
+//          the file is strictly sequential.
+// ======================================================================
+
+class image_writer {
+public:
+    static constexpr size_t BUFFER_BYTES = 1u << 20;
+
+    image_writer() = default;
+    ~image_writer();
+    image_writer(const image_writer &) = delete;
+    image_writer &operator=(const image_writer &) = delete;
+
+    // Create "<stem>.<ext>" in 'dir', or "<stem> (2).<ext>" and so on if
+    // that exists; never overwrites. 'path' gets the name used.
+    bool create(const std::string &dir, const std::string &stem, const std::string &ext,
+                std::string &path, std::string &err);
+    bool append(const void *data, size_t len);
+    // Flush the tail and close; false if any write failed
+    bool finish();
+    // Close and delete the file (failed dump)
+    void discard();
+
+    uint64_t bytes() const { return bytes_; }
+
+private:
+    bool flush();
+
+    int                  fd_ = -1;
+    std::string          path_;
+    std::vector<uint8_t> buf_;
+    uint64_t             bytes_ = 0;
+    bool                 ok_ = true;
+};
+
+#endif /* N64DUMP_IMAGE_WRITER_H_ */
@@ -0,0 +1,235 @@
+/*  main.cpp – n64dump: dump every connected reader at once
+ *  ---------------------------------------------------------------
+ *  • Without port arguments it dumps every reader it finds in sysfs
+ *  • One thread per reader; the main thread only prints progress
+ *  • Prints each reader's throughput and the total at the end; exit 1
+ *    if any dump failed
+ *  • -g reads a list of small ranges from each reader in one GATHER
+ *    round trip and hex-dumps them instead
+ *  • -a waits for the readers' auto dumps (CLI: Game Cartridge → Auto
+ *    Dump, without an SD card) and takes ROM and save of every cart
+ *    they announce until Ctrl-C
+ */
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <app/xfer.h>
+
+#include "discover.h"
+#include "reader.h"
+
+#define MIB (1024.0 * 1024.0)
+
+static void usage(const char *argv0) {
+    std::fprintf(stderr,
+        "usage: %s [options] [PORT...]\n"
+        "  -o DIR             write the dumps here (default: .)\n"
+        "  -r REGION          rom (default), sram, eeprom or flashram\n"
+        "  -w FRAMES          frames in flight per reader (default 32)\n"
+        "  -f BYTES           payload bytes per frame (default 4096)\n"
+        "  -l                 list the readers found and exit\n"
+        "  -a                 auto mode: dump every cart the readers announce,\n"
+        "                     ROM and save, until Ctrl-C\n"
+        "  -g ADDR:LEN,...    hex-dump these cart bus ranges (hex address, e.g.\n"
+        "                     10000020:20 for the title) in one request\n"
+        "Without PORT every reader on USB (VID 2E8A, PID 000A) is dumped.\n",
+        argv0);
+}
+
+static bool parse_region(const char *s, uint8_t &out) {
+    if      (!std::strcmp(s, "rom"))      out = XFER_REGION_ROM;
+    else if (!std::strcmp(s, "sram"))     out = XFER_REGION_SRAM;
+    else if (!std::strcmp(s, "eeprom"))   out = XFER_REGION_EEPROM;
+    else if (!std::strcmp(s, "flashram")) out = XFER_REGION_FLASHRAM;
+    else return false;
+    return true;
+}
+
+// "10000020:20,08000000:10": hex address, decimal or 0x length
+static bool parse_ranges(const char *s, std::vector<xfer_range_t> &out) {
+    while (*s) {
+        char *end;
+        xfer_range_t r;
+        r.addr = static_cast<uint32_t>(std::strtoul(s, &end, 16));
+        if (*end != ':') return false;
+        r.len = static_cast<uint32_t>(std::strtoul(end + 1, &end, 0));
+        if (*end && *end != ',') return false;
+        out.push_back(r);
+        s = *end ? end + 1 : end;
+    }
+    return !out.empty() && out.size() <= XFER_GATHER_MAX_RANGES;
+}
+
+static bool gather_all(const std::vector<reader_port> &ports, const std::vector<xfer_range_t> &ranges) {
+    bool all_ok = true;
+    for (const auto &p : ports) {
+        gather_result r = run_gather(p, ranges);
+        if (!r.ok) {
+            std::printf("%-14s FAILED: %s\n", p.path.c_str(), r.error.c_str());
+            all_ok = false;
+            continue;
+        }
+        std::printf("%s: %u ranges in %u runs, %u bytes (%u read), %u us on the device, "
+                    "%.1f ms round trip\n", p.path.c_str(), r.done.ranges, r.done.runs,
+                    r.done.bytes, r.done.bus_bytes, r.done.us, r.seconds * 1000.0);
+        size_t at = 0;
+        for (const auto &g : ranges) {
+            for (uint32_t i = 0; i < g.len; i += 16u) {
+                std::printf("  %08X:", g.addr + i);
+                for (uint32_t j = i; j < g.len && j < i + 16u; ++j) std::printf(" %02X", r.data[at + j]);
+                std::printf("\n");
+            }
+            at += g.len;
+        }
+    }
+    return all_ok;
+}
+
+// One thread per reader, each waiting for its carts
+static bool auto_all(const std::vector<reader_port> &ports, const dump_options &opt) {
+    size_t n = ports.size();
+    std::vector<auto_result> res(n);
+    std::vector<std::thread> threads;
+    std::fprintf(stderr, "waiting for carts on %zu reader(s); Ctrl-C stops\n", n);
+    auto t0 = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < n; ++i) {
+        threads.emplace_back([&, i] { res[i] = run_auto(ports[i], opt); });
+    }
+    for (auto &t : threads) t.join();
+    double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    uint32_t carts = 0, failed = 0;
+    uint64_t bytes = 0;
+    for (size_t i = 0; i < n; ++i) {
+        if (!res[i].error.empty()) std::printf("%-14s stopped: %s\n", ports[i].path.c_str(), res[i].error.c_str());
+        carts  += res[i].carts;
+        failed += res[i].failed;
+        bytes  += res[i].bytes;
+    }
+    std::printf("total: %u carts (%u failed), %.2f MiB in %.0f s, %.0f carts/hour\n",
+                carts, failed, bytes / MIB, wall, wall > 0 ? carts * 3600.0 / wall : 0.0);
+    return failed == 0;
+}
+
+static void on_sigint(int) { g_stop = true; }
+
+int main(int argc, char **argv) {
+    dump_options             opt;
+    std::vector<reader_port> ports;
+    std::vector<xfer_range_t> ranges;
+    bool                     list = false;
+    bool                     autom = false;
+
+    for (int i = 1; i < argc; ++i) {
+        const char *a = argv[i];
+        const char *v = (i + 1 < argc) ? argv[i + 1] : nullptr;
+        if (!std::strcmp(a, "-l")) {
+            list = true;
+        } else if (!std::strcmp(a, "-a")) {
+            autom = true;
+        } else if (a[0] == '-' && !v) {
+            usage(argv[0]);
+            return 2;
+        } else if (!std::strcmp(a, "-o")) {
+            opt.out_dir = v;
+            ++i;
+        } else if (!std::strcmp(a, "-r")) {
+            if (!parse_region(v, opt.region)) {
+                usage(argv[0]);
+                return 2;
+            }
+            ++i;
+        } else if (!std::strcmp(a, "-g")) {
+            if (!parse_ranges(v, ranges)) {
+                usage(argv[0]);
+                return 2;
+            }
+            ++i;
+        } else if (!std::strcmp(a, "-w")) {
+            opt.window = static_cast<uint16_t>(std::atoi(v));
+            ++i;
+        } else if (!std::strcmp(a, "-f")) {
+            opt.frame_size = static_cast<uint16_t>(std::atoi(v));
+            ++i;
+        } else if (a[0] == '-') {
+            usage(argv[0]);
+            return 2;
+        } else {
+            ports.push_back({ a, "" });
+        }
+    }
+    if (ports.empty()) ports = discover_readers();
+    if (list) {
+        for (const auto &p : ports) std::printf("%s  %s\n", p.path.c_str(), p.serial.c_str());
+        return 0;
+    }
+    if (ports.empty()) {
+        std::fprintf(stderr, "no readers found\n");
+        return 1;
+    }
+
+    std::signal(SIGINT, on_sigint);
+    if (!ranges.empty()) return gather_all(ports, ranges) ? 0 : 1;
+    if (autom) return auto_all(ports, opt) ? 0 : 1;
+
+    // ---- one session thread per reader ----
+    size_t n = ports.size();
+    std::unique_ptr<dump_progress[]> prog(new dump_progress[n]);
+    std::vector<dump_result>         res(n);
+    std::vector<std::thread>         threads;
+    auto t0 = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < n; ++i) {
+        threads.emplace_back([&, i] { res[i] = run_dump(ports[i], opt, prog[i]); });
+    }
+
+    // ---- progress, once a second; the wall clock stops with the last reader ----
+    for (unsigned tick = 1; ; ++tick) {
+        size_t done = 0;
+        for (size_t i = 0; i < n; ++i) done += prog[i].finished ? 1 : 0;
+        if (done == n) break;
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        if (tick % 10u) continue;
+        double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        uint64_t all = 0;
+        std::fprintf(stderr, "\r");
+        for (size_t i = 0; i < n; ++i) {
+            uint64_t b = prog[i].bytes;
+            all += b;
+            std::fprintf(stderr, "%s %.1f MiB  ", ports[i].path.c_str(), b / MIB);
+        }
+        std::fprintf(stderr, "| %.2f MiB/s ", all / MIB / s);
+    }
+    for (auto &t : threads) t.join();
+    double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    std::fprintf(stderr, "\n");
+
+    // ---- report ----
+    uint64_t total  = 0;
+    bool     all_ok = true;
+    for (size_t i = 0; i < n; ++i) {
+        const dump_result &r = res[i];
+        if (!r.ok) {
+            std::printf("%-14s FAILED: %s\n", ports[i].path.c_str(), r.error.c_str());
+            all_ok = false;
+            continue;
+        }
+        total += r.bytes;
+        std::printf("%-14s %-32s %8.2f MiB %7.2f s %6.2f MiB/s  crc %08X  "
+                    "%u NAKs, %u bad frames, stalls %u cart / %u USB\n"
+                    "%-14s md5 %s  sha1 %s\n",
+                    ports[i].path.c_str(), r.file.c_str(), r.bytes / MIB, r.seconds,
+                    r.seconds > 0 ? r.bytes / MIB / r.seconds : 0.0, r.crc32,
+                    r.naks, r.bad_frames, r.producer_stalls, r.consumer_stalls,
+                    "", r.md5.empty() ? "-" : r.md5.c_str(), r.sha1.empty() ? "-" : r.sha1.c_str());
+    }
+    std::printf("total: %zu reader(s), %.2f MiB in %.2f s, %.2f MiB/s\n",
+                n, total / MIB, wall, wall > 0 ? total / MIB / wall : 0.0);
+    return all_ok ? 0 : 1;
+}
@@ -0,0 +1,447 @@
+/* reader.cpp – xfer.h client for one reader
+ *  ---------------------------------------------------------------
+ *  • The port is read in large chunks and parsed like the firmware
+ *    does it: hunt for the SOF, take the header, check the CRC, and
+ *    drop one byte to resync on anything that does not parse
+ *  • Frames are accepted in sequence only (go-back-N); one ACK per
+ *    quarter window keeps the device's window open without an upstream
+ *    packet per frame
+ *  • ROM dumps are named after the header title in the first frame;
+ *    saves after the board's serial number
+ *  • Silence for ACK_TIMEOUT_MS repeats the last ACK (or the START);
+ *    after MAX_RETRIES of those the reader counts as gone
+ *  • Auto mode keeps the port open between carts and runs the same
+ *    dump session on it once per region
+ */
+#include "reader.h"
+
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include <app/xfer.h>
+
+#include "image_writer.h"
+#include "serial_port.h"
+
+#define ACK_TIMEOUT_MS   1500
+#define MAX_RETRIES      10u
+#define READ_CHUNK       (64u * 1024u)
+
+std::atomic<bool> g_stop{false};
+
+/* ------------------------------------------------------------ */
+/*  CRC-32                                                       */
+/* ------------------------------------------------------------ */
+// Same polynomial as app/crc32.h; the table is built at compile time,
+// so threads share it without a first-use race
+static constexpr std::array<uint32_t, 256> crc_table = [] {
+    std::array<uint32_t, 256> t{};
+    for (uint32_t i = 0; i < 256; ++i) {
+        uint32_t c = i;
+        for (int k = 0; k < 8; ++k) c = (c & 1u) ? (c >> 1) ^ 0xEDB88320u : (c >> 1);
+        t[i] = c;
+    }
+    return t;
+}();
+
+static uint32_t crc32_update(uint32_t crc, const void *data, size_t len) {
+    const uint8_t *p = static_cast<const uint8_t *>(data);
+    crc = ~crc;
+    while (len--) crc = crc_table[(crc ^ *p++) & 0xFFu] ^ (crc >> 8);
+    return ~crc;
+}
+
+static std::string hex(const uint8_t *p, size_t n) {
+    static const char digits[] = "0123456789abcdef";
+    std::string s;
+    for (size_t i = 0; i < n; ++i) {
+        s += digits[p[i] >> 4];
+        s += digits[p[i] & 0x0Fu];
+    }
+    return s;
+}
+
+/* ------------------------------------------------------------ */
+/*  Frames                                                       */
+/* ------------------------------------------------------------ */
+static uint32_t frame_crc(const xfer_header_t &h, const uint8_t *payload) {
+    uint32_t crc = crc32_update(0, &h, offsetof(xfer_header_t, crc));
+    return crc32_update(crc, payload, h.len);
+}
+
+static bool send_frame(serial_port &port, uint8_t type, uint32_t seq, uint32_t offset,
+                       const void *payload = nullptr, uint16_t len = 0) {
+    uint8_t buf[XFER_HEADER_LEN + 64];
+    xfer_header_t h{};
+    h.sof[0] = XFER_SOF0;
+    h.sof[1] = XFER_SOF1;
+    h.type   = type;
+    h.seq    = seq;
+    h.offset = offset;
+    h.len    = len;
+    h.crc    = frame_crc(h, static_cast<const uint8_t *>(payload));
+    std::memcpy(buf, &h, sizeof(h));
+    if (len) std::memcpy(&buf[sizeof(h)], payload, len);
+    return port.write_all(buf, sizeof(h) + len);
+}
+
+// Byte stream in, whole frames out
+class frame_parser {
+public:
+    void feed(const uint8_t *p, size_t n) { buf_.insert(buf_.end(), p, p + n); }
+
+    // Next frame with a good CRC; 'payload' points into the parser and
+    // stays valid until the next call
+    bool next(xfer_header_t &h, const uint8_t *&payload) {
+        for (;;) {
+            size_t avail = buf_.size() - pos_;
+            const uint8_t *p = buf_.data() + pos_;
+            if (avail < 2) break;
+            if (p[0] != XFER_SOF0 || p[1] != XFER_SOF1) {
+                skip(1);
+                continue;
+            }
+            if (avail < XFER_HEADER_LEN) break;
+            std::memcpy(&h, p, sizeof(h));
+            if (h.len > XFER_MAX_PAYLOAD) {
+                skip(1);
+                bad++;
+                continue;
+            }
+            if (avail < XFER_HEADER_LEN + h.len) break;
+            if (frame_crc(h, p + XFER_HEADER_LEN) != h.crc) {
+                skip(1);
+                bad++;
+                continue;
+            }
+            payload = p + XFER_HEADER_LEN;
+            skip(XFER_HEADER_LEN + h.len);
+            return true;
+        }
+        // Keep the unparsed tail at the front
+        buf_.erase(buf_.begin(), buf_.begin() + static_cast<long>(pos_));
+        pos_ = 0;
+        return false;
+    }
+
+    uint32_t bad = 0;
+
+private:
+    void skip(size_t n) { pos_ += n; }
+
+    std::vector<uint8_t> buf_;
+    size_t               pos_ = 0;
+};
+
+/* ------------------------------------------------------------ */
+/*  Naming                                                       */
+/* ------------------------------------------------------------ */
+static const char *region_ext(uint8_t region) {
+    switch (region) {
+    case XFER_REGION_ROM:      return "z64";
+    case XFER_REGION_SRAM:     return "sra";
+    case XFER_REGION_EEPROM:   return "eep";
+    case XFER_REGION_FLASHRAM: return "fla";
+    default:                   return "bin";
+    }
+}
+
+// Header title (0x20, 20 bytes), cleaned up for a file name
+static std::string rom_title(const uint8_t *first, size_t len) {
+    std::string s;
+    for (size_t i = 0x20; i < 0x34 && i < len; ++i) {
+        char c = static_cast<char>(first[i]);
+        if (c == '\0') break;
+        s += (c < 0x20 || c > 0x7E || std::strchr("\\/:*?\"<>|", c)) ? '_' : c;
+    }
+    while (!s.empty() && (s.back() == ' ' || s.back() == '.')) s.pop_back();
+    return s;
+}
+
+/* ------------------------------------------------------------ */
+/*  Session                                                      */
+/* ------------------------------------------------------------ */
+// One region over a port that is already open
+static dump_result dump_on(serial_port &port, const reader_port &rp, const dump_options &opt,
+                           dump_progress &prog) {
+    using clock = std::chrono::steady_clock;
+    dump_result  r;
+    image_writer out;
+    frame_parser fp;
+
+    auto fail = [&](const std::string &why) {
+        r.error = why;
+        out.discard();
+        prog.finished = true;
+        return r;
+    };
+
+    xfer_start_t st{};
+    st.region     = opt.region;
+    st.length     = opt.length;
+    st.frame_size = opt.frame_size;
+    st.window     = opt.window;
+    if (!send_frame(port, XFER_T_START, 0, 0, &st, sizeof(st))) return fail("write failed");
+    auto t0 = clock::now();
+
+    const uint32_t ack_every = opt.window >= 4 ? opt.window / 4u : 1u;
+    std::vector<uint8_t> rx(READ_CHUNK);
+    uint32_t expect   = 0;          // next frame wanted
+    uint32_t acked    = 0;          // last ACK sent
+    uint32_t nak_sent = UINT32_MAX; // seq of the last NAK, to send it once
+    uint32_t retries  = 0;
+    bool     opened   = false;
+
+    while (!g_stop) {
+        long n = port.read_some(rx.data(), rx.size(), ACK_TIMEOUT_MS);
+        if (n < 0) return fail("device gone");
+        if (n == 0) {
+            if (++retries > MAX_RETRIES) return fail("no answer");
+            // Lost ACK or lost START: say it again
+            bool ok = expect ? send_frame(port, XFER_T_ACK, expect, 0)
+                             : send_frame(port, XFER_T_START, 0, 0, &st, sizeof(st));
+            if (!ok) return fail("write failed");
+            continue;
+        }
+        fp.feed(rx.data(), static_cast<size_t>(n));
+
+        xfer_header_t  h;
+        const uint8_t *pl;
+        while (fp.next(h, pl)) {
+            retries = 0;
+            if (h.type == XFER_T_ERROR) {
+                return fail("device: " + std::string(reinterpret_cast<const char *>(pl), h.len));
+            }
+            if (h.type == XFER_T_DATA) {
+                if (h.seq > expect) {
+                    // A frame went missing: go back to it, once per gap
+                    if (nak_sent != expect) {
+                        if (!send_frame(port, XFER_T_NAK, expect, 0)) return fail("write failed");
+                        nak_sent = expect;
+                        r.naks++;
+                    }
+                    continue;
+                }
+                if (h.seq < expect) continue;           // resend of a frame we have
+                if (!opened) {
+                    std::string stem = !opt.stem.empty() ? opt.stem :
+                                       opt.region == XFER_REGION_ROM ? rom_title(pl, h.len) : "";
+                    if (stem.empty()) stem = rp.serial.empty() ? "n64" : rp.serial;
+                    if (!out.create(opt.out_dir, stem, region_ext(opt.region), r.file, r.error))
+                        return fail(r.error);
+                    opened = true;
+                }
+                if (!out.append(pl, h.len)) return fail(r.file + ": write failed");
+                r.crc32 = crc32_update(r.crc32, pl, h.len);
+                prog.bytes = out.bytes();
+                expect++;
+                if (expect - acked >= ack_every) {
+                    if (!send_frame(port, XFER_T_ACK, expect, 0)) return fail("write failed");
+                    acked = expect;
+                }
+                continue;
+            }
+            if (h.type == XFER_T_DONE && h.len >= sizeof(xfer_done_t)) {
+                if (h.seq != expect) {
+                    // DONE overtook a lost frame
+                    if (!send_frame(port, XFER_T_NAK, expect, 0)) return fail("write failed");
+                    r.naks++;
+                    continue;
+                }
+                xfer_done_t d;
+                std::memcpy(&d, pl, sizeof(d));
+                r.seconds = std::chrono::duration<double>(clock::now() - t0).count();
+                send_frame(port, XFER_T_ACK, expect + 1u, 0);
+                r.device_crc32    = d.crc32;
+                if (!(d.flags & XFER_DONE_PARTIAL)) {
+                    r.md5  = hex(d.md5, sizeof(d.md5));
+                    r.sha1 = hex(d.sha1, sizeof(d.sha1));
+                }
+                r.producer_stalls = d.producer_stalls;
+                r.consumer_stalls = d.consumer_stalls;
+                r.bytes           = out.bytes();
+                r.bad_frames      = fp.bad;
+                prog.total        = d.length;
+                if (!out.finish()) return fail(r.file + ": write failed");
+                if (r.bytes != d.length) return fail("short dump");
+                if (r.crc32 != d.crc32) return fail("CRC-32 differs from the device's");
+                r.ok = true;
+                prog.finished = true;
+                return r;
+            }
+        }
+    }
+    send_frame(port, XFER_T_ABORT, 0, 0);
+    return fail("interrupted");
+}
+
+dump_result run_dump(const reader_port &rp, const dump_options &opt, dump_progress &prog) {
+    serial_port port;
+    dump_result r;
+    if (!port.open(rp.path, r.error)) {
+        r.error = rp.path + ": " + r.error;
+        prog.finished = true;
+        return r;
+    }
+    port.discard_input();
+    return dump_on(port, rp, opt, prog);
+}
+
+/* ------------------------------------------------------------ */
+/*  Gather                                                       */
+/* ------------------------------------------------------------ */
+// Nothing is acknowledged, so a lost frame means asking again
+gather_result run_gather(const reader_port &rp, const std::vector<xfer_range_t> &ranges) {
+    using clock = std::chrono::steady_clock;
+    gather_result r;
+    serial_port   port;
+
+    if (!port.open(rp.path, r.error)) {
+        r.error = rp.path + ": " + r.error;
+        return r;
+    }
+    port.discard_input();
+
+    uint32_t want = 0;
+    for (const auto &g : ranges) want += g.len;
+    uint16_t len = static_cast<uint16_t>(ranges.size() * sizeof(xfer_range_t));
+    std::vector<uint8_t> rx(READ_CHUNK);
+
+    for (uint32_t tries = 0; tries <= MAX_RETRIES && !g_stop; ++tries) {
+        frame_parser fp;
+        r.data.clear();
+        if (!send_frame(port, XFER_T_GATHER, 0, 0, ranges.data(), len)) {
+            r.error = "write failed";
+            return r;
+        }
+        auto t0 = clock::now();
+        uint32_t expect = 0;
+        bool     lost   = false;
+        while (!lost) {
+            long n = port.read_some(rx.data(), rx.size(), ACK_TIMEOUT_MS);
+            if (n < 0) {
+                r.error = "device gone";
+                return r;
+            }
+            if (n == 0) break;
+            fp.feed(rx.data(), static_cast<size_t>(n));
+
+            xfer_header_t  h;
+            const uint8_t *pl;
+            while (!lost && fp.next(h, pl)) {
+                if (h.type == XFER_T_ERROR) {
+                    r.error = "device: " + std::string(reinterpret_cast<const char *>(pl), h.len);
+                    return r;
+                }
+                if (h.type == XFER_T_DATA) {
+                    lost = h.seq != expect++ || h.offset != r.data.size();
+                    r.data.insert(r.data.end(), pl, pl + h.len);
+                } else if (h.type == XFER_T_DONE && h.len >= sizeof(xfer_gather_done_t)) {
+                    std::memcpy(&r.done, pl, sizeof(r.done));
+                    if (h.seq != expect || r.data.size() != want) {
+                        lost = true;
+                        break;
+                    }
+                    r.seconds = std::chrono::duration<double>(clock::now() - t0).count();
+                    r.ok = true;
+                    return r;
+                }
+            }
+        }
+        // Let the rest of a broken answer drain before asking again
+        port.discard_input();
+    }
+    r.error = "no answer";
+    return r;
+}
+
+/* ------------------------------------------------------------ */
+/*  Auto mode                                                    */
+/* ------------------------------------------------------------ */
+// "dir/Name (2).z64" → "Name (2)"
+static std::string file_stem(const std::string &path) {
+    size_t a = path.find_last_of('/');
+    a = a == std::string::npos ? 0 : a + 1;
+    size_t b = path.find_last_of('.');
+    return path.substr(a, b == std::string::npos || b < a ? std::string::npos : b - a);
+}
+
+// ROM, then the save under the ROM's name; ABORT tells the reader the
+// host is done with the cart either way
+static bool dump_cart(serial_port &port, const reader_port &rp, const dump_options &opt,
+                      const xfer_header_t &h, const xfer_cart_t &c, auto_result &res) {
+    char id[5] = { 0 };
+    for (unsigned i = 0; i < 4; ++i) id[i] = (c.cart_id[i] >= 0x20 && c.cart_id[i] <= 0x7E) ? c.cart_id[i] : '?';
+
+    dump_options  o = opt;
+    dump_progress prog;
+    o.region = XFER_REGION_ROM;
+    o.length = c.rom_bytes;
+    dump_result rom = dump_on(port, rp, o, prog);
+    dump_result save;
+    save.ok = true;
+    if (rom.ok && c.save_region != XFER_REGION_NONE) {
+        dump_progress sprog;
+        o.region = c.save_region;
+        o.length = c.save_bytes;
+        o.stem   = file_stem(rom.file);
+        save = dump_on(port, rp, o, sprog);
+    }
+    send_frame(port, XFER_T_ABORT, 0, 0);
+
+    bool ok = rom.ok && save.ok;
+    if (ok) {
+        res.carts++;
+        res.bytes += rom.bytes + save.bytes;
+        std::printf("%s: cart %u %s v%u: %s, %.2f MiB in %.2f s, crc %08X md5 %s sha1 %s%s%s\n",
+                    rp.path.c_str(), h.seq, id, c.version, rom.file.c_str(),
+                    rom.bytes / (1024.0 * 1024.0), rom.seconds + save.seconds, rom.crc32,
+                    rom.md5.empty() ? "-" : rom.md5.c_str(),
+                    rom.sha1.empty() ? "-" : rom.sha1.c_str(),
+                    save.file.empty() ? "" : ", ", save.file.c_str());
+    } else {
+        res.failed++;
+        std::printf("%s: cart %u %s v%u FAILED: %s\n", rp.path.c_str(), h.seq, id, c.version,
+                    (rom.ok ? save : rom).error.c_str());
+    }
+    std::fflush(stdout);
+    return ok;
+}
+
+auto_result run_auto(const reader_port &rp, const dump_options &opt) {
+    auto_result  res;
+    serial_port  port;
+    if (!port.open(rp.path, res.error)) {
+        res.error = rp.path + ": " + res.error;
+        return res;
+    }
+    port.discard_input();
+
+    std::vector<uint8_t> rx(READ_CHUNK);
+    frame_parser fp;
+    uint32_t     last = 0;          // number of the cart handled last
+    while (!g_stop) {
+        long n = port.read_some(rx.data(), rx.size(), ACK_TIMEOUT_MS);
+        if (n < 0) {
+            res.error = "device gone";
+            return res;
+        }
+        fp.feed(rx.data(), static_cast<size_t>(n));
+
+        xfer_header_t  h;
+        const uint8_t *pl;
+        while (!g_stop && fp.next(h, pl)) {
+            // A repeat of the cart just done is still in the buffer
+            if (h.type != XFER_T_CART || h.len < sizeof(xfer_cart_t) || h.seq == last) continue;
+            xfer_cart_t c;
+            std::memcpy(&c, pl, sizeof(c));
+            last = h.seq;
+            dump_cart(port, rp, opt, h, c, res);
+            fp = frame_parser();
+        }
+    }
+    return res;
+}
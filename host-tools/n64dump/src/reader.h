@@ -0,0 +1,88 @@
+/* reader.h – one reader, one dump, on its own thread */
+#ifndef N64DUMP_READER_H_
+#define N64DUMP_READER_H_
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <app/xfer.h>
+
+#include "discover.h"
+
+// ======================================================================
+// Reader session
+// Purpose: Run one region dump against one reader: START, take DATA
+//          frames in order, ACK them cumulatively, NAK the first
+//          missing frame, and check the device's CRC-32 in DONE
+//          against the bytes written. DONE's MD5 and SHA-1 are kept
+//          for DAT matching. Every reader gets a thread that
+//          blocks only on its own port and its own file, so readers
+//          never wait for each other.
+//          A GATHER asks for a list of small ranges in one frame and
+//          gets them back in one burst of frames.
+//          In auto mode the reader speaks first: it sends CART for each
+//          new cart in its slot, the session dumps ROM and save and
+//          sends ABORT, and the reader signals that the cart can go.
+// ======================================================================
+
+struct dump_options {
+    std::string out_dir = ".";
+    uint8_t     region  = 0;        // XFER_REGION_*
+    uint16_t    frame_size = 4096;
+    uint16_t    window     = 32;
+    uint32_t    length     = 0;     // region bytes, 0 = the device's default
+    std::string stem;               // file name without extension, "" = from the data
+};
+
+struct dump_progress {
+    std::atomic<uint64_t> bytes{0};
+    std::atomic<uint64_t> total{0};     // known once DONE arrives, else 0
+    std::atomic<bool>     finished{false};
+};
+
+struct dump_result {
+    bool        ok = false;
+    std::string error;
+    std::string file;
+    uint64_t    bytes = 0;
+    double      seconds = 0;            // START to DONE
+    uint32_t    crc32 = 0;              // of the file
+    uint32_t    device_crc32 = 0;       // from DONE
+    std::string md5, sha1;              // hex, from DONE; "" if it had none
+                                        //   (XFER_DONE_PARTIAL)
+    uint32_t    naks = 0;               // gaps asked for again
+    uint32_t    bad_frames = 0;         // CRC errors, resynced
+    uint32_t    producer_stalls = 0;    // device: the cart waited for USB
+    uint32_t    consumer_stalls = 0;    // device: USB waited for the cart
+};
+
+// Set from the SIGINT handler; sessions ABORT and stop
+extern std::atomic<bool> g_stop;
+
+dump_result run_dump(const reader_port &port, const dump_options &opt, dump_progress &prog);
+
+// One GATHER: the bytes of every range, concatenated in request order
+struct gather_result {
+    bool                 ok = false;
+    std::string          error;
+    std::vector<uint8_t> data;
+    xfer_gather_done_t   done{};
+    double               seconds = 0;   // GATHER sent to DONE
+};
+
+gather_result run_gather(const reader_port &port, const std::vector<xfer_range_t> &ranges);
+
+// Auto mode: every cart the reader announces, until g_stop or the
+// reader goes away. Each cart is reported on stdout as it finishes.
+struct auto_result {
+    uint32_t    carts = 0;
+    uint32_t    failed = 0;
+    uint64_t    bytes = 0;
+    std::string error;                  // why the session ended, "" on g_stop
+};
+
+auto_result run_auto(const reader_port &port, const dump_options &opt);
+
+#endif /* N64DUMP_READER_H_ */
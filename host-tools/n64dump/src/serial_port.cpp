@@ -0,0 +1,73 @@
+/* serial_port.cpp – termios/poll() implementation of serial_port.h */
+#include "serial_port.h"
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+
+serial_port::~serial_port() { close(); }
+
+bool serial_port::open(const std::string &path, std::string &err) {
+    close();
+    fd_ = ::open(path.c_str(), O_RDWR | O_NOCTTY | O_CLOEXEC);
+    if (fd_ < 0) {
+        err = std::strerror(errno);
+        return false;
+    }
+    // Pipes and sockets (tests) have no line settings to change
+    struct termios t;
+    if (isatty(fd_)) {
+        if (tcgetattr(fd_, &t) != 0) {
+            err = std::strerror(errno);
+            close();
+            return false;
+        }
+        cfmakeraw(&t);
+        t.c_cflag |= CLOCAL | CREAD;
+        t.c_cc[VMIN]  = 0;
+        t.c_cc[VTIME] = 0;
+        if (tcsetattr(fd_, TCSANOW, &t) != 0) {
+            err = std::strerror(errno);
+            close();
+            return false;
+        }
+    }
+    return true;
+}
+
+void serial_port::close() {
+    if (fd_ >= 0) ::close(fd_);
+    fd_ = -1;
+}
+
+void serial_port::discard_input() {
+    uint8_t buf[4096];
+    if (isatty(fd_)) tcflush(fd_, TCIFLUSH);
+    while (read_some(buf, sizeof(buf), 50) > 0) {}
+}
+
+bool serial_port::write_all(const void *data, size_t len) {
+    const uint8_t *p = static_cast<const uint8_t *>(data);
+    while (len) {
+        ssize_t n = ::write(fd_, p, len);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        p   += n;
+        len -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+long serial_port::read_some(void *dst, size_t max, int timeout_ms) {
+    struct pollfd pfd = { fd_, POLLIN, 0 };
+    int r = poll(&pfd, 1, timeout_ms);
+    if (r < 0) return errno == EINTR ? 0 : -1;
+    if (r == 0) return 0;
+    ssize_t n = ::read(fd_, dst, max);
+    if (n < 0) return (errno == EINTR || errno == EAGAIN) ? 0 : -1;
+    if (n == 0) return -1;                          // hung up
+    return static_cast<long>(n);
+}
@@ -0,0 +1,39 @@
+/* serial_port.h – raw CDC port: blocking writes, reads with a timeout */
+#ifndef N64DUMP_SERIAL_PORT_H_
+#define N64DUMP_SERIAL_PORT_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// ======================================================================
+// Serial port
+// Purpose: Own one reader's tty. The line is put in raw mode, so frames
+//          pass through untouched; the baud rate means nothing to a USB
+//          CDC port and is left alone. Opening asserts DTR, which is
+//          what the firmware's CLI waits for.
+// ======================================================================
+
+class serial_port {
+public:
+    serial_port() = default;
+    ~serial_port();
+    serial_port(const serial_port &) = delete;
+    serial_port &operator=(const serial_port &) = delete;
+
+    // False, with errno's text in 'err', if the port cannot be used
+    bool open(const std::string &path, std::string &err);
+    void close();
+
+    // Drop whatever the device sent before (menu text, an old transfer)
+    void discard_input();
+    bool write_all(const void *data, size_t len);
+    // Up to 'max' bytes; 0 when nothing arrived within timeout_ms, -1 on
+    // an error (device unplugged)
+    long read_some(void *dst, size_t max, int timeout_ms);
+
+private:
+    int fd_ = -1;
+};
+
+#endif /* N64DUMP_SERIAL_PORT_H_ */